@@ -52,6 +52,17 @@ endif
 # 'y' to set the Alignment Check Enable bit in SCTLR/SCTLR_EL1, 'n' to clear it
 CFG_SCTLR_ALIGNMENT_CHECK ?= y
 
+# 'y' if the CPU implements the Generic Timer, that is the CNTPCT and CNTFRQ
+# registers read to timestamp statistics and profiling events. Cortex-A5 and
+# Cortex-A9 don't have it and force this to 'n', such timestamps are then 0.
+CFG_CORE_HAS_GENERIC_TIMER ?= y
+
+ifneq ($(CFG_MUTEX_SPIN_US),0)
+ifneq ($(CFG_CORE_HAS_GENERIC_TIMER),y)
+$(error CFG_MUTEX_SPIN_US requires CFG_CORE_HAS_GENERIC_TIMER=y)
+endif
+endif
+
 ifeq ($(CFG_CORE_LARGE_PHYS_ADDR),y)
 $(call force,CFG_WITH_LPAE,y)
 endif
@@ -4,6 +4,7 @@ $(call force,CFG_WITH_LPAE,n)
 $(call force,CFG_HWSUPP_MEM_PERM_WXN,n)
 $(call force,CFG_HWSUPP_MEM_PERM_PXN,n)
 $(call force,CFG_SECURE_TIME_SOURCE_CNTPCT,n)
+$(call force,CFG_CORE_HAS_GENERIC_TIMER,n)
 arm32-platform-cpuarch 	:= cortex-a9
 arm32-platform-cflags 	+= -mcpu=$(arm32-platform-cpuarch)
 arm32-platform-aflags 	+= -mcpu=$(arm32-platform-cpuarch)
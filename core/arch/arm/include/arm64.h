@@ -215,6 +215,11 @@ static inline void dsb_ishst(void)
 	asm volatile ("dsb ishst");
 }
 
+static inline void dmb(void)
+{
+	asm volatile ("dmb sy");
+}
+
 static inline void write_at_s1e1r(uint64_t va)
 {
 	asm volatile ("at	S1E1R, %0" : : "r" (va));
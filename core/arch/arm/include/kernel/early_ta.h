@@ -9,10 +9,31 @@
 #include <stdint.h>
 #include <tee_api_types.h>
 
+/* Formats of compressed early TAs */
+#define EARLY_TA_FORMAT_DEFLATE		0
+#define EARLY_TA_FORMAT_LZ4		1
+
+/*
+ * An early TA in EARLY_TA_FORMAT_LZ4 is split in blocks of the same
+ * uncompressed size, the last one may be shorter, compressed one by one
+ * in the LZ4 block format so that reading can start at any block. @ta
+ * starts with the following little endian 32-bit words:
+ *
+ * block_size		Uncompressed size of a block
+ * num_blocks		Number of blocks
+ * offs[num_blocks + 1]	Offset of each block from the end of @offs, the
+ *			last one is the end of the last block
+ *
+ * A block whose compressed size equals its uncompressed size is stored
+ * as is.
+ */
+#define EARLY_TA_LZ4_MAX_BLOCK_SIZE	(64 * 1024)
+
 struct early_ta {
 	TEE_UUID uuid;
 	uint32_t size;
 	uint32_t uncompressed_size; /* 0: not compressed */
+	uint32_t format; /* EARLY_TA_FORMAT_*, if compressed */
 	const uint8_t ta[]; /* @size bytes */
 };
 
@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+#ifndef KERNEL_LOCK_PROF_H
+#define KERNEL_LOCK_PROF_H
+
+#include <compiler.h>
+#include <stdbool.h>
+#include <types_ext.h>
+
+struct mutex;
+
+#define LOCK_PROF_TYPE_SPINLOCK	0
+#define LOCK_PROF_TYPE_MUTEX	1
+
+/*
+ * Contention statistics of a lock class, times are in system counter
+ * ticks (CNTPCT)
+ *
+ * @key:	Identifies the lock class: the address of the lock, the same
+ *		identity as used by lockdep, or for mutexes initialized with
+ *		mutex_init() the return address of that call
+ * @type:	LOCK_PROF_TYPE_*
+ * @acquired:	Number of times the lock has been acquired
+ * @contended:	Number of times the lock had to be waited for
+ * @wait_ticks:	Total time spent waiting for the lock
+ * @max_wait_ticks: Longest time spent waiting for the lock
+ * @hold_ticks:	Total time the lock has been held, write locks only for
+ *		mutexes
+ * @max_hold_ticks: Longest time the lock has been held
+ */
+struct lock_prof_stats {
+	uint64_t key;
+	uint32_t type;
+	uint32_t pad;
+	uint64_t acquired;
+	uint64_t contended;
+	uint64_t wait_ticks;
+	uint64_t max_wait_ticks;
+	uint64_t hold_ticks;
+	uint64_t max_hold_ticks;
+};
+
+#ifdef CFG_LOCK_PROFILING
+/* Returns the start timestamp of a wait for a lock */
+uint64_t lock_prof_timestamp(void);
+
+/*
+ * Records an acquisition of a spinlock, @wait_start is 0 if the lock was
+ * acquired without waiting
+ */
+void lock_prof_spin_acquired(unsigned int *lock, uint64_t wait_start);
+void lock_prof_spin_released(unsigned int *lock);
+
+void lock_prof_mutex_init(struct mutex *m, vaddr_t init_site);
+void lock_prof_mutex_acquired(struct mutex *m, bool write,
+			      uint64_t wait_start);
+void lock_prof_mutex_released(struct mutex *m);
+
+/*
+ * Copies the statistics of at most @count lock classes into @stats and
+ * returns the number of lock classes recorded so far
+ */
+size_t lock_prof_get_stats(struct lock_prof_stats *stats, size_t count);
+#else
+static inline uint64_t lock_prof_timestamp(void)
+{
+	return 0;
+}
+
+static inline void lock_prof_spin_acquired(unsigned int *lock __unused,
+					   uint64_t wait_start __unused)
+{
+}
+
+static inline void lock_prof_spin_released(unsigned int *lock __unused)
+{
+}
+
+static inline void lock_prof_mutex_init(struct mutex *m __unused,
+					vaddr_t init_site __unused)
+{
+}
+
+static inline void lock_prof_mutex_acquired(struct mutex *m __unused,
+					    bool write __unused,
+					    uint64_t wait_start __unused)
+{
+}
+
+static inline void lock_prof_mutex_released(struct mutex *m __unused)
+{
+}
+#endif
+
+#endif /*KERNEL_LOCK_PROF_H*/
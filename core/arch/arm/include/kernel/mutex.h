@@ -23,15 +23,35 @@ struct mutex {
 	struct wait_queue wq;
 	short state;		/* -1: write, 0: unlocked, > 0: readers */
 	short owner_id;		/* Only valid for state == -1 (write lock) */
+#ifdef CFG_LOCK_PROFILING
+	vaddr_t init_site;	/* Caller of mutex_init(), 0 if static */
+	uint64_t acquired_at;	/* When last write locked, 0 if not */
+#endif
 };
 #define MUTEX_INITIALIZER \
 	{ .owner_id = MUTEX_OWNER_ID_NONE, .wq = WAIT_QUEUE_INITIALIZER, }
 
 TAILQ_HEAD(mutex_head, mutex);
 
+/*
+ * Statistics on contended mutex acquisitions
+ *
+ * @spin_acquired:	Acquired after spinning while the owner was running
+ *			on another core
+ * @slept_acquired:	Acquired after sleeping in normal world at least once
+ */
+struct mutex_stats {
+	uint32_t spin_acquired;
+	uint32_t slept_acquired;
+};
+
 void mutex_init(struct mutex *m);
 void mutex_destroy(struct mutex *m);
 
+#ifdef CFG_WITH_STATS
+void mutex_get_stats(struct mutex_stats *stats);
+#endif
+
 #ifdef CFG_MUTEX_DEBUG
 void mutex_unlock_debug(struct mutex *m, const char *fname, int lineno);
 #define mutex_unlock(m) mutex_unlock_debug((m), __FILE__, __LINE__)
@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+#ifndef KERNEL_PROFILER_H
+#define KERNEL_PROFILER_H
+
+#include <pta_profiler.h>
+#include <tee_api_types.h>
+#include <types_ext.h>
+
+struct thread_ctx_regs;
+
+#ifdef CFG_CORE_PROFILER
+/*
+ * Records a sample for a thread preempted at @pc in kernel mode, @regs
+ * holds the saved registers of the thread and @stack, @stack_size are the
+ * bounds of its kernel stack. Called with all exceptions masked.
+ */
+void prof_sample(const struct thread_ctx_regs *regs, vaddr_t pc,
+		 vaddr_t stack, size_t stack_size);
+
+/*
+ * Starts sampling into @buf which must be large enough to hold the header
+ * and @samples_per_cpu samples for each CPU, as returned by
+ * prof_buf_size(). @samples_per_cpu must be a power of two.
+ */
+TEE_Result prof_start(void *buf, size_t samples_per_cpu);
+
+/* Stops sampling, the buffer supplied to prof_start() isn't used after this */
+void prof_stop(void);
+
+size_t prof_buf_size(size_t samples_per_cpu);
+#else
+static inline void prof_sample(const struct thread_ctx_regs *regs __unused,
+			       vaddr_t pc __unused, vaddr_t stack __unused,
+			       size_t stack_size __unused)
+{
+}
+#endif
+
+#endif /*KERNEL_PROFILER_H*/
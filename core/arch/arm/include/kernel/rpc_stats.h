@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+#ifndef KERNEL_RPC_STATS_H
+#define KERNEL_RPC_STATS_H
+
+#include <compiler.h>
+#include <types_ext.h>
+
+/*
+ * Commands with a larger id are all accounted to a single entry with
+ * @cmd set to RPC_STATS_CMD_OTHER
+ */
+#define RPC_STATS_NUM_CMDS	32
+#define RPC_STATS_CMD_OTHER	RPC_STATS_NUM_CMDS
+#define RPC_STATS_NUM_BUCKETS	32
+
+/*
+ * Latency of the normal world servicing an OPTEE_RPC_CMD_*, times are in
+ * system counter ticks (CNTPCT)
+ *
+ * @cmd:	OPTEE_RPC_CMD_* or RPC_STATS_CMD_OTHER
+ * @in_flight:	Number of requests currently serviced by normal world
+ * @count:	Number of completed requests
+ * @total_ticks: Accumulated latency of the completed requests
+ * @max_ticks:	Longest latency
+ * @buckets:	@buckets[n] counts the requests which took 2^n to
+ *		2^(n+1) - 1 ticks, the last bucket also counts all longer
+ *		requests
+ */
+struct rpc_cmd_stats {
+	uint32_t cmd;
+	uint32_t in_flight;
+	uint64_t count;
+	uint64_t total_ticks;
+	uint64_t max_ticks;
+	uint32_t buckets[RPC_STATS_NUM_BUCKETS];
+};
+
+#ifdef CFG_WITH_STATS
+/* Returns the start time of a request passed to rpc_stats_end() */
+uint64_t rpc_stats_begin(uint32_t cmd);
+void rpc_stats_end(uint32_t cmd, uint64_t begin);
+
+/*
+ * Copies the statistics of at most @count commands which have been
+ * requested into @stats and returns the number of such commands
+ */
+size_t rpc_stats_get(struct rpc_cmd_stats *stats, size_t count);
+#else
+static inline uint64_t rpc_stats_begin(uint32_t cmd __unused)
+{
+	return 0;
+}
+
+static inline void rpc_stats_end(uint32_t cmd __unused,
+				 uint64_t begin __unused)
+{
+}
+#endif
+
+#endif /*KERNEL_RPC_STATS_H*/
@@ -0,0 +1,45 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+#ifndef KERNEL_RWLOCK_H
+#define KERNEL_RWLOCK_H
+
+#include <compiler.h>
+#include <types_ext.h>
+
+/* At least the size of the data cache lines of the supported cores */
+#define RWLOCK_CACHE_LINE_SIZE	64
+
+/*
+ * Reader-writer spinlock for read-mostly data
+ *
+ * Each core has its own reader count on a separate cache line, so
+ * readers don't write to a cache line shared with other cores. A writer
+ * first excludes other writers, then waits for the reader counts of all
+ * cores to drop to zero, so taking the write lock is expensive.
+ *
+ * Like for spinlocks the critical sections must not sleep, and all
+ * exceptions are masked while the lock is held. The read lock can be
+ * taken recursively on the same core, also while a writer is waiting,
+ * but a core holding the read lock must not take the write lock.
+ *
+ * @writer:	Taken by the writer, SPINLOCK_UNLOCK if there's none
+ * @readers:	Number of readers on each core
+ */
+struct rwlock {
+	unsigned int writer;
+	struct {
+		unsigned int count;
+	} __aligned(RWLOCK_CACHE_LINE_SIZE) readers[CFG_TEE_CORE_NB_CORE];
+};
+
+#define RWLOCK_INITIALIZER { .writer = 0 }
+
+uint32_t rwlock_read_lock_xsave(struct rwlock *l);
+void rwlock_read_unlock_xrestore(struct rwlock *l, uint32_t exceptions);
+
+uint32_t rwlock_write_lock_xsave(struct rwlock *l);
+void rwlock_write_unlock_xrestore(struct rwlock *l, uint32_t exceptions);
+
+#endif /*KERNEL_RWLOCK_H*/
@@ -14,6 +14,7 @@
 #include <assert.h>
 #include <compiler.h>
 #include <stdbool.h>
+#include <kernel/lock_prof.h>
 #include <kernel/thread.h>
 
 #ifdef CFG_TEE_CORE_DEBUG
@@ -38,7 +39,18 @@ unsigned int __cpu_spin_trylock(unsigned int *lock);
 static inline void cpu_spin_lock_no_dldetect(unsigned int *lock)
 {
 	assert(thread_foreign_intr_disabled());
+#ifdef CFG_LOCK_PROFILING
+	if (__cpu_spin_trylock(lock)) {
+		uint64_t wait_start = lock_prof_timestamp();
+
+		__cpu_spin_lock(lock);
+		lock_prof_spin_acquired(lock, wait_start);
+	} else {
+		lock_prof_spin_acquired(lock, 0);
+	}
+#else
 	__cpu_spin_lock(lock);
+#endif
 	spinlock_count_incr();
 }
 
@@ -51,10 +63,13 @@ static inline void cpu_spin_lock_dldetect(const char *func, const int line,
 {
 	unsigned int retries = 0;
 	unsigned int reminder = 0;
+	uint64_t wait_start = 0;
 
 	assert(thread_foreign_intr_disabled());
 
 	while (__cpu_spin_trylock(lock)) {
+		if (!wait_start)
+			wait_start = lock_prof_timestamp();
 		retries++;
 		if (!retries) {
 			/* wrapped, time to report */
@@ -66,6 +81,7 @@ static inline void cpu_spin_lock_dldetect(const char *func, const int line,
 		}
 	}
 
+	lock_prof_spin_acquired(lock, wait_start);
 	spinlock_count_incr();
 }
 #else
@@ -82,14 +98,17 @@ static inline bool cpu_spin_trylock(unsigned int *lock)
 
 	assert(thread_foreign_intr_disabled());
 	rc = __cpu_spin_trylock(lock);
-	if (!rc)
+	if (!rc) {
+		lock_prof_spin_acquired(lock, 0);
 		spinlock_count_incr();
+	}
 	return !rc;
 }
 
 static inline void cpu_spin_unlock(unsigned int *lock)
 {
 	assert(thread_foreign_intr_disabled());
+	lock_prof_spin_released(lock);
 	__cpu_spin_unlock(lock);
 	spinlock_count_decr();
 }
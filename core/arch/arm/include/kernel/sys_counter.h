@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+#ifndef KERNEL_SYS_COUNTER_H
+#define KERNEL_SYS_COUNTER_H
+
+#include <arm.h>
+#include <types_ext.h>
+
+/*
+ * Timestamps of statistics and profiling events. Without the Generic
+ * Timer, CFG_CORE_HAS_GENERIC_TIMER=n, they're all 0 and so is the
+ * frequency, which tells the consumer of the statistics that times
+ * weren't recorded.
+ */
+static inline uint64_t sys_counter_read(void)
+{
+#ifdef CFG_CORE_HAS_GENERIC_TIMER
+	return read_cntpct();
+#else
+	return 0;
+#endif
+}
+
+static inline uint32_t sys_counter_freq(void)
+{
+#ifdef CFG_CORE_HAS_GENERIC_TIMER
+	return read_cntfrq();
+#else
+	return 0;
+#endif
+}
+
+#endif /*KERNEL_SYS_COUNTER_H*/
@@ -294,6 +294,13 @@ int thread_get_id(void);
  */
 int thread_get_id_may_fail(void);
 
+/*
+ * Returns true if the thread is currently executing on a core, that is
+ * not suspended waiting for normal world. The state is read without
+ * locking so the result is only a hint.
+ */
+bool thread_is_running(int thread_id);
+
 /* Returns Thread Specific Data (TSD) pointer. */
 struct thread_specific_data *thread_get_tsd(void);
 
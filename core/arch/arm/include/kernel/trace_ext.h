@@ -0,0 +1,47 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+#ifndef KERNEL_TRACE_EXT_H
+#define KERNEL_TRACE_EXT_H
+
+#include <compiler.h>
+#include <stddef.h>
+
+#ifdef CFG_CORE_TRACE_RING
+/*
+ * Switches trace_ext_puts() from synchronous console output to the per-CPU
+ * trace rings. Called once the boot CPU is done with the early boot
+ * messages.
+ */
+void trace_ext_set_async(void);
+
+/*
+ * Moves at most @len bytes of the per-CPU trace rings into @buf and
+ * returns the number of bytes moved. The console isn't touched, normal
+ * world outputs the traces read with the trace ring pseudo TA whenever it
+ * sees fit. Returns 0 while another CPU is reading.
+ */
+size_t trace_ext_read(char *buf, size_t len);
+
+/*
+ * Outputs what's left in the trace rings and makes all subsequent traces
+ * synchronous again. Used when panicking so that no message is lost.
+ */
+void trace_ext_set_sync(void);
+#else
+static inline void trace_ext_set_async(void)
+{
+}
+
+static inline size_t trace_ext_read(char *buf __unused, size_t len __unused)
+{
+	return 0;
+}
+
+static inline void trace_ext_set_sync(void)
+{
+}
+#endif
+
+#endif /*KERNEL_TRACE_EXT_H*/
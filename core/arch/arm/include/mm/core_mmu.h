@@ -620,6 +620,9 @@ struct mmu_partition *core_alloc_mmu_prtn(void *tables);
 void core_free_mmu_prtn(struct mmu_partition *prtn);
 void core_mmu_set_prtn(struct mmu_partition *prtn);
 void core_mmu_set_default_prtn(void);
+/* Maps @mm into @prtn after core_init_mmu_prtn(), for all cores */
+void core_mmu_map_prtn_region(struct mmu_partition *prtn,
+			      struct tee_mmap_region *mm);
 
 void core_mmu_init_virtualization(void);
 #endif
@@ -230,16 +230,60 @@ static inline void tee_pager_release_phys(void *addr __unused,
  */
 struct tee_pager_stats {
 	size_t hidden_hits;
-	size_t ro_hits;
+	size_t ro_hits;		/* also the number of pages hash checked */
 	size_t rw_hits;
 	size_t zi_released;
 	size_t npages;		/* number of load pages */
 	size_t npages_all;	/* number of pages */
+	size_t boot_checked;	/* pageable pages hash checked at boot */
+	uint64_t boot_check_ticks; /* time of the check at boot, CNTPCT ticks */
+};
+
+#define TEE_PAGER_AREA_TYPE_RO		0
+#define TEE_PAGER_AREA_TYPE_RW		1
+#define TEE_PAGER_AREA_TYPE_LOCK	2
+
+/*
+ * Statistics on a pager area, times are in system counter ticks (CNTPCT)
+ *
+ * @uuid:	UUID of the TA owning the area, all zero for core areas
+ * @base:	Start virtual address of the area
+ * @size:	Size of the area in bytes
+ * @type:	TEE_PAGER_AREA_TYPE_*
+ * @resident:	Number of pages of the area currently held in physical
+ *		pages, hidden pages included
+ * @faults:	Number of faults handled in the area
+ * @loads:	Number of pages loaded (paged in)
+ * @saves:	Number of dirty pages saved (paged out)
+ * @decrypted:	Number of bytes decrypted when loading pages
+ * @encrypted:	Number of bytes encrypted when saving pages
+ * @fault_ticks: Total time spent in tee_pager_handle_fault() for faults
+ *		in the area
+ */
+struct tee_pager_area_stats {
+	TEE_UUID uuid;
+	uint64_t base;
+	uint32_t size;
+	uint32_t type;
+	uint32_t resident;
+	uint32_t faults;
+	uint32_t loads;
+	uint32_t saves;
+	uint64_t decrypted;
+	uint64_t encrypted;
+	uint64_t fault_ticks;
 };
 
 #ifdef CFG_WITH_PAGER
 void tee_pager_get_stats(struct tee_pager_stats *stats);
 bool tee_pager_handle_fault(struct abort_info *ai);
+
+/*
+ * Records the number of pages of the pageable area of the core checked
+ * against their hashes at boot and the time it took, for
+ * tee_pager_get_stats()
+ */
+void tee_pager_set_boot_check_stats(size_t npages, uint64_t ticks);
 #else /*CFG_WITH_PAGER*/
 static inline bool tee_pager_handle_fault(struct abort_info *ai __unused)
 {
@@ -252,4 +296,21 @@ static inline void tee_pager_get_stats(struct tee_pager_stats *stats)
 }
 #endif /*CFG_WITH_PAGER*/
 
+#if defined(CFG_WITH_PAGER) && defined(CFG_WITH_STATS)
+/*
+ * Copies the statistics of at most @count pager areas into @stats and
+ * returns the total number of areas, core areas first followed by the
+ * areas of each user TA. Must be called with tee_ta_mutex held.
+ */
+size_t tee_pager_get_area_stats(struct tee_pager_area_stats *stats,
+				size_t count);
+#else
+static inline size_t
+tee_pager_get_area_stats(struct tee_pager_area_stats *stats __unused,
+			 size_t count __unused)
+{
+	return 0;
+}
+#endif
+
 #endif /*MM_TEE_PAGER_H*/
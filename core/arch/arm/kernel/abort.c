@@ -634,7 +634,9 @@ void abort_handler(uint32_t abort_type, struct thread_abort_regs *regs)
 		thread_kernel_save_vfp();
 		handled = tee_pager_handle_fault(&ai);
 		thread_kernel_restore_vfp();
-		if (!handled) {
+		if (handled) {
+			tee_ta_acct_page_fault();
+		} else {
 			abort_print_error(&ai);
 			if (!abort_is_user_exception(&ai))
 				panic("unhandled pageable abort");
@@ -5,19 +5,44 @@
 #include <initcall.h>
 #include <kernel/early_ta.h>
 #include <kernel/linker.h>
+#include <kernel/lz4.h>
 #include <kernel/user_ta.h>
 #include <stdio.h>
 #include <string.h>
 #include <trace.h>
 #include <util.h>
+#ifdef CFG_ZLIB
 #include <zlib.h>
+#endif
 
 #include "elf_load.h"
 
+/*
+ * @blocks:	Start of the compressed blocks
+ * @block_size:	Uncompressed size of a block
+ * @num_blocks:	Number of blocks
+ * @buf:	A block decompressed for reads of less than a block
+ * @buf_idx:	Index of the block in @buf, SIZE_MAX if none
+ */
+struct lz4_state {
+	const uint8_t *blocks;
+	size_t block_size;
+	size_t num_blocks;
+	uint8_t *buf;
+	size_t buf_idx;
+};
+
+/*
+ * @offs:	Read offset in the uncompressed TA, unused with
+ *		EARLY_TA_FORMAT_DEFLATE
+ */
 struct user_ta_store_handle {
 	const struct early_ta *early_ta;
 	size_t offs;
+#ifdef CFG_ZLIB
 	z_stream strm;
+#endif
+	struct lz4_state lz4;
 };
 
 #define for_each_early_ta(_ta) \
@@ -37,6 +62,17 @@ static const struct early_ta *find_early_ta(const TEE_UUID *uuid)
 	return NULL;
 }
 
+static bool is_deflate(const struct early_ta *ta)
+{
+	return ta->uncompressed_size && ta->format == EARLY_TA_FORMAT_DEFLATE;
+}
+
+static bool is_lz4(const struct early_ta *ta)
+{
+	return ta->uncompressed_size && ta->format == EARLY_TA_FORMAT_LZ4;
+}
+
+#ifdef CFG_ZLIB
 static void *zalloc(void *opaque __unused, unsigned int items,
 		    unsigned int size)
 {
@@ -66,59 +102,17 @@ static bool decompression_init(z_stream *strm,
 	return true;
 }
 
-static TEE_Result early_ta_open(const TEE_UUID *uuid,
-				struct user_ta_store_handle **h)
-{
-	struct user_ta_store_handle *handle;
-	const struct early_ta *ta;
-	bool st;
-
-	ta = find_early_ta(uuid);
-	if (!ta)
-		return TEE_ERROR_ITEM_NOT_FOUND;
-
-	handle = calloc(1, sizeof(*handle));
-	if (!handle)
-		return TEE_ERROR_OUT_OF_MEMORY;
-
-	if (ta->uncompressed_size) {
-		st = decompression_init(&handle->strm, ta);
-		if (!st) {
-			free(handle);
-			return TEE_ERROR_BAD_FORMAT;
-		}
-	}
-	handle->early_ta = ta;
-	*h = handle;
-
-	return TEE_SUCCESS;
-}
-
-static TEE_Result early_ta_get_size(const struct user_ta_store_handle *h,
-				    size_t *size)
+static TEE_Result deflate_init(struct user_ta_store_handle *h)
 {
-	const struct early_ta *ta = h->early_ta;
-
-	if (ta->uncompressed_size)
-		*size = ta->uncompressed_size;
-	else
-		*size = ta->size;
+	if (!decompression_init(&h->strm, h->early_ta))
+		return TEE_ERROR_BAD_FORMAT;
 
 	return TEE_SUCCESS;
 }
 
-static TEE_Result read_uncompressed(struct user_ta_store_handle *h, void *data,
-				    size_t len)
+static void deflate_final(struct user_ta_store_handle *h)
 {
-	uint8_t *src = (uint8_t *)h->early_ta->ta + h->offs;
-
-	if (h->offs + len > h->early_ta->size)
-		return TEE_ERROR_BAD_PARAMETERS;
-	if (data)
-		memcpy(data, src, len);
-	h->offs += len;
-
-	return TEE_SUCCESS;
+	inflateEnd(&h->strm);
 }
 
 static TEE_Result read_compressed(struct user_ta_store_handle *h, void *data,
@@ -184,20 +178,227 @@ out:
 
 	return ret;
 }
+#else
+static TEE_Result deflate_init(struct user_ta_store_handle *h __unused)
+{
+	EMSG("Early TA compressed with DEFLATE but CFG_ZLIB=n");
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+
+static void deflate_final(struct user_ta_store_handle *h __unused)
+{
+}
+
+static TEE_Result read_compressed(struct user_ta_store_handle *h __unused,
+				  void *data __unused, size_t len __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif /*CFG_ZLIB*/
+
+static uint32_t lz4_word(const struct early_ta *ta, size_t idx)
+{
+	uint32_t v = 0;
+
+	memcpy(&v, ta->ta + idx * sizeof(v), sizeof(v));
+	return v;
+}
+
+/* Offset of block @idx from h->lz4.blocks */
+static size_t lz4_block_offs(struct user_ta_store_handle *h, size_t idx)
+{
+	return lz4_word(h->early_ta, 2 + idx);
+}
+
+static TEE_Result lz4_init(struct user_ta_store_handle *h)
+{
+	const struct early_ta *ta = h->early_ta;
+	struct lz4_state *s = &h->lz4;
+	size_t hdr_size = 0;
+	size_t n = 0;
+
+	if (ta->size < 3 * sizeof(uint32_t))
+		return TEE_ERROR_BAD_FORMAT;
+
+	s->block_size = lz4_word(ta, 0);
+	s->num_blocks = lz4_word(ta, 1);
+	if (!s->block_size || s->block_size > EARLY_TA_LZ4_MAX_BLOCK_SIZE ||
+	    s->num_blocks != ta->uncompressed_size / s->block_size +
+			     !!(ta->uncompressed_size % s->block_size) ||
+	    s->num_blocks > ta->size / sizeof(uint32_t) - 3)
+		return TEE_ERROR_BAD_FORMAT;
+
+	hdr_size = (s->num_blocks + 3) * sizeof(uint32_t);
+	s->blocks = ta->ta + hdr_size;
+	if (lz4_block_offs(h, 0) ||
+	    lz4_block_offs(h, s->num_blocks) != ta->size - hdr_size)
+		return TEE_ERROR_BAD_FORMAT;
+	for (n = 0; n < s->num_blocks; n++)
+		if (lz4_block_offs(h, n) > lz4_block_offs(h, n + 1))
+			return TEE_ERROR_BAD_FORMAT;
+
+	s->buf_idx = SIZE_MAX;
+
+	return TEE_SUCCESS;
+}
+
+static void lz4_final(struct user_ta_store_handle *h)
+{
+	free(h->lz4.buf);
+}
+
+static TEE_Result lz4_decompress(struct user_ta_store_handle *h, size_t idx,
+				 void *dst, size_t len)
+{
+	size_t offs = lz4_block_offs(h, idx);
+	const uint8_t *src = h->lz4.blocks + offs;
+	size_t src_len = lz4_block_offs(h, idx + 1) - offs;
+
+	/* Blocks which don't compress are stored as is */
+	if (src_len == len) {
+		memcpy(dst, src, len);
+		return TEE_SUCCESS;
+	}
+
+	return lz4_decompress_block(src, src_len, dst, len);
+}
+
+/*
+ * Whole blocks are decompressed directly into @data, the others through
+ * h->lz4.buf which is kept for the next read. Skipped data isn't
+ * decompressed at all.
+ */
+static TEE_Result read_lz4(struct user_ta_store_handle *h, void *data,
+			   size_t len)
+{
+	size_t size = h->early_ta->uncompressed_size;
+	struct lz4_state *s = &h->lz4;
+	TEE_Result res = TEE_SUCCESS;
+	uint8_t *dst = data;
+	size_t boffs = 0;
+	size_t blen = 0;
+	size_t idx = 0;
+	size_t l = 0;
+
+	if (len > size - h->offs)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (!data) {
+		h->offs += len;
+		return TEE_SUCCESS;
+	}
+
+	while (len) {
+		idx = h->offs / s->block_size;
+		boffs = h->offs % s->block_size;
+		blen = MIN(s->block_size, size - idx * s->block_size);
+		l = MIN(len, blen - boffs);
+
+		if (l == blen) {
+			res = lz4_decompress(h, idx, dst, blen);
+		} else {
+			if (!s->buf) {
+				s->buf = malloc(s->block_size);
+				if (!s->buf)
+					return TEE_ERROR_OUT_OF_MEMORY;
+			}
+			if (s->buf_idx != idx) {
+				s->buf_idx = SIZE_MAX;
+				res = lz4_decompress(h, idx, s->buf, blen);
+				if (!res)
+					s->buf_idx = idx;
+			}
+			if (!res)
+				memcpy(dst, s->buf + boffs, l);
+		}
+		if (res) {
+			EMSG("Decompression error of block %zu", idx);
+			return res;
+		}
+
+		dst += l;
+		len -= l;
+		h->offs += l;
+	}
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result early_ta_open(const TEE_UUID *uuid,
+				struct user_ta_store_handle **h)
+{
+	struct user_ta_store_handle *handle;
+	const struct early_ta *ta;
+	TEE_Result res = TEE_SUCCESS;
+
+	ta = find_early_ta(uuid);
+	if (!ta)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+
+	handle = calloc(1, sizeof(*handle));
+	if (!handle)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	handle->early_ta = ta;
+	if (is_deflate(ta))
+		res = deflate_init(handle);
+	else if (is_lz4(ta))
+		res = lz4_init(handle);
+	else if (ta->uncompressed_size)
+		res = TEE_ERROR_BAD_FORMAT;
+	if (res) {
+		free(handle);
+		return res;
+	}
+	*h = handle;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result early_ta_get_size(const struct user_ta_store_handle *h,
+				    size_t *size)
+{
+	const struct early_ta *ta = h->early_ta;
+
+	if (ta->uncompressed_size)
+		*size = ta->uncompressed_size;
+	else
+		*size = ta->size;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result read_uncompressed(struct user_ta_store_handle *h, void *data,
+				    size_t len)
+{
+	uint8_t *src = (uint8_t *)h->early_ta->ta + h->offs;
+
+	if (h->offs + len > h->early_ta->size)
+		return TEE_ERROR_BAD_PARAMETERS;
+	if (data)
+		memcpy(data, src, len);
+	h->offs += len;
+
+	return TEE_SUCCESS;
+}
 
 static TEE_Result early_ta_read(struct user_ta_store_handle *h, void *data,
 				size_t len)
 {
-	if (h->early_ta->uncompressed_size)
+	if (is_deflate(h->early_ta))
 		return read_compressed(h, data, len);
+	else if (is_lz4(h->early_ta))
+		return read_lz4(h, data, len);
 	else
 		return read_uncompressed(h, data, len);
 }
 
 static void early_ta_close(struct user_ta_store_handle *h)
 {
-	if (h->early_ta->uncompressed_size)
-		inflateEnd(&h->strm);
+	if (is_deflate(h->early_ta))
+		deflate_final(h);
+	else if (is_lz4(h->early_ta))
+		lz4_final(h);
 	free(h);
 }
 
@@ -217,7 +418,8 @@ static TEE_Result early_ta_init(void)
 	for_each_early_ta(ta) {
 		if (ta->uncompressed_size)
 			snprintf(msg, sizeof(msg),
-				 " (compressed, uncompressed %u)",
+				 " (compressed %s, uncompressed %u)",
+				 is_lz4(ta) ? "LZ4" : "DEFLATE",
 				 ta->uncompressed_size);
 		else
 			msg[0] = '\0';
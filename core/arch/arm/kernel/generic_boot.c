@@ -11,12 +11,15 @@
 #include <inttypes.h>
 #include <keep.h>
 #include <kernel/asan.h>
+#include <kernel/dt.h>
 #include <kernel/generic_boot.h>
 #include <kernel/linker.h>
 #include <kernel/misc.h>
 #include <kernel/panic.h>
+#include <kernel/sys_counter.h>
 #include <kernel/tee_misc.h>
 #include <kernel/thread.h>
+#include <kernel/trace_ext.h>
 #include <malloc.h>
 #include <mm/core_memprot.h>
 #include <mm/core_mmu.h>
@@ -334,6 +337,9 @@ static void init_runtime(unsigned long pageable_part)
 	size_t pageable_size = __pageable_end - __pageable_start;
 	size_t hash_size = (pageable_size / SMALL_PAGE_SIZE) *
 			   TEE_SHA256_HASH_SIZE;
+	size_t num_checked = 0;
+	uint64_t begin = 0;
+	uint64_t ticks = 0;
 	tee_mm_entry_t *mm;
 	uint8_t *paged_store;
 	uint8_t *hashes;
@@ -381,9 +387,19 @@ static void init_runtime(unsigned long pageable_part)
 		__pageable_part_end - __pageable_part_start);
 	asan_memcpy_unchecked(paged_store, __init_start, init_size);
 
-	/* Check that hashes of what's in pageable area is OK */
+	/*
+	 * Check that hashes of what's in pageable area is OK. The pager
+	 * checks each page it loads, so unless CFG_PAGER_DEFER_HASH_CHECK=n
+	 * only the init part which is used in place is checked here.
+	 */
+#ifdef CFG_PAGER_DEFER_HASH_CHECK
+	num_checked = init_size / SMALL_PAGE_SIZE;
+#else
+	num_checked = pageable_size / SMALL_PAGE_SIZE;
+#endif
 	DMSG("Checking hashes of pageable area");
-	for (n = 0; (n * SMALL_PAGE_SIZE) < pageable_size; n++) {
+	begin = sys_counter_read();
+	for (n = 0; n < num_checked; n++) {
 		const uint8_t *hash = hashes + n * TEE_SHA256_HASH_SIZE;
 		const uint8_t *page = paged_store + n * SMALL_PAGE_SIZE;
 		TEE_Result res;
@@ -396,6 +412,15 @@ static void init_runtime(unsigned long pageable_part)
 			panic();
 		}
 	}
+	ticks = sys_counter_read() - begin;
+	tee_pager_set_boot_check_stats(num_checked, ticks);
+	if (sys_counter_freq())
+		IMSG("Checked %zu of %zu pageable pages in %" PRIu64 " us",
+		     num_checked, pageable_size / SMALL_PAGE_SIZE,
+		     ticks * 1000000 / sys_counter_freq());
+	else
+		IMSG("Checked %zu of %zu pageable pages", num_checked,
+		     pageable_size / SMALL_PAGE_SIZE);
 
 	/*
 	 * Assert prepaged init sections are page aligned so that nothing
@@ -499,6 +524,9 @@ void *get_embedded_dt(void)
 	if (!checked) {
 		if (fdt_check_header(embedded_secure_dtb))
 			panic("Invalid embedded DTB");
+#ifdef CFG_DT_INDEX
+		dt_index_init(embedded_secure_dtb);
+#endif
 
 		checked = true;
 	}
@@ -1061,6 +1089,7 @@ static void init_primary_helper(unsigned long pageable_part,
 	core_mmu_init_virtualization();
 #endif
 	DMSG("Primary CPU switching to normal world boot");
+	trace_ext_set_async();
 }
 
 /* What this function is using is needed each time another CPU is started */
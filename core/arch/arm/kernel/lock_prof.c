@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <arm.h>
+#include <assert.h>
+#include <atomic.h>
+#include <kernel/linker.h>
+#include <kernel/lock_prof.h>
+#include <kernel/mutex.h>
+#include <kernel/sys_counter.h>
+#include <string.h>
+#include <util.h>
+
+/* Number of classes of each lock type, must be a power of two */
+#define LOCK_PROF_MAX_CLASSES	128
+
+/*
+ * A lock class is keyed on the same identity as lockdep uses, the address
+ * of the lock object, except for mutexes initialized with mutex_init()
+ * which are grouped by the call site of mutex_init().
+ *
+ * @key:	Identity of the class, 0 for an unused entry. Claimed with a
+ *		compare and swap, never released.
+ * @acquired_at: When the spinlock was last acquired, protected by the
+ *		spinlock itself so only used for statically allocated
+ *		spinlocks which each have their own class
+ *
+ * The other fields are as in struct lock_prof_stats. They are updated
+ * with atomic operations so recording doesn't need any lock shared by
+ * all CPUs.
+ */
+struct lock_prof_class {
+	uint64_t key;
+	uint64_t acquired;
+	uint64_t contended;
+	uint64_t wait_ticks;
+	uint64_t max_wait_ticks;
+	uint64_t hold_ticks;
+	uint64_t max_hold_ticks;
+	uint64_t acquired_at;
+};
+
+/*
+ * Spinlocks and mutexes are kept in different tables as a struct mutex
+ * starts with a spinlock. Lookups use open addressing with linear
+ * probing.
+ */
+static struct lock_prof_class spin_classes[LOCK_PROF_MAX_CLASSES] __nex_bss;
+static struct lock_prof_class mutex_classes[LOCK_PROF_MAX_CLASSES] __nex_bss;
+
+/*
+ * Spinlocks which aren't statically allocated, for instance the spinlocks
+ * embedded in each struct mutex, are all accounted to this class
+ */
+static struct lock_prof_class dynamic_spin_class __nex_bss;
+
+#ifdef CFG_VIRTUALIZATION
+extern const uint8_t __nex_bss_start[];
+extern const uint8_t __nex_bss_end[];
+#endif
+
+static bool is_static_lock(vaddr_t va)
+{
+#ifdef CFG_VIRTUALIZATION
+	if (va >= (vaddr_t)__nex_bss_start && va < (vaddr_t)__nex_bss_end)
+		return true;
+#endif
+	return va >= (vaddr_t)__data_start && va < (vaddr_t)__bss_end;
+}
+
+/* Finalizer of MurmurHash3, mixes all bits of the key */
+static size_t hash_key(uint64_t key)
+{
+	uint32_t h = key ^ (key >> 32);
+
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+
+	return h;
+}
+
+/* Returns the class of a lock, adding it to @classes if @add is true */
+static struct lock_prof_class *get_class(struct lock_prof_class *classes,
+					 uint64_t key, bool add)
+{
+	const size_t mask = LOCK_PROF_MAX_CLASSES - 1;
+	struct lock_prof_class *c = NULL;
+	uint64_t k = 0;
+	size_t idx = 0;
+	size_t n = 0;
+
+	COMPILE_TIME_ASSERT(IS_POWER_OF_TWO(LOCK_PROF_MAX_CLASSES));
+
+	idx = hash_key(key);
+	for (n = 0; n < LOCK_PROF_MAX_CLASSES; n++) {
+		c = classes + ((idx + n) & mask);
+		k = atomic_load_u64(&c->key);
+		while (!k) {
+			if (!add)
+				return NULL;
+			/* On failure @k is updated with the key of the winner */
+			if (atomic_cas_u64(&c->key, &k, key))
+				return c;
+		}
+		if (k == key)
+			return c;
+	}
+
+	/* The table is full, the lock isn't recorded */
+	return NULL;
+}
+
+static void update_max(uint64_t *max, uint64_t val)
+{
+	uint64_t old = atomic_load_u64(max);
+
+	while (val > old && !atomic_cas_u64(max, &old, val))
+		;
+}
+
+static void record_acquired(struct lock_prof_class *c, uint64_t now,
+			    uint64_t wait_start)
+{
+	uint64_t wait = 0;
+
+	atomic_add_u64(&c->acquired, 1);
+	if (!wait_start)
+		return;
+
+	atomic_add_u64(&c->contended, 1);
+	/* Without a system counter only the counts are recorded */
+	if (now) {
+		wait = now - wait_start;
+		atomic_add_u64(&c->wait_ticks, wait);
+		update_max(&c->max_wait_ticks, wait);
+	}
+}
+
+static void record_released(struct lock_prof_class *c, uint64_t hold)
+{
+	atomic_add_u64(&c->hold_ticks, hold);
+	update_max(&c->max_hold_ticks, hold);
+}
+
+uint64_t lock_prof_timestamp(void)
+{
+	uint64_t now = sys_counter_read();
+
+	/* 0 means no wait */
+	return now ? now : 1;
+}
+
+/*
+ * Nothing is locked while recording, so this may also be called from
+ * native interrupt handlers interrupting another recording.
+ */
+void lock_prof_spin_acquired(unsigned int *lock, uint64_t wait_start)
+{
+	uint64_t now = sys_counter_read();
+	struct lock_prof_class *c = NULL;
+
+	if (is_static_lock((vaddr_t)lock)) {
+		c = get_class(spin_classes, (vaddr_t)lock, true);
+		if (!c)
+			return;
+		c->acquired_at = now;
+	} else {
+		c = &dynamic_spin_class;
+	}
+
+	record_acquired(c, now, wait_start);
+}
+
+void lock_prof_spin_released(unsigned int *lock)
+{
+	struct lock_prof_class *c = NULL;
+
+	if (!is_static_lock((vaddr_t)lock))
+		return;
+
+	c = get_class(spin_classes, (vaddr_t)lock, false);
+	if (c && c->acquired_at)
+		record_released(c, sys_counter_read() - c->acquired_at);
+}
+
+static vaddr_t mutex_key(struct mutex *m)
+{
+	if (m->init_site)
+		return m->init_site;
+	return (vaddr_t)m;
+}
+
+void lock_prof_mutex_init(struct mutex *m, vaddr_t init_site)
+{
+	m->init_site = init_site;
+}
+
+void lock_prof_mutex_acquired(struct mutex *m, bool write,
+			      uint64_t wait_start)
+{
+	uint64_t now = sys_counter_read();
+	struct lock_prof_class *c = NULL;
+
+	c = get_class(mutex_classes, mutex_key(m), true);
+	if (c)
+		record_acquired(c, now, wait_start);
+
+	/* Only the owner of a write lock updates this */
+	if (write)
+		m->acquired_at = now;
+}
+
+void lock_prof_mutex_released(struct mutex *m)
+{
+	struct lock_prof_class *c = NULL;
+
+	/* Hold times are only recorded for write locks */
+	if (!m->acquired_at)
+		return;
+
+	c = get_class(mutex_classes, mutex_key(m), false);
+	if (c)
+		record_released(c, sys_counter_read() - m->acquired_at);
+
+	m->acquired_at = 0;
+}
+
+static void get_class_stats(struct lock_prof_stats *stats,
+			    struct lock_prof_class *c, uint32_t type)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->key = atomic_load_u64(&c->key);
+	stats->type = type;
+	stats->acquired = atomic_load_u64(&c->acquired);
+	stats->contended = atomic_load_u64(&c->contended);
+	stats->wait_ticks = atomic_load_u64(&c->wait_ticks);
+	stats->max_wait_ticks = atomic_load_u64(&c->max_wait_ticks);
+	stats->hold_ticks = atomic_load_u64(&c->hold_ticks);
+	stats->max_hold_ticks = atomic_load_u64(&c->max_hold_ticks);
+}
+
+size_t lock_prof_get_stats(struct lock_prof_stats *stats, size_t count)
+{
+	struct lock_prof_class *c = NULL;
+	size_t num = 0;
+	size_t n = 0;
+
+	if (atomic_load_u64(&dynamic_spin_class.acquired)) {
+		if (num < count)
+			get_class_stats(stats + num, &dynamic_spin_class,
+					LOCK_PROF_TYPE_SPINLOCK);
+		num++;
+	}
+
+	for (n = 0; n < LOCK_PROF_MAX_CLASSES; n++) {
+		c = spin_classes + n;
+		if (!atomic_load_u64(&c->key))
+			continue;
+		if (num < count)
+			get_class_stats(stats + num, c,
+					LOCK_PROF_TYPE_SPINLOCK);
+		num++;
+	}
+
+	for (n = 0; n < LOCK_PROF_MAX_CLASSES; n++) {
+		c = mutex_classes + n;
+		if (!atomic_load_u64(&c->key))
+			continue;
+		if (num < count)
+			get_class_stats(stats + num, c, LOCK_PROF_TYPE_MUTEX);
+		num++;
+	}
+
+	return num;
+}
@@ -3,6 +3,9 @@
  * Copyright (c) 2015-2017, Linaro Limited
  */
 
+#include <atomic.h>
+#include <kernel/delay.h>
+#include <kernel/lock_prof.h>
 #include <kernel/mutex.h>
 #include <kernel/panic.h>
 #include <kernel/spinlock.h>
@@ -11,13 +14,69 @@
 
 #include "mutex_lockdep.h"
 
+#ifdef CFG_WITH_STATS
+static struct mutex_stats mutex_stats;
+
+void mutex_get_stats(struct mutex_stats *stats)
+{
+	stats->spin_acquired = atomic_load_u32(&mutex_stats.spin_acquired);
+	stats->slept_acquired = atomic_load_u32(&mutex_stats.slept_acquired);
+}
+
+static void update_stats(bool spun, bool slept)
+{
+	if (slept)
+		atomic_inc32(&mutex_stats.slept_acquired);
+	else if (spun)
+		atomic_inc32(&mutex_stats.spin_acquired);
+}
+#else
+static void update_stats(bool spun __unused, bool slept __unused)
+{
+}
+#endif
+
+/*
+ * Sleeping in normal world costs two RPCs, one to sleep and one issued by
+ * the unlocking thread to wake us, while mutexes typically are held only
+ * briefly. So as long as the owner is running on another core it's
+ * cheaper to spin for a bounded time before going to sleep.
+ */
+static bool can_spin_on(int owner)
+{
+	return CFG_MUTEX_SPIN_US && owner >= 0 && thread_is_running(owner);
+}
+
+/*
+ * Spins with the mutex spinlock released until the mutex may have become
+ * available, the owner is suspended or CFG_MUTEX_SPIN_US has elapsed.
+ */
+static void spin_on_owner(struct mutex *m, int owner, bool wait_read)
+{
+	uint64_t expire = timeout_init_us(CFG_MUTEX_SPIN_US);
+	short state = 0;
+
+	while (thread_is_running(owner) && !timeout_elapsed(expire)) {
+		state = __compiler_atomic_load(&m->state);
+		if (!state || (wait_read && state > 0))
+			return;
+		if (__compiler_atomic_load(&m->owner_id) != owner)
+			return;
+	}
+}
+
 void mutex_init(struct mutex *m)
 {
 	*m = (struct mutex)MUTEX_INITIALIZER;
+	lock_prof_mutex_init(m, (vaddr_t)__builtin_return_address(0));
 }
 
 static void __mutex_lock(struct mutex *m, const char *fname, int lineno)
 {
+	uint64_t wait_start = 0;
+	bool spun = false;
+	bool slept = false;
+
 	assert_have_no_spinlock();
 	assert(thread_get_id_may_fail() != -1);
 	assert(thread_is_in_normal_mode());
@@ -29,6 +88,7 @@ static void __mutex_lock(struct mutex *m, const char *fname, int lineno)
 		bool can_lock;
 		struct wait_queue_elem wqe;
 		int owner = MUTEX_OWNER_ID_NONE;
+		bool spin = false;
 
 		/*
 		 * If the mutex is locked we need to initialize the wqe
@@ -43,23 +103,41 @@ static void __mutex_lock(struct mutex *m, const char *fname, int lineno)
 
 		can_lock = !m->state;
 		if (!can_lock) {
-			wq_wait_init(&m->wq, &wqe, false /* wait_read */);
 			owner = m->owner_id;
 			assert(owner != thread_get_id_may_fail());
+			/* Spin at most once, then sleep */
+			spin = !spun && can_spin_on(owner);
+			if (!spin)
+				wq_wait_init(&m->wq, &wqe,
+					     false /* wait_read */);
 		} else {
 			m->state = -1; /* write locked */
+			m->owner_id = thread_get_id();
 		}
 
 		cpu_spin_unlock_xrestore(&m->spin_lock, old_itr_status);
 
-		if (!can_lock) {
-			/*
-			 * Someone else is holding the lock, wait in normal
-			 * world for the lock to become available.
-			 */
-			wq_wait_final(&m->wq, &wqe, m, owner, fname, lineno);
-		} else
+		if (can_lock) {
+			update_stats(spun, slept);
+			lock_prof_mutex_acquired(m, true, wait_start);
 			return;
+		}
+
+		if (!wait_start)
+			wait_start = lock_prof_timestamp();
+
+		if (spin) {
+			spun = true;
+			spin_on_owner(m, owner, false /* wait_read */);
+			continue;
+		}
+
+		/*
+		 * Someone else is holding the lock, wait in normal
+		 * world for the lock to become available.
+		 */
+		slept = true;
+		wq_wait_final(&m->wq, &wqe, m, owner, fname, lineno);
 	}
 }
 
@@ -71,6 +149,7 @@ static void __mutex_unlock(struct mutex *m, const char *fname, int lineno)
 	assert(thread_get_id_may_fail() != -1);
 
 	mutex_unlock_check(m);
+	lock_prof_mutex_released(m);
 
 	old_itr_status = cpu_spin_lock_xsave(&m->spin_lock);
 
@@ -78,6 +157,7 @@ static void __mutex_unlock(struct mutex *m, const char *fname, int lineno)
 		panic();
 
 	m->state = 0;
+	m->owner_id = MUTEX_OWNER_ID_NONE;
 
 	cpu_spin_unlock_xrestore(&m->spin_lock, old_itr_status);
 
@@ -96,11 +176,16 @@ static bool __mutex_trylock(struct mutex *m, const char *fname __unused,
 	old_itr_status = cpu_spin_lock_xsave(&m->spin_lock);
 
 	can_lock_write = !m->state;
-	if (can_lock_write)
+	if (can_lock_write) {
 		m->state = -1;
+		m->owner_id = thread_get_id();
+	}
 
 	cpu_spin_unlock_xrestore(&m->spin_lock, old_itr_status);
 
+	if (can_lock_write)
+		lock_prof_mutex_acquired(m, true, 0);
+
 	return can_lock_write;
 }
 
@@ -128,6 +213,10 @@ static void __mutex_read_unlock(struct mutex *m, const char *fname, int lineno)
 
 static void __mutex_read_lock(struct mutex *m, const char *fname, int lineno)
 {
+	uint64_t wait_start = 0;
+	bool spun = false;
+	bool slept = false;
+
 	assert_have_no_spinlock();
 	assert(thread_get_id_may_fail() != -1);
 	assert(thread_is_in_normal_mode());
@@ -137,6 +226,7 @@ static void __mutex_read_lock(struct mutex *m, const char *fname, int lineno)
 		bool can_lock;
 		struct wait_queue_elem wqe;
 		int owner = MUTEX_OWNER_ID_NONE;
+		bool spin = false;
 
 		/*
 		 * If the mutex is locked we need to initialize the wqe
@@ -151,23 +241,40 @@ static void __mutex_read_lock(struct mutex *m, const char *fname, int lineno)
 
 		can_lock = m->state != -1;
 		if (!can_lock) {
-			wq_wait_init(&m->wq, &wqe, true /* wait_read */);
 			owner = m->owner_id;
 			assert(owner != thread_get_id_may_fail());
+			/* Spin at most once, then sleep */
+			spin = !spun && can_spin_on(owner);
+			if (!spin)
+				wq_wait_init(&m->wq, &wqe,
+					     true /* wait_read */);
 		} else {
 			m->state++; /* read_locked */
 		}
 
 		cpu_spin_unlock_xrestore(&m->spin_lock, old_itr_status);
 
-		if (!can_lock) {
-			/*
-			 * Someone else is holding the lock, wait in normal
-			 * world for the lock to become available.
-			 */
-			wq_wait_final(&m->wq, &wqe, m, owner, fname, lineno);
-		} else
+		if (can_lock) {
+			update_stats(spun, slept);
+			lock_prof_mutex_acquired(m, false, wait_start);
 			return;
+		}
+
+		if (!wait_start)
+			wait_start = lock_prof_timestamp();
+
+		if (spin) {
+			spun = true;
+			spin_on_owner(m, owner, true /* wait_read */);
+			continue;
+		}
+
+		/*
+		 * Someone else is holding the lock, wait in normal
+		 * world for the lock to become available.
+		 */
+		slept = true;
+		wq_wait_final(&m->wq, &wqe, m, owner, fname, lineno);
 	}
 }
 
@@ -189,6 +296,9 @@ static bool __mutex_read_trylock(struct mutex *m, const char *fname __unused,
 
 	cpu_spin_unlock_xrestore(&m->spin_lock, old_itr_status);
 
+	if (can_lock)
+		lock_prof_mutex_acquired(m, false, 0);
+
 	return can_lock;
 }
 
@@ -326,6 +436,7 @@ static void __condvar_wait(struct condvar *cv, struct mutex *m,
 	short new_state;
 
 	mutex_unlock_check(m);
+	lock_prof_mutex_released(m);
 
 	/* Link this condvar to this mutex until reinitialized */
 	old_itr_status = cpu_spin_lock_xsave(&cv->spin_lock);
@@ -349,6 +460,7 @@ static void __condvar_wait(struct condvar *cv, struct mutex *m,
 	} else {
 		/* Only one lock (read or write), unlock the mutex */
 		m->state = 0;
+		m->owner_id = MUTEX_OWNER_ID_NONE;
 	}
 	new_state = m->state;
 
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <arm.h>
+#include <atomic.h>
+#include <kernel/linker.h>
+#include <kernel/misc.h>
+#include <kernel/profiler.h>
+#include <kernel/unwind.h>
+#include <string.h>
+#include <util.h>
+
+#include "thread_private.h"
+
+/*
+ * Samples are taken from the foreign interrupt handler when a thread
+ * executing in kernel mode is suspended, see thread_state_suspend(). Code
+ * running with foreign interrupts masked is consequently never sampled,
+ * instead the time is accounted to where the interrupts are unmasked
+ * again.
+ *
+ * The sample buffer lives in non-secure shared memory, so the ring indexes
+ * are kept in secure memory and only copied to the buffer.
+ *
+ * prof_busy[] is set by a CPU while it's recording a sample, it's used by
+ * prof_stop() to know when the buffer isn't accessed any longer.
+ */
+static struct prof_buf_hdr *prof_hdr;
+static size_t prof_samples_per_cpu;
+static uint64_t prof_head[CFG_TEE_CORE_NB_CORE];
+static unsigned int prof_busy[CFG_TEE_CORE_NB_CORE];
+static unsigned int prof_active;
+
+static size_t cpu_buf_size(size_t samples_per_cpu)
+{
+	return sizeof(struct prof_cpu_buf) +
+	       samples_per_cpu * sizeof(struct prof_sample);
+}
+
+static struct prof_cpu_buf *get_cpu_buf(size_t pos)
+{
+	return (void *)((vaddr_t)(prof_hdr + 1) +
+			pos * cpu_buf_size(prof_samples_per_cpu));
+}
+
+size_t prof_buf_size(size_t samples_per_cpu)
+{
+	return sizeof(struct prof_buf_hdr) +
+	       CFG_TEE_CORE_NB_CORE * cpu_buf_size(samples_per_cpu);
+}
+
+#if defined(CFG_UNWIND) && defined(ARM64)
+static size_t unwind_regs(struct prof_sample *s,
+			  const struct thread_ctx_regs *regs, vaddr_t pc,
+			  vaddr_t stack, size_t stack_size)
+{
+	struct unwind_state_arm64 state = { .fp = regs->x[29], .pc = pc };
+	size_t n = 0;
+
+	while (n < PROF_MAX_DEPTH - 1 &&
+	       unwind_stack_arm64(&state, true /*kernel stack*/, stack,
+				  stack_size))
+		s->pc[++n] = state.pc;
+
+	return n + 1;
+}
+#elif defined(CFG_UNWIND) && defined(ARM32)
+static size_t unwind_regs(struct prof_sample *s,
+			  const struct thread_ctx_regs *regs, vaddr_t pc,
+			  vaddr_t stack, size_t stack_size)
+{
+	struct unwind_state_arm32 state = { 0 };
+	vaddr_t exidx = (vaddr_t)__exidx_start;
+	size_t exidx_sz = (vaddr_t)__exidx_end - (vaddr_t)__exidx_start;
+	size_t n = 0;
+
+	/* r0..r12 are saved in order at the start of struct thread_ctx_regs */
+	memcpy(state.registers, &regs->r0, 13 * sizeof(uint32_t));
+	state.registers[13] = regs->svc_sp;
+	state.registers[14] = regs->svc_lr;
+	state.registers[15] = pc;
+
+	while (n < PROF_MAX_DEPTH - 1 &&
+	       unwind_stack_arm32(&state, exidx, exidx_sz,
+				  true /*kernel stack*/, stack, stack_size))
+		s->pc[++n] = state.registers[15];
+
+	return n + 1;
+}
+#else
+static size_t unwind_regs(struct prof_sample *s __unused,
+			  const struct thread_ctx_regs *regs __unused,
+			  vaddr_t pc __unused, vaddr_t stack __unused,
+			  size_t stack_size __unused)
+{
+	return 1;
+}
+#endif
+
+void prof_sample(const struct thread_ctx_regs *regs, vaddr_t pc,
+		 vaddr_t stack, size_t stack_size)
+{
+	struct prof_cpu_buf *cb = NULL;
+	struct prof_sample *s = NULL;
+	size_t pos = 0;
+
+	if (!atomic_load_uint(&prof_active))
+		return;
+
+	pos = get_core_pos();
+
+	atomic_store_uint(prof_busy + pos, 1);
+	/* Pairs with the barrier in prof_stop() */
+	dmb();
+	if (!atomic_load_uint(&prof_active))
+		goto out;
+
+	cb = get_cpu_buf(pos);
+	s = (struct prof_sample *)(cb + 1) +
+	    (prof_head[pos] & (prof_samples_per_cpu - 1));
+
+	s->thread = thread_get_id();
+	s->pc[0] = pc;
+	s->depth = unwind_regs(s, regs, pc, stack, stack_size);
+
+	prof_head[pos]++;
+	cb->head = prof_head[pos];
+out:
+	atomic_store_uint(prof_busy + pos, 0);
+}
+
+TEE_Result prof_start(void *buf, size_t samples_per_cpu)
+{
+	if (!buf || !IS_POWER_OF_TWO(samples_per_cpu))
+		return TEE_ERROR_BAD_PARAMETERS;
+	if (atomic_load_uint(&prof_active) || prof_hdr)
+		return TEE_ERROR_BAD_STATE;
+
+	memset(buf, 0, prof_buf_size(samples_per_cpu));
+	memset(prof_head, 0, sizeof(prof_head));
+	prof_hdr = buf;
+	prof_samples_per_cpu = samples_per_cpu;
+	prof_hdr->magic = PROF_BUF_MAGIC;
+	prof_hdr->version = PROF_BUF_VERSION;
+	prof_hdr->num_cpus = CFG_TEE_CORE_NB_CORE;
+	prof_hdr->samples_per_cpu = samples_per_cpu;
+	prof_hdr->max_depth = PROF_MAX_DEPTH;
+
+	/* Make sure the header is initialized before sampling starts */
+	dmb();
+	atomic_store_uint(&prof_active, 1);
+
+	return TEE_SUCCESS;
+}
+
+void prof_stop(void)
+{
+	size_t n = 0;
+
+	atomic_store_uint(&prof_active, 0);
+	dmb();
+	for (n = 0; n < CFG_TEE_CORE_NB_CORE; n++)
+		while (atomic_load_uint(prof_busy + n))
+			;
+	prof_hdr = NULL;
+	prof_samples_per_cpu = 0;
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <kernel/rpc_stats.h>
+#include <kernel/spinlock.h>
+#include <kernel/sys_counter.h>
+#include <util.h>
+
+/*
+ * Statistics are shared by all guests with CFG_VIRTUALIZATION as the
+ * normal world servicing the requests is assumed to be the same.
+ */
+/* The last entry accounts all commands with an id >= RPC_STATS_NUM_CMDS */
+static struct rpc_cmd_stats rpc_stats[RPC_STATS_NUM_CMDS + 1] __nex_bss;
+static unsigned int rpc_stats_lock __nex_bss = SPINLOCK_UNLOCK;
+
+static struct rpc_cmd_stats *get_stats(uint32_t cmd)
+{
+	if (cmd < RPC_STATS_NUM_CMDS)
+		return rpc_stats + cmd;
+	return rpc_stats + RPC_STATS_NUM_CMDS;
+}
+
+static size_t get_bucket(uint64_t ticks)
+{
+	size_t n = 0;
+
+	while (ticks > 1 && n < RPC_STATS_NUM_BUCKETS - 1) {
+		ticks >>= 1;
+		n++;
+	}
+
+	return n;
+}
+
+uint64_t rpc_stats_begin(uint32_t cmd)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&rpc_stats_lock);
+	struct rpc_cmd_stats *s = get_stats(cmd);
+
+	s->cmd = MIN(cmd, (uint32_t)RPC_STATS_CMD_OTHER);
+	s->in_flight++;
+	cpu_spin_unlock_xrestore(&rpc_stats_lock, exceptions);
+
+	return sys_counter_read();
+}
+
+void rpc_stats_end(uint32_t cmd, uint64_t begin)
+{
+	uint64_t ticks = sys_counter_read() - begin;
+	uint32_t exceptions = cpu_spin_lock_xsave(&rpc_stats_lock);
+	struct rpc_cmd_stats *s = get_stats(cmd);
+
+	s->in_flight--;
+	s->count++;
+	s->total_ticks += ticks;
+	s->max_ticks = MAX(s->max_ticks, ticks);
+	s->buckets[get_bucket(ticks)]++;
+	cpu_spin_unlock_xrestore(&rpc_stats_lock, exceptions);
+}
+
+size_t rpc_stats_get(struct rpc_cmd_stats *stats, size_t count)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&rpc_stats_lock);
+	size_t num = 0;
+	size_t n = 0;
+
+	for (n = 0; n < ARRAY_SIZE(rpc_stats); n++) {
+		if (!rpc_stats[n].count && !rpc_stats[n].in_flight)
+			continue;
+		if (num < count)
+			stats[num] = rpc_stats[n];
+		num++;
+	}
+
+	cpu_spin_unlock_xrestore(&rpc_stats_lock, exceptions);
+
+	return num;
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <arm.h>
+#include <atomic.h>
+#include <kernel/misc.h>
+#include <kernel/rwlock.h>
+#include <kernel/spinlock.h>
+#include <kernel/thread.h>
+
+/*
+ * A reader publishes its count before checking for a writer, and a writer
+ * takes the writer lock before checking the reader counts. The full
+ * barriers in between guarantee that at least one of them sees the other,
+ * so they can't both enter the critical section.
+ */
+
+uint32_t rwlock_read_lock_xsave(struct rwlock *l)
+{
+	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	unsigned int *count = &l->readers[get_core_pos()].count;
+
+	while (true) {
+		atomic_store_uint(count, *count + 1);
+		dmb();
+		/*
+		 * A recursive read lock doesn't back off: a writer can't
+		 * have entered while this core held the lock, it's waiting
+		 * for the count of this core to drop to zero.
+		 */
+		if (*count > 1 ||
+		    atomic_load_uint(&l->writer) == SPINLOCK_UNLOCK)
+			break;
+
+		/* Back off while the writer is active */
+		atomic_store_uint(count, *count - 1);
+		while (atomic_load_uint(&l->writer) != SPINLOCK_UNLOCK)
+			;
+	}
+	spinlock_count_incr();
+
+	return exceptions;
+}
+
+void rwlock_read_unlock_xrestore(struct rwlock *l, uint32_t exceptions)
+{
+	unsigned int *count = &l->readers[get_core_pos()].count;
+
+	assert(*count);
+	/* Complete the accesses of the critical section first */
+	dmb();
+	atomic_store_uint(count, *count - 1);
+	spinlock_count_decr();
+	thread_unmask_exceptions(exceptions);
+}
+
+uint32_t rwlock_write_lock_xsave(struct rwlock *l)
+{
+	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	size_t n = 0;
+
+	__cpu_spin_lock(&l->writer);
+	dmb();
+	for (n = 0; n < CFG_TEE_CORE_NB_CORE; n++)
+		while (atomic_load_uint(&l->readers[n].count))
+			;
+	spinlock_count_incr();
+
+	return exceptions;
+}
+
+void rwlock_write_unlock_xrestore(struct rwlock *l, uint32_t exceptions)
+{
+	dmb();
+	__cpu_spin_unlock(&l->writer);
+	spinlock_count_decr();
+	thread_unmask_exceptions(exceptions);
+}
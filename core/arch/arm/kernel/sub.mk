@@ -37,9 +37,13 @@ srcs-$(CFG_ARM32_core) += vfp_a32.S
 srcs-$(CFG_ARM64_core) += vfp_a64.S
 endif
 srcs-y += trace_ext.c
+srcs-$(CFG_WITH_STATS) += rpc_stats.c
+srcs-$(CFG_CORE_PROFILER) += profiler.c
 srcs-$(CFG_ARM32_core) += misc_a32.S
 srcs-$(CFG_ARM64_core) += misc_a64.S
 srcs-y += mutex.c
+srcs-y += rwlock.c
+srcs-$(CFG_LOCK_PROFILING) += lock_prof.c
 srcs-$(CFG_LOCKDEP) += mutex_lockdep.c
 srcs-y += wait_queue.c
 srcs-$(CFG_PM_STUBS) += pm_stubs.c
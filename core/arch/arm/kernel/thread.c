@@ -14,10 +14,13 @@
 #include <kernel/misc.h>
 #include <kernel/msg_param.h>
 #include <kernel/panic.h>
+#include <kernel/profiler.h>
+#include <kernel/rpc_stats.h>
 #include <kernel/spinlock.h>
 #include <kernel/tee_ta_manager.h>
 #include <kernel/thread_defs.h>
 #include <kernel/thread.h>
+#include <kernel/tracepoint.h>
 #include <kernel/virtualization.h>
 #include <mm/core_memprot.h>
 #include <mm/mobj.h>
@@ -431,12 +434,17 @@ static void thread_alloc_and_run(struct thread_smc_args *args)
 
 	unlock_global();
 
+#ifdef CFG_VIRTUALIZATION
+	virt_account_std_call(!found_thread);
+#endif
+
 	if (!found_thread) {
 		args->a0 = OPTEE_SMC_RETURN_ETHREAD_LIMIT;
 		return;
 	}
 
 	l->curr_thread = n;
+	tp_thread_alloc(n);
 
 	threads[n].flags = 0;
 	init_regs(threads + n, args);
@@ -531,6 +539,7 @@ static void thread_resume_from_rpc(struct thread_smc_args *args)
 	}
 
 	l->curr_thread = n;
+	tp_thread_resume(n);
 
 	if (is_user_mode(&threads[n].regs))
 		tee_ta_update_session_utime_resume();
@@ -562,7 +571,9 @@ void thread_handle_fast_smc(struct thread_smc_args *args)
 	}
 #endif
 
+	tp_fast_smc_begin(args->a0);
 	thread_fast_smc_handler_ptr(args);
+	tp_fast_smc_end(args->a0);
 
 #ifdef CFG_VIRTUALIZATION
 	virt_unset_guest();
@@ -584,10 +595,13 @@ void thread_handle_std_smc(struct thread_smc_args *args)
 	}
 #endif
 
-	if (args->a0 == OPTEE_SMC_CALL_RETURN_FROM_RPC)
+	if (args->a0 == OPTEE_SMC_CALL_RETURN_FROM_RPC) {
 		thread_resume_from_rpc(args);
-	else
+	} else {
+		/* Resumes are traced as TP_EVENT_THREAD_RESUME instead */
+		tp_std_smc_begin(args->a0, args->a1);
 		thread_alloc_and_run(args);
+	}
 
 #ifdef CFG_VIRTUALIZATION
 	virt_unset_guest();
@@ -621,9 +635,11 @@ static void thread_rpc_free_arg(uint64_t cookie)
 void __weak __thread_std_smc_entry(struct thread_smc_args *args)
 {
 #ifdef CFG_VIRTUALIZATION
-	virt_on_stdcall();
+	if (virt_on_stdcall())
+		args->a0 = OPTEE_SMC_RETURN_ENOMEM;
+	else
 #endif
-	thread_std_smc_handler_ptr(args);
+		thread_std_smc_handler_ptr(args);
 
 	if (args->a0 == OPTEE_SMC_RETURN_OK) {
 		struct thread_ctx *thr = threads + thread_get_id();
@@ -636,6 +652,8 @@ void __weak __thread_std_smc_entry(struct thread_smc_args *args)
 			thr->rpc_mobj = NULL;
 		}
 	}
+
+	tp_std_smc_end(args->a0);
 }
 
 void *thread_get_tmp_sp(void)
@@ -762,6 +780,7 @@ int thread_state_suspend(uint32_t flags, uint32_t cpsr, vaddr_t pc)
 	assert(ct != -1);
 
 	thread_check_canaries();
+	tp_thread_suspend(flags, pc);
 
 	release_unused_kernel_stack(threads + ct, cpsr);
 
@@ -769,6 +788,10 @@ int thread_state_suspend(uint32_t flags, uint32_t cpsr, vaddr_t pc)
 		thread_user_save_vfp();
 		tee_ta_update_session_utime_suspend();
 		tee_ta_gprof_sample_pc(pc);
+	} else if (flags & THREAD_FLAGS_EXIT_ON_FOREIGN_INTR) {
+		prof_sample(&threads[ct].regs, pc,
+			    threads[ct].stack_va_end - STACK_THREAD_SIZE,
+			    STACK_THREAD_SIZE);
 	}
 	thread_lazy_restore_ns_vfp();
 
@@ -859,6 +882,14 @@ int thread_get_id(void)
 	return ct;
 }
 
+bool thread_is_running(int thread_id)
+{
+	if (thread_id < 0 || thread_id >= CFG_NUM_THREADS)
+		return false;
+	return __compiler_atomic_load(&threads[thread_id].state) ==
+	       THREAD_STATE_ACTIVE;
+}
+
 static void init_handlers(const struct thread_handlers *handlers)
 {
 	thread_std_smc_handler_ptr = handlers->std_smc;
@@ -1576,6 +1607,8 @@ uint32_t thread_rpc_cmd(uint32_t cmd, size_t num_params,
 	uint32_t rpc_args[THREAD_RPC_NUM_ARGS] = { OPTEE_SMC_RETURN_RPC_CMD };
 	void *arg = NULL;
 	uint64_t carg = 0;
+	uint64_t stats_begin = 0;
+	uint64_t begin = 0;
 	uint32_t ret = 0;
 
 	/* The source CRYPTO_RNG_SRC_JITTER_RPC is safe to use here */
@@ -1586,10 +1619,19 @@ uint32_t thread_rpc_cmd(uint32_t cmd, size_t num_params,
 	if (ret)
 		return ret;
 
+	tp_rpc_begin(cmd);
+	begin = tee_ta_acct_rpc_begin();
+	stats_begin = rpc_stats_begin(cmd);
+
 	reg_pair_from_64(carg, rpc_args + 1, rpc_args + 2);
 	thread_rpc(rpc_args);
 
-	return get_rpc_arg_res(arg, num_params, params);
+	rpc_stats_end(cmd, stats_begin);
+	tee_ta_acct_rpc_end(begin);
+	ret = get_rpc_arg_res(arg, num_params, params);
+	tp_rpc_end(cmd, ret);
+
+	return ret;
 }
 
 /**
@@ -1604,6 +1646,7 @@ uint32_t thread_rpc_cmd(uint32_t cmd, size_t num_params,
 static void thread_rpc_free(unsigned int bt, uint64_t cookie, struct mobj *mobj)
 {
 	uint32_t rpc_args[THREAD_RPC_NUM_ARGS] = { OPTEE_SMC_RETURN_RPC_CMD };
+	uint64_t begin = 0;
 	void *arg = NULL;
 	uint64_t carg = 0;
 	struct thread_param param = THREAD_PARAM_VALUE(IN, bt, cookie, 0);
@@ -1614,7 +1657,9 @@ static void thread_rpc_free(unsigned int bt, uint64_t cookie, struct mobj *mobj)
 
 	if (!ret) {
 		reg_pair_from_64(carg, rpc_args + 1, rpc_args + 2);
+		begin = rpc_stats_begin(OPTEE_RPC_CMD_SHM_FREE);
 		thread_rpc(rpc_args);
+		rpc_stats_end(OPTEE_RPC_CMD_SHM_FREE, begin);
 	}
 }
 
@@ -1671,12 +1716,15 @@ static struct mobj *thread_rpc_alloc(size_t size, size_t align, unsigned int bt)
 	struct thread_param param = THREAD_PARAM_VALUE(IN, bt, size, align);
 	uint32_t ret = get_rpc_arg(OPTEE_RPC_CMD_SHM_ALLOC, 1, &param,
 				   &arg, &carg);
+	uint64_t begin = 0;
 
 	if (ret)
 		return NULL;
 
 	reg_pair_from_64(carg, rpc_args + 1, rpc_args + 2);
+	begin = rpc_stats_begin(OPTEE_RPC_CMD_SHM_ALLOC);
 	thread_rpc(rpc_args);
+	rpc_stats_end(OPTEE_RPC_CMD_SHM_ALLOC, begin);
 
 	return get_rpc_alloc_res(arg, bt);
 }
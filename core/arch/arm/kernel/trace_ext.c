@@ -2,18 +2,232 @@
 /*
  * Copyright (c) 2014, Linaro Limited
  */
+#include <arm.h>
+#include <atomic.h>
+#include <inttypes.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 #include <trace.h>
 #include <console.h>
+#include <kernel/misc.h>
 #include <kernel/spinlock.h>
 #include <kernel/thread.h>
+#include <kernel/trace_ext.h>
 #include <mm/core_mmu.h>
+#include <util.h>
 
 const char trace_ext_prefix[] = "TC";
 int trace_level __nex_data = TRACE_LEVEL;
 static unsigned int puts_lock __nex_bss = SPINLOCK_UNLOCK;
 
-void trace_ext_puts(const char *str)
+#ifdef CFG_CORE_TRACE_RING
+/* Number of bytes output to the console while holding puts_lock */
+#define TRACE_RING_DRAIN_CHUNK	64U
+/*
+ * Number of attempts of trace_ext_set_sync() to take over the rings, a
+ * reader never holds them longer than the time needed to copy them
+ */
+#define TRACE_RING_SYNC_TRIES	1000000U
+
+/*
+ * Single producer, single consumer ring of trace messages. The producer is
+ * the CPU owning the ring, with all exceptions masked. The consumer is the
+ * CPU currently reading the rings, see trace_ext_read().
+ *
+ * @head:	Updated by the producer only
+ * @tail:	Updated by the consumer only
+ * @dropped:	Number of messages discarded because the ring was full,
+ *		updated by the producer only
+ * @dropped_reported: Value of @dropped when last reported, updated by the
+ *		consumer only
+ */
+struct trace_ring {
+	uint32_t head;
+	uint32_t tail;
+	uint32_t dropped;
+	uint32_t dropped_reported;
+	char buf[CFG_CORE_TRACE_RING_SIZE];
+};
+
+/* Where the traces taken out of the rings go, the console if @buf is NULL */
+struct trace_sink {
+	char *buf;
+	size_t size;
+	size_t len;
+};
+
+static struct trace_ring trace_rings[CFG_TEE_CORE_NB_CORE] __nex_bss;
+static bool trace_async __nex_bss;
+/* Position + 1 of the CPU reading the rings, 0 if none */
+static unsigned int trace_reader __nex_bss;
+/* Ring where the last read stopped because the buffer was full */
+static size_t trace_read_ring __nex_bss;
+
+static void ring_put(struct trace_ring *r, const char *str)
+{
+	const uint32_t mask = CFG_CORE_TRACE_RING_SIZE - 1;
+	uint32_t head = r->head;
+	uint32_t tail = atomic_load_u32(&r->tail);
+	size_t len = strlen(str);
+	size_t n = 0;
+
+	COMPILE_TIME_ASSERT(IS_POWER_OF_TWO(CFG_CORE_TRACE_RING_SIZE));
+
+	/* Whole messages are dropped to keep the output readable */
+	if (len > CFG_CORE_TRACE_RING_SIZE - (head - tail)) {
+		atomic_store_u32(&r->dropped, r->dropped + 1);
+		return;
+	}
+
+	/* Don't let the writes below overtake the read of tail */
+	dmb();
+	for (n = 0; n < len; n++)
+		r->buf[(head + n) & mask] = str[n];
+	/* Publish the message only once it's completely written */
+	dmb();
+	atomic_store_u32(&r->head, head + len);
+}
+
+static size_t sink_space(struct trace_sink *sink)
+{
+	if (!sink->buf)
+		return SIZE_MAX;
+	return sink->size - sink->len;
+}
+
+static void sink_putc(struct trace_sink *sink, char c)
+{
+	if (sink->buf)
+		sink->buf[sink->len++] = c;
+	else
+		console_putc(c);
+}
+
+/*
+ * Moves at most @max bytes from the ring to @sink, called by the owner of
+ * trace_reader. Returns true if there's more left in the ring.
+ */
+static bool ring_drain(struct trace_ring *r, struct trace_sink *sink,
+		       uint32_t max)
+{
+	const uint32_t mask = CFG_CORE_TRACE_RING_SIZE - 1;
+	uint32_t dropped = atomic_load_u32(&r->dropped);
+	uint32_t head = atomic_load_u32(&r->head);
+	uint32_t tail = r->tail;
+	uint32_t n = 0;
+	const char *p = NULL;
+	char msg[48] = { 0 };
+
+	if (dropped != r->dropped_reported) {
+		snprintf(msg, sizeof(msg), "*** %"PRIu32" trace(s) dropped\n",
+			 dropped - r->dropped_reported);
+		if (strlen(msg) > sink_space(sink))
+			return true;
+		for (p = msg; *p; p++)
+			sink_putc(sink, *p);
+		r->dropped_reported = dropped;
+	}
+
+	/* Read the message only after having read head */
+	dmb();
+	max = MIN(max, head - tail);
+	if (sink_space(sink) < max)
+		max = sink_space(sink);
+	for (n = 0; n < max; n++)
+		sink_putc(sink, r->buf[(tail + n) & mask]);
+	/* Release the space only after having read the message */
+	dmb();
+	atomic_store_u32(&r->tail, tail + n);
+
+	return head != tail + n;
+}
+
+/* Called with exceptions masked so that the CPU stays the same */
+static unsigned int reader_id(void)
+{
+	return get_core_pos() + 1;
+}
+
+void trace_ext_set_async(void)
+{
+	trace_async = true;
+}
+
+size_t trace_ext_read(char *buf, size_t len)
+{
+	struct trace_sink sink = { .buf = buf, .size = len };
+	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	unsigned int idle = 0;
+	size_t idx = 0;
+	size_t n = 0;
+
+	/*
+	 * Only one CPU reads at a time, the others return nothing since
+	 * what's in the rings is going to be picked up by the current
+	 * reader or the next one.
+	 */
+	if (!atomic_cas_uint(&trace_reader, &idle, reader_id()))
+		goto out;
+
+	/* Resume with the ring which didn't fit last time */
+	for (n = 0; n < ARRAY_SIZE(trace_rings); n++) {
+		idx = (trace_read_ring + n) % ARRAY_SIZE(trace_rings);
+		if (ring_drain(trace_rings + idx, &sink, UINT32_MAX)) {
+			trace_read_ring = idx;
+			break;
+		}
+	}
+
+	atomic_store_uint(&trace_reader, 0);
+out:
+	thread_unmask_exceptions(exceptions);
+	return sink.len;
+}
+
+void trace_ext_set_sync(void)
+{
+	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	struct trace_sink sink = { .buf = NULL };
+	unsigned int owner = reader_id();
+	unsigned int idle = 0;
+	bool more = false;
+	size_t n = 0;
+
+	trace_async = false;
+
+	/*
+	 * Wait for the current reader to be done so that what's left is
+	 * output once and in order. If it's this CPU which panicked while
+	 * reading, the rings are left as they are. A reader which doesn't
+	 * finish in time has most likely stopped on another CPU, the rings
+	 * are output anyway.
+	 */
+	for (n = 0; n < TRACE_RING_SYNC_TRIES; n++) {
+		if (atomic_cas_uint(&trace_reader, &idle, owner))
+			break;
+		if (idle == owner)
+			goto out;
+		idle = 0;
+	}
+
+	for (n = 0; n < ARRAY_SIZE(trace_rings); n++) {
+		do {
+			cpu_spin_lock_no_dldetect(&puts_lock);
+			more = ring_drain(trace_rings + n, &sink,
+					  TRACE_RING_DRAIN_CHUNK);
+			console_flush();
+			cpu_spin_unlock(&puts_lock);
+		} while (more);
+	}
+
+	atomic_store_uint(&trace_reader, 0);
+out:
+	thread_unmask_exceptions(exceptions);
+}
+#endif /*CFG_CORE_TRACE_RING*/
+
+static void puts_sync(const char *str)
 {
 	uint32_t itr_status = thread_mask_exceptions(THREAD_EXCP_ALL);
 	bool mmu_enabled = cpu_mmu_enabled();
@@ -41,6 +255,22 @@ void trace_ext_puts(const char *str)
 	thread_unmask_exceptions(itr_status);
 }
 
+void trace_ext_puts(const char *str)
+{
+#ifdef CFG_CORE_TRACE_RING
+	uint32_t exceptions = 0;
+
+	if (trace_async && cpu_mmu_enabled()) {
+		exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+		ring_put(trace_rings + get_core_pos(), str);
+		thread_unmask_exceptions(exceptions);
+		return;
+	}
+#endif
+
+	puts_sync(str);
+}
+
 int trace_ext_get_thread_id(void)
 {
 	return thread_get_id_may_fail();
@@ -13,6 +13,7 @@
 #include <kernel/tee_misc.h>
 #include <kernel/tee_ta_manager.h>
 #include <kernel/thread.h>
+#include <kernel/tracepoint.h>
 #include <kernel/user_ta.h>
 #include <mm/core_memprot.h>
 #include <mm/core_mmu.h>
@@ -316,6 +317,8 @@ static TEE_Result user_ta_enter(TEE_ErrorOrigin *err,
 		     utc->ctx.panic_code);
 		serr = TEE_ORIGIN_TEE;
 		res = TEE_ERROR_TARGET_DEAD;
+		/* Don't keep other TAs out of the storage until it's freed */
+		tee_svc_storage_abort_all_tx(utc);
 	}
 
 	/* Copy out value results */
@@ -476,6 +479,8 @@ static void free_utc(struct user_ta_ctx *utc)
 
 	/* Free cryp states created by this TA */
 	tee_svc_cryp_free_states(utc);
+	/* Abort storage transactions not committed by this TA */
+	tee_svc_storage_abort_all_tx(utc);
 	/* Close cryp objects opened by this TA */
 	tee_obj_close_all(utc);
 	/* Free emums created by this TA */
@@ -984,6 +989,8 @@ TEE_Result tee_ta_init_user_ta_session(const TEE_UUID *uuid,
 	if (!utc)
 		return TEE_ERROR_OUT_OF_MEMORY;
 
+	tp_ta_load_begin(uuid);
+
 	TAILQ_INIT(&utc->open_sessions);
 	TAILQ_INIT(&utc->cryp_states);
 	TAILQ_INIT(&utc->objects);
@@ -1058,11 +1065,13 @@ TEE_Result tee_ta_init_user_ta_session(const TEE_UUID *uuid,
 
 	free_elf_states(utc);
 	tee_mmu_set_ctx(NULL);
+	tp_ta_load_end(TEE_SUCCESS);
 	return TEE_SUCCESS;
 
 err:
 	free_elf_states(utc);
 	tee_mmu_set_ctx(NULL);
 	free_utc(utc);
+	tp_ta_load_end(res);
 	return res;
 }
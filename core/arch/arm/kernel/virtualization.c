@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: BSD-2-Clause
 /* Copyright (c) 2018, EPAM Systems. All rights reserved. */
 
+#include <assert.h>
+#include <atomic.h>
 #include <compiler.h>
 #include <platform_config.h>
 #include <kernel/generic_boot.h>
@@ -9,6 +11,7 @@
 #include <kernel/misc.h>
 #include <kernel/panic.h>
 #include <kernel/refcount.h>
+#include <kernel/rwlock.h>
 #include <kernel/spinlock.h>
 #include <kernel/virtualization.h>
 #include <mm/core_memprot.h>
@@ -19,10 +22,22 @@
 #include <string.h>
 #include <util.h>
 
-static unsigned int prtn_list_lock __nex_data = SPINLOCK_UNLOCK;
+/*
+ * Guest partitions are indexed by guest_id in prtn_table, using open
+ * addressing with linear probing. The table is twice as large as the
+ * maximum number of guests to keep the probe sequences short.
+ *
+ * prtn_table is searched by virt_set_guest() on each entry from normal
+ * world while it's only updated when guests are created or destroyed.
+ */
+#define PRTN_TABLE_SIZE		(2 * CFG_VIRT_GUEST_COUNT)
 
-static LIST_HEAD(prtn_list_head, guest_partition) prtn_list __nex_data =
-	LIST_HEAD_INITIALIZER(prtn_list_head);
+/* Marks a removed entry, probing continues past it */
+#define PRTN_REMOVED		((struct guest_partition *)1)
+
+static struct rwlock prtn_table_lock __nex_data = RWLOCK_INITIALIZER;
+static struct guest_partition *prtn_table[PRTN_TABLE_SIZE] __nex_bss;
+static size_t prtn_count __nex_bss;
 
 /* Free pages used for guest partitions */
 tee_mm_pool_t virt_mapper_pool __nex_bss;
@@ -31,7 +46,6 @@ tee_mm_pool_t virt_mapper_pool __nex_bss;
 struct tee_mmap_region *kmemory_map __nex_bss;
 
 struct guest_partition {
-	LIST_ENTRY(guest_partition) link;
 	struct mmu_partition *mmu_prtn;
 	struct tee_mmap_region *memory_map;
 	struct mutex mutex;
@@ -42,6 +56,7 @@ struct guest_partition {
 	bool runtime_initialized;
 	uint16_t id;
 	struct refcount refc;
+	struct virt_guest_stats stats;
 };
 
 struct guest_partition *current_partition[CFG_TEE_CORE_NB_CORE] __nex_bss;
@@ -67,6 +82,44 @@ static void set_current_prtn(struct guest_partition *prtn)
 	thread_unmask_exceptions(exceptions);
 }
 
+/* Returns the slot of @guest_id in prtn_table, called with the lock held */
+static struct guest_partition **find_prtn_slot(uint16_t guest_id)
+{
+	struct guest_partition **slot = NULL;
+	size_t n = 0;
+
+	for (n = 0; n < PRTN_TABLE_SIZE; n++) {
+		slot = prtn_table + (guest_id + n) % PRTN_TABLE_SIZE;
+		if (!*slot)
+			return NULL;
+		if (*slot != PRTN_REMOVED && (*slot)->id == guest_id)
+			return slot;
+	}
+
+	return NULL;
+}
+
+/* Called with the lock held for writing */
+static bool add_prtn(struct guest_partition *prtn)
+{
+	struct guest_partition **slot = NULL;
+	size_t n = 0;
+
+	if (prtn_count >= CFG_VIRT_GUEST_COUNT || find_prtn_slot(prtn->id))
+		return false;
+
+	for (n = 0; n < PRTN_TABLE_SIZE; n++) {
+		slot = prtn_table + (prtn->id + n) % PRTN_TABLE_SIZE;
+		if (!*slot || *slot == PRTN_REMOVED) {
+			*slot = prtn;
+			prtn_count++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static size_t get_ta_ram_size(void)
 {
 	return TA_RAM_SIZE / CFG_VIRT_GUEST_COUNT -
@@ -74,11 +127,15 @@ static size_t get_ta_ram_size(void)
 		core_mmu_get_total_pages_size();
 }
 
-static struct tee_mmap_region *prepare_memory_map(paddr_t tee_data,
-						  paddr_t ta_ram)
+/*
+ * The memory map of a guest is a copy of kmemory_map with .data and .bss
+ * remapped to the memory of the guest. One extra entry is left before the
+ * end of the table for TA RAM, which is added by add_ta_ram_to_map() on
+ * the first std call of the guest.
+ */
+static struct tee_mmap_region *prepare_memory_map(paddr_t tee_data)
 {
 	int i, entries;
-	vaddr_t max_va = 0;
 	struct tee_mmap_region *map;
 	/*
 	 * This function assumes that at time of operation,
@@ -108,22 +165,8 @@ static struct tee_mmap_region *prepare_memory_map(paddr_t tee_data,
 			map[i].attr = core_mmu_type_to_attr(map[i].type);
 			map[i].pa = tee_data;
 		}
-		if (map[i].va + map[i].size > max_va)
-			max_va = map[i].va + map[i].size;
 	}
 
-	/* Map TA_RAM */
-	assert(map[entries - 1].type == MEM_AREA_END);
-	map[entries] = map[entries - 1];
-	map[entries - 1].region_size = SMALL_PAGE_SIZE;
-	map[entries - 1].va = ROUNDUP(max_va, map[entries - 1].region_size);
-	map[entries - 1].va +=
-		(ta_ram - map[entries - 1].va) & CORE_MMU_PGDIR_MASK;
-	map[entries - 1].pa = ta_ram;
-	map[entries - 1].size = get_ta_ram_size();
-	map[entries - 1].type = MEM_AREA_TA_RAM;
-	map[entries - 1].attr = core_mmu_type_to_attr(map[entries - 1].type);
-
 	DMSG("New map (%08lx):",  (vaddr_t)(VCORE_UNPG_RW_PA));
 
 	for (i = 0; i < entries; i++)
@@ -134,6 +177,34 @@ static struct tee_mmap_region *prepare_memory_map(paddr_t tee_data,
 	return map;
 }
 
+/* Returns the entry of the memory map @map which was filled in for TA RAM */
+static struct tee_mmap_region *add_ta_ram_to_map(struct tee_mmap_region *map,
+						 paddr_t ta_ram)
+{
+	struct tee_mmap_region *mm = NULL;
+	vaddr_t max_va = 0;
+
+	for (mm = map; mm->type != MEM_AREA_END; mm++)
+		if (mm->va + mm->size > max_va)
+			max_va = mm->va + mm->size;
+
+	/* mm is the spare entry reserved by prepare_memory_map() */
+	assert(!mm[1].type);
+	mm->region_size = SMALL_PAGE_SIZE;
+	mm->va = ROUNDUP(max_va, mm->region_size);
+	mm->va += (ta_ram - mm->va) & CORE_MMU_PGDIR_MASK;
+	mm->pa = ta_ram;
+	mm->size = get_ta_ram_size();
+	mm->attr = core_mmu_type_to_attr(MEM_AREA_TA_RAM);
+	mm->type = MEM_AREA_TA_RAM;
+
+	DMSG("T: %-16s rsz: %08x, pa: %08lx, va: %08lx, sz: %08lx attr: %x",
+	     teecore_memtype_name(mm->type), mm->region_size, mm->pa, mm->va,
+	     mm->size, mm->attr);
+
+	return mm;
+}
+
 void virt_init_memory(struct tee_mmap_region *memory_map)
 {
 	struct tee_mmap_region *map;
@@ -168,6 +239,12 @@ void virt_init_memory(struct tee_mmap_region *memory_map)
 }
 
 
+/*
+ * Only the memory needed to switch to the guest is allocated when the
+ * guest is created, TA RAM is allocated by provision_ta_ram() on the first
+ * std call of the guest. This keeps creation of a guest cheap and a guest
+ * which never calls into OP-TEE doesn't hold a share of TA RAM.
+ */
 static int configure_guest_prtn_mem(struct guest_partition *prtn)
 {
 	int ret;
@@ -181,14 +258,6 @@ static int configure_guest_prtn_mem(struct guest_partition *prtn)
 	}
 	DMSG("TEE RAM: %08" PRIxPA, tee_mm_get_smem(prtn->tee_ram));
 
-	prtn->ta_ram = tee_mm_alloc(&virt_mapper_pool, get_ta_ram_size());
-	if (!prtn->ta_ram) {
-		EMSG("Can't allocate memory for TA data");
-		ret = TEE_ERROR_OUT_OF_MEMORY;
-		goto err;
-	}
-	DMSG("TA RAM: %08" PRIxPA, tee_mm_get_smem(prtn->ta_ram));
-
 	prtn->tables = tee_mm_alloc(&virt_mapper_pool,
 				   core_mmu_get_total_pages_size());
 	if (!prtn->tables) {
@@ -207,8 +276,7 @@ static int configure_guest_prtn_mem(struct guest_partition *prtn)
 		goto err;
 	}
 
-	prtn->memory_map = prepare_memory_map(tee_mm_get_smem(prtn->tee_ram),
-					     tee_mm_get_smem(prtn->ta_ram));
+	prtn->memory_map = prepare_memory_map(tee_mm_get_smem(prtn->tee_ram));
 	if (!prtn->memory_map) {
 		ret = TEE_ERROR_OUT_OF_MEMORY;
 		goto err;
@@ -220,8 +288,13 @@ static int configure_guest_prtn_mem(struct guest_partition *prtn)
 	/* Switch to guest's mappings */
 	core_mmu_set_prtn(prtn->mmu_prtn);
 
-	/* clear .bss */
-	memset((void *)(VCORE_UNPG_RW_PA), 0, VCORE_UNPG_RW_SZ);
+	/*
+	 * As on boot only .bss needs to be cleared, the rest of the area
+	 * after it (heap, stacks and other .nozi sections) is initialized
+	 * by its users. free_prtn() wipes the whole area when a guest is
+	 * destroyed so nothing of it is left for the next guest.
+	 */
+	memset((void *)__bss_start, 0, __bss_end - __bss_start);
 
 	/* copy .data section from R/O original */
 	memcpy(__data_start,
@@ -233,8 +306,6 @@ static int configure_guest_prtn_mem(struct guest_partition *prtn)
 err:
 	if (prtn->tee_ram)
 		tee_mm_free(prtn->tee_ram);
-	if (prtn->ta_ram)
-		tee_mm_free(prtn->ta_ram);
 	if (prtn->tables)
 		tee_mm_free(prtn->tables);
 	nex_free(prtn->mmu_prtn);
@@ -243,10 +314,43 @@ err:
 	return ret;
 }
 
+/* Called with prtn->mutex held while the guest partition is active */
+static TEE_Result provision_ta_ram(struct guest_partition *prtn)
+{
+	struct tee_mmap_region *mm = NULL;
+
+	prtn->ta_ram = tee_mm_alloc(&virt_mapper_pool, get_ta_ram_size());
+	if (!prtn->ta_ram) {
+		EMSG("Can't allocate memory for TA data of guest %d",
+		     prtn->id);
+		return TEE_ERROR_OUT_OF_MEMORY;
+	}
+	DMSG("TA RAM: %08" PRIxPA, tee_mm_get_smem(prtn->ta_ram));
+
+	mm = add_ta_ram_to_map(prtn->memory_map,
+			       tee_mm_get_smem(prtn->ta_ram));
+	core_mmu_map_prtn_region(prtn->mmu_prtn, mm);
+
+	return TEE_SUCCESS;
+}
+
+static void free_prtn(struct guest_partition *prtn)
+{
+	memset(phys_to_virt(tee_mm_get_smem(prtn->tee_ram),
+			    MEM_AREA_SEC_RAM_OVERALL), 0, VCORE_UNPG_RW_SZ);
+	tee_mm_free(prtn->tee_ram);
+	tee_mm_free(prtn->ta_ram);
+	tee_mm_free(prtn->tables);
+	core_free_mmu_prtn(prtn->mmu_prtn);
+	nex_free(prtn->memory_map);
+	nex_free(prtn);
+}
+
 uint32_t virt_guest_created(uint16_t guest_id)
 {
-	struct guest_partition *prtn;
-	uint32_t exceptions;
+	struct guest_partition *prtn = NULL;
+	uint32_t exceptions = 0;
+	bool added = false;
 
 	prtn = nex_calloc(1, sizeof(*prtn));
 	if (!prtn)
@@ -265,33 +369,40 @@ uint32_t virt_guest_created(uint16_t guest_id)
 	/* Initialize threads */
 	thread_init_threads();
 
-	exceptions = cpu_spin_lock_xsave(&prtn_list_lock);
-	LIST_INSERT_HEAD(&prtn_list, prtn, link);
-	cpu_spin_unlock_xrestore(&prtn_list_lock, exceptions);
+	set_current_prtn(NULL);
+	core_mmu_set_default_prtn();
+
+	exceptions = rwlock_write_lock_xsave(&prtn_table_lock);
+	added = add_prtn(prtn);
+	rwlock_write_unlock_xrestore(&prtn_table_lock, exceptions);
+
+	if (!added) {
+		EMSG("Guest %d already exists or too many guests", guest_id);
+		free_prtn(prtn);
+		return OPTEE_SMC_RETURN_ENOTAVAIL;
+	}
 
 	IMSG("Added guest %d", guest_id);
 
-	set_current_prtn(NULL);
-	core_mmu_set_default_prtn();
 	return OPTEE_SMC_RETURN_OK;
 }
 
 uint32_t virt_guest_destroyed(uint16_t guest_id)
 {
-	struct guest_partition *prtn;
-	uint32_t exceptions;
+	struct guest_partition **slot = NULL;
+	struct guest_partition *prtn = NULL;
+	uint32_t exceptions = 0;
 
 	IMSG("Removing guest %d", guest_id);
 
-	exceptions = cpu_spin_lock_xsave(&prtn_list_lock);
-
-	LIST_FOREACH(prtn, &prtn_list, link) {
-		if (prtn->id == guest_id) {
-			LIST_REMOVE(prtn, link);
-			break;
-		}
+	exceptions = rwlock_write_lock_xsave(&prtn_table_lock);
+	slot = find_prtn_slot(guest_id);
+	if (slot) {
+		prtn = *slot;
+		*slot = PRTN_REMOVED;
+		prtn_count--;
 	}
-	cpu_spin_unlock_xrestore(&prtn_list_lock, exceptions);
+	rwlock_write_unlock_xrestore(&prtn_table_lock, exceptions);
 
 	if (prtn) {
 		if (!refcount_dec(&prtn->refc)) {
@@ -300,12 +411,7 @@ uint32_t virt_guest_destroyed(uint16_t guest_id)
 			panic();
 		}
 
-		tee_mm_free(prtn->tee_ram);
-		tee_mm_free(prtn->ta_ram);
-		tee_mm_free(prtn->tables);
-		core_free_mmu_prtn(prtn->mmu_prtn);
-		nex_free(prtn->memory_map);
-		nex_free(prtn);
+		free_prtn(prtn);
 	} else
 		EMSG("Client with id %d is not found", guest_id);
 
@@ -314,8 +420,9 @@ uint32_t virt_guest_destroyed(uint16_t guest_id)
 
 bool virt_set_guest(uint16_t guest_id)
 {
-	struct guest_partition *prtn;
-	uint32_t exceptions;
+	struct guest_partition **slot = NULL;
+	struct guest_partition *prtn = NULL;
+	uint32_t exceptions = 0;
 
 	prtn = get_current_prtn();
 
@@ -326,20 +433,17 @@ bool virt_set_guest(uint16_t guest_id)
 	if (prtn)
 		panic("Virtual guest partition is already set");
 
-	exceptions = cpu_spin_lock_xsave(&prtn_list_lock);
-	LIST_FOREACH(prtn, &prtn_list, link) {
-		if (prtn->id == guest_id) {
-			set_current_prtn(prtn);
-			core_mmu_set_prtn(prtn->mmu_prtn);
-			refcount_inc(&prtn->refc);
-			cpu_spin_unlock_xrestore(&prtn_list_lock,
-						 exceptions);
-			return true;
-		}
+	exceptions = rwlock_read_lock_xsave(&prtn_table_lock);
+	slot = find_prtn_slot(guest_id);
+	if (slot) {
+		prtn = *slot;
+		set_current_prtn(prtn);
+		core_mmu_set_prtn(prtn->mmu_prtn);
+		refcount_inc(&prtn->refc);
 	}
-	cpu_spin_unlock_xrestore(&prtn_list_lock, exceptions);
+	rwlock_read_unlock_xrestore(&prtn_table_lock, exceptions);
 
-	return guest_id == HYP_CLNT_ID;
+	return slot || guest_id == HYP_CLNT_ID;
 }
 
 void virt_unset_guest(void)
@@ -355,19 +459,47 @@ void virt_unset_guest(void)
 		panic();
 }
 
-void virt_on_stdcall(void)
+TEE_Result virt_on_stdcall(void)
 {
 	struct guest_partition *prtn = get_current_prtn();
+	TEE_Result res = TEE_SUCCESS;
 
 	/* Initialize runtime on first std call */
 	if (!prtn->runtime_initialized) {
 		mutex_lock(&prtn->mutex);
 		if (!prtn->runtime_initialized) {
-			init_tee_runtime();
-			prtn->runtime_initialized = true;
+			if (!prtn->ta_ram)
+				res = provision_ta_ram(prtn);
+			if (!res) {
+				init_tee_runtime();
+				prtn->runtime_initialized = true;
+			}
 		}
 		mutex_unlock(&prtn->mutex);
 	}
+
+	return res;
+}
+
+void virt_account_std_call(bool rejected)
+{
+	struct guest_partition *prtn = get_current_prtn();
+
+	if (!prtn)
+		return;
+
+	atomic_inc32(&prtn->stats.std_calls);
+	if (rejected)
+		atomic_inc32(&prtn->stats.thread_limit);
+}
+
+void virt_get_stats(struct virt_guest_stats *stats)
+{
+	struct guest_partition *prtn = get_current_prtn();
+
+	assert(prtn);
+	stats->std_calls = atomic_load_u32(&prtn->stats.std_calls);
+	stats->thread_limit = atomic_load_u32(&prtn->stats.thread_limit);
 }
 
 struct tee_mmap_region *virt_get_memory_map(void)
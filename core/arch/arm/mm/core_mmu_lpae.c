@@ -451,6 +451,34 @@ void core_mmu_set_default_prtn(void)
 {
 	core_mmu_set_prtn(&default_partition);
 }
+
+void core_mmu_map_prtn_region(struct mmu_partition *prtn,
+			      struct tee_mmap_region *mm)
+{
+	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_FOREIGN_INTR);
+	size_t first = mm->va >> L1_XLAT_ADDRESS_SHIFT;
+	size_t last = (mm->va + mm->size - 1) >> L1_XLAT_ADDRESS_SHIFT;
+	size_t pos = get_core_pos();
+	size_t n = 0;
+
+	core_mmu_map_region(prtn, mm);
+
+	/*
+	 * Level 1 tables are per core, copy only the entries covering the
+	 * region as the other cores may have user mappings active.
+	 */
+	for (n = 0; n < CFG_TEE_CORE_NB_CORE; n++) {
+		if (n == pos)
+			continue;
+
+		memcpy(prtn->l1_tables[0][n] + first,
+		       prtn->l1_tables[0][pos] + first,
+		       XLAT_ENTRY_SIZE * (last - first + 1));
+	}
+	dsb_ishst();
+
+	thread_unmask_exceptions(exceptions);
+}
 #endif
 
 void core_init_mmu_prtn(struct mmu_partition *prtn, struct tee_mmap_region *mm)
@@ -14,10 +14,12 @@
 #include <kernel/asan.h>
 #include <kernel/panic.h>
 #include <kernel/spinlock.h>
+#include <kernel/sys_counter.h>
 #include <kernel/tee_misc.h>
 #include <kernel/tee_ta_manager.h>
 #include <kernel/thread.h>
 #include <kernel/tlb_helpers.h>
+#include <kernel/tracepoint.h>
 #include <mm/core_memprot.h>
 #include <mm/tee_mm.h>
 #include <mm/tee_pager.h>
@@ -48,6 +50,18 @@ enum area_type {
 	AREA_TYPE_LOCK,
 };
 
+/*
+ * Per area counters, see struct tee_pager_area_stats
+ */
+struct pager_area_stats {
+	uint32_t faults;
+	uint32_t loads;
+	uint32_t saves;
+	uint64_t decrypted;
+	uint64_t encrypted;
+	uint64_t fault_ticks;
+};
+
 struct tee_pager_area {
 	union {
 		const uint8_t *hashes;
@@ -59,6 +73,9 @@ struct tee_pager_area {
 	vaddr_t base;
 	size_t size;
 	struct pgt *pgt;
+#ifdef CFG_WITH_STATS
+	struct pager_area_stats stats;
+#endif
 	TAILQ_ENTRY(tee_pager_area) link;
 };
 
@@ -145,6 +162,37 @@ void tee_pager_get_stats(struct tee_pager_stats *stats)
 	pager_stats.zi_released = 0;
 }
 
+void tee_pager_set_boot_check_stats(size_t npages, uint64_t ticks)
+{
+	pager_stats.boot_checked = npages;
+	pager_stats.boot_check_ticks = ticks;
+}
+
+static inline void incr_area_loads(struct tee_pager_area *area,
+				   size_t decrypted)
+{
+	area->stats.loads++;
+	area->stats.decrypted += decrypted;
+}
+
+static inline void incr_area_saves(struct tee_pager_area *area)
+{
+	area->stats.saves++;
+	area->stats.encrypted += SMALL_PAGE_SIZE;
+}
+
+static inline uint64_t area_fault_begin(void)
+{
+	return sys_counter_read();
+}
+
+static inline void area_fault_end(struct tee_pager_area *area,
+				  uint64_t begin)
+{
+	area->stats.faults++;
+	area->stats.fault_ticks += sys_counter_read() - begin;
+}
+
 #else /* CFG_WITH_STATS */
 static inline void incr_ro_hits(void) { }
 static inline void incr_rw_hits(void) { }
@@ -152,11 +200,22 @@ static inline void incr_hidden_hits(void) { }
 static inline void incr_zi_released(void) { }
 static inline void incr_npages_all(void) { }
 static inline void set_npages(void) { }
+static inline void incr_area_loads(struct tee_pager_area *area __unused,
+				   size_t decrypted __unused) { }
+static inline void incr_area_saves(struct tee_pager_area *area __unused) { }
+static inline uint64_t area_fault_begin(void) { return 0; }
+static inline void area_fault_end(struct tee_pager_area *area __unused,
+				  uint64_t begin __unused) { }
 
 void tee_pager_get_stats(struct tee_pager_stats *stats)
 {
 	memset(stats, 0, sizeof(struct tee_pager_stats));
 }
+
+void tee_pager_set_boot_check_stats(size_t npages __unused,
+				    uint64_t ticks __unused)
+{
+}
 #endif /* CFG_WITH_STATS */
 
 #define TBL_NUM_ENTRIES	(CORE_MMU_PGDIR_SIZE / SMALL_PAGE_SIZE)
@@ -669,6 +728,8 @@ static void tee_pager_load_page(struct tee_pager_area *area, vaddr_t page_va,
 		tlbi_mva_allasid((vaddr_t)va_alias);
 	}
 
+	tp_pager_load(area->type, page_va);
+
 	asan_tag_access(va_alias, (uint8_t *)va_alias + SMALL_PAGE_SIZE);
 	switch (area->type) {
 	case AREA_TYPE_RO:
@@ -678,6 +739,7 @@ static void tee_pager_load_page(struct tee_pager_area *area, vaddr_t page_va,
 
 			memcpy(va_alias, stored_page, SMALL_PAGE_SIZE);
 			incr_ro_hits();
+			incr_area_loads(area, 0);
 
 			if (hash_sha256_check(hash, va_alias,
 					      SMALL_PAGE_SIZE) != TEE_SUCCESS) {
@@ -693,18 +755,22 @@ static void tee_pager_load_page(struct tee_pager_area *area, vaddr_t page_va,
 	case AREA_TYPE_RW:
 		FMSG("Restore %p %#" PRIxVA " iv %#" PRIx64,
 			va_alias, page_va, area->u.rwp[idx].iv);
-		if (!area->u.rwp[idx].iv)
+		if (!area->u.rwp[idx].iv) {
 			memset(va_alias, 0, SMALL_PAGE_SIZE);
-		else if (!decrypt_page(&area->u.rwp[idx], stored_page,
-				       va_alias)) {
+			incr_area_loads(area, 0);
+		} else if (!decrypt_page(&area->u.rwp[idx], stored_page,
+					 va_alias)) {
 			EMSG("PH 0x%" PRIxVA " failed", page_va);
 			panic();
+		} else {
+			incr_area_loads(area, SMALL_PAGE_SIZE);
 		}
 		incr_rw_hits();
 		break;
 	case AREA_TYPE_LOCK:
 		FMSG("Zero init %p %#" PRIxVA, va_alias, page_va);
 		memset(va_alias, 0, SMALL_PAGE_SIZE);
+		incr_area_loads(area, 0);
 		break;
 	default:
 		panic();
@@ -727,6 +793,7 @@ static void tee_pager_save_page(struct tee_pager_pmem *pmem, uint32_t attr)
 				(uint8_t *)pmem->va_alias + SMALL_PAGE_SIZE);
 		encrypt_page(&pmem->area->u.rwp[idx], pmem->va_alias,
 			     stored_page);
+		incr_area_saves(pmem->area);
 		asan_tag_no_access(pmem->va_alias,
 				   (uint8_t *)pmem->va_alias + SMALL_PAGE_SIZE);
 		FMSG("Saved %#" PRIxVA " iv %#" PRIx64,
@@ -745,19 +812,29 @@ static void free_area(struct tee_pager_area *area)
 	free(area);
 }
 
+/*
+ * The areas of a user TA are also walked by tee_pager_get_area_stats()
+ * on behalf of other threads, so the lists are only modified with the
+ * pager lock held.
+ */
 static bool pager_add_uta_area(struct user_ta_ctx *utc, vaddr_t base,
 			       size_t size)
 {
+	struct tee_pager_area_head *areas = NULL;
 	struct tee_pager_area *area;
+	uint32_t exceptions;
 	uint32_t flags;
 	vaddr_t b = base;
 	size_t s = ROUNDUP(size, SMALL_PAGE_SIZE);
 
 	if (!utc->areas) {
-		utc->areas = malloc(sizeof(*utc->areas));
-		if (!utc->areas)
+		areas = malloc(sizeof(*areas));
+		if (!areas)
 			return false;
-		TAILQ_INIT(utc->areas);
+		TAILQ_INIT(areas);
+		exceptions = pager_lock_check_stack(64);
+		utc->areas = areas;
+		pager_unlock(exceptions);
 	}
 
 	flags = TEE_MATTR_PRW | TEE_MATTR_URWX;
@@ -774,7 +851,9 @@ static bool pager_add_uta_area(struct user_ta_ctx *utc, vaddr_t base,
 		area = alloc_area(NULL, b, s2, flags, NULL, NULL);
 		if (!area)
 			return false;
+		exceptions = pager_lock_check_stack(64);
 		TAILQ_INSERT_TAIL(utc->areas, area, link);
+		pager_unlock(exceptions);
 		b += s2;
 		s -= s2;
 	}
@@ -803,11 +882,14 @@ bool tee_pager_add_uta_area(struct user_ta_ctx *utc, vaddr_t base, size_t size)
 	tee_pager_assign_uta_tables(utc);
 	if (!pager_add_uta_area(utc, base, size)) {
 		struct tee_pager_area *next_a;
+		uint32_t exceptions;
 
 		/* Remove all added areas */
 		TAILQ_FOREACH_SAFE(area, utc->areas, link, next_a) {
 			if (!area->pgt) {
+				exceptions = pager_lock_check_stack(64);
 				TAILQ_REMOVE(utc->areas, area, link);
+				pager_unlock(exceptions);
 				free_area(area);
 			}
 		}
@@ -917,6 +999,7 @@ void tee_pager_transfer_uta_region(struct user_ta_ctx *src_utc,
 {
 	struct tee_pager_area *area;
 	struct tee_pager_area *next_a;
+	uint32_t exceptions;
 
 	TAILQ_FOREACH_SAFE(area, src_utc->areas, link, next_a) {
 		vaddr_t new_area_base;
@@ -926,7 +1009,9 @@ void tee_pager_transfer_uta_region(struct user_ta_ctx *src_utc,
 					  src_base, size))
 			continue;
 
+		exceptions = pager_lock_check_stack(64);
 		TAILQ_REMOVE(src_utc->areas, area, link);
+		pager_unlock(exceptions);
 
 		new_area_base = dst_base + (src_base - area->base);
 		new_idx = (new_area_base - dst_pgt[0]->vabase) /
@@ -941,7 +1026,9 @@ void tee_pager_transfer_uta_region(struct user_ta_ctx *src_utc,
 		 * could be tricky to find.
 		 */
 		assert(!find_area(dst_utc->areas, area->base));
+		exceptions = pager_lock_check_stack(64);
 		TAILQ_INSERT_TAIL(dst_utc->areas, area, link);
+		pager_unlock(exceptions);
 	}
 }
 
@@ -985,20 +1072,28 @@ void tee_pager_rem_uta_region(struct user_ta_ctx *utc, vaddr_t base,
 
 void tee_pager_rem_uta_areas(struct user_ta_ctx *utc)
 {
+	struct tee_pager_area_head *areas = NULL;
 	struct tee_pager_area *area;
+	uint32_t exceptions;
 
 	if (!utc->areas)
 		return;
 
+	/* Unlink the list first, the areas are freed without the lock */
+	exceptions = pager_lock_check_stack(64);
+	areas = utc->areas;
+	utc->areas = NULL;
+	pager_unlock(exceptions);
+
 	while (true) {
-		area = TAILQ_FIRST(utc->areas);
+		area = TAILQ_FIRST(areas);
 		if (!area)
 			break;
-		TAILQ_REMOVE(utc->areas, area, link);
+		TAILQ_REMOVE(areas, area, link);
 		free_area(area);
 	}
 
-	free(utc->areas);
+	free(areas);
 }
 
 bool tee_pager_set_uta_area_attr(struct user_ta_ctx *utc, vaddr_t base,
@@ -1217,6 +1312,7 @@ static struct tee_pager_pmem *tee_pager_get_page(struct tee_pager_area *area)
 		uint32_t a;
 
 		assert(pmem->area && pmem->area->pgt);
+		tp_pager_evict(area_idx2va(pmem->area, pmem->pgidx));
 		area_get_entry(pmem->area, pmem->pgidx, NULL, &a);
 		area_set_entry(pmem->area, pmem->pgidx, 0, 0);
 		pgt_dec_used_entries(pmem->area->pgt);
@@ -1350,6 +1446,7 @@ static void stat_handle_fault(void)
 
 bool tee_pager_handle_fault(struct abort_info *ai)
 {
+	uint64_t begin = area_fault_begin();
 	struct tee_pager_area *area;
 	vaddr_t page_va = ai->va & ~SMALL_PAGE_MASK;
 	uint32_t exceptions;
@@ -1359,6 +1456,8 @@ bool tee_pager_handle_fault(struct abort_info *ai)
 	abort_print(ai);
 #endif
 
+	tp_pager_fault_begin(ai->va);
+
 	/*
 	 * We're updating pages that can affect several active CPUs at a
 	 * time below. We end up here because a thread tries to access some
@@ -1483,7 +1582,10 @@ bool tee_pager_handle_fault(struct abort_info *ai)
 	tee_pager_hide_pages();
 	ret = true;
 out:
+	if (area)
+		area_fault_end(area, begin);
 	pager_unlock(exceptions);
+	tp_pager_fault_end(ret);
 	return ret;
 }
 
@@ -1672,3 +1774,84 @@ void *tee_pager_alloc(size_t size, uint32_t flags)
 
 	return smem;
 }
+
+#ifdef CFG_WITH_STATS
+static size_t get_pmem_resident(struct tee_pager_pmem_head *head,
+				struct tee_pager_area *area)
+{
+	struct tee_pager_pmem *pmem = NULL;
+	size_t n = 0;
+
+	TAILQ_FOREACH(pmem, head, link)
+		if (pmem->area == area && pmem->pgidx != INVALID_PGIDX)
+			n++;
+
+	return n;
+}
+
+static size_t get_areas_stats(struct tee_pager_area_head *areas,
+			      const TEE_UUID *uuid,
+			      struct tee_pager_area_stats *stats,
+			      size_t count, size_t num)
+{
+	struct tee_pager_area_stats *s = NULL;
+	struct tee_pager_area *area = NULL;
+
+	if (!areas)
+		return num;
+
+	TAILQ_FOREACH(area, areas, link) {
+		if (num < count) {
+			s = stats + num;
+			memset(s, 0, sizeof(*s));
+			if (uuid)
+				s->uuid = *uuid;
+			s->base = area->base;
+			s->size = area->size;
+			s->type = area->type;
+			s->resident =
+				get_pmem_resident(&tee_pager_pmem_head, area) +
+				get_pmem_resident(&tee_pager_lock_pmem_head,
+						  area);
+			s->faults = area->stats.faults;
+			s->loads = area->stats.loads;
+			s->saves = area->stats.saves;
+			s->decrypted = area->stats.decrypted;
+			s->encrypted = area->stats.encrypted;
+			s->fault_ticks = area->stats.fault_ticks;
+		}
+		num++;
+	}
+
+	return num;
+}
+
+size_t tee_pager_get_area_stats(struct tee_pager_area_stats *stats,
+				size_t count)
+{
+	struct tee_ta_ctx *ctx __maybe_unused = NULL;
+	uint32_t exceptions = 0;
+	size_t num = 0;
+
+	COMPILE_TIME_ASSERT(AREA_TYPE_RO == TEE_PAGER_AREA_TYPE_RO &&
+			    AREA_TYPE_RW == TEE_PAGER_AREA_TYPE_RW &&
+			    AREA_TYPE_LOCK == TEE_PAGER_AREA_TYPE_LOCK);
+
+	/*
+	 * The area lists of the user TAs are only modified with the pager
+	 * lock held, tee_ctxes is protected by tee_ta_mutex held by the
+	 * caller
+	 */
+	exceptions = pager_lock(NULL);
+	num = get_areas_stats(&tee_pager_area_head, NULL, stats, count, num);
+#ifdef CFG_PAGED_USER_TA
+	TAILQ_FOREACH(ctx, &tee_ctxes, link)
+		if (is_user_ta_ctx(ctx))
+			num = get_areas_stats(to_user_ta_ctx(ctx)->areas,
+					      &ctx->uuid, stats, count, num);
+#endif
+	pager_unlock(exceptions);
+
+	return num;
+}
+#endif /*CFG_WITH_STATS*/
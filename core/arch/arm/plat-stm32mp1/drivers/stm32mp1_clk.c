@@ -964,7 +964,7 @@ static unsigned int clk_freq_prop(void *fdt, int node)
 static void get_osc_freq_from_dt(void *fdt)
 {
 	enum stm32mp_osc_id idx;
-	int clk_node = fdt_path_offset(fdt, "/clocks");
+	int clk_node = dt_path_offset(fdt, "/clocks");
 
 	if (clk_node < 0)
 		panic();
@@ -1003,7 +1003,7 @@ static TEE_Result stm32mp1_clk_early_init(void)
 	int ignored = 0;
 
 	fdt = get_embedded_dt();
-	node = fdt_node_offset_by_compatible(fdt, -1, DT_RCC_CLK_COMPAT);
+	node = dt_node_offset_by_compatible(fdt, -1, DT_RCC_CLK_COMPAT);
 
 	if (node < 0 || _fdt_reg_base_address(fdt, node) != RCC_BASE)
 		panic();
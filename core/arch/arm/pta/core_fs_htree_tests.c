@@ -3,7 +3,11 @@
  * Copyright (c) 2017, Linaro Limited
  */
 
+#include <arm.h>
 #include <assert.h>
+#include <kernel/sys_counter.h>
+#include <kernel/tee_ta_manager.h>
+#include <stdlib.h>
 #include <string.h>
 #include <tee/fs_htree.h>
 #include <tee/tee_fs_rpc.h>
@@ -616,6 +620,61 @@ out:
 	return res;
 }
 
+#ifdef CFG_CORE_MICROBENCH
+/*
+ * Writes or reads @iterations blocks, in sequence modulo @num_blocks, of
+ * a hash tree stored in memory. Returns the elapsed system counter ticks
+ * in @ticks.
+ */
+TEE_Result core_fs_htree_bench(bool write, size_t num_blocks,
+			       size_t iterations, uint64_t *ticks)
+{
+	TEE_Result res = TEE_SUCCESS;
+	struct tee_fs_htree *ht = NULL;
+	uint8_t hash[TEE_FS_HTREE_HASH_SIZE];
+	struct test_aux *aux = NULL;
+	struct tee_ta_session *sess = NULL;
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	if (!num_blocks || num_blocks >= UINT16_MAX)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	res = tee_ta_get_current_session(&sess);
+	if (res)
+		return res;
+
+	aux = aux_alloc(num_blocks);
+	if (!aux)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	res = tee_fs_htree_open(true, hash, &sess->ctx->uuid, &test_htree_ops,
+				aux, &ht);
+	CHECK_RES(res, goto out);
+
+	res = do_range(write_block, &ht, 0, num_blocks, 0);
+	CHECK_RES(res, goto out);
+	res = tee_fs_htree_sync_to_storage(&ht, hash);
+	CHECK_RES(res, goto out);
+
+	begin = sys_counter_read();
+	for (n = 0; n < iterations; n++) {
+		if (write)
+			res = write_block(&ht, n % num_blocks, 0);
+		else
+			res = read_block(&ht, n % num_blocks, 0);
+		CHECK_RES(res, goto out);
+	}
+	if (write)
+		res = tee_fs_htree_sync_to_storage(&ht, hash);
+	*ticks = sys_counter_read() - begin;
+out:
+	tee_fs_htree_close(&ht);
+	aux_free(aux);
+	return res;
+}
+#endif
+
 TEE_Result core_fs_htree_tests(uint32_t nParamTypes,
 			       TEE_Param pParams[TEE_NUM_PARAMS] __unused)
 {
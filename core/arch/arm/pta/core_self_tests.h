@@ -6,6 +6,7 @@
 #define CORE_SELF_TESTS_H
 
 #include <compiler.h>
+#include <stdbool.h>
 #include <tee_api_types.h>
 #include <tee_api_defines.h>
 
@@ -31,4 +32,17 @@ static inline TEE_Result core_lockdep_tests(
 }
 #endif
 
+#if defined(CFG_TEE_CORE_EMBED_INTERNAL_TESTS) && defined(CFG_WITH_USER_TA)
+TEE_Result core_fs_htree_bench(bool write, size_t num_blocks,
+			       size_t iterations, uint64_t *ticks);
+#else
+static inline TEE_Result core_fs_htree_bench(bool write __unused,
+					     size_t num_blocks __unused,
+					     size_t iterations __unused,
+					     uint64_t *ticks __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
 #endif /*CORE_SELF_TESTS_H*/
@@ -96,13 +96,16 @@ static TEE_Result test_sgi(void)
 	itr_raise_sgi(TEST_SGI_ID,
 		     (uint8_t)(SHIFT_U32(1, CFG_TEE_CORE_NB_CORE) - 1));
 	tee_time_wait(200);
-	if (memcmp(test_sgi_value, expect_sgi_value, sizeof(test_sgi_value)))
-		return TEE_ERROR_GENERIC;
+	if (memcmp(test_sgi_value, expect_sgi_value, sizeof(test_sgi_value))) {
+		res = TEE_ERROR_GENERIC;
+		goto out;
+	}
 
 	for (i = 0; i < TEST_TIMES; i++) {
-		res = crypto_rng_read(&num, 1);
-		if (res != TEE_SUCCESS)
-			return TEE_ERROR_GENERIC;
+		if (crypto_rng_read(&num, 1) != TEE_SUCCESS) {
+			res = TEE_ERROR_GENERIC;
+			goto out;
+		}
 		num = num % CFG_TEE_CORE_NB_CORE;
 		cpu_mask = 0x0;
 		for (j = 0; j < num; j++) {
@@ -112,11 +115,16 @@ static TEE_Result test_sgi(void)
 		itr_raise_sgi(TEST_SGI_ID, cpu_mask);
 		tee_time_wait(200);
 		if (memcmp(test_sgi_value, expect_sgi_value,
-		    sizeof(test_sgi_value)))
-			return TEE_ERROR_GENERIC;
+		    sizeof(test_sgi_value))) {
+			res = TEE_ERROR_GENERIC;
+			goto out;
+		}
 	}
 
-	return TEE_SUCCESS;
+	res = TEE_SUCCESS;
+out:
+	itr_remove(&sgi_handler);
+	return res;
 }
 
 static TEE_Result test_spi(void)
@@ -129,24 +137,31 @@ static TEE_Result test_spi(void)
 	itr_enable(TEST_SPI_ID);
 
 	for (i = 0; i < TEST_TIMES; i++) {
-		res = crypto_rng_read(&num, 1);
-		if (res != TEE_SUCCESS)
-			return TEE_ERROR_GENERIC;
+		if (crypto_rng_read(&num, 1) != TEE_SUCCESS) {
+			res = TEE_ERROR_GENERIC;
+			goto out;
+		}
 		num = num % CFG_TEE_CORE_NB_CORE;
 		expect_spi_value[num]++;
 		itr_set_affinity(TEST_SPI_ID, 0x1 << num);
 		itr_raise_pi(TEST_SPI_ID);
 		tee_time_wait(200);
 		if (memcmp(test_spi_value, expect_spi_value,
-		    sizeof(test_spi_value)))
-			return TEE_ERROR_GENERIC;
+		    sizeof(test_spi_value))) {
+			res = TEE_ERROR_GENERIC;
+			goto out;
+		}
 	}
 
-	return TEE_SUCCESS;
+	res = TEE_SUCCESS;
+out:
+	itr_remove(&spi_handler);
+	return res;
 }
 
 static TEE_Result test_ppi(void)
 {
+	TEE_Result res;
 	uint32_t exceptions;
 
 	itr_add(&ppi_handler);
@@ -157,10 +172,15 @@ static TEE_Result test_ppi(void)
 	itr_raise_pi(TEST_PPI_ID);
 	thread_unmask_exceptions(exceptions);
 	tee_time_wait(200);
-	if (memcmp(test_ppi_value, expect_ppi_value, sizeof(test_ppi_value)))
-		return TEE_ERROR_GENERIC;
+	if (memcmp(test_ppi_value, expect_ppi_value, sizeof(test_ppi_value))) {
+		res = TEE_ERROR_GENERIC;
+		goto out;
+	}
 
-	return TEE_SUCCESS;
+	res = TEE_SUCCESS;
+out:
+	itr_remove(&ppi_handler);
+	return res;
 }
 
 static TEE_Result interrupt_tests(uint32_t nParamTypes __unused,
@@ -0,0 +1,798 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <arm.h>
+#include <compiler.h>
+#include <crypto/crypto.h>
+#include <kernel/handle.h>
+#include <kernel/mutex.h>
+#include <kernel/pseudo_ta.h>
+#include <kernel/spinlock.h>
+#include <kernel/sys_counter.h>
+#include <malloc.h>
+#include <mempool.h>
+#include <mm/core_memprot.h>
+#include <mm/tee_mm.h>
+#include <mm/tee_pager.h>
+#include <pta_microbench.h>
+#include <string.h>
+#include <tee_api_defines.h>
+#include <tee_api_types.h>
+#include <trace.h>
+#include <utee_defines.h>
+#include <util.h>
+
+#include "core_self_tests.h"
+
+#define TA_NAME		"microbench.ta"
+
+/* Upper limit of the buffers processed by the crypto benchmarks */
+#define MAX_DATA_SIZE		(64 * 1024)
+
+/* Upper limit of the number of handles or pages used by a benchmark */
+#define MAX_OBJECTS		1024
+
+/*
+ * Each benchmark runs @iterations of an operation and returns the elapsed
+ * system counter ticks in @ticks, excluding setup and teardown.
+ */
+struct bench_args {
+	uint32_t param;
+	size_t iterations;
+	size_t size;
+	uint64_t ticks;
+};
+
+static uint64_t bench_begin(void)
+{
+	isb();
+	return sys_counter_read();
+}
+
+static uint64_t bench_end(uint64_t begin)
+{
+	isb();
+	return sys_counter_read() - begin;
+}
+
+static TEE_Result bench_handle(struct bench_args *a, bool lookup)
+{
+	TEE_Result res = TEE_SUCCESS;
+	struct handle_db db = HANDLE_DB_INITIALIZER;
+	uint64_t begin = 0;
+	int h = 0;
+	size_t n = 0;
+
+	if (a->param > MAX_OBJECTS)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* Any non-NULL pointer will do */
+	for (n = 0; n < a->param; n++) {
+		if (handle_get(&db, &db) < 0) {
+			res = TEE_ERROR_OUT_OF_MEMORY;
+			goto out;
+		}
+	}
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		if (lookup) {
+			if (!handle_lookup(&db, n % MAX(a->param, 1U)) &&
+			    a->param) {
+				res = TEE_ERROR_GENERIC;
+				goto out;
+			}
+		} else {
+			h = handle_get(&db, &db);
+			if (h < 0) {
+				res = TEE_ERROR_OUT_OF_MEMORY;
+				goto out;
+			}
+			handle_put(&db, h);
+		}
+	}
+	a->ticks = bench_end(begin);
+out:
+	handle_db_destroy(&db);
+	return res;
+}
+
+static TEE_Result bench_malloc(struct bench_args *a)
+{
+	uint64_t begin = 0;
+	void *p = NULL;
+	size_t n = 0;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		p = malloc(a->param);
+		if (!p)
+			return TEE_ERROR_OUT_OF_MEMORY;
+		free(p);
+	}
+	a->ticks = bench_end(begin);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result bench_mempool(struct bench_args *a)
+{
+	TEE_Result res = TEE_SUCCESS;
+	struct mempool *pool = NULL;
+	size_t pool_size = 0;
+	uint64_t begin = 0;
+	void *data = NULL;
+	void *p = NULL;
+	size_t n = 0;
+
+	if (!a->param || a->param > MAX_DATA_SIZE)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* Room for a few items and their headers */
+	pool_size = 4 * ROUNDUP(a->param + sizeof(struct mempool_item),
+				MEMPOOL_ALIGN);
+	/* malloc() alignment is at least MEMPOOL_ALIGN */
+	data = malloc(pool_size);
+	if (!data)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	pool = mempool_alloc_pool(data, pool_size, NULL);
+	if (!pool) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		p = mempool_alloc(pool, a->param);
+		if (!p) {
+			res = TEE_ERROR_OUT_OF_MEMORY;
+			goto out;
+		}
+		mempool_free(pool, p);
+	}
+	a->ticks = bench_end(begin);
+out:
+	free(pool);
+	free(data);
+	return res;
+}
+
+static TEE_Result bench_tee_mm(struct bench_args *a)
+{
+	/* The pool only manages addresses, the memory is never accessed */
+	const paddr_t lo = 0x10000000;
+	const paddr_t hi = lo + 16 * 1024 * 1024;
+	TEE_Result res = TEE_SUCCESS;
+	tee_mm_pool_t pool = { 0 };
+	tee_mm_entry_t *mm = NULL;
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	if (!a->param || a->param > hi - lo)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (!tee_mm_init(&pool, lo, hi, SMALL_PAGE_SHIFT, TEE_MM_POOL_NO_FLAGS))
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		mm = tee_mm_alloc(&pool, a->param);
+		if (!mm) {
+			res = TEE_ERROR_OUT_OF_MEMORY;
+			goto out;
+		}
+		tee_mm_free(mm);
+	}
+	a->ticks = bench_end(begin);
+out:
+	tee_mm_final(&pool);
+	return res;
+}
+
+static TEE_Result bench_hash(struct bench_args *a, const uint8_t *data)
+{
+	uint8_t digest[TEE_MAX_HASH_SIZE] = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t begin = 0;
+	void *ctx = NULL;
+	size_t n = 0;
+
+	res = crypto_hash_alloc_ctx(&ctx, a->param);
+	if (res)
+		return res;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		res = crypto_hash_init(ctx, a->param);
+		if (!res)
+			res = crypto_hash_update(ctx, a->param, data, a->size);
+		if (!res)
+			res = crypto_hash_final(ctx, a->param, digest,
+						sizeof(digest));
+		if (res)
+			goto out;
+	}
+	a->ticks = bench_end(begin);
+out:
+	crypto_hash_free_ctx(ctx, a->param);
+	return res;
+}
+
+static TEE_Result bench_mac(struct bench_args *a, const uint8_t *data)
+{
+	uint8_t digest[TEE_MAX_HASH_SIZE] = { 0 };
+	uint8_t key[32] = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	size_t key_len = sizeof(key);
+	uint64_t begin = 0;
+	void *ctx = NULL;
+	size_t n = 0;
+
+	/* CMAC and CBC-MAC take AES keys, HMAC any size */
+	if (TEE_ALG_GET_MAIN_ALG(a->param) == TEE_MAIN_ALGO_AES)
+		key_len = 16;
+
+	res = crypto_mac_alloc_ctx(&ctx, a->param);
+	if (res)
+		return res;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		res = crypto_mac_init(ctx, a->param, key, key_len);
+		if (!res)
+			res = crypto_mac_update(ctx, a->param, data, a->size);
+		if (!res)
+			res = crypto_mac_final(ctx, a->param, digest,
+					       sizeof(digest));
+		if (res)
+			goto out;
+	}
+	a->ticks = bench_end(begin);
+out:
+	crypto_mac_free_ctx(ctx, a->param);
+	return res;
+}
+
+static TEE_Result bench_cipher(struct bench_args *a, uint8_t *data)
+{
+	uint8_t key[32] = { 0 };
+	uint8_t iv[16] = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	size_t key_len = 16;
+	uint64_t begin = 0;
+	void *ctx = NULL;
+	size_t n = 0;
+
+	/* XTS takes two keys, DES3 a 24 byte key */
+	if (TEE_ALG_GET_MAIN_ALG(a->param) == TEE_MAIN_ALGO_DES3)
+		key_len = 24;
+	else if (TEE_ALG_GET_MAIN_ALG(a->param) == TEE_MAIN_ALGO_DES)
+		key_len = 8;
+
+	res = crypto_cipher_alloc_ctx(&ctx, a->param);
+	if (res)
+		return res;
+
+	res = crypto_cipher_init(ctx, a->param, TEE_MODE_ENCRYPT, key, key_len,
+				 key + 16, 16, iv, sizeof(iv));
+	if (res)
+		goto out;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		res = crypto_cipher_update(ctx, a->param, TEE_MODE_ENCRYPT,
+					   false, data, a->size, data);
+		if (res)
+			goto out;
+	}
+	a->ticks = bench_end(begin);
+	crypto_cipher_final(ctx, a->param);
+out:
+	crypto_cipher_free_ctx(ctx, a->param);
+	return res;
+}
+
+static TEE_Result bench_authenc(struct bench_args *a, uint8_t *data)
+{
+	uint8_t key[16] = { 0 };
+	uint8_t nonce[12] = { 0 };
+	uint8_t tag[16] = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	size_t tag_len = sizeof(tag);
+	size_t dst_len = 0;
+	uint64_t begin = 0;
+	void *ctx = NULL;
+	size_t n = 0;
+
+	res = crypto_authenc_alloc_ctx(&ctx, a->param);
+	if (res)
+		return res;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		/* A new nonce for each message */
+		memcpy(nonce, &n, sizeof(n));
+		res = crypto_authenc_init(ctx, a->param, TEE_MODE_ENCRYPT,
+					  key, sizeof(key), nonce,
+					  sizeof(nonce), sizeof(tag), 0,
+					  a->size);
+		if (res)
+			goto out;
+		dst_len = a->size;
+		tag_len = sizeof(tag);
+		res = crypto_authenc_enc_final(ctx, a->param, data, a->size,
+					       data, &dst_len, tag, &tag_len);
+		crypto_authenc_final(ctx, a->param);
+		if (res)
+			goto out;
+	}
+	a->ticks = bench_end(begin);
+out:
+	crypto_authenc_free_ctx(ctx, a->param);
+	return res;
+}
+
+static void free_rsa_keypair(struct rsa_keypair *key)
+{
+	crypto_bignum_free(key->e);
+	crypto_bignum_free(key->d);
+	crypto_bignum_free(key->n);
+	crypto_bignum_free(key->p);
+	crypto_bignum_free(key->q);
+	crypto_bignum_free(key->qp);
+	crypto_bignum_free(key->dp);
+	crypto_bignum_free(key->dq);
+}
+
+static TEE_Result bench_rsa(struct bench_args *a, bool sign)
+{
+	const uint32_t algo = TEE_ALG_RSASSA_PKCS1_V1_5_SHA256;
+	static const uint8_t e[] = { 0x01, 0x00, 0x01 };
+	uint8_t digest[TEE_SHA256_HASH_SIZE] = { 0 };
+	struct rsa_keypair key = { 0 };
+	struct rsa_public_key pub = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	uint64_t begin = 0;
+	uint8_t *sig = NULL;
+	size_t sig_len = 0;
+	size_t n = 0;
+
+	if (a->param < 1024 || a->param > CFG_CORE_BIGNUM_MAX_BITS ||
+	    a->param % 8)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	sig = malloc(a->param / 8);
+	if (!sig)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	res = crypto_acipher_alloc_rsa_keypair(&key, a->param);
+	if (res)
+		goto out_free_sig;
+	res = crypto_bignum_bin2bn(e, sizeof(e), key.e);
+	if (res)
+		goto out;
+	res = crypto_acipher_gen_rsa_key(&key, a->param);
+	if (res)
+		goto out;
+	pub.e = key.e;
+	pub.n = key.n;
+
+	sig_len = a->param / 8;
+	res = crypto_acipher_rsassa_sign(algo, &key, -1, digest,
+					 sizeof(digest), sig, &sig_len);
+	if (res)
+		goto out;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		if (sign) {
+			sig_len = a->param / 8;
+			res = crypto_acipher_rsassa_sign(algo, &key, -1, digest,
+							 sizeof(digest), sig,
+							 &sig_len);
+		} else {
+			res = crypto_acipher_rsassa_verify(algo, &pub, -1,
+							   digest,
+							   sizeof(digest), sig,
+							   sig_len);
+		}
+		if (res)
+			goto out;
+	}
+	a->ticks = bench_end(begin);
+out:
+	free_rsa_keypair(&key);
+out_free_sig:
+	free(sig);
+	return res;
+}
+
+static TEE_Result ecc_curve_to_algo(uint32_t curve, uint32_t *algo,
+				    size_t *key_bits)
+{
+	switch (curve) {
+	case TEE_ECC_CURVE_NIST_P192:
+		*algo = TEE_ALG_ECDSA_P192;
+		*key_bits = 192;
+		return TEE_SUCCESS;
+	case TEE_ECC_CURVE_NIST_P224:
+		*algo = TEE_ALG_ECDSA_P224;
+		*key_bits = 224;
+		return TEE_SUCCESS;
+	case TEE_ECC_CURVE_NIST_P256:
+		*algo = TEE_ALG_ECDSA_P256;
+		*key_bits = 256;
+		return TEE_SUCCESS;
+	case TEE_ECC_CURVE_NIST_P384:
+		*algo = TEE_ALG_ECDSA_P384;
+		*key_bits = 384;
+		return TEE_SUCCESS;
+	case TEE_ECC_CURVE_NIST_P521:
+		*algo = TEE_ALG_ECDSA_P521;
+		*key_bits = 521;
+		return TEE_SUCCESS;
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+}
+
+static TEE_Result bench_ecc(struct bench_args *a, bool sign)
+{
+	uint8_t digest[TEE_SHA256_HASH_SIZE] = { 0 };
+	/* r and s of up to 521 bits each */
+	uint8_t sig[2 * 66] = { 0 };
+	struct ecc_keypair key = { 0 };
+	struct ecc_public_key pub = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	size_t sig_len = sizeof(sig);
+	size_t key_bits = 0;
+	uint64_t begin = 0;
+	uint32_t algo = 0;
+	size_t n = 0;
+
+	res = ecc_curve_to_algo(a->param, &algo, &key_bits);
+	if (res)
+		return res;
+
+	res = crypto_acipher_alloc_ecc_keypair(&key, key_bits);
+	if (res)
+		return res;
+	key.curve = a->param;
+	res = crypto_acipher_gen_ecc_key(&key);
+	if (res)
+		goto out;
+	pub.x = key.x;
+	pub.y = key.y;
+	pub.curve = key.curve;
+
+	res = crypto_acipher_ecc_sign(algo, &key, digest, sizeof(digest), sig,
+				      &sig_len);
+	if (res)
+		goto out;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		if (sign) {
+			sig_len = sizeof(sig);
+			res = crypto_acipher_ecc_sign(algo, &key, digest,
+						      sizeof(digest), sig,
+						      &sig_len);
+		} else {
+			res = crypto_acipher_ecc_verify(algo, &pub, digest,
+							sizeof(digest), sig,
+							sig_len);
+		}
+		if (res)
+			goto out;
+	}
+	a->ticks = bench_end(begin);
+out:
+	crypto_bignum_free(key.d);
+	crypto_bignum_free(key.x);
+	crypto_bignum_free(key.y);
+	return res;
+}
+
+#ifdef CFG_WITH_PAGER
+/* Paged memory can't be freed, it's kept for the next run */
+static struct mutex pager_bench_mu = MUTEX_INITIALIZER;
+static uint8_t *pager_bench_pages;
+static size_t pager_bench_num_pages;
+
+static TEE_Result bench_pager_fault(struct bench_args *a)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint8_t *pages = NULL;
+	uint64_t ticks = 0;
+	uint64_t begin = 0;
+	size_t n = 0;
+	size_t m = 0;
+
+	if (!a->param || a->param > MAX_OBJECTS)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&pager_bench_mu);
+
+	if (!pager_bench_pages) {
+		pager_bench_pages = tee_pager_alloc(a->param * SMALL_PAGE_SIZE,
+						    0);
+		if (!pager_bench_pages) {
+			res = TEE_ERROR_OUT_OF_MEMORY;
+			goto out;
+		}
+		pager_bench_num_pages = a->param;
+	} else if (a->param > pager_bench_num_pages) {
+		res = TEE_ERROR_BAD_PARAMETERS;
+		goto out;
+	}
+	pages = pager_bench_pages;
+
+	/*
+	 * The physical pages are released before each iteration so that
+	 * touching a page triggers a fault which maps a new zeroed page.
+	 */
+	for (n = 0; n < a->iterations; n++) {
+		tee_pager_release_phys(pages, a->param * SMALL_PAGE_SIZE);
+		begin = bench_begin();
+		for (m = 0; m < a->param; m++)
+			pages[m * SMALL_PAGE_SIZE] = 1;
+		ticks += bench_end(begin);
+	}
+	a->ticks = ticks;
+out:
+	mutex_unlock(&pager_bench_mu);
+	return res;
+}
+#else
+static TEE_Result bench_pager_fault(struct bench_args *a __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+/*
+ * Static so that the lock profiling, keyed on the address of the mutex,
+ * doesn't collect a new class for each run
+ */
+static struct mutex bench_mu = MUTEX_INITIALIZER;
+
+static TEE_Result bench_mutex(struct bench_args *a)
+{
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		mutex_lock(&bench_mu);
+		mutex_unlock(&bench_mu);
+	}
+	a->ticks = bench_end(begin);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result bench_spinlock(struct bench_args *a)
+{
+	unsigned int lock = SPINLOCK_UNLOCK;
+	uint32_t exceptions = 0;
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	begin = bench_begin();
+	for (n = 0; n < a->iterations; n++) {
+		exceptions = cpu_spin_lock_xsave(&lock);
+		cpu_spin_unlock_xrestore(&lock, exceptions);
+	}
+	a->ticks = bench_end(begin);
+
+	return TEE_SUCCESS;
+}
+
+/*
+ * The buffers are allocated from TA RAM as they are larger than the core
+ * heap. The destination and source are in separate halves of the
+ * allocation except for memmove() where they overlap.
+ */
+static TEE_Result bench_mem(uint32_t bench, struct bench_args *a)
+{
+	size_t dst_offs = a->param & 0xff;
+	size_t src_offs = (a->param >> 8) & 0xff;
+	size_t len = a->size + PTA_MICROBENCH_MEM_MAX_OFFS;
+	TEE_Result res = TEE_SUCCESS;
+	tee_mm_entry_t *mm = NULL;
+	uint8_t *buf = NULL;
+	uint8_t *dst = NULL;
+	uint8_t *src = NULL;
+	uint64_t begin = 0;
+	size_t n = 0;
+	int diff = 0;
+
+	if (a->size > PTA_MICROBENCH_MEM_MAX_SIZE ||
+	    dst_offs >= PTA_MICROBENCH_MEM_MAX_OFFS ||
+	    src_offs >= PTA_MICROBENCH_MEM_MAX_OFFS)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mm = tee_mm_alloc(&tee_mm_sec_ddr, 2 * len);
+	if (!mm)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	buf = phys_to_virt(tee_mm_get_smem(mm), MEM_AREA_TA_RAM);
+	if (!buf) {
+		res = TEE_ERROR_GENERIC;
+		goto out;
+	}
+
+	memset(buf, 0x5a, 2 * len);
+	dst = buf + dst_offs;
+	if (bench == PTA_MICROBENCH_MEMMOVE)
+		src = buf + src_offs;
+	else
+		src = buf + len + src_offs;
+
+	begin = bench_begin();
+	switch (bench) {
+	case PTA_MICROBENCH_MEMCPY:
+		for (n = 0; n < a->iterations; n++)
+			memcpy(dst, src, a->size);
+		break;
+	case PTA_MICROBENCH_MEMMOVE:
+		for (n = 0; n < a->iterations; n++)
+			memmove(dst, src, a->size);
+		break;
+	case PTA_MICROBENCH_MEMSET:
+		for (n = 0; n < a->iterations; n++)
+			memset(dst, 0, a->size);
+		break;
+	case PTA_MICROBENCH_MEMCMP:
+		for (n = 0; n < a->iterations; n++)
+			diff |= memcmp(dst, src, a->size);
+		break;
+	default:
+		res = TEE_ERROR_BAD_PARAMETERS;
+		goto out;
+	}
+	a->ticks = bench_end(begin);
+
+	/* Buffers of the same bytes must compare equal */
+	if (diff)
+		res = TEE_ERROR_GENERIC;
+out:
+	tee_mm_free(mm);
+	return res;
+}
+
+static TEE_Result bench_crypto(uint32_t bench, struct bench_args *a)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint8_t *data = NULL;
+
+	if (a->size > MAX_DATA_SIZE)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	data = calloc(1, MAX(a->size, 1U));
+	if (!data)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	switch (bench) {
+	case PTA_MICROBENCH_HASH:
+		res = bench_hash(a, data);
+		break;
+	case PTA_MICROBENCH_MAC:
+		res = bench_mac(a, data);
+		break;
+	case PTA_MICROBENCH_CIPHER:
+		res = bench_cipher(a, data);
+		break;
+	case PTA_MICROBENCH_AUTHENC:
+		res = bench_authenc(a, data);
+		break;
+	default:
+		res = TEE_ERROR_BAD_PARAMETERS;
+		break;
+	}
+
+	free(data);
+	return res;
+}
+
+static TEE_Result run_bench(uint32_t bench, struct bench_args *a)
+{
+	switch (bench) {
+	case PTA_MICROBENCH_HANDLE_GET:
+		return bench_handle(a, false);
+	case PTA_MICROBENCH_HANDLE_LOOKUP:
+		return bench_handle(a, true);
+	case PTA_MICROBENCH_MALLOC:
+		return bench_malloc(a);
+	case PTA_MICROBENCH_MEMPOOL:
+		return bench_mempool(a);
+	case PTA_MICROBENCH_TEE_MM:
+		return bench_tee_mm(a);
+	case PTA_MICROBENCH_HASH:
+	case PTA_MICROBENCH_MAC:
+	case PTA_MICROBENCH_CIPHER:
+	case PTA_MICROBENCH_AUTHENC:
+		return bench_crypto(bench, a);
+	case PTA_MICROBENCH_RSA_SIGN:
+		return bench_rsa(a, true);
+	case PTA_MICROBENCH_RSA_VERIFY:
+		return bench_rsa(a, false);
+	case PTA_MICROBENCH_ECC_SIGN:
+		return bench_ecc(a, true);
+	case PTA_MICROBENCH_ECC_VERIFY:
+		return bench_ecc(a, false);
+	case PTA_MICROBENCH_FS_HTREE_WRITE:
+		return core_fs_htree_bench(true, a->param, a->iterations,
+					   &a->ticks);
+	case PTA_MICROBENCH_FS_HTREE_READ:
+		return core_fs_htree_bench(false, a->param, a->iterations,
+					   &a->ticks);
+	case PTA_MICROBENCH_PAGER_FAULT:
+		return bench_pager_fault(a);
+	case PTA_MICROBENCH_MUTEX:
+		return bench_mutex(a);
+	case PTA_MICROBENCH_SPINLOCK:
+		return bench_spinlock(a);
+	case PTA_MICROBENCH_MEMCPY:
+	case PTA_MICROBENCH_MEMMOVE:
+	case PTA_MICROBENCH_MEMSET:
+	case PTA_MICROBENCH_MEMCMP:
+		return bench_mem(bench, a);
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+}
+
+static TEE_Result cmd_run(uint32_t types, TEE_Param p[TEE_NUM_PARAMS])
+{
+	struct bench_args a = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_VALUE_OUTPUT,
+				     TEE_PARAM_TYPE_VALUE_OUTPUT))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	/* Nothing can be timed without the system counter */
+	if (!sys_counter_freq())
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	a.param = p[0].value.b;
+	a.iterations = p[1].value.a;
+	a.size = p[1].value.b;
+
+	res = run_bench(p[0].value.a, &a);
+	if (res) {
+		DMSG("Benchmark %" PRIu32 " failed: %#" PRIx32,
+		     p[0].value.a, res);
+		return res;
+	}
+
+	p[2].value.a = a.ticks >> 32;
+	p[2].value.b = a.ticks;
+	p[3].value.a = sys_counter_freq();
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result invoke_command(void *psess __unused, uint32_t cmd,
+				 uint32_t ptypes,
+				 TEE_Param params[TEE_NUM_PARAMS])
+{
+	switch (cmd) {
+	case PTA_MICROBENCH_CMD_NOP:
+		return TEE_SUCCESS;
+	case PTA_MICROBENCH_CMD_RUN:
+		return cmd_run(ptypes, params);
+	default:
+		break;
+	}
+
+	return TEE_ERROR_BAD_PARAMETERS;
+}
+
+pseudo_ta_register(.uuid = PTA_MICROBENCH_UUID, .name = TA_NAME,
+		   .flags = PTA_DEFAULT_FLAGS,
+		   .invoke_command_entry_point = invoke_command);
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <compiler.h>
+#include <kernel/mutex.h>
+#include <kernel/profiler.h>
+#include <kernel/pseudo_ta.h>
+#include <kernel/thread.h>
+#include <mm/mobj.h>
+#include <pta_profiler.h>
+#include <string.h>
+#include <trace.h>
+
+#define TA_NAME		"profiler.ta"
+
+/* Upper limit of the number of samples per CPU */
+#define PROF_MAX_SAMPLES_PER_CPU	(64 * 1024)
+
+static struct mutex prof_mu = MUTEX_INITIALIZER;
+static struct mobj *prof_mobj;
+static void *prof_buf;
+static size_t prof_size;
+static bool prof_running;
+
+static void free_buf(void)
+{
+	thread_rpc_free_global_payload(prof_mobj);
+	prof_mobj = NULL;
+	prof_buf = NULL;
+	prof_size = 0;
+}
+
+static TEE_Result prof_cmd_start(uint32_t types, TEE_Param p[TEE_NUM_PARAMS])
+{
+	TEE_Result res = TEE_SUCCESS;
+	size_t samples_per_cpu = 0;
+
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_VALUE_OUTPUT,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	samples_per_cpu = p[0].value.a;
+	if (!IS_POWER_OF_TWO(samples_per_cpu) ||
+	    samples_per_cpu > PROF_MAX_SAMPLES_PER_CPU)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&prof_mu);
+
+	if (prof_running) {
+		res = TEE_ERROR_BAD_STATE;
+		goto out;
+	}
+
+	/* Samples from a previous run are discarded */
+	if (prof_mobj)
+		free_buf();
+
+	prof_size = prof_buf_size(samples_per_cpu);
+	prof_mobj = thread_rpc_alloc_global_payload(prof_size);
+	if (!prof_mobj) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	prof_buf = mobj_get_va(prof_mobj, 0);
+	if (!prof_buf) {
+		res = TEE_ERROR_GENERIC;
+		goto err;
+	}
+
+	res = prof_start(prof_buf, samples_per_cpu);
+	if (res)
+		goto err;
+
+	DMSG("Sampling with %zu samples per CPU", samples_per_cpu);
+
+	prof_running = true;
+	p[1].value.a = prof_size;
+	goto out;
+err:
+	free_buf();
+out:
+	mutex_unlock(&prof_mu);
+	return res;
+}
+
+static TEE_Result prof_cmd_stop(uint32_t types,
+				TEE_Param p[TEE_NUM_PARAMS] __unused)
+{
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_NONE, TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE, TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&prof_mu);
+
+	if (prof_running) {
+		prof_stop();
+		prof_running = false;
+	}
+
+	mutex_unlock(&prof_mu);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result prof_cmd_read(uint32_t types, TEE_Param p[TEE_NUM_PARAMS])
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&prof_mu);
+
+	if (!prof_mobj || prof_running) {
+		res = TEE_ERROR_BAD_STATE;
+	} else if (p[0].memref.size < prof_size) {
+		p[0].memref.size = prof_size;
+		res = TEE_ERROR_SHORT_BUFFER;
+	} else {
+		memcpy(p[0].memref.buffer, prof_buf, prof_size);
+		p[0].memref.size = prof_size;
+	}
+
+	mutex_unlock(&prof_mu);
+
+	return res;
+}
+
+static TEE_Result invoke_command(void *psess __unused, uint32_t cmd,
+				 uint32_t ptypes,
+				 TEE_Param params[TEE_NUM_PARAMS])
+{
+	switch (cmd) {
+	case PTA_PROFILER_CMD_START:
+		return prof_cmd_start(ptypes, params);
+	case PTA_PROFILER_CMD_STOP:
+		return prof_cmd_stop(ptypes, params);
+	case PTA_PROFILER_CMD_READ:
+		return prof_cmd_read(ptypes, params);
+	default:
+		break;
+	}
+
+	return TEE_ERROR_BAD_PARAMETERS;
+}
+
+pseudo_ta_register(.uuid = PTA_PROFILER_UUID, .name = TA_NAME,
+		   .flags = PTA_DEFAULT_FLAGS,
+		   .invoke_command_entry_point = invoke_command);
@@ -2,26 +2,28 @@
 /*
  * Copyright (c) 2015, Linaro Limited
  */
+#include <arm.h>
 #include <compiler.h>
 #include <stdio.h>
 #include <trace.h>
+#include <kernel/interrupt.h>
+#include <kernel/lock_prof.h>
+#include <kernel/mutex.h>
 #include <kernel/pseudo_ta.h>
+#include <kernel/rpc_stats.h>
+#include <kernel/sys_counter.h>
+#include <kernel/tee_ta_manager.h>
+#include <kernel/virtualization.h>
 #include <mm/tee_pager.h>
 #include <mm/tee_mm.h>
 #include <string.h>
 #include <string_ext.h>
 #include <malloc.h>
+#include <pta_stats.h>
+#include <util.h>
 
 #define TA_NAME		"stats.ta"
 
-#define STATS_UUID \
-		{ 0xd96a5b40, 0xe2c7, 0xb1af, \
-			{ 0x87, 0x94, 0x10, 0x02, 0xa5, 0xd5, 0xc6, 0x1b } }
-
-#define STATS_CMD_PAGER_STATS		0
-#define STATS_CMD_ALLOC_STATS		1
-#define STATS_CMD_MEMLEAK_STATS		2
-
 #define STATS_NB_POOLS			4
 
 static TEE_Result get_alloc_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
@@ -101,15 +103,124 @@ static TEE_Result get_alloc_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
 	return TEE_SUCCESS;
 }
 
+static void copy_heap_site(struct stats_heap_site *d,
+			   const struct malloc_site_stats *s)
+{
+	COMPILE_TIME_ASSERT(sizeof(*d) == 72);
+	COMPILE_TIME_ASSERT(sizeof(d->fname) == sizeof(s->fname));
+
+	memset(d, 0, sizeof(*d));
+	memcpy(d->fname, s->fname, sizeof(d->fname));
+	d->line = s->line;
+	d->num_allocs = s->num_allocs;
+	d->num_alloced = s->num_alloced;
+	d->allocated = s->allocated;
+	d->max_allocated = s->max_allocated;
+}
+
+static TEE_Result get_heap_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	struct malloc_site_stats *sites = NULL;
+	struct malloc_heap_stats heap = { 0 };
+	struct stats_heap *stats = NULL;
+	struct stats_heap_site *out = NULL;
+	size_t max_sites = 0;
+	size_t num_sites = 0;
+	size_t num = 0;
+	size_t n = 0;
+
+	/*
+	 * p[0].value.a = pool id, 1 for the heap or 4 for the nexus heap
+	 *		  as for STATS_CMD_ALLOC_STATS
+	 * p[1].memref.buffer = output buffer to struct stats_heap
+	 * p[2].memref.buffer = output buffer to an array of
+	 *			struct stats_heap_site, one for each call
+	 *			site with CFG_TEE_CORE_MALLOC_DEBUG=y
+	 * p[3].value.a = number of call sites
+	 */
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+			    TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (p[1].memref.size < sizeof(struct stats_heap)) {
+		p[1].memref.size = sizeof(struct stats_heap);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+
+	max_sites = p[2].memref.size / sizeof(*out);
+
+	switch (p[0].value.a) {
+	case 1:
+		num = MIN(malloc_get_site_stats(NULL, 0), max_sites);
+		sites = calloc(num, sizeof(*sites));
+		if (num && !sites)
+			return TEE_ERROR_OUT_OF_MEMORY;
+		malloc_get_heap_stats(&heap);
+		num_sites = malloc_get_site_stats(sites, num);
+		break;
+#ifdef CFG_VIRTUALIZATION
+	case 4:
+		num = MIN(nex_malloc_get_site_stats(NULL, 0), max_sites);
+		sites = calloc(num, sizeof(*sites));
+		if (num && !sites)
+			return TEE_ERROR_OUT_OF_MEMORY;
+		nex_malloc_get_heap_stats(&heap);
+		num_sites = nex_malloc_get_site_stats(sites, num);
+		break;
+#endif
+	default:
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+
+	COMPILE_TIME_ASSERT(sizeof(*stats) == 80);
+	COMPILE_TIME_ASSERT(ARRAY_SIZE(heap.size_class) ==
+			    STATS_HEAP_NUM_SIZE_CLASSES);
+	stats = p[1].memref.buffer;
+	stats->num_alloced = heap.num_alloced;
+	stats->num_free = heap.num_free;
+	stats->total_free = heap.total_free;
+	stats->largest_free = heap.largest_free;
+	for (n = 0; n < STATS_HEAP_NUM_SIZE_CLASSES; n++)
+		stats->size_class[n] = heap.size_class[n];
+
+	out = p[2].memref.buffer;
+	for (n = 0; n < MIN(num_sites, num); n++)
+		copy_heap_site(out + n, sites + n);
+	free(sites);
+
+	p[1].memref.size = sizeof(struct stats_heap);
+	if (num_sites > max_sites) {
+		p[2].memref.size = num_sites * sizeof(*out);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+	num_sites = MIN(num_sites, num);
+	p[2].memref.size = num_sites * sizeof(*out);
+	p[3].value.a = num_sites;
+
+	return TEE_SUCCESS;
+}
+
 static TEE_Result get_pager_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
 {
 	struct tee_pager_stats stats;
+	uint32_t frq = 0;
 
+	/*
+	 * p[3] is optional:
+	 * p[3].value.a = number of pageable pages hash checked at boot
+	 * p[3].value.b = time of the check at boot in microseconds
+	 */
 	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
 			    TEE_PARAM_TYPE_VALUE_OUTPUT,
 			    TEE_PARAM_TYPE_VALUE_OUTPUT,
-			    TEE_PARAM_TYPE_NONE) != type) {
-		EMSG("expect 3 output values as argument");
+			    TEE_PARAM_TYPE_NONE) != type &&
+	    TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT) != type) {
+		EMSG("expect 3 or 4 output values as argument");
 		return TEE_ERROR_BAD_PARAMETERS;
 	}
 
@@ -121,6 +232,12 @@ static TEE_Result get_pager_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
 	p[2].value.a = stats.hidden_hits;
 	p[2].value.b = stats.zi_released;
 
+	if (TEE_PARAM_TYPE_GET(type, 3) == TEE_PARAM_TYPE_VALUE_OUTPUT) {
+		frq = sys_counter_freq();
+		p[3].value.a = stats.boot_checked;
+		p[3].value.b = frq ? stats.boot_check_ticks * 1000000 / frq : 0;
+	}
+
 	return TEE_SUCCESS;
 }
 
@@ -137,6 +254,412 @@ static TEE_Result get_memleak_stats(uint32_t type,
 	return TEE_SUCCESS;
 }
 
+static void copy_ta_acct(struct stats_ta_acct *d, struct tee_ta_ctx *ctx)
+{
+	const struct tee_ta_acct *acct = &ctx->acct;
+	size_t n = 0;
+
+	/*
+	 * The export structures are part of the ABI, their size only
+	 * changes with STATS_VERSION and they have no implicit padding so
+	 * that 32-bit and 64-bit normal worlds agree on the layout. A new
+	 * syscall or operation class requires a new STATS_VERSION.
+	 */
+	COMPILE_TIME_ASSERT(sizeof(*d) == 720);
+	COMPILE_TIME_ASSERT(ARRAY_SIZE(acct->syscalls) <=
+			    STATS_TA_NUM_SYSCALLS);
+	COMPILE_TIME_ASSERT(ARRAY_SIZE(acct->crypto_bytes) <=
+			    STATS_TA_NUM_CRYPTO_CLASSES);
+
+	memset(d, 0, sizeof(*d));
+	d->uuid = ctx->uuid;
+	d->sess_count = ctx->ref_count;
+	d->panicked = ctx->panicked;
+	d->user_ticks = acct->user_ticks;
+	d->kernel_ticks = acct->kernel_ticks;
+	d->rpc_count = acct->rpc_count;
+	d->rpc_ticks = acct->rpc_ticks;
+	d->storage_read = acct->storage_read;
+	d->storage_written = acct->storage_written;
+	d->page_faults = acct->page_faults;
+	for (n = 0; n < ARRAY_SIZE(acct->crypto_bytes); n++)
+		d->crypto_bytes[n] = acct->crypto_bytes[n];
+	for (n = 0; n < ARRAY_SIZE(acct->syscalls); n++)
+		d->syscalls[n] = acct->syscalls[n];
+}
+
+static TEE_Result get_ta_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	TEE_Result res = TEE_SUCCESS;
+	struct stats_ta_acct *stats = NULL;
+	struct tee_ta_ctx *ctx = NULL;
+	size_t count = 0;
+	size_t size = 0;
+
+	/*
+	 * p[0].memref.buffer = output buffer to an array of
+	 *			struct stats_ta_acct, one for each loaded TA
+	 * p[1].value.a = number of entries
+	 * p[1].value.b = frequency of the system counter, that is the unit
+	 *		  of the time fields of struct stats_ta_acct
+	 */
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&tee_ta_mutex);
+
+	TAILQ_FOREACH(ctx, &tee_ctxes, link)
+		count++;
+
+	size = count * sizeof(*stats);
+	if (p[0].memref.size < size) {
+		p[0].memref.size = size;
+		res = TEE_ERROR_SHORT_BUFFER;
+		goto out;
+	}
+
+	stats = p[0].memref.buffer;
+	TAILQ_FOREACH(ctx, &tee_ctxes, link) {
+		copy_ta_acct(stats, ctx);
+		stats++;
+	}
+
+	p[0].memref.size = size;
+	p[1].value.a = count;
+	p[1].value.b = sys_counter_freq();
+out:
+	mutex_unlock(&tee_ta_mutex);
+
+	return res;
+}
+
+#ifdef CFG_LOCK_PROFILING
+static TEE_Result get_lock_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	struct lock_prof_stats *stats = NULL;
+	struct stats_lock *out = NULL;
+	size_t max_count = 0;
+	size_t count = 0;
+	size_t num = 0;
+	size_t n = 0;
+
+	/*
+	 * p[0].memref.buffer = output buffer to an array of
+	 *			struct stats_lock, one for each lock class
+	 * p[1].value.a = number of entries
+	 * p[1].value.b = frequency of the system counter, that is the unit
+	 *		  of the time fields of struct stats_lock
+	 */
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	max_count = p[0].memref.size / sizeof(*out);
+	num = MIN(lock_prof_get_stats(NULL, 0), max_count);
+	stats = calloc(num, sizeof(*stats));
+	if (num && !stats)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	count = lock_prof_get_stats(stats, num);
+
+	COMPILE_TIME_ASSERT(sizeof(*out) == 64);
+	out = p[0].memref.buffer;
+	for (n = 0; n < MIN(count, num); n++) {
+		memset(out + n, 0, sizeof(*out));
+		out[n].key = stats[n].key;
+		out[n].type = stats[n].type;
+		out[n].acquired = stats[n].acquired;
+		out[n].contended = stats[n].contended;
+		out[n].wait_ticks = stats[n].wait_ticks;
+		out[n].max_wait_ticks = stats[n].max_wait_ticks;
+		out[n].hold_ticks = stats[n].hold_ticks;
+		out[n].max_hold_ticks = stats[n].max_hold_ticks;
+	}
+	free(stats);
+
+	if (count > max_count) {
+		p[0].memref.size = count * sizeof(*out);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+	count = MIN(count, num);
+	p[0].memref.size = count * sizeof(*out);
+
+	p[1].value.a = count;
+	p[1].value.b = sys_counter_freq();
+
+	return TEE_SUCCESS;
+}
+#else
+static TEE_Result get_lock_stats(uint32_t type __unused,
+				 TEE_Param p[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+static TEE_Result get_rpc_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	struct rpc_cmd_stats *stats = NULL;
+	struct stats_rpc_cmd *out = NULL;
+	size_t max_count = 0;
+	size_t count = 0;
+	size_t num = 0;
+	size_t n = 0;
+	size_t m = 0;
+
+	/*
+	 * p[0].memref.buffer = output buffer to an array of
+	 *			struct stats_rpc_cmd, one for each
+	 *			OPTEE_RPC_CMD_* requested so far
+	 * p[1].value.a = number of entries
+	 * p[1].value.b = frequency of the system counter, that is the unit
+	 *		  of the time fields of struct stats_rpc_cmd, 0 if
+	 *		  times aren't recorded
+	 */
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	max_count = p[0].memref.size / sizeof(*out);
+	num = MIN(rpc_stats_get(NULL, 0), max_count);
+	stats = calloc(num, sizeof(*stats));
+	if (num && !stats)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	count = rpc_stats_get(stats, num);
+
+	COMPILE_TIME_ASSERT(sizeof(*out) == 160);
+	COMPILE_TIME_ASSERT(RPC_STATS_NUM_BUCKETS == STATS_RPC_NUM_BUCKETS);
+	COMPILE_TIME_ASSERT(RPC_STATS_CMD_OTHER == STATS_RPC_CMD_OTHER);
+	out = p[0].memref.buffer;
+	for (n = 0; n < MIN(count, num); n++) {
+		memset(out + n, 0, sizeof(*out));
+		out[n].cmd = stats[n].cmd;
+		out[n].in_flight = stats[n].in_flight;
+		out[n].count = stats[n].count;
+		out[n].total_ticks = stats[n].total_ticks;
+		out[n].max_ticks = stats[n].max_ticks;
+		for (m = 0; m < STATS_RPC_NUM_BUCKETS; m++)
+			out[n].buckets[m] = stats[n].buckets[m];
+	}
+	free(stats);
+
+	if (count > max_count) {
+		p[0].memref.size = count * sizeof(*out);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+	count = MIN(count, num);
+	p[0].memref.size = count * sizeof(*out);
+
+	p[1].value.a = count;
+	p[1].value.b = sys_counter_freq();
+
+	return TEE_SUCCESS;
+}
+
+#if defined(CFG_WITH_PAGER) && defined(CFG_WITH_STATS)
+static TEE_Result get_pager_area_stats(uint32_t type,
+				       TEE_Param p[TEE_NUM_PARAMS])
+{
+	struct tee_pager_area_stats *stats = NULL;
+	struct stats_pager_area *out = NULL;
+	size_t max_count = 0;
+	size_t count = 0;
+	size_t num = 0;
+	size_t n = 0;
+
+	/*
+	 * p[0].memref.buffer = output buffer to an array of
+	 *			struct stats_pager_area, one for each
+	 *			pager area. Areas of user TAs are
+	 *			identified by the UUID of the TA.
+	 * p[1].value.a = number of entries
+	 * p[1].value.b = frequency of the system counter, that is the unit
+	 *		  of the time fields of struct stats_pager_area
+	 */
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	max_count = p[0].memref.size / sizeof(*out);
+
+	mutex_lock(&tee_ta_mutex);
+	num = MIN(tee_pager_get_area_stats(NULL, 0), max_count);
+	stats = calloc(num, sizeof(*stats));
+	if (num && !stats) {
+		mutex_unlock(&tee_ta_mutex);
+		return TEE_ERROR_OUT_OF_MEMORY;
+	}
+	count = tee_pager_get_area_stats(stats, num);
+	mutex_unlock(&tee_ta_mutex);
+
+	COMPILE_TIME_ASSERT(sizeof(*out) == 72);
+	out = p[0].memref.buffer;
+	for (n = 0; n < MIN(count, num); n++) {
+		memset(out + n, 0, sizeof(*out));
+		out[n].uuid = stats[n].uuid;
+		out[n].base = stats[n].base;
+		out[n].size = stats[n].size;
+		out[n].type = stats[n].type;
+		out[n].resident = stats[n].resident;
+		out[n].faults = stats[n].faults;
+		out[n].loads = stats[n].loads;
+		out[n].saves = stats[n].saves;
+		out[n].decrypted = stats[n].decrypted;
+		out[n].encrypted = stats[n].encrypted;
+		out[n].fault_ticks = stats[n].fault_ticks;
+	}
+	free(stats);
+
+	if (count > max_count) {
+		p[0].memref.size = count * sizeof(*out);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+	count = MIN(count, num);
+	p[0].memref.size = count * sizeof(*out);
+
+	p[1].value.a = count;
+	p[1].value.b = sys_counter_freq();
+
+	return TEE_SUCCESS;
+}
+#else
+static TEE_Result get_pager_area_stats(uint32_t type __unused,
+				       TEE_Param p[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+static TEE_Result get_mutex_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	struct mutex_stats stats = { 0 };
+
+	/*
+	 * p[0].value.a = number of contended acquisitions completed by
+	 *		  spinning on the owner
+	 * p[0].value.b = number of contended acquisitions which had to
+	 *		  sleep in normal world
+	 */
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_get_stats(&stats);
+	p[0].value.a = stats.spin_acquired;
+	p[0].value.b = stats.slept_acquired;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result get_itr_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	struct itr_stats *stats = NULL;
+	struct stats_itr *out = NULL;
+	size_t max_count = 0;
+	size_t count = 0;
+	size_t num = 0;
+	size_t n = 0;
+
+	/*
+	 * p[0].memref.buffer = output buffer to an array of
+	 *			struct stats_itr, one for each interrupt
+	 *			with a registered handler
+	 * p[1].value.a = number of entries
+	 * p[1].value.b = frequency of the system counter, that is the unit
+	 *		  of the time fields of struct stats_itr
+	 */
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+			    TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	max_count = p[0].memref.size / sizeof(*out);
+	num = MIN(itr_get_stats(NULL, 0), max_count);
+	stats = calloc(num, sizeof(*stats));
+	if (num && !stats)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	count = itr_get_stats(stats, num);
+
+	COMPILE_TIME_ASSERT(sizeof(*out) == 24);
+	out = p[0].memref.buffer;
+	for (n = 0; n < MIN(count, num); n++) {
+		memset(out + n, 0, sizeof(*out));
+		out[n].it = stats[n].it;
+		out[n].count = stats[n].count;
+		out[n].total_ticks = stats[n].total_ticks;
+		out[n].max_ticks = stats[n].max_ticks;
+	}
+	free(stats);
+
+	if (count > max_count) {
+		p[0].memref.size = count * sizeof(*out);
+		return TEE_ERROR_SHORT_BUFFER;
+	}
+	count = MIN(count, num);
+	p[0].memref.size = count * sizeof(*out);
+
+	p[1].value.a = count;
+	p[1].value.b = sys_counter_freq();
+
+	return TEE_SUCCESS;
+}
+
+#ifdef CFG_VIRTUALIZATION
+static TEE_Result get_guest_stats(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	struct virt_guest_stats stats = { 0 };
+
+	/*
+	 * Statistics of the guest VM invoking this command
+	 * p[0].value.a = number of std calls received
+	 * p[0].value.b = number of std calls rejected because all threads
+	 *		  of the guest were busy
+	 */
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	virt_get_stats(&stats);
+	p[0].value.a = stats.std_calls;
+	p[0].value.b = stats.thread_limit;
+
+	return TEE_SUCCESS;
+}
+#else
+static TEE_Result get_guest_stats(uint32_t type __unused,
+				  TEE_Param p[TEE_NUM_PARAMS] __unused)
+{
+	return TEE_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+static TEE_Result get_version(uint32_t type, TEE_Param p[TEE_NUM_PARAMS])
+{
+	if (TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_OUTPUT,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE,
+			    TEE_PARAM_TYPE_NONE) != type)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	p[0].value.a = STATS_VERSION;
+	p[0].value.b = 0;
+
+	return TEE_SUCCESS;
+}
+
 /*
  * Trusted Application Entry Points
  */
@@ -152,6 +675,24 @@ static TEE_Result invoke_command(void *psess __unused,
 		return get_alloc_stats(ptypes, params);
 	case STATS_CMD_MEMLEAK_STATS:
 		return get_memleak_stats(ptypes, params);
+	case STATS_CMD_TA_STATS:
+		return get_ta_stats(ptypes, params);
+	case STATS_CMD_LOCK_STATS:
+		return get_lock_stats(ptypes, params);
+	case STATS_CMD_HEAP_STATS:
+		return get_heap_stats(ptypes, params);
+	case STATS_CMD_RPC_STATS:
+		return get_rpc_stats(ptypes, params);
+	case STATS_CMD_PAGER_AREA_STATS:
+		return get_pager_area_stats(ptypes, params);
+	case STATS_CMD_MUTEX_STATS:
+		return get_mutex_stats(ptypes, params);
+	case STATS_CMD_GUEST_STATS:
+		return get_guest_stats(ptypes, params);
+	case STATS_CMD_ITR_STATS:
+		return get_itr_stats(ptypes, params);
+	case STATS_CMD_GET_VERSION:
+		return get_version(ptypes, params);
 	default:
 		break;
 	}
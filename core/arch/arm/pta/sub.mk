@@ -12,6 +12,10 @@ endif
 srcs-$(CFG_WITH_STATS) += stats.c
 srcs-$(CFG_TA_GPROF_SUPPORT) += gprof.c
 srcs-$(CFG_TEE_BENCHMARK) += benchmark.c
+srcs-$(CFG_CORE_TRACEPOINTS) += tracepoint.c
+srcs-$(CFG_CORE_TRACE_RING) += trace_ring.c
+srcs-$(CFG_CORE_PROFILER) += profiler.c
+srcs-$(CFG_CORE_MICROBENCH) += microbench.c
 srcs-$(CFG_SDP_PTA) += sdp_pta.c
 srcs-$(CFG_SYSTEM_PTA) += system.c
 srcs-$(CFG_DEVICE_ENUM_PTA) += device.c
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <compiler.h>
+#include <kernel/pseudo_ta.h>
+#include <kernel/trace_ext.h>
+#include <pta_trace_ring.h>
+
+#define TA_NAME		"trace_ring.ta"
+
+static TEE_Result trace_ring_cmd_read(uint32_t types,
+				      TEE_Param p[TEE_NUM_PARAMS])
+{
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	p[0].memref.size = trace_ext_read(p[0].memref.buffer,
+					  p[0].memref.size);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result invoke_command(void *psess __unused, uint32_t cmd,
+				 uint32_t ptypes,
+				 TEE_Param params[TEE_NUM_PARAMS])
+{
+	switch (cmd) {
+	case PTA_TRACE_RING_CMD_READ:
+		return trace_ring_cmd_read(ptypes, params);
+	default:
+		break;
+	}
+
+	return TEE_ERROR_BAD_PARAMETERS;
+}
+
+pseudo_ta_register(.uuid = PTA_TRACE_RING_UUID, .name = TA_NAME,
+		   .flags = PTA_DEFAULT_FLAGS | TA_FLAG_CONCURRENT,
+		   .invoke_command_entry_point = invoke_command);
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <compiler.h>
+#include <inttypes.h>
+#include <kernel/misc.h>
+#include <kernel/mutex.h>
+#include <kernel/pseudo_ta.h>
+#include <kernel/thread.h>
+#include <kernel/tracepoint.h>
+#include <mm/core_memprot.h>
+#include <mm/mobj.h>
+#include <pta_tracepoint.h>
+#include <string.h>
+#include <trace.h>
+
+#define TA_NAME		"tracepoint.ta"
+
+/* Upper limit of the number of events per CPU */
+#define TP_MAX_EVENTS_PER_CPU	(1024 * 1024)
+
+static struct mutex tp_mu = MUTEX_INITIALIZER;
+static struct mobj *tp_mobj;
+static void *tp_buf;
+static size_t tp_size;
+
+static TEE_Result tp_cmd_start(uint32_t types, TEE_Param p[TEE_NUM_PARAMS])
+{
+	TEE_Result res = TEE_SUCCESS;
+	size_t events_per_cpu = 0;
+	paddr_t pa = 0;
+
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_VALUE_OUTPUT,
+				     TEE_PARAM_TYPE_VALUE_OUTPUT,
+				     TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	events_per_cpu = p[0].value.a;
+	if (!IS_POWER_OF_TWO(events_per_cpu) ||
+	    events_per_cpu > TP_MAX_EVENTS_PER_CPU)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&tp_mu);
+
+	if (tp_mobj) {
+		res = TEE_ERROR_BAD_STATE;
+		goto out;
+	}
+
+	tp_size = tp_buf_size(events_per_cpu);
+	tp_mobj = thread_rpc_alloc_global_payload(tp_size);
+	if (!tp_mobj) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	tp_buf = mobj_get_va(tp_mobj, 0);
+	if (!tp_buf || mobj_get_pa(tp_mobj, 0, 0, &pa)) {
+		res = TEE_ERROR_GENERIC;
+		goto err;
+	}
+
+	res = tp_start(tp_buf, events_per_cpu);
+	if (res)
+		goto err;
+
+	DMSG("Recording %zu events per CPU at pa %#" PRIxPA,
+	     events_per_cpu, pa);
+
+	reg_pair_from_64(pa, &p[1].value.a, &p[1].value.b);
+	p[2].value.a = tp_size;
+	goto out;
+err:
+	thread_rpc_free_global_payload(tp_mobj);
+	tp_mobj = NULL;
+	tp_buf = NULL;
+out:
+	mutex_unlock(&tp_mu);
+	return res;
+}
+
+static TEE_Result tp_cmd_stop(uint32_t types,
+			      TEE_Param p[TEE_NUM_PARAMS] __unused)
+{
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_NONE, TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE, TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&tp_mu);
+
+	if (tp_mobj) {
+		tp_stop();
+		thread_rpc_free_global_payload(tp_mobj);
+		tp_mobj = NULL;
+		tp_buf = NULL;
+	}
+
+	mutex_unlock(&tp_mu);
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result tp_cmd_read(uint32_t types, TEE_Param p[TEE_NUM_PARAMS])
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_MEMREF_OUTPUT,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&tp_mu);
+
+	if (!tp_mobj) {
+		res = TEE_ERROR_BAD_STATE;
+	} else if (p[0].memref.size < tp_size) {
+		p[0].memref.size = tp_size;
+		res = TEE_ERROR_SHORT_BUFFER;
+	} else {
+		memcpy(p[0].memref.buffer, tp_buf, tp_size);
+		p[0].memref.size = tp_size;
+	}
+
+	mutex_unlock(&tp_mu);
+
+	return res;
+}
+
+static TEE_Result tp_cmd_pause(uint32_t types, TEE_Param p[TEE_NUM_PARAMS])
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	if (types != TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE,
+				     TEE_PARAM_TYPE_NONE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&tp_mu);
+
+	if (tp_mobj)
+		tp_pause(!p[0].value.a);
+	else
+		res = TEE_ERROR_BAD_STATE;
+
+	mutex_unlock(&tp_mu);
+
+	return res;
+}
+
+static TEE_Result invoke_command(void *psess __unused, uint32_t cmd,
+				 uint32_t ptypes,
+				 TEE_Param params[TEE_NUM_PARAMS])
+{
+	switch (cmd) {
+	case PTA_TRACEPOINT_CMD_START:
+		return tp_cmd_start(ptypes, params);
+	case PTA_TRACEPOINT_CMD_STOP:
+		return tp_cmd_stop(ptypes, params);
+	case PTA_TRACEPOINT_CMD_READ:
+		return tp_cmd_read(ptypes, params);
+	case PTA_TRACEPOINT_CMD_PAUSE:
+		return tp_cmd_pause(ptypes, params);
+	default:
+		break;
+	}
+
+	return TEE_ERROR_BAD_PARAMETERS;
+}
+
+pseudo_ta_register(.uuid = PTA_TRACEPOINT_UUID, .name = TA_NAME,
+		   .flags = PTA_DEFAULT_FLAGS,
+		   .invoke_command_entry_point = invoke_command);
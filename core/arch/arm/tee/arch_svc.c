@@ -117,6 +117,8 @@ static const struct syscall_entry tee_svc_syscall_table[] = {
 	SYSCALL_ENTRY(syscall_not_supported),
 	SYSCALL_ENTRY(syscall_not_supported),
 	SYSCALL_ENTRY(syscall_cache_operation),
+	SYSCALL_ENTRY(syscall_storage_tx_begin),
+	SYSCALL_ENTRY(syscall_storage_tx_end),
 };
 
 #ifdef TRACE_SYSCALLS
@@ -180,6 +182,7 @@ void __weak tee_svc_handler(struct thread_svc_regs *regs)
 	size_t max_args;
 	syscall_t scf;
 	uint32_t state;
+	uint64_t entered;
 
 	COMPILE_TIME_ASSERT(ARRAY_SIZE(tee_svc_syscall_table) ==
 				(TEE_SCN_MAX + 1));
@@ -211,7 +214,9 @@ void __weak tee_svc_handler(struct thread_svc_regs *regs)
 	else
 		scf = tee_svc_syscall_table[scn].fn;
 
+	entered = tee_ta_acct_syscall_enter(scn);
 	set_svc_retval(regs, tee_svc_do_call(regs, scf));
+	tee_ta_acct_syscall_exit(entered);
 
 	if (scn != TEE_SCN_RETURN) {
 		/* We're about to switch back to user mode */
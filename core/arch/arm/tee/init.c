@@ -4,7 +4,9 @@
  */
 
 #include <initcall.h>
+#include <inttypes.h>
 #include <kernel/linker.h>
+#include <kernel/sys_counter.h>
 #include <kernel/tee_misc.h>
 #include <kernel/time_source.h>
 #include <malloc.h>		/* required for inits */
@@ -21,19 +23,55 @@
 
 #define TEE_MON_MAX_NUM_ARGS    8
 
+#ifdef CFG_CORE_INITCALL_TIMING
+/* Reads as 0 us without a system counter, CFG_CORE_HAS_GENERIC_TIMER=n */
+static uint64_t ticks_to_us(uint64_t ticks)
+{
+	uint32_t freq = sys_counter_freq();
+
+	if (!freq)
+		return 0;
+	return ticks * 1000000 / freq;
+}
+
 static void call_initcalls(void)
 {
-	const initcall_t *call;
+	const struct initcall *call = NULL;
+	uint64_t total = 0;
+	uint64_t begin = 0;
+	uint64_t ticks = 0;
 
 	for (call = initcall_begin; call < initcall_end; call++) {
 		TEE_Result ret;
-		ret = (*call)();
+
+		begin = sys_counter_read();
+		ret = call->func();
+		ticks = sys_counter_read() - begin;
+		total += ticks;
+		IMSG("level %d %s() %" PRIu64 " us", call->level,
+		     call->func_name, ticks_to_us(ticks));
+		if (ret != TEE_SUCCESS)
+			EMSG("Initial call %s() failed: %#" PRIx32,
+			     call->func_name, ret);
+	}
+	IMSG("%zu initcalls in %" PRIu64 " us",
+	     (size_t)(initcall_end - initcall_begin), ticks_to_us(total));
+}
+#else
+static void call_initcalls(void)
+{
+	const struct initcall *call;
+
+	for (call = initcall_begin; call < initcall_end; call++) {
+		TEE_Result ret;
+		ret = call->func();
 		if (ret != TEE_SUCCESS) {
 			EMSG("Initial call 0x%08" PRIxVA " failed",
-			     (vaddr_t)call);
+			     (vaddr_t)call->func);
 		}
 	}
 }
+#endif
 
 /*
  * Note: this function is weak just to make it possible to exclude it from
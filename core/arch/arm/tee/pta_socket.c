@@ -3,20 +3,237 @@
  * Copyright (c) 2016-2017, Linaro Limited
  */
 
+#include <arm.h>
 #include <assert.h>
+#include <compiler.h>
 #include <mm/mobj.h>
 #include <kernel/pseudo_ta.h>
+#include <malloc.h>
 #include <optee_rpc_cmd.h>
 #include <pta_socket.h>
 #include <string.h>
+#include <sys/queue.h>
 #include <tee/tee_fs_rpc.h>
+#include <util.h>
+
+/*
+ * Rings of a socket switched with PTA_SOCKET_RING_ENABLE. The indexes
+ * owned by OP-TEE and the size are kept here as normal world may modify
+ * the shared memory at any time.
+ *
+ * @handle:	Socket handle
+ * @mobj:	Shared memory holding both rings
+ * @tx:		Transmit ring, produced by OP-TEE
+ * @rx:		Receive ring, consumed by OP-TEE
+ * @size:	Size of the data of each ring
+ * @tx_prod:	Bytes produced into @tx
+ * @rx_cons:	Bytes consumed from @rx
+ */
+struct socket_ring {
+	uint32_t handle;
+	struct mobj *mobj;
+	struct optee_socket_ring *tx;
+	struct optee_socket_ring *rx;
+	uint32_t size;
+	uint32_t tx_prod;
+	uint32_t rx_cons;
+	SLIST_ENTRY(socket_ring) link;
+};
+
+struct socket_sess {
+	uint32_t instance_id;
+	SLIST_HEAD(, socket_ring) rings;
+};
 
 static uint32_t get_instance_id(struct tee_ta_session *sess)
 {
 	return sess->ctx->ops->get_instance_id(sess->ctx);
 }
 
-static TEE_Result socket_open(uint32_t instance_id, uint32_t param_types,
+static struct socket_ring *find_ring(struct socket_sess *s, uint32_t handle)
+{
+	struct socket_ring *r = NULL;
+
+	SLIST_FOREACH(r, &s->rings, link)
+		if (r->handle == handle)
+			return r;
+
+	return NULL;
+}
+
+static uint8_t *ring_data(struct optee_socket_ring *ring)
+{
+	return (uint8_t *)(ring + 1);
+}
+
+static TEE_Result ring_rpc(struct socket_sess *s, struct socket_ring *r,
+			   uint32_t cmd, uint32_t dir, uint32_t timeout)
+{
+	struct thread_param tpm[2] = {
+		[0] = THREAD_PARAM_VALUE(IN, cmd, s->instance_id, r->handle),
+		[1] = THREAD_PARAM_VALUE(IN, dir, timeout, 0),
+	};
+
+	return thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 2, tpm);
+}
+
+/* Copies as much of @buf as fits into the transmit ring */
+static TEE_Result ring_produce(struct socket_ring *r, const uint8_t *buf,
+			       size_t len, size_t *produced)
+{
+	uint32_t cons = __compiler_atomic_load(&r->tx->cons);
+	uint32_t offs = r->tx_prod & (r->size - 1);
+	size_t n = 0;
+
+	if (r->tx_prod - cons > r->size)
+		return TEE_ERROR_COMMUNICATION;
+
+	n = MIN(len, (size_t)(r->size - (r->tx_prod - cons)));
+	if (n) {
+		/* Don't overwrite data before it's consumed */
+		dmb();
+		if (offs + n > r->size) {
+			memcpy(ring_data(r->tx) + offs, buf, r->size - offs);
+			memcpy(ring_data(r->tx), buf + r->size - offs,
+			       n - (r->size - offs));
+		} else {
+			memcpy(ring_data(r->tx) + offs, buf, n);
+		}
+		r->tx_prod += n;
+		/* Publish the data before the index */
+		dmb();
+		__compiler_atomic_store(&r->tx->prod, r->tx_prod);
+	}
+
+	*produced = n;
+	return TEE_SUCCESS;
+}
+
+/* Copies at most @len bytes from the receive ring into @buf */
+static TEE_Result ring_consume(struct socket_ring *r, uint8_t *buf,
+			       size_t len, size_t *consumed)
+{
+	uint32_t prod = __compiler_atomic_load(&r->rx->prod);
+	uint32_t offs = r->rx_cons & (r->size - 1);
+	size_t n = 0;
+
+	if (prod - r->rx_cons > r->size)
+		return TEE_ERROR_COMMUNICATION;
+
+	n = MIN(len, (size_t)(prod - r->rx_cons));
+	if (n) {
+		/* Don't read the data before the index */
+		dmb();
+		if (offs + n > r->size) {
+			memcpy(buf, ring_data(r->rx) + offs, r->size - offs);
+			memcpy(buf + r->size - offs, ring_data(r->rx),
+			       n - (r->size - offs));
+		} else {
+			memcpy(buf, ring_data(r->rx) + offs, n);
+		}
+		r->rx_cons += n;
+		/* Release the space after the data is read */
+		dmb();
+		__compiler_atomic_store(&r->rx->cons, r->rx_cons);
+	}
+
+	*consumed = n;
+	return TEE_SUCCESS;
+}
+
+/*
+ * Normal world is only involved when tee-supplicant sleeps on an empty
+ * transmit ring or when the transmit ring is full.
+ *
+ * The index is published before the waiting flag is read and
+ * tee-supplicant sets the flag before it checks the ring again, see
+ * struct optee_socket_ring. The full barriers in between make sure that
+ * at least one side sees the store of the other, so either the flag is
+ * seen and tee-supplicant is kicked or it sees the new data and doesn't
+ * sleep.
+ */
+static TEE_Result ring_send(struct socket_sess *s, struct socket_ring *r,
+			    TEE_Param params[TEE_NUM_PARAMS])
+{
+	const uint8_t *buf = params[1].memref.buffer;
+	size_t len = params[1].memref.size;
+	uint32_t timeout = params[0].value.b;
+	TEE_Result res = TEE_SUCCESS;
+	size_t done = 0;
+	size_t n = 0;
+
+	while (true) {
+		res = ring_produce(r, buf + done, len - done, &n);
+		if (res)
+			break;
+		done += n;
+
+		if (n) {
+			/* Don't read the flag before the index is published */
+			dmb();
+			if (__compiler_atomic_load(&r->tx->cons_waiting)) {
+				res = ring_rpc(s, r, OPTEE_RPC_SOCKET_RING_KICK,
+					       OPTEE_SOCKET_RING_TX, 0);
+				if (res)
+					break;
+			}
+		}
+
+		if (done == len || timeout == PTA_SOCKET_TIMEOUT_NONBLOCKING)
+			break;
+
+		res = ring_rpc(s, r, OPTEE_RPC_SOCKET_RING_WAIT,
+			       OPTEE_SOCKET_RING_TX, timeout);
+		if (res)
+			break;
+	}
+
+	params[2].value.a = done;
+	return res;
+}
+
+/*
+ * Normal world is only involved when the receive ring is empty or full,
+ * the waiting flag is read as in ring_send()
+ */
+static TEE_Result ring_recv(struct socket_sess *s, struct socket_ring *r,
+			    TEE_Param params[TEE_NUM_PARAMS])
+{
+	uint32_t timeout = params[0].value.b;
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	while (true) {
+		res = ring_consume(r, params[1].memref.buffer,
+				   params[1].memref.size, &n);
+		if (res || n || timeout == PTA_SOCKET_TIMEOUT_NONBLOCKING)
+			break;
+
+		res = ring_rpc(s, r, OPTEE_RPC_SOCKET_RING_WAIT,
+			       OPTEE_SOCKET_RING_RX, timeout);
+		if (res)
+			break;
+	}
+
+	if (n) {
+		dmb();
+		if (__compiler_atomic_load(&r->rx->prod_waiting))
+			res = ring_rpc(s, r, OPTEE_RPC_SOCKET_RING_KICK,
+				       OPTEE_SOCKET_RING_RX, 0);
+	}
+
+	params[1].memref.size = n;
+	return res;
+}
+
+static void free_ring(struct socket_sess *s, struct socket_ring *r)
+{
+	SLIST_REMOVE(&s->rings, r, socket_ring, link);
+	thread_rpc_free_payload(r->mobj);
+	free(r);
+}
+
+static TEE_Result socket_open(struct socket_sess *s, uint32_t param_types,
 			      TEE_Param params[TEE_NUM_PARAMS])
 {
 	struct mobj *mobj;
@@ -41,7 +258,7 @@ static TEE_Result socket_open(uint32_t instance_id, uint32_t param_types,
 
 	struct thread_param tpm[4] = {
 		[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_OPEN,
-					 instance_id, 0),
+					 s->instance_id, 0),
 		[1] = THREAD_PARAM_VALUE(IN,
 				params[0].value.b, /* server port number */
 				params[2].value.a, /* protocol */
@@ -57,9 +274,11 @@ static TEE_Result socket_open(uint32_t instance_id, uint32_t param_types,
 	return res;
 }
 
-static TEE_Result socket_close(uint32_t instance_id, uint32_t param_types,
+static TEE_Result socket_close(struct socket_sess *s, uint32_t param_types,
 			       TEE_Param params[TEE_NUM_PARAMS])
 {
+	struct socket_ring *r = NULL;
+	TEE_Result res;
 	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
 					  TEE_PARAM_TYPE_NONE,
 					  TEE_PARAM_TYPE_NONE,
@@ -72,15 +291,23 @@ static TEE_Result socket_close(uint32_t instance_id, uint32_t param_types,
 	}
 
 	struct thread_param tpm = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_CLOSE,
-						     instance_id,
+						     s->instance_id,
 						     params[0].value.a);
 
-	return thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 1, &tpm);
+	res = thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 1, &tpm);
+
+	/* tee-supplicant has released the rings with the socket */
+	r = find_ring(s, params[0].value.a);
+	if (r)
+		free_ring(s, r);
+
+	return res;
 }
 
-static TEE_Result socket_send(uint32_t instance_id, uint32_t param_types,
+static TEE_Result socket_send(struct socket_sess *s, uint32_t param_types,
 			      TEE_Param params[TEE_NUM_PARAMS])
 {
+	struct socket_ring *r = NULL;
 	struct mobj *mobj;
 	TEE_Result res;
 	void *va;
@@ -95,6 +322,10 @@ static TEE_Result socket_send(uint32_t instance_id, uint32_t param_types,
 		return TEE_ERROR_BAD_PARAMETERS;
 	}
 
+	r = find_ring(s, params[0].value.a);
+	if (r)
+		return ring_send(s, r, params);
+
 	va = tee_fs_rpc_cache_alloc(params[1].memref.size, &mobj);
 	if (!va)
 		return TEE_ERROR_OUT_OF_MEMORY;
@@ -102,7 +333,8 @@ static TEE_Result socket_send(uint32_t instance_id, uint32_t param_types,
 	memcpy(va, params[1].memref.buffer, params[1].memref.size);
 
 	struct thread_param tpm[3] = {
-		[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_SEND, instance_id,
+		[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_SEND,
+					 s->instance_id,
 					 params[0].value.a /* handle */),
 		[1] = THREAD_PARAM_MEMREF(IN, mobj, 0, params[1].memref.size),
 		[2] = THREAD_PARAM_VALUE(INOUT, params[0].value.b, /* timeout */
@@ -115,9 +347,10 @@ static TEE_Result socket_send(uint32_t instance_id, uint32_t param_types,
 	return res;
 }
 
-static TEE_Result socket_recv(uint32_t instance_id, uint32_t param_types,
+static TEE_Result socket_recv(struct socket_sess *s, uint32_t param_types,
 			      TEE_Param params[TEE_NUM_PARAMS])
 {
+	struct socket_ring *r = NULL;
 	struct mobj *mobj;
 	TEE_Result res;
 	void *va;
@@ -132,12 +365,17 @@ static TEE_Result socket_recv(uint32_t instance_id, uint32_t param_types,
 		return TEE_ERROR_BAD_PARAMETERS;
 	}
 
+	r = find_ring(s, params[0].value.a);
+	if (r)
+		return ring_recv(s, r, params);
+
 	va = tee_fs_rpc_cache_alloc(params[1].memref.size, &mobj);
 	if (!va)
 		return TEE_ERROR_OUT_OF_MEMORY;
 
 	struct thread_param tpm[3] = {
-		[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_RECV, instance_id,
+		[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_RECV,
+					 s->instance_id,
 					 params[0].value.a /* handle */),
 		[1] = THREAD_PARAM_MEMREF(OUT, mobj, 0, params[1].memref.size),
 		[2] = THREAD_PARAM_VALUE(IN, params[0].value.b /* timeout */,
@@ -155,7 +393,7 @@ static TEE_Result socket_recv(uint32_t instance_id, uint32_t param_types,
 	return res;
 }
 
-static TEE_Result socket_ioctl(uint32_t instance_id, uint32_t param_types,
+static TEE_Result socket_ioctl(struct socket_sess *s, uint32_t param_types,
 			       TEE_Param params[TEE_NUM_PARAMS])
 {
 	struct mobj *mobj;
@@ -180,7 +418,7 @@ static TEE_Result socket_ioctl(uint32_t instance_id, uint32_t param_types,
 
 	struct thread_param tpm[3] = {
 		[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_IOCTL,
-					 instance_id,
+					 s->instance_id,
 					 params[0].value.a /* handle */),
 		[1] = THREAD_PARAM_MEMREF(INOUT, mobj, 0,
 					  params[1].memref.size),
@@ -198,7 +436,74 @@ static TEE_Result socket_ioctl(uint32_t instance_id, uint32_t param_types,
 	return res;
 }
 
-typedef TEE_Result (*ta_func)(uint32_t instance_id, uint32_t param_types,
+static TEE_Result socket_ring_enable(struct socket_sess *s,
+				     uint32_t param_types,
+				     TEE_Param params[TEE_NUM_PARAMS])
+{
+	struct socket_ring *r = NULL;
+	size_t ring_size = 0;
+	uint32_t size = 0;
+	TEE_Result res;
+	uint8_t *va;
+	uint32_t exp_pt = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+					  TEE_PARAM_TYPE_NONE,
+					  TEE_PARAM_TYPE_NONE,
+					  TEE_PARAM_TYPE_NONE);
+
+	if (exp_pt != param_types) {
+		DMSG("got param_types 0x%x, expected 0x%x",
+		     param_types, exp_pt);
+		return TEE_ERROR_BAD_PARAMETERS;
+	}
+
+	size = params[0].value.b;
+	if (!IS_POWER_OF_TWO(size) || size < PTA_SOCKET_RING_MIN_SIZE ||
+	    size > PTA_SOCKET_RING_MAX_SIZE)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	if (find_ring(s, params[0].value.a))
+		return TEE_ERROR_BAD_STATE;
+
+	r = calloc(1, sizeof(*r));
+	if (!r)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	ring_size = sizeof(struct optee_socket_ring) + size;
+	r->mobj = thread_rpc_alloc_payload(2 * ring_size);
+	if (!r->mobj) {
+		free(r);
+		return TEE_ERROR_OUT_OF_MEMORY;
+	}
+
+	va = mobj_get_va(r->mobj, 0);
+	assert(va);
+	memset(va, 0, 2 * ring_size);
+	r->handle = params[0].value.a;
+	r->size = size;
+	r->tx = (struct optee_socket_ring *)va;
+	r->rx = (struct optee_socket_ring *)(va + ring_size);
+	r->tx->size = size;
+	r->rx->size = size;
+
+	struct thread_param tpm[2] = {
+		[0] = THREAD_PARAM_VALUE(IN, OPTEE_RPC_SOCKET_RING_SETUP,
+					 s->instance_id, r->handle),
+		[1] = THREAD_PARAM_MEMREF(IN, r->mobj, 0, 2 * ring_size),
+	};
+
+	res = thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 2, tpm);
+	if (res) {
+		thread_rpc_free_payload(r->mobj);
+		free(r);
+		return res;
+	}
+
+	SLIST_INSERT_HEAD(&s->rings, r, link);
+
+	return TEE_SUCCESS;
+}
+
+typedef TEE_Result (*ta_func)(struct socket_sess *s, uint32_t param_types,
 			      TEE_Param params[TEE_NUM_PARAMS]);
 
 static const ta_func ta_funcs[] = {
@@ -207,6 +512,7 @@ static const ta_func ta_funcs[] = {
 	[PTA_SOCKET_SEND] = socket_send,
 	[PTA_SOCKET_RECV] = socket_recv,
 	[PTA_SOCKET_IOCTL] = socket_ioctl,
+	[PTA_SOCKET_RING_ENABLE] = socket_ring_enable,
 };
 
 /*
@@ -218,36 +524,49 @@ static TEE_Result pta_socket_open_session(uint32_t param_types __unused,
 			void **sess_ctx)
 {
 	struct tee_ta_session *s;
+	struct socket_sess *sess;
 
 	/* Check that we're called from a TA */
 	s = tee_ta_get_calling_session();
 	if (!s)
 		return TEE_ERROR_ACCESS_DENIED;
 
-	*sess_ctx = (void *)(vaddr_t)get_instance_id(s);
+	sess = calloc(1, sizeof(*sess));
+	if (!sess)
+		return TEE_ERROR_OUT_OF_MEMORY;
+
+	sess->instance_id = get_instance_id(s);
+	SLIST_INIT(&sess->rings);
+	*sess_ctx = sess;
 
 	return TEE_SUCCESS;
 }
 
 static void pta_socket_close_session(void *sess_ctx)
 {
+	struct socket_sess *sess = sess_ctx;
 	TEE_Result res;
 	struct thread_param tpm = {
 		.attr = THREAD_PARAM_ATTR_VALUE_IN, .u.value = {
-			.a = OPTEE_RPC_SOCKET_CLOSE_ALL, .b = (vaddr_t)sess_ctx,
+			.a = OPTEE_RPC_SOCKET_CLOSE_ALL,
+			.b = sess->instance_id,
 		},
 	};
 
 	res = thread_rpc_cmd(OPTEE_RPC_CMD_SOCKET, 1, &tpm);
 	if (res != TEE_SUCCESS)
 		DMSG("OPTEE_RPC_SOCKET_CLOSE_ALL failed: %#" PRIx32, res);
+
+	while (!SLIST_EMPTY(&sess->rings))
+		free_ring(sess, SLIST_FIRST(&sess->rings));
+	free(sess);
 }
 
 static TEE_Result pta_socket_invoke_command(void *sess_ctx, uint32_t cmd_id,
 			uint32_t param_types, TEE_Param params[TEE_NUM_PARAMS])
 {
 	if (cmd_id < ARRAY_SIZE(ta_funcs) && ta_funcs[cmd_id])
-		return ta_funcs[cmd_id]((vaddr_t)sess_ctx, param_types, params);
+		return ta_funcs[cmd_id](sess_ctx, param_types, params);
 
 	return TEE_ERROR_NOT_IMPLEMENTED;
 }
@@ -8,6 +8,7 @@
 #include <crypto/crypto.h>
 #include <crypto/crypto_impl.h>
 #include <kernel/panic.h>
+#include <kernel/tracepoint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <utee_defines.h>
@@ -72,16 +73,28 @@ TEE_Result crypto_hash_init(void *ctx, uint32_t algo __unused)
 	return hash_ops(ctx)->init(ctx);
 }
 
-TEE_Result crypto_hash_update(void *ctx, uint32_t algo __unused,
+TEE_Result crypto_hash_update(void *ctx, uint32_t algo,
 			      const uint8_t *data, size_t len)
 {
-	return hash_ops(ctx)->update(ctx, data, len);
+	TEE_Result res = TEE_SUCCESS;
+
+	tp_crypto_begin(algo, len);
+	res = hash_ops(ctx)->update(ctx, data, len);
+	tp_crypto_end(algo, res);
+
+	return res;
 }
 
-TEE_Result crypto_hash_final(void *ctx, uint32_t algo __unused,
+TEE_Result crypto_hash_final(void *ctx, uint32_t algo,
 			     uint8_t *digest, size_t len)
 {
-	return hash_ops(ctx)->final(ctx, digest, len);
+	TEE_Result res = TEE_SUCCESS;
+
+	tp_crypto_begin(algo, 0);
+	res = hash_ops(ctx)->final(ctx, digest, len);
+	tp_crypto_end(algo, res);
+
+	return res;
 }
 
 TEE_Result crypto_cipher_alloc_ctx(void **ctx, uint32_t algo)
@@ -160,12 +173,18 @@ TEE_Result crypto_cipher_init(void *ctx __unused, uint32_t algo __unused,
 				     iv, iv_len);
 }
 
-TEE_Result crypto_cipher_update(void *ctx, uint32_t algo __unused,
+TEE_Result crypto_cipher_update(void *ctx, uint32_t algo,
 				TEE_OperationMode mode __unused,
 				bool last_block, const uint8_t *data,
 				size_t len, uint8_t *dst)
 {
-	return cipher_ops(ctx)->update(ctx, last_block, data, len, dst);
+	TEE_Result res = TEE_SUCCESS;
+
+	tp_crypto_begin(algo, len);
+	res = cipher_ops(ctx)->update(ctx, last_block, data, len, dst);
+	tp_crypto_end(algo, res);
+
+	return res;
 }
 
 void crypto_cipher_final(void *ctx, uint32_t algo __unused)
@@ -275,19 +294,31 @@ TEE_Result crypto_mac_init(void *ctx, uint32_t algo __unused,
 	return mac_ops(ctx)->init(ctx, key, len);
 }
 
-TEE_Result crypto_mac_update(void *ctx, uint32_t algo __unused,
+TEE_Result crypto_mac_update(void *ctx, uint32_t algo,
 			     const uint8_t *data, size_t len)
 {
+	TEE_Result res = TEE_SUCCESS;
+
 	if (!len)
 		return TEE_SUCCESS;
 
-	return mac_ops(ctx)->update(ctx, data, len);
+	tp_crypto_begin(algo, len);
+	res = mac_ops(ctx)->update(ctx, data, len);
+	tp_crypto_end(algo, res);
+
+	return res;
 }
 
-TEE_Result crypto_mac_final(void *ctx, uint32_t algo __unused,
+TEE_Result crypto_mac_final(void *ctx, uint32_t algo,
 			    uint8_t *digest, size_t digest_len)
 {
-	return mac_ops(ctx)->final(ctx, digest, digest_len);
+	TEE_Result res = TEE_SUCCESS;
+
+	tp_crypto_begin(algo, 0);
+	res = mac_ops(ctx)->final(ctx, digest, digest_len);
+	tp_crypto_end(algo, res);
+
+	return res;
 }
 
 TEE_Result crypto_authenc_alloc_ctx(void **ctx, uint32_t algo)
@@ -344,44 +375,62 @@ TEE_Result crypto_authenc_update_aad(void *ctx, uint32_t algo __unused,
 }
 
 
-TEE_Result crypto_authenc_update_payload(void *ctx, uint32_t algo __unused,
+TEE_Result crypto_authenc_update_payload(void *ctx, uint32_t algo,
 					 TEE_OperationMode mode,
 					 const uint8_t *src_data,
 					 size_t src_len, uint8_t *dst_data,
 					 size_t *dst_len)
 {
+	TEE_Result res = TEE_SUCCESS;
+
 	if (*dst_len < src_len)
 		return TEE_ERROR_SHORT_BUFFER;
 	*dst_len = src_len;
 
-	return ae_ops(ctx)->update_payload(ctx, mode, src_data, src_len,
-					   dst_data);
+	tp_crypto_begin(algo, src_len);
+	res = ae_ops(ctx)->update_payload(ctx, mode, src_data, src_len,
+					  dst_data);
+	tp_crypto_end(algo, res);
+
+	return res;
 }
 
-TEE_Result crypto_authenc_enc_final(void *ctx, uint32_t algo __unused,
+TEE_Result crypto_authenc_enc_final(void *ctx, uint32_t algo,
 				    const uint8_t *src_data, size_t src_len,
 				    uint8_t *dst_data, size_t *dst_len,
 				    uint8_t *dst_tag, size_t *dst_tag_len)
 {
+	TEE_Result res = TEE_SUCCESS;
+
 	if (*dst_len < src_len)
 		return TEE_ERROR_SHORT_BUFFER;
 	*dst_len = src_len;
 
-	return ae_ops(ctx)->enc_final(ctx, src_data, src_len, dst_data,
-				      dst_tag, dst_tag_len);
+	tp_crypto_begin(algo, src_len);
+	res = ae_ops(ctx)->enc_final(ctx, src_data, src_len, dst_data,
+				     dst_tag, dst_tag_len);
+	tp_crypto_end(algo, res);
+
+	return res;
 }
 
-TEE_Result crypto_authenc_dec_final(void *ctx, uint32_t algo __unused,
+TEE_Result crypto_authenc_dec_final(void *ctx, uint32_t algo,
 				    const uint8_t *src_data, size_t src_len,
 				    uint8_t *dst_data, size_t *dst_len,
 				    const uint8_t *tag, size_t tag_len)
 {
+	TEE_Result res = TEE_SUCCESS;
+
 	if (*dst_len < src_len)
 		return TEE_ERROR_SHORT_BUFFER;
 	*dst_len = src_len;
 
-	return ae_ops(ctx)->dec_final(ctx, src_data, src_len, dst_data, tag,
-				      tag_len);
+	tp_crypto_begin(algo, src_len);
+	res = ae_ops(ctx)->dec_final(ctx, src_data, src_len, dst_data, tag,
+				     tag_len);
+	tp_crypto_end(algo, res);
+
+	return res;
 }
 
 void crypto_authenc_final(void *ctx, uint32_t algo __unused)
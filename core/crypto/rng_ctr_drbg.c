@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * CTR_DRBG with AES-256 and no derivation function as specified in
+ * NIST SP 800-90A Rev. 1 section 10.2.1. It's seeded and reseeded with
+ * full entropy input from hw_get_random_bytes(), so the hardware RNG is
+ * only accessed once every CTR_DRBG_RESEED_INTERVAL requests instead of
+ * for each byte.
+ */
+
+#include <crypto/crypto.h>
+#include <kernel/mutex.h>
+#include <rng_support.h>
+#include <string.h>
+#include <types_ext.h>
+#include <util.h>
+
+#define CTR_DRBG_KEY_LEN		32
+#define CTR_DRBG_BLOCK_LEN		16
+#define CTR_DRBG_SEED_LEN		(CTR_DRBG_KEY_LEN + CTR_DRBG_BLOCK_LEN)
+/* Largest number of bytes per request, 2^19 bits */
+#define CTR_DRBG_MAX_REQUEST		(64 * 1024)
+#define CTR_DRBG_RESEED_INTERVAL	(1 << 16)
+
+/*
+ * @ek:			Expanded AES key, Key in SP 800-90A
+ * @rounds:		Number of AES rounds of @ek
+ * @v:			Counter block, V in SP 800-90A
+ * @reseed_counter:	Number of requests since the last (re)seed
+ * @pers:		Personalization string from crypto_rng_init()
+ * @instantiated:	True once seeded from the hardware RNG
+ */
+static struct ctr_drbg_state {
+	uint64_t ek[30];
+	unsigned int rounds;
+	uint8_t v[CTR_DRBG_BLOCK_LEN];
+	uint32_t reseed_counter;
+	uint8_t pers[CTR_DRBG_SEED_LEN];
+	bool instantiated;
+} state;
+
+static struct mutex state_mu = MUTEX_INITIALIZER;
+
+static void inc_v(uint8_t v[CTR_DRBG_BLOCK_LEN])
+{
+	int n = 0;
+
+	for (n = CTR_DRBG_BLOCK_LEN - 1; n >= 0; n--)
+		if (++v[n])
+			break;
+}
+
+static TEE_Result set_key(const uint8_t key[CTR_DRBG_KEY_LEN])
+{
+	return crypto_aes_expand_enc_key(key, CTR_DRBG_KEY_LEN, state.ek,
+					 &state.rounds);
+}
+
+/* CTR_DRBG_Update(), @data is CTR_DRBG_SEED_LEN bytes or NULL for zeroes */
+static TEE_Result update(const uint8_t *data)
+{
+	uint8_t temp[CTR_DRBG_SEED_LEN] = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	for (n = 0; n < CTR_DRBG_SEED_LEN; n += CTR_DRBG_BLOCK_LEN) {
+		inc_v(state.v);
+		crypto_aes_enc_block(state.ek, state.rounds, state.v,
+				     temp + n);
+	}
+
+	if (data)
+		for (n = 0; n < CTR_DRBG_SEED_LEN; n++)
+			temp[n] ^= data[n];
+
+	res = set_key(temp);
+	memcpy(state.v, temp + CTR_DRBG_KEY_LEN, CTR_DRBG_BLOCK_LEN);
+	memset(temp, 0, sizeof(temp));
+
+	return res;
+}
+
+/* Instantiate and reseed, the additional input is the personalization */
+static TEE_Result seed(void)
+{
+	uint8_t seed_material[CTR_DRBG_SEED_LEN] = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	size_t n = 0;
+
+	res = hw_get_random_bytes(seed_material, sizeof(seed_material));
+	if (res)
+		return res;
+
+	for (n = 0; n < CTR_DRBG_SEED_LEN; n++)
+		seed_material[n] ^= state.pers[n];
+
+	if (!state.instantiated) {
+		uint8_t zero_key[CTR_DRBG_KEY_LEN] = { 0 };
+
+		memset(state.v, 0, sizeof(state.v));
+		res = set_key(zero_key);
+		if (res)
+			goto out;
+	}
+
+	res = update(seed_material);
+	if (!res) {
+		state.reseed_counter = 1;
+		state.instantiated = true;
+	}
+out:
+	memset(seed_material, 0, sizeof(seed_material));
+	return res;
+}
+
+static TEE_Result generate(uint8_t *buf, size_t len)
+{
+	uint8_t block[CTR_DRBG_BLOCK_LEN] = { 0 };
+	TEE_Result res = TEE_SUCCESS;
+	size_t l = 0;
+
+	if (!state.instantiated ||
+	    state.reseed_counter > CTR_DRBG_RESEED_INTERVAL) {
+		res = seed();
+		if (res)
+			return res;
+	}
+
+	while (len) {
+		inc_v(state.v);
+		l = MIN(len, sizeof(block));
+		if (l == sizeof(block)) {
+			crypto_aes_enc_block(state.ek, state.rounds, state.v,
+					     buf);
+		} else {
+			crypto_aes_enc_block(state.ek, state.rounds, state.v,
+					     block);
+			memcpy(buf, block, l);
+		}
+		buf += l;
+		len -= l;
+	}
+	memset(block, 0, sizeof(block));
+
+	res = update(NULL);
+	state.reseed_counter++;
+
+	return res;
+}
+
+TEE_Result crypto_rng_init(const void *data, size_t dlen)
+{
+	mutex_lock(&state_mu);
+	memset(state.pers, 0, sizeof(state.pers));
+	if (data)
+		memcpy(state.pers, data, MIN(dlen, sizeof(state.pers)));
+	/* The hardware RNG may not be ready yet, seeded on first read */
+	state.instantiated = false;
+	mutex_unlock(&state_mu);
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result crypto_rng_read(void *buf, size_t blen)
+{
+	TEE_Result res = TEE_SUCCESS;
+	uint8_t *b = buf;
+	size_t l = 0;
+
+	if (!b)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	mutex_lock(&state_mu);
+	while (blen && !res) {
+		l = MIN(blen, (size_t)CTR_DRBG_MAX_REQUEST);
+		res = generate(b, l);
+		b += l;
+		blen -= l;
+	}
+	mutex_unlock(&state_mu);
+
+	return res;
+}
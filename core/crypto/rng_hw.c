@@ -20,17 +20,23 @@ void __weak crypto_rng_add_event(enum crypto_rng_src sid __unused,
 {
 }
 
-TEE_Result __weak crypto_rng_read(void *buf, size_t blen)
+/* Adapter for drivers which only implement hw_get_random_byte() */
+TEE_Result __weak hw_get_random_bytes(void *buf, size_t len)
 {
 	uint8_t *b = buf;
 	size_t n;
 
-	if (!b)
-		return TEE_ERROR_BAD_PARAMETERS;
-
-	for (n = 0; n < blen; n++)
+	for (n = 0; n < len; n++)
 		b[n] = hw_get_random_byte();
 
 	return TEE_SUCCESS;
 }
 
+TEE_Result __weak crypto_rng_read(void *buf, size_t blen)
+{
+	if (!buf)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	return hw_get_random_bytes(buf, blen);
+}
+
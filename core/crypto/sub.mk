@@ -12,6 +12,7 @@ ifeq ($(CFG_WITH_SOFTWARE_PRNG),y)
 srcs-y += rng_fortuna.c
 else
 srcs-y += rng_hw.c
+srcs-$(CFG_WITH_CTR_DRBG) += rng_ctr_drbg.c
 endif
 
 ifneq ($(CFG_CRYPTO_CBC_MAC_FROM_CRYPTOLIB),y)
@@ -13,6 +13,8 @@
 #include <mm/core_mmu.h>
 #include <platform_config.h>
 #include <rng_support.h>
+#include <string.h>
+#include <util.h>
 
 #define	RNG_OUTPUT_L            0x0000
 #define	RNG_OUTPUT_H            0x0004
@@ -72,53 +74,84 @@ register_phys_mem_pgdir(MEM_AREA_IO_SEC, RNG_BASE, RNG_REG_SIZE);
 
 static unsigned int rng_lock = SPINLOCK_UNLOCK;
 
-uint8_t hw_get_random_byte(void)
+/*
+ * Output of the RNG not consumed yet, the last @rng_buf_len bytes of
+ * @rng_buf. Protected by rng_lock.
+ */
+static uint32_t rng_buf[2];
+static size_t rng_buf_len;
+
+/* Reads 64 bits from the RNG, called with rng_lock held */
+static void read_output(vaddr_t rng, uint32_t val[2])
+{
+	/* Is the result ready (available)? */
+	while (!(io_read32(rng + RNG_STATUS) & RNG_READY)) {
+		/* Is the shutdown threshold reached? */
+		if (io_read32(rng + RNG_STATUS) & SHUTDOWN_OFLO) {
+			uint32_t alarm = io_read32(rng + RNG_ALARMSTOP);
+			uint32_t tune = io_read32(rng + RNG_FRODETUNE);
+
+			/* Clear the alarm events */
+			io_write32(rng + RNG_ALARMMASK, 0x0);
+			io_write32(rng + RNG_ALARMSTOP, 0x0);
+			/* De-tune offending FROs */
+			io_write32(rng + RNG_FRODETUNE, tune ^ alarm);
+			/* Re-enable the shut down FROs */
+			io_write32(rng + RNG_FROENABLE, RNG_FRO_MASK);
+			/* Clear the shutdown overflow event */
+			io_write32(rng + RNG_INTACK, SHUTDOWN_OFLO);
+
+			DMSG("Fixed FRO shutdown\n");
+		}
+	}
+	/* Read random value */
+	val[0] = io_read32(rng + RNG_OUTPUT_L);
+	val[1] = io_read32(rng + RNG_OUTPUT_H);
+	/* Acknowledge read complete */
+	io_write32(rng + RNG_INTACK, RNG_READY);
+}
+
+/*
+ * The lock is taken for one 64-bit output of the RNG at a time so that a
+ * large request doesn't keep other cores spinning with interrupts masked
+ * while the RNG refills. Bytes left over by a request are kept for the
+ * next one.
+ */
+TEE_Result hw_get_random_bytes(void *buf, size_t len)
 {
-	static int pos;
-	static union {
-		uint32_t val[2];
-		uint8_t byte[8];
-	} random;
 	vaddr_t rng = (vaddr_t)phys_to_virt(RNG_BASE, MEM_AREA_IO_SEC);
-	uint8_t ret;
-
-	uint32_t exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
-	cpu_spin_lock(&rng_lock);
-
-	if (!pos) {
-		/* Is the result ready (available)? */
-		while (!(io_read32(rng + RNG_STATUS) & RNG_READY)) {
-			/* Is the shutdown threshold reached? */
-			if (io_read32(rng + RNG_STATUS) & SHUTDOWN_OFLO) {
-				uint32_t alarm = io_read32(rng + RNG_ALARMSTOP);
-				uint32_t tune = io_read32(rng + RNG_FRODETUNE);
-
-				/* Clear the alarm events */
-				io_write32(rng + RNG_ALARMMASK, 0x0);
-				io_write32(rng + RNG_ALARMSTOP, 0x0);
-				/* De-tune offending FROs */
-				io_write32(rng + RNG_FRODETUNE, tune ^ alarm);
-				/* Re-enable the shut down FROs */
-				io_write32(rng + RNG_FROENABLE, RNG_FRO_MASK);
-				/* Clear the shutdown overflow event */
-				io_write32(rng + RNG_INTACK, SHUTDOWN_OFLO);
-
-				DMSG("Fixed FRO shutdown\n");
-			}
+	uint8_t *b = buf;
+	uint8_t *src = NULL;
+	uint32_t exceptions = 0;
+	size_t l = 0;
+
+	while (len) {
+		exceptions = cpu_spin_lock_xsave(&rng_lock);
+
+		if (!rng_buf_len) {
+			read_output(rng, rng_buf);
+			rng_buf_len = sizeof(rng_buf);
 		}
-		/* Read random value */
-		random.val[0] = io_read32(rng + RNG_OUTPUT_L);
-		random.val[1] = io_read32(rng + RNG_OUTPUT_H);
-		/* Acknowledge read complete */
-		io_write32(rng + RNG_INTACK, RNG_READY);
+		src = (uint8_t *)rng_buf + sizeof(rng_buf) - rng_buf_len;
+		l = MIN(len, rng_buf_len);
+		memcpy(b, src, l);
+		memset(src, 0, l);
+		rng_buf_len -= l;
+
+		cpu_spin_unlock_xrestore(&rng_lock, exceptions);
+
+		b += l;
+		len -= l;
 	}
 
-	ret = random.byte[pos];
+	return TEE_SUCCESS;
+}
 
-	pos = (pos + 1) % 8;
+uint8_t hw_get_random_byte(void)
+{
+	uint8_t ret = 0;
 
-	cpu_spin_unlock(&rng_lock);
-	thread_set_exceptions(exceptions);
+	hw_get_random_bytes(&ret, sizeof(ret));
 
 	return ret;
 }
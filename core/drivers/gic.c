@@ -212,6 +212,7 @@ void gic_init_base_addr(struct gic_data *gd, vaddr_t gicc_base __maybe_unused,
 	gd->gicd_base = gicd_base;
 	gd->max_it = probe_max_it(gicc_base, gicd_base);
 	gd->chip.ops = &gic_ops;
+	gd->chip.max_it = gd->max_it;
 }
 
 static void gic_it_add(struct gic_data *gd, size_t it)
@@ -393,18 +394,28 @@ void gic_dump_state(struct gic_data *gd)
 
 void gic_it_handle(struct gic_data *gd)
 {
-	uint32_t iar;
-	uint32_t id;
+	uint32_t iar = 0;
+	uint32_t id = 0;
 
-	iar = gic_read_iar(gd);
-	id = iar & GICC_IAR_IT_ID_MASK;
+	/*
+	 * Acknowledge and handle interrupts until none is pending, saves a
+	 * trap per interrupt when they arrive in bursts.
+	 */
+	while (true) {
+		iar = gic_read_iar(gd);
+		id = iar & GICC_IAR_IT_ID_MASK;
 
-	if (id < gd->max_it)
-		itr_handle(id);
-	else
-		DMSG("ignoring interrupt %" PRIu32, id);
+		/* 1020-1023 are special IDs, 1023 means none is pending */
+		if (id >= GIC_MAX_INTS)
+			break;
 
-	gic_write_eoir(gd, iar);
+		if (id < gd->max_it)
+			itr_handle(id);
+		else
+			DMSG("ignoring interrupt %" PRIu32, id);
+
+		gic_write_eoir(gd, iar);
+	}
 }
 
 static void gic_op_add(struct itr_chip *chip, size_t it,
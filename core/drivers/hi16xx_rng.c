@@ -13,6 +13,7 @@
 #include <mm/core_mmu.h>
 #include <platform_config.h>
 #include <rng_support.h>
+#include <string.h>
 #include <trace.h>
 #include <types_ext.h>
 #include <util.h>
@@ -60,31 +61,34 @@ static TEE_Result hi16xx_rng_init(void)
 	return TEE_SUCCESS;
 }
 
-uint8_t hw_get_random_byte(void)
+TEE_Result hw_get_random_bytes(void *buf, size_t len)
 {
-	static vaddr_t r;
-	static int pos;
-	static union {
-		uint32_t val;
-		uint8_t byte[4];
-	} random;
-	uint8_t ret;
-	uint32_t exceptions;
+	vaddr_t r = (vaddr_t)phys_to_virt(RNG_BASE, MEM_AREA_IO_SEC) + RNG_NUM;
+	uint8_t *b = buf;
+	uint32_t val = 0;
+	uint32_t exceptions = 0;
+	size_t l = 0;
 
 	exceptions = cpu_spin_lock_xsave(&rng_lock);
 
-	if (!r)
-		r = (vaddr_t)phys_to_virt(RNG_BASE, MEM_AREA_IO_SEC) + RNG_NUM;
+	while (len) {
+		val = io_read32(r);
+		l = MIN(len, sizeof(val));
+		memcpy(b, &val, l);
+		b += l;
+		len -= l;
+	}
 
-	if (!pos)
-		random.val = io_read32(r);
+	cpu_spin_unlock_xrestore(&rng_lock, exceptions);
 
-	ret = random.byte[pos++];
+	return TEE_SUCCESS;
+}
 
-	if (pos == 4)
-		pos = 0;
+uint8_t hw_get_random_byte(void)
+{
+	uint8_t ret = 0;
 
-	cpu_spin_unlock_xrestore(&rng_lock, exceptions);
+	hw_get_random_bytes(&ret, sizeof(ret));
 
 	return ret;
 }
@@ -110,7 +110,7 @@ static TEE_Result imx_wdog_base(vaddr_t *wdog_vbase)
 
 	/* search the first usable wdog */
 	for (i = 0; i < ARRAY_SIZE(wdog_path); i++) {
-		off = fdt_path_offset(fdt, wdog_path[i]);
+		off = dt_path_offset(fdt, wdog_path[i]);
 		if (off < 0)
 			continue;
 
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Stand-in for a hardware RNG on platforms without one, for instance
+ * QEMU, so that the code consuming hw_get_random_bytes() can be exercised.
+ * The output is derived from the system counter, if there is one, and is
+ * NOT suitable to protect anything.
+ */
+
+#include <initcall.h>
+#include <kernel/spinlock.h>
+#include <kernel/sys_counter.h>
+#include <rng_support.h>
+#include <string.h>
+#include <trace.h>
+#include <util.h>
+
+static unsigned int rng_lock = SPINLOCK_UNLOCK;
+static uint64_t rng_state;
+
+/* splitmix64 */
+static uint64_t next_word(void)
+{
+	uint64_t z = 0;
+
+	rng_state += 0x9e3779b97f4a7c15ULL ^ sys_counter_read();
+	z = rng_state;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+	return z ^ (z >> 31);
+}
+
+TEE_Result hw_get_random_bytes(void *buf, size_t len)
+{
+	uint32_t exceptions = cpu_spin_lock_xsave(&rng_lock);
+	uint8_t *b = buf;
+	uint64_t val = 0;
+	size_t l = 0;
+
+	while (len) {
+		val = next_word();
+		l = MIN(len, sizeof(val));
+		memcpy(b, &val, l);
+		b += l;
+		len -= l;
+	}
+
+	cpu_spin_unlock_xrestore(&rng_lock, exceptions);
+
+	return TEE_SUCCESS;
+}
+
+uint8_t hw_get_random_byte(void)
+{
+	uint8_t ret = 0;
+
+	hw_get_random_bytes(&ret, sizeof(ret));
+
+	return ret;
+}
+
+static TEE_Result soft_rng_init(void)
+{
+	IMSG("WARNING: Using the insecure software stand-in RNG");
+	return TEE_SUCCESS;
+}
+
+driver_init(soft_rng_init);
@@ -322,7 +322,7 @@ void stm32_etzpc_init(paddr_t base)
 static TEE_Result init_etzpc_from_dt(void)
 {
 	void *fdt = get_embedded_dt();
-	int node = fdt_node_offset_by_compatible(fdt, -1, ETZPC_COMPAT);
+	int node = dt_node_offset_by_compatible(fdt, -1, ETZPC_COMPAT);
 	int status;
 	paddr_t pbase;
 
@@ -330,7 +330,7 @@ static TEE_Result init_etzpc_from_dt(void)
 
 	if (node < 0)
 		panic();
-	assert(fdt_node_offset_by_compatible(fdt, node, ETZPC_COMPAT) < 0);
+	assert(dt_node_offset_by_compatible(fdt, node, ETZPC_COMPAT) < 0);
 
 	status = _fdt_get_status(fdt, node);
 	if (!(status & DT_STATUS_OK_SEC))
@@ -127,6 +127,33 @@ int _fdt_get_status(const void *fdt, int offs);
  */
 void _fdt_fill_device_info(void *fdt, struct dt_node_info *info, int node);
 
+/*
+ * Indexed lookups
+ *
+ * dt_index_init() walks the device tree once and indexes its nodes by
+ * compatible string, phandle, path and parent. The functions below return
+ * the same as their libfdt counterparts but use the index when called with
+ * the indexed tree, and fall back to libfdt otherwise. The tree must not
+ * be modified once indexed, only the read-only embedded DTB is indexed.
+ *
+ * dt_index_init() returns 0 on success or -1 if the tree can't be indexed,
+ * in which case lookups keep using libfdt.
+ */
+int dt_index_init(const void *fdt);
+
+/* Same as fdt_node_offset_by_compatible() */
+int dt_node_offset_by_compatible(const void *fdt, int startoffset,
+				 const char *compatible);
+
+/* Same as fdt_node_offset_by_phandle() */
+int dt_node_offset_by_phandle(const void *fdt, uint32_t phandle);
+
+/* Same as fdt_path_offset() */
+int dt_path_offset(const void *fdt, const char *path);
+
+/* Same as fdt_parent_offset() */
+int dt_parent_offset(const void *fdt, int offs);
+
 #else /* !CFG_DT */
 
 static inline const struct dt_driver *__dt_driver_start(void)
@@ -169,6 +196,36 @@ static inline int _fdt_get_status(const void *fdt __unused, int offs __unused)
 	return -1;
 }
 
+static inline int dt_index_init(const void *fdt __unused)
+{
+	return -1;
+}
+
+static inline int dt_node_offset_by_compatible(const void *fdt __unused,
+					       int startoffset __unused,
+					       const char *compatible __unused)
+{
+	return -1;
+}
+
+static inline int dt_node_offset_by_phandle(const void *fdt __unused,
+					    uint32_t phandle __unused)
+{
+	return -1;
+}
+
+static inline int dt_path_offset(const void *fdt __unused,
+				 const char *path __unused)
+{
+	return -1;
+}
+
+static inline int dt_parent_offset(const void *fdt __unused,
+				   int offs __unused)
+{
+	return -1;
+}
+
 static inline void _fdt_fill_device_info(void *fdt __unused,
 					 struct dt_node_info *info __unused,
 					 int node __unused)
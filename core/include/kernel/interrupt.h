@@ -9,9 +9,16 @@
 #include <sys/queue.h>
 
 #define ITRF_TRIGGER_LEVEL	(1 << 0)
+/*
+ * The interrupt line may be shared with other handlers, all handlers
+ * registered for the same interrupt must have this flag
+ */
+#define ITRF_SHARED		(1 << 1)
 
+/* @max_it: the largest interrupt number of the chip */
 struct itr_chip {
 	const struct itr_ops *ops;
+	size_t max_it;
 };
 
 struct itr_ops {
@@ -38,10 +45,32 @@ struct itr_handler {
 	SLIST_ENTRY(itr_handler) link;
 };
 
+/*
+ * Statistics of an interrupt, times are in system counter ticks (CNTPCT),
+ * 0 without CFG_CORE_HAS_GENERIC_TIMER
+ *
+ * @it:		Interrupt number
+ * @count:	Number of times the interrupt has been handled
+ * @total_ticks: Accumulated time spent in the handlers
+ * @max_ticks:	Longest time spent in the handlers
+ */
+struct itr_stats {
+	uint32_t it;
+	uint32_t count;
+	uint64_t total_ticks;
+	uint64_t max_ticks;
+};
+
 void itr_init(struct itr_chip *data);
 void itr_handle(size_t it);
 
 void itr_add(struct itr_handler *handler);
+/*
+ * Unregisters a handler added with itr_add(), the interrupt is disabled
+ * if it was the last handler. The caller must make sure that the
+ * interrupt isn't being handled concurrently.
+ */
+void itr_remove(struct itr_handler *handler);
 void itr_enable(size_t it);
 void itr_disable(size_t it);
 /* raise the Peripheral Interrupt corresponding to the interrupt ID */
@@ -57,4 +86,12 @@ void itr_raise_sgi(size_t it, uint8_t cpu_mask);
  */
 void itr_set_affinity(size_t it, uint8_t cpu_mask);
 
+#ifdef CFG_WITH_STATS
+/*
+ * Copies the statistics of at most @count interrupts which have a handler
+ * into @stats and returns the number of such interrupts
+ */
+size_t itr_get_stats(struct itr_stats *stats, size_t count);
+#endif
+
 #endif /*__KERNEL_INTERRUPT_H*/
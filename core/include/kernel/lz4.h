@@ -0,0 +1,29 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#ifndef __KERNEL_LZ4_H
+#define __KERNEL_LZ4_H
+
+#include <stddef.h>
+#include <tee_api_types.h>
+
+/*
+ * Decompresses a block in the LZ4 block format, without the frame format
+ * around it, as produced by LZ4_compress_default() or
+ * scripts/ta_bin_to_c.py
+ *
+ * @src:	Compressed block
+ * @src_len:	Length of @src
+ * @dst:	Output buffer
+ * @dst_len:	Uncompressed size of the block, the output must fill @dst
+ *
+ * The block may not reference data before @dst. Returns
+ * TEE_ERROR_BAD_FORMAT if the block is malformed or doesn't decompress
+ * to exactly @dst_len bytes.
+ */
+TEE_Result lz4_decompress_block(const void *src, size_t src_len, void *dst,
+				size_t dst_len);
+
+#endif /*__KERNEL_LZ4_H*/
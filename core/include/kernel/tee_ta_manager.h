@@ -14,6 +14,7 @@
 #include <kernel/tee_common.h>
 #include <kernel/mutex.h>
 #include <tee_api_types.h>
+#include <tee_syscall_numbers.h>
 #include <user_ta_header.h>
 
 /* Magic TEE identity pointer: set when teecore requests a TA close */
@@ -74,6 +75,38 @@ struct sample_buf {
 };
 #endif
 
+#if defined(CFG_WITH_STATS)
+/* Indexed by TEE_ALG_GET_CLASS(), that is TEE_OPERATION_* */
+#define TEE_TA_ACCT_NB_CRYPTO_CLASSES	16
+
+/*
+ * Resource accounting of a TA session or context, times are in system
+ * counter ticks (CNTPCT). Sessions of a TA executing concurrently may lose
+ * updates of the context counters, which are thus approximate in that case.
+ *
+ * @user_ticks:		Time spent in user mode
+ * @kernel_ticks:	Time spent in system calls, including RPCs
+ * @rpc_count:		Number of RPCs to normal world
+ * @rpc_ticks:		Time spent waiting for normal world in RPCs
+ * @storage_read:	Bytes read from persistent objects
+ * @storage_written:	Bytes written to persistent objects
+ * @page_faults:	Number of faults handled by the pager
+ * @crypto_bytes:	Bytes supplied to crypto operations, by class
+ * @syscalls:		Number of system calls, by number
+ */
+struct tee_ta_acct {
+	uint64_t user_ticks;
+	uint64_t kernel_ticks;
+	uint64_t rpc_count;
+	uint64_t rpc_ticks;
+	uint64_t storage_read;
+	uint64_t storage_written;
+	uint64_t page_faults;
+	uint64_t crypto_bytes[TEE_TA_ACCT_NB_CRYPTO_CLASSES];
+	uint32_t syscalls[TEE_SCN_MAX + 1];
+};
+#endif
+
 /* Context of a loaded TA */
 struct tee_ta_ctx {
 	TEE_UUID uuid;
@@ -85,6 +118,9 @@ struct tee_ta_ctx {
 	uint32_t ref_count;	/* Reference counter for multi session TA */
 	bool busy;		/* context is busy and cannot be entered */
 	struct condvar busy_cv;	/* CV used when context is busy */
+#if defined(CFG_WITH_STATS)
+	struct tee_ta_acct acct; /* Totals of all sessions */
+#endif
 };
 
 struct tee_ta_session {
@@ -105,6 +141,10 @@ struct tee_ta_session {
 #if defined(CFG_TA_GPROF_SUPPORT)
 	struct sample_buf *sbuf; /* Profiling data (PC sampling) */
 #endif
+#if defined(CFG_WITH_STATS)
+	struct tee_ta_acct acct; /* Resource accounting */
+	uint64_t usr_entered;	/* When this session last entered user mode */
+#endif
 };
 
 /* Registered contexts */
@@ -162,12 +202,51 @@ void tee_ta_dump_current(void);
 
 #if defined(CFG_TA_GPROF_SUPPORT)
 void tee_ta_gprof_sample_pc(vaddr_t pc);
+#else
+static inline void tee_ta_gprof_sample_pc(vaddr_t pc __unused) {}
+#endif
+
+#if defined(CFG_TA_GPROF_SUPPORT) || defined(CFG_WITH_STATS)
 void tee_ta_update_session_utime_suspend(void);
 void tee_ta_update_session_utime_resume(void);
 #else
-static inline void tee_ta_gprof_sample_pc(vaddr_t pc __unused) {}
 static inline void tee_ta_update_session_utime_suspend(void) {}
 static inline void tee_ta_update_session_utime_resume(void) {}
 #endif
 
+#if defined(CFG_WITH_STATS)
+/*
+ * Accounting of the current session, the functions are no-ops when called
+ * outside of a session. tee_ta_acct_syscall_enter() and
+ * tee_ta_acct_rpc_begin() return a timestamp to be supplied to
+ * tee_ta_acct_syscall_exit() and tee_ta_acct_rpc_end() respectively.
+ */
+uint64_t tee_ta_acct_syscall_enter(size_t scn);
+void tee_ta_acct_syscall_exit(uint64_t entered);
+uint64_t tee_ta_acct_rpc_begin(void);
+void tee_ta_acct_rpc_end(uint64_t begin);
+void tee_ta_acct_page_fault(void);
+void tee_ta_acct_storage(struct tee_ta_session *s, size_t read,
+			 size_t written);
+void tee_ta_acct_crypto(struct tee_ta_session *s, uint32_t algo, size_t len);
+#else
+static inline uint64_t tee_ta_acct_syscall_enter(size_t scn __unused)
+{
+	return 0;
+}
+static inline void tee_ta_acct_syscall_exit(uint64_t entered __unused) {}
+static inline uint64_t tee_ta_acct_rpc_begin(void)
+{
+	return 0;
+}
+static inline void tee_ta_acct_rpc_end(uint64_t begin __unused) {}
+static inline void tee_ta_acct_page_fault(void) {}
+static inline void tee_ta_acct_storage(struct tee_ta_session *s __unused,
+				       size_t read __unused,
+				       size_t written __unused) {}
+static inline void tee_ta_acct_crypto(struct tee_ta_session *s __unused,
+				      uint32_t algo __unused,
+				      size_t len __unused) {}
+#endif
+
 #endif
@@ -0,0 +1,157 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+#ifndef KERNEL_TRACEPOINT_H
+#define KERNEL_TRACEPOINT_H
+
+#include <assert.h>
+#include <pta_tracepoint.h>
+#include <string.h>
+#include <tee_api_types.h>
+#include <types_ext.h>
+
+/*
+ * Static tracepoints recording binary events in per-CPU ring buffers, see
+ * <pta_tracepoint.h> for the buffer format. With CFG_CORE_TRACEPOINTS=n
+ * all the tp_*() helpers below are empty and compiled out.
+ */
+
+#ifdef CFG_CORE_TRACEPOINTS
+void tp_record(unsigned int id, unsigned int phase, uint32_t arg0,
+	       uint64_t arg1, uint64_t arg2);
+
+/*
+ * Starts recording events into @buf which must be large enough to hold
+ * the header and @events_per_cpu events for each CPU, as returned by
+ * tp_buf_size(). @events_per_cpu must be a power of two.
+ */
+TEE_Result tp_start(void *buf, size_t events_per_cpu);
+
+/* Stops recording, the buffer supplied to tp_start() isn't used after this */
+void tp_stop(void);
+
+/* Pauses or resumes recording into the buffer supplied to tp_start() */
+void tp_pause(bool pause);
+
+size_t tp_buf_size(size_t events_per_cpu);
+#else
+static inline void tp_record(unsigned int id __unused,
+			     unsigned int phase __unused,
+			     uint32_t arg0 __unused, uint64_t arg1 __unused,
+			     uint64_t arg2 __unused)
+{
+}
+#endif
+
+static inline void tp_std_smc_begin(uint32_t a0, uint32_t a1)
+{
+	tp_record(TP_EVENT_STD_SMC, TP_PHASE_BEGIN, a0, a1, 0);
+}
+
+static inline void tp_std_smc_end(uint32_t a0)
+{
+	tp_record(TP_EVENT_STD_SMC, TP_PHASE_END, a0, 0, 0);
+}
+
+static inline void tp_fast_smc_begin(uint32_t a0)
+{
+	tp_record(TP_EVENT_FAST_SMC, TP_PHASE_BEGIN, a0, 0, 0);
+}
+
+static inline void tp_fast_smc_end(uint32_t a0)
+{
+	tp_record(TP_EVENT_FAST_SMC, TP_PHASE_END, a0, 0, 0);
+}
+
+static inline void tp_thread_alloc(size_t thread_id)
+{
+	tp_record(TP_EVENT_THREAD_ALLOC, TP_PHASE_INSTANT, thread_id, 0, 0);
+}
+
+static inline void tp_thread_suspend(uint32_t flags, vaddr_t pc)
+{
+	tp_record(TP_EVENT_THREAD_SUSPEND, TP_PHASE_INSTANT, flags, pc, 0);
+}
+
+static inline void tp_thread_resume(size_t thread_id)
+{
+	tp_record(TP_EVENT_THREAD_RESUME, TP_PHASE_INSTANT, thread_id, 0, 0);
+}
+
+static inline void tp_rpc_begin(uint32_t cmd)
+{
+	tp_record(TP_EVENT_RPC, TP_PHASE_BEGIN, cmd, 0, 0);
+}
+
+static inline void tp_rpc_end(uint32_t cmd, uint32_t res)
+{
+	tp_record(TP_EVENT_RPC, TP_PHASE_END, cmd, res, 0);
+}
+
+static inline void tp_pager_fault_begin(vaddr_t va)
+{
+	tp_record(TP_EVENT_PAGER_FAULT, TP_PHASE_BEGIN, 0, va, 0);
+}
+
+static inline void tp_pager_fault_end(bool handled)
+{
+	tp_record(TP_EVENT_PAGER_FAULT, TP_PHASE_END, handled, 0, 0);
+}
+
+static inline void tp_pager_load(unsigned int area_type, vaddr_t page_va)
+{
+	tp_record(TP_EVENT_PAGER_LOAD, TP_PHASE_INSTANT, area_type, page_va, 0);
+}
+
+static inline void tp_pager_evict(vaddr_t page_va)
+{
+	tp_record(TP_EVENT_PAGER_EVICT, TP_PHASE_INSTANT, 0, page_va, 0);
+}
+
+static inline void tp_storage_read_begin(size_t block_num)
+{
+	tp_record(TP_EVENT_STORAGE_READ, TP_PHASE_BEGIN, 0, block_num, 0);
+}
+
+static inline void tp_storage_read_end(TEE_Result res)
+{
+	tp_record(TP_EVENT_STORAGE_READ, TP_PHASE_END, res, 0, 0);
+}
+
+static inline void tp_storage_write_begin(size_t block_num)
+{
+	tp_record(TP_EVENT_STORAGE_WRITE, TP_PHASE_BEGIN, 0, block_num, 0);
+}
+
+static inline void tp_storage_write_end(TEE_Result res)
+{
+	tp_record(TP_EVENT_STORAGE_WRITE, TP_PHASE_END, res, 0, 0);
+}
+
+static inline void tp_crypto_begin(uint32_t algo, size_t len)
+{
+	tp_record(TP_EVENT_CRYPTO, TP_PHASE_BEGIN, algo, len, 0);
+}
+
+static inline void tp_crypto_end(uint32_t algo, TEE_Result res)
+{
+	tp_record(TP_EVENT_CRYPTO, TP_PHASE_END, algo, res, 0);
+}
+
+static inline void tp_ta_load_begin(const TEE_UUID *uuid)
+{
+	uint64_t a[2] = { 0 };
+
+	COMPILE_TIME_ASSERT(sizeof(*uuid) - sizeof(uuid->timeLow) ==
+			    sizeof(uint64_t) + sizeof(uint32_t));
+	memcpy(a, &uuid->timeMid, sizeof(*uuid) - sizeof(uuid->timeLow));
+	tp_record(TP_EVENT_TA_LOAD, TP_PHASE_BEGIN, uuid->timeLow, a[0], a[1]);
+}
+
+static inline void tp_ta_load_end(TEE_Result res)
+{
+	tp_record(TP_EVENT_TA_LOAD, TP_PHASE_END, res, 0, 0);
+}
+
+#endif /*KERNEL_TRACEPOINT_H*/
@@ -6,10 +6,24 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <tee_api_types.h>
 #include <mm/core_mmu.h>
 
 #define HYP_CLNT_ID 0
 
+/*
+ * Per guest statistics, each guest has its own pool of CFG_NUM_THREADS
+ * threads
+ * @std_calls:		Number of std calls received from the guest
+ * @thread_limit:	Number of std calls rejected with
+ *			OPTEE_SMC_RETURN_ETHREAD_LIMIT because all threads
+ *			of the guest were busy
+ */
+struct virt_guest_stats {
+	uint32_t std_calls;
+	uint32_t thread_limit;
+};
+
 /**
  * virt_guest_created() - create new VM partition
  * @guest_id: VM id provided by hypervisor
@@ -61,9 +75,25 @@ void virt_unset_guest(void);
  * virt_on_stdcall() - std call hook
  *
  * This hook is called on every std call, but really is needed
- * only once: to initialize TEE runtime for current guest VM
+ * only once: to allocate TA RAM and initialize TEE runtime for
+ * current guest VM
+ *
+ * Return: TEE_SUCCESS or TEE_ERROR_OUT_OF_MEMORY if TA RAM
+ * couldn't be allocated, in which case the call must be failed
+ */
+TEE_Result virt_on_stdcall(void);
+
+/**
+ * virt_account_std_call() - account a std call to the current guest VM
+ * @rejected: true if no thread was available to serve the call
+ */
+void virt_account_std_call(bool rejected);
+
+/**
+ * virt_get_stats() - get statistics of the current guest VM
+ * @stats: statistics returned here
  */
-void virt_on_stdcall(void);
+void virt_get_stats(struct virt_guest_stats *stats);
 
 /*
  * Next function are needed because virtualization subsystem manages
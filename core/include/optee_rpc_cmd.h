@@ -6,6 +6,8 @@
 #ifndef __OPTEE_RPC_CMD_H
 #define __OPTEE_RPC_CMD_H
 
+#include <stdint.h>
+
 /*
  * All RPC is done with a struct optee_msg_arg as bearer of information,
  * struct optee_msg_arg::arg holds values defined by OPTEE_RPC_CMD_* below.
@@ -313,6 +315,81 @@
  */
 #define OPTEE_RPC_SOCKET_IOCTL	5
 
+/*
+ * Switch the data path of a TCP socket to rings in shared memory
+ *
+ * [in]     value[0].a	    OPTEE_RPC_SOCKET_RING_SETUP
+ * [in]     value[0].b	    TA instance id
+ * [in]     value[0].c	    Socket handle
+ * [in]     memref[1]	    Rings, see struct optee_socket_ring
+ *
+ * The shared memory stays registered until the socket is closed. Data
+ * is then transmitted by producing into the transmit ring and received
+ * by consuming from the receive ring, OPTEE_RPC_SOCKET_SEND and
+ * OPTEE_RPC_SOCKET_RECV aren't used for the socket any longer.
+ */
+#define OPTEE_RPC_SOCKET_RING_SETUP	6
+
+/*
+ * Wait until there's free space in the transmit ring or data in the
+ * receive ring of a socket
+ *
+ * [in]     value[0].a	    OPTEE_RPC_SOCKET_RING_WAIT
+ * [in]     value[0].b	    TA instance id
+ * [in]     value[0].c	    Socket handle
+ * [in]     value[1].a	    OPTEE_SOCKET_RING_TX or OPTEE_SOCKET_RING_RX
+ * [in]     value[1].b	    Timeout ms or OPTEE_RPC_SOCKET_TIMEOUT_*
+ */
+#define OPTEE_RPC_SOCKET_RING_WAIT	7
+
+/*
+ * Wake up tee-supplicant waiting for data in the transmit ring or for
+ * free space in the receive ring of a socket, only sent if it has set
+ * cons_waiting or prod_waiting respectively
+ *
+ * [in]     value[0].a	    OPTEE_RPC_SOCKET_RING_KICK
+ * [in]     value[0].b	    TA instance id
+ * [in]     value[0].c	    Socket handle
+ * [in]     value[1].a	    OPTEE_SOCKET_RING_TX or OPTEE_SOCKET_RING_RX
+ */
+#define OPTEE_RPC_SOCKET_RING_KICK	8
+
+#define OPTEE_SOCKET_RING_TX	0
+#define OPTEE_SOCKET_RING_RX	1
+
+/*
+ * Header of a ring passed with OPTEE_RPC_SOCKET_RING_SETUP, the shared
+ * memory holds the transmit ring followed by the receive ring, each a
+ * header directly followed by @size bytes of data.
+ *
+ * @prod:	Free running count of bytes produced, only written by the
+ *		producer
+ * @cons:	Free running count of bytes consumed, only written by the
+ *		consumer
+ * @size:	Size of the data, a power of two
+ * @cons_waiting: Set by tee-supplicant when it waits for data in the
+ *		transmit ring
+ * @prod_waiting: Set by tee-supplicant when it waits for free space in
+ *		the receive ring
+ *
+ * OP-TEE publishes @prod of the transmit ring or @cons of the receive
+ * ring, issues a full barrier and then reads the waiting flag to decide
+ * whether to send OPTEE_RPC_SOCKET_RING_KICK. Before sleeping,
+ * tee-supplicant must likewise set the waiting flag, issue a full barrier
+ * (e.g. __atomic_thread_fence(__ATOMIC_SEQ_CST)) and check the ring
+ * again, only sleeping if it's still empty or full. Otherwise both sides
+ * may miss the store of the other and the wakeup is lost. The flag is
+ * cleared once tee-supplicant has woken up.
+ */
+struct optee_socket_ring {
+	uint32_t prod;
+	uint32_t cons;
+	uint32_t size;
+	uint32_t cons_waiting;
+	uint32_t prod_waiting;
+	uint32_t pad[3];
+};
+
 /* End of definition of protocol for command OPTEE_RPC_CMD_SOCKET */
 
 #endif /*__OPTEE_RPC_CMD_H*/
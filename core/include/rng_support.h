@@ -5,8 +5,17 @@
 #ifndef __RNG_SUPPORT_H__
 #define __RNG_SUPPORT_H__
 
+#include <stddef.h>
 #include <stdint.h>
+#include <tee_api_types.h>
 
 uint8_t hw_get_random_byte(void);
 
+/*
+ * Fills @buf with @len bytes from the hardware RNG. Drivers should
+ * implement this to read whole words from the device at once, the
+ * default implementation calls hw_get_random_byte() for each byte.
+ */
+TEE_Result hw_get_random_bytes(void *buf, size_t len);
+
 #endif /* __RNG_SUPPORT_H__ */
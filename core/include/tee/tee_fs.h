@@ -23,6 +23,7 @@ struct tee_fs_dirent {
 struct tee_fs_dir;
 struct tee_file_handle;
 struct tee_pobj;
+struct tee_ta_ctx;
 
 /*
  * tee_fs implements a POSIX like secure file system with GP extension
@@ -48,6 +49,18 @@ struct tee_file_operations {
 	TEE_Result (*opendir)(const TEE_UUID *uuid, struct tee_fs_dir **d);
 	TEE_Result (*readdir)(struct tee_fs_dir *d, struct tee_fs_dirent **ent);
 	void (*closedir)(struct tee_fs_dir *d);
+
+	/*
+	 * Optional, changes made by @ctx until end_transaction() are
+	 * committed to storage together or not at all. Until the
+	 * transaction has ended begin_transaction() returns
+	 * TEE_ERROR_BUSY to other contexts and the other operations
+	 * return TEE_ERROR_STORAGE_NOT_AVAILABLE.
+	 * The transaction is aborted if @commit is false or if any of the
+	 * changes failed, end_transaction() then returns the error.
+	 */
+	TEE_Result (*begin_transaction)(struct tee_ta_ctx *ctx);
+	TEE_Result (*end_transaction)(struct tee_ta_ctx *ctx, bool commit);
 };
 
 #ifdef CFG_REE_FS
@@ -63,8 +63,16 @@ TEE_Result syscall_storage_obj_trunc(unsigned long obj, size_t len);
 TEE_Result syscall_storage_obj_seek(unsigned long obj, int32_t offset,
 				    unsigned long whence);
 
+TEE_Result syscall_storage_tx_begin(unsigned long storage_id);
+
+TEE_Result syscall_storage_tx_end(unsigned long storage_id,
+				  unsigned long commit);
+
 void tee_svc_storage_close_all_enum(struct user_ta_ctx *utc);
 
+/* Aborts the storage transactions of a TA which is being destroyed */
+void tee_svc_storage_abort_all_tx(struct user_ta_ctx *utc);
+
 void tee_svc_storage_init(void);
 
 struct tee_pobj;
@@ -48,10 +48,10 @@ static int find_chosen_node(void *fdt)
 	if (!fdt)
 		return -1;
 
-	int offset = fdt_path_offset(fdt, "/secure-chosen");
+	int offset = dt_path_offset(fdt, "/secure-chosen");
 
 	if (offset < 0)
-		offset = fdt_path_offset(fdt, "/chosen");
+		offset = dt_path_offset(fdt, "/chosen");
 
 	return offset;
 }
@@ -107,7 +107,7 @@ TEE_Result get_console_node_from_dt(void **fdt_out, int *offs_out,
 		/* Not an alias, assume we have a node path */
 		uart = stdout_data;
 	}
-	offs = fdt_path_offset(fdt, uart);
+	offs = dt_path_offset(fdt, uart);
 	if (offs >= 0) {
 		if (fdt_out)
 			*fdt_out = fdt;
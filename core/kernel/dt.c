@@ -16,14 +16,21 @@ const struct dt_driver *dt_find_compatible_driver(const void *fdt, int offs)
 {
 	const struct dt_device_match *dm;
 	const struct dt_driver *drv;
+	const char *compat;
+	int len;
+
+	/* Look up the property once instead of once per match entry */
+	compat = fdt_getprop(fdt, offs, "compatible", &len);
+	if (!compat)
+		return NULL;
 
 	for_each_dt_driver(drv) {
 		for (dm = drv->match_table; dm; dm++) {
 			if (!dm->compatible) {
 				break;
 			}
-			if (!fdt_node_check_compatible(fdt, offs,
-						       dm->compatible)) {
+			if (fdt_stringlist_contains(compat, len,
+						    dm->compatible)) {
 				return drv;
 			}
 		}
@@ -132,7 +139,7 @@ paddr_t _fdt_reg_base_address(const void *fdt, int offs)
 	int len;
 	int parent;
 
-	parent = fdt_parent_offset(fdt, offs);
+	parent = dt_parent_offset(fdt, offs);
 	if (parent < 0)
 		return DT_INFO_INVALID_REG;
 
@@ -155,7 +162,7 @@ ssize_t _fdt_reg_size(const void *fdt, int offs)
 	int len;
 	int parent;
 
-	parent = fdt_parent_offset(fdt, offs);
+	parent = dt_parent_offset(fdt, offs);
 	if (parent < 0)
 		return DT_INFO_INVALID_REG;
 
@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <kernel/dt.h>
+#include <libfdt.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <trace.h>
+
+/*
+ * Index of a device tree which is never modified, built by one walk over
+ * the tree. Nodes are recorded in the order they appear in the blob, so
+ * that the nodes array is sorted by offset. The other arrays map a key to
+ * a node offset and are sorted by key and then offset:
+ * - compat: hash of each string of the "compatible" property
+ * - phandle: phandle of the node
+ * - path: hash of the full path of the node
+ *
+ * Hashes may collide, so a lookup checks each candidate against the
+ * blob before returning it.
+ */
+
+#define DT_INDEX_MAX_DEPTH	32
+
+struct dt_index_node {
+	int offs;
+	int parent;	/* Index in nodes[] of the parent, -1 for the root */
+};
+
+struct dt_index_ent {
+	uint32_t key;
+	int offs;
+};
+
+struct dt_index {
+	const void *fdt;
+	struct dt_index_node *nodes;
+	size_t num_nodes;
+	struct dt_index_ent *compat;
+	size_t num_compat;
+	struct dt_index_ent *phandle;
+	size_t num_phandle;
+	struct dt_index_ent *path;
+};
+
+static struct dt_index dt_index;
+
+/* FNV-1a */
+static uint32_t hash_cont(uint32_t h, const char *s, size_t len)
+{
+	size_t n = 0;
+
+	for (n = 0; n < len; n++)
+		h = (h ^ (uint8_t)s[n]) * 16777619;
+
+	return h;
+}
+
+static uint32_t hash_str(const char *s, size_t len)
+{
+	return hash_cont(2166136261, s, len);
+}
+
+static int cmp_ent(const void *a, const void *b)
+{
+	const struct dt_index_ent *ea = a;
+	const struct dt_index_ent *eb = b;
+
+	if (ea->key != eb->key)
+		return ea->key < eb->key ? -1 : 1;
+	if (ea->offs != eb->offs)
+		return ea->offs < eb->offs ? -1 : 1;
+	return 0;
+}
+
+/* Returns the index of the first entry not less than @key, @offs */
+static size_t find_ent(const struct dt_index_ent *ents, size_t num_ents,
+		       uint32_t key, int offs)
+{
+	const struct dt_index_ent e = { .key = key, .offs = offs };
+	size_t lo = 0;
+	size_t hi = num_ents;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (cmp_ent(ents + mid, &e) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/* Returns the index of the node at @offs or -1 if there's none */
+static int find_node(int offs)
+{
+	size_t lo = 0;
+	size_t hi = dt_index.num_nodes;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (dt_index.nodes[mid].offs == offs)
+			return mid;
+		if (dt_index.nodes[mid].offs < offs)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return -1;
+}
+
+static void index_free(struct dt_index *ix)
+{
+	nex_free(ix->nodes);
+	nex_free(ix->compat);
+	nex_free(ix->phandle);
+	nex_free(ix->path);
+	memset(ix, 0, sizeof(*ix));
+}
+
+static int index_count(const void *fdt, struct dt_index *ix)
+{
+	uint32_t phandle = 0;
+	int offs = 0;
+	int depth = 0;
+	int n = 0;
+
+	for (offs = 0; offs >= 0 && depth >= 0;
+	     offs = fdt_next_node(fdt, offs, &depth)) {
+		if (depth >= DT_INDEX_MAX_DEPTH)
+			return -1;
+		ix->num_nodes++;
+		n = fdt_stringlist_count(fdt, offs, "compatible");
+		if (n > 0)
+			ix->num_compat += n;
+		phandle = fdt_get_phandle(fdt, offs);
+		if (phandle && phandle != (uint32_t)-1)
+			ix->num_phandle++;
+	}
+	if (offs != -FDT_ERR_NOTFOUND && depth >= 0)
+		return -1;
+
+	return 0;
+}
+
+static int index_fill(const void *fdt, struct dt_index *ix)
+{
+	uint32_t path_hash[DT_INDEX_MAX_DEPTH] = { 0 };
+	int parent[DT_INDEX_MAX_DEPTH] = { 0 };
+	const char *name = NULL;
+	const char *s = NULL;
+	size_t num_compat = 0;
+	size_t num_phandle = 0;
+	size_t idx = 0;
+	uint32_t phandle = 0;
+	uint32_t h = 0;
+	int depth = 0;
+	int offs = 0;
+	int len = 0;
+	int n = 0;
+
+	for (offs = 0; offs >= 0 && depth >= 0;
+	     offs = fdt_next_node(fdt, offs, &depth), idx++) {
+		if (idx >= ix->num_nodes)
+			return -1;
+
+		name = fdt_get_name(fdt, offs, &len);
+		if (!name)
+			return -1;
+		if (!depth) {
+			h = hash_str("/", 1);
+			ix->nodes[idx].parent = -1;
+		} else {
+			h = path_hash[depth - 1];
+			if (depth > 1)
+				h = hash_cont(h, "/", 1);
+			h = hash_cont(h, name, len);
+			ix->nodes[idx].parent = parent[depth - 1];
+		}
+		path_hash[depth] = h;
+		parent[depth] = idx;
+		ix->nodes[idx].offs = offs;
+		ix->path[idx].key = h;
+		ix->path[idx].offs = offs;
+
+		s = fdt_getprop(fdt, offs, "compatible", &len);
+		while (s && len > 0) {
+			n = strnlen(s, len);
+			if (n == len || num_compat >= ix->num_compat)
+				return -1;
+			ix->compat[num_compat].key = hash_str(s, n);
+			ix->compat[num_compat].offs = offs;
+			num_compat++;
+			s += n + 1;
+			len -= n + 1;
+		}
+
+		phandle = fdt_get_phandle(fdt, offs);
+		if (phandle && phandle != (uint32_t)-1) {
+			if (num_phandle >= ix->num_phandle)
+				return -1;
+			ix->phandle[num_phandle].key = phandle;
+			ix->phandle[num_phandle].offs = offs;
+			num_phandle++;
+		}
+	}
+
+	if (idx != ix->num_nodes || num_compat != ix->num_compat ||
+	    num_phandle != ix->num_phandle)
+		return -1;
+
+	qsort(ix->compat, ix->num_compat, sizeof(*ix->compat), cmp_ent);
+	qsort(ix->phandle, ix->num_phandle, sizeof(*ix->phandle), cmp_ent);
+	qsort(ix->path, ix->num_nodes, sizeof(*ix->path), cmp_ent);
+
+	return 0;
+}
+
+int dt_index_init(const void *fdt)
+{
+	struct dt_index ix = { .fdt = fdt };
+
+	if (index_count(fdt, &ix))
+		goto err;
+
+	ix.nodes = nex_calloc(ix.num_nodes, sizeof(*ix.nodes));
+	ix.path = nex_calloc(ix.num_nodes, sizeof(*ix.path));
+	ix.compat = nex_calloc(ix.num_compat + 1, sizeof(*ix.compat));
+	ix.phandle = nex_calloc(ix.num_phandle + 1, sizeof(*ix.phandle));
+	if (!ix.nodes || !ix.path || !ix.compat || !ix.phandle)
+		goto err;
+
+	if (index_fill(fdt, &ix))
+		goto err;
+
+	index_free(&dt_index);
+	dt_index = ix;
+	DMSG("Indexed %zu nodes, %zu compatible, %zu phandles",
+	     ix.num_nodes, ix.num_compat, ix.num_phandle);
+	return 0;
+err:
+	EMSG("Can't index DTB, using plain lookups");
+	index_free(&ix);
+	return -1;
+}
+
+int dt_node_offset_by_compatible(const void *fdt, int startoffset,
+				 const char *compatible)
+{
+	uint32_t key = 0;
+	size_t n = 0;
+
+	if (!fdt || fdt != dt_index.fdt)
+		return fdt_node_offset_by_compatible(fdt, startoffset,
+						     compatible);
+
+	key = hash_str(compatible, strlen(compatible));
+	n = find_ent(dt_index.compat, dt_index.num_compat, key,
+		     startoffset + 1);
+	for (; n < dt_index.num_compat && dt_index.compat[n].key == key; n++)
+		if (!fdt_node_check_compatible(fdt, dt_index.compat[n].offs,
+					       compatible))
+			return dt_index.compat[n].offs;
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+int dt_node_offset_by_phandle(const void *fdt, uint32_t phandle)
+{
+	size_t n = 0;
+
+	if (!fdt || fdt != dt_index.fdt || !phandle || phandle == (uint32_t)-1)
+		return fdt_node_offset_by_phandle(fdt, phandle);
+
+	n = find_ent(dt_index.phandle, dt_index.num_phandle, phandle, 0);
+	if (n < dt_index.num_phandle && dt_index.phandle[n].key == phandle)
+		return dt_index.phandle[n].offs;
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+/* Matches the names of node @idx and its parents with @path */
+static bool path_matches(const void *fdt, const char *path, size_t len,
+			 int idx)
+{
+	const char *name = NULL;
+	int nlen = 0;
+
+	while (dt_index.nodes[idx].parent >= 0) {
+		name = fdt_get_name(fdt, dt_index.nodes[idx].offs, &nlen);
+		if (!name || len < (size_t)nlen + 1 ||
+		    path[len - nlen - 1] != '/' ||
+		    memcmp(path + len - nlen, name, nlen))
+			return false;
+		len -= nlen + 1;
+		idx = dt_index.nodes[idx].parent;
+	}
+
+	return !len;
+}
+
+int dt_path_offset(const void *fdt, const char *path)
+{
+	size_t len = 0;
+	uint32_t key = 0;
+	size_t n = 0;
+	int idx = 0;
+
+	/* Aliases, "/" and unit addresses left out are resolved by libfdt */
+	if (!fdt || fdt != dt_index.fdt || path[0] != '/' || !path[1])
+		return fdt_path_offset(fdt, path);
+
+	len = strlen(path);
+	key = hash_str(path, len);
+	n = find_ent(dt_index.path, dt_index.num_nodes, key, 0);
+	for (; n < dt_index.num_nodes && dt_index.path[n].key == key; n++) {
+		idx = find_node(dt_index.path[n].offs);
+		if (idx >= 0 && path_matches(fdt, path, len, idx))
+			return dt_index.path[n].offs;
+	}
+
+	return fdt_path_offset(fdt, path);
+}
+
+int dt_parent_offset(const void *fdt, int offs)
+{
+	int idx = 0;
+
+	if (!fdt || fdt != dt_index.fdt || offs < 0)
+		return fdt_parent_offset(fdt, offs);
+
+	idx = find_node(offs);
+	if (idx < 0)
+		return fdt_parent_offset(fdt, offs);
+	if (dt_index.nodes[idx].parent < 0)
+		return -FDT_ERR_NOTFOUND;
+
+	return dt_index.nodes[dt_index.nodes[idx].parent].offs;
+}
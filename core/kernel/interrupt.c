@@ -3,8 +3,15 @@
  * Copyright (c) 2016, Linaro Limited
  */
 
+#include <arm.h>
 #include <kernel/interrupt.h>
+#include <kernel/misc.h>
+#include <kernel/panic.h>
+#include <kernel/sys_counter.h>
+#include <malloc.h>
+#include <string.h>
 #include <trace.h>
+#include <util.h>
 
 /*
  * NOTE!
@@ -14,35 +21,133 @@
  * we begin to modify settings after boot initialization.
  */
 
+/*
+ * Interrupts below this number are private to each CPU (SGIs and PPIs),
+ * the same interrupt may then be handled by several CPUs at once
+ */
+#define ITR_NUM_PRIVATE		32
+
+/*
+ * @handlers:	Handlers registered for the interrupt, more than one only
+ *		if they all have ITRF_SHARED
+ * @stats:	Statistics of a shared peripheral interrupt, which is only
+ *		active on one CPU at a time
+ */
+struct itr_desc {
+	SLIST_HEAD(, itr_handler) handlers;
+#ifdef CFG_WITH_STATS
+	struct itr_stats stats;
+#endif
+};
+
 static struct itr_chip *itr_chip;
-static SLIST_HEAD(, itr_handler) handlers = SLIST_HEAD_INITIALIZER(handlers);
+
+/* Indexed by interrupt number, itr_chip->max_it + 1 entries */
+static struct itr_desc *itr_descs;
+
+#ifdef CFG_WITH_STATS
+static struct itr_stats itr_private_stats[CFG_TEE_CORE_NB_CORE]
+					 [ITR_NUM_PRIVATE];
+#endif
 
 void itr_init(struct itr_chip *chip)
 {
 	itr_chip = chip;
+	itr_descs = nex_calloc(chip->max_it + 1, sizeof(*itr_descs));
+	if (!itr_descs)
+		panic();
 }
 
-static struct itr_handler *find_handler(size_t it)
+#ifdef CFG_WITH_STATS
+static uint64_t stats_timestamp(void)
+{
+	return sys_counter_read();
+}
+
+/* Called with exceptions masked */
+static void update_stats(size_t it, uint64_t ticks)
+{
+	struct itr_stats *s = NULL;
+
+	if (it < ITR_NUM_PRIVATE)
+		s = &itr_private_stats[get_core_pos()][it];
+	else
+		s = &itr_descs[it].stats;
+
+	s->count++;
+	s->total_ticks += ticks;
+	s->max_ticks = MAX(s->max_ticks, ticks);
+}
+
+size_t itr_get_stats(struct itr_stats *stats, size_t count)
+{
+	struct itr_stats s = { 0 };
+	size_t num = 0;
+	size_t it = 0;
+	size_t n = 0;
+
+	if (!itr_chip)
+		return 0;
+
+	for (it = 0; it <= itr_chip->max_it; it++) {
+		if (SLIST_EMPTY(&itr_descs[it].handlers))
+			continue;
+
+		if (it < ITR_NUM_PRIVATE) {
+			memset(&s, 0, sizeof(s));
+			for (n = 0; n < CFG_TEE_CORE_NB_CORE; n++) {
+				s.count += itr_private_stats[n][it].count;
+				s.total_ticks +=
+					itr_private_stats[n][it].total_ticks;
+				s.max_ticks =
+					MAX(s.max_ticks,
+					    itr_private_stats[n][it].max_ticks);
+			}
+		} else {
+			s = itr_descs[it].stats;
+		}
+		s.it = it;
+
+		if (num < count)
+			stats[num] = s;
+		num++;
+	}
+
+	return num;
+}
+#else
+static uint64_t stats_timestamp(void)
 {
-	struct itr_handler *h;
+	return 0;
+}
 
-	SLIST_FOREACH(h, &handlers, link)
-		if (h->it == it)
-			return h;
-	return NULL;
+static void update_stats(size_t it __unused, uint64_t ticks __unused)
+{
 }
+#endif
 
 void itr_handle(size_t it)
 {
-	struct itr_handler *h = find_handler(it);
+	enum itr_return res = ITRR_NONE;
+	struct itr_handler *h = NULL;
+	uint64_t begin = 0;
 
-	if (!h) {
+	if (it > itr_chip->max_it || SLIST_EMPTY(&itr_descs[it].handlers)) {
 		EMSG("Disabling unhandled interrupt %zu", it);
 		itr_chip->ops->disable(itr_chip, it);
 		return;
 	}
 
-	if (h->handler(h) != ITRR_HANDLED) {
+	begin = stats_timestamp();
+
+	/* Shared handlers are all called, one of them may have cleared it */
+	SLIST_FOREACH(h, &itr_descs[it].handlers, link)
+		if (h->handler(h) == ITRR_HANDLED)
+			res = ITRR_HANDLED;
+
+	update_stats(it, stats_timestamp() - begin);
+
+	if (res != ITRR_HANDLED) {
 		EMSG("Disabling interrupt %zu not handled by handler", it);
 		itr_chip->ops->disable(itr_chip, it);
 	}
@@ -50,8 +155,35 @@ void itr_handle(size_t it)
 
 void itr_add(struct itr_handler *h)
 {
+	struct itr_handler *other = NULL;
+	struct itr_desc *d = NULL;
+
+	if (h->it > itr_chip->max_it)
+		panic();
+
+	d = itr_descs + h->it;
+	other = SLIST_FIRST(&d->handlers);
+	if (other && !(h->flags & other->flags & ITRF_SHARED)) {
+		EMSG("Interrupt %zu is already handled and isn't shared",
+		     h->it);
+		panic();
+	}
+
 	itr_chip->ops->add(itr_chip, h->it, h->flags);
-	SLIST_INSERT_HEAD(&handlers, h, link);
+	SLIST_INSERT_HEAD(&d->handlers, h, link);
+}
+
+void itr_remove(struct itr_handler *h)
+{
+	struct itr_desc *d = NULL;
+
+	if (h->it > itr_chip->max_it)
+		panic();
+
+	d = itr_descs + h->it;
+	SLIST_REMOVE(&d->handlers, h, itr_handler, link);
+	if (SLIST_EMPTY(&d->handlers))
+		itr_chip->ops->disable(itr_chip, h->it);
 }
 
 void itr_enable(size_t it)
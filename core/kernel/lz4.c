@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <kernel/lz4.h>
+#include <string.h>
+#include <types_ext.h>
+#include <util.h>
+
+#define LZ4_MIN_MATCH	4
+#define LZ4_LEN_MASK	0xf
+
+/* Adds the extra length bytes following a length of 15 in a token */
+static bool read_len(const uint8_t **ip, const uint8_t *iend, size_t max,
+		     size_t *len)
+{
+	uint8_t b = 0;
+
+	do {
+		if (*ip == iend)
+			return false;
+		b = *(*ip)++;
+		*len += b;
+		if (*len > max)
+			return false;
+	} while (b == 255);
+
+	return true;
+}
+
+TEE_Result lz4_decompress_block(const void *src, size_t src_len, void *dst,
+				size_t dst_len)
+{
+	const uint8_t *ip = src;
+	const uint8_t *iend = ip + src_len;
+	uint8_t *op = dst;
+	uint8_t *oend = op + dst_len;
+	uint8_t token = 0;
+	size_t offs = 0;
+	size_t len = 0;
+	size_t l = 0;
+
+	while (ip < iend) {
+		token = *ip++;
+
+		len = token >> 4;
+		if (len == LZ4_LEN_MASK && !read_len(&ip, iend, dst_len, &len))
+			return TEE_ERROR_BAD_FORMAT;
+		if (len > (size_t)(iend - ip) || len > (size_t)(oend - op))
+			return TEE_ERROR_BAD_FORMAT;
+		memcpy(op, ip, len);
+		op += len;
+		ip += len;
+
+		/* The last sequence has literals only */
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2)
+			return TEE_ERROR_BAD_FORMAT;
+		offs = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (!offs || offs > (size_t)(op - (uint8_t *)dst))
+			return TEE_ERROR_BAD_FORMAT;
+
+		len = token & LZ4_LEN_MASK;
+		if (len == LZ4_LEN_MASK && !read_len(&ip, iend, dst_len, &len))
+			return TEE_ERROR_BAD_FORMAT;
+		len += LZ4_MIN_MATCH;
+		if (len > (size_t)(oend - op))
+			return TEE_ERROR_BAD_FORMAT;
+
+		/*
+		 * A match may overlap the output, copy it in chunks of at
+		 * most @offs bytes which repeats the pattern.
+		 */
+		while (len) {
+			l = MIN(len, offs);
+			memcpy(op, op - offs, l);
+			op += l;
+			len -= l;
+		}
+	}
+
+	if (op != oend)
+		return TEE_ERROR_BAD_FORMAT;
+
+	return TEE_SUCCESS;
+}
@@ -6,6 +6,7 @@
 
 #include <kernel/panic.h>
 #include <kernel/thread.h>
+#include <kernel/trace_ext.h>
 #include <trace.h>
 
 void __do_panic(const char *file __maybe_unused,
@@ -18,6 +19,9 @@ void __do_panic(const char *file __maybe_unused,
 
 	/* TODO: notify other cores */
 
+	/* Output pending traces, then trace synchronously from now on */
+	trace_ext_set_sync();
+
 	/* trace: Panic ['panic-string-message' ]at FILE:LINE [<FUNCTION>]" */
 	if (!file && !func && !msg)
 		EMSG_RAW("Panic");
@@ -13,6 +13,7 @@
 #include <kernel/mutex.h>
 #include <kernel/panic.h>
 #include <kernel/pseudo_ta.h>
+#include <kernel/sys_counter.h>
 #include <kernel/tee_common.h>
 #include <kernel/tee_misc.h>
 #include <kernel/tee_ta_manager.h>
@@ -28,6 +29,7 @@
 #include <tee/tee_svc_storage.h>
 #include <tee_api_types.h>
 #include <trace.h>
+#include <utee_defines.h>
 #include <utee_types.h>
 #include <util.h>
 
@@ -384,6 +386,27 @@ infinite:
 	sess->cancel_time.millis = UINT32_MAX;
 }
 
+#if defined(CFG_WITH_STATS)
+static void acct_print_session(struct tee_ta_session *s)
+{
+	struct tee_ta_acct *a = &s->acct;
+	uint64_t syscalls = 0;
+	size_t n = 0;
+
+	for (n = 0; n < ARRAY_SIZE(a->syscalls); n++)
+		syscalls += a->syscalls[n];
+
+	DMSG("session %u: user %" PRIu64 " kernel %" PRIu64 " ticks, %" PRIu64
+	     " syscalls, %" PRIu64 " RPCs, %" PRIu64 " faults",
+	     s->id, a->user_ticks, a->kernel_ticks, syscalls, a->rpc_count,
+	     a->page_faults);
+}
+#else
+static void acct_print_session(struct tee_ta_session *s __unused)
+{
+}
+#endif
+
 /*-----------------------------------------------------------------------------
  * Close a Trusted Application and free available resources
  *---------------------------------------------------------------------------*/
@@ -424,6 +447,7 @@ TEE_Result tee_ta_close_session(struct tee_ta_session *csess,
 	}
 
 	tee_ta_unlink_session(sess, open_sessions);
+	acct_print_session(sess);
 #if defined(CFG_TA_GPROF_SUPPORT)
 	free(sess->sbuf);
 #endif
@@ -826,23 +850,13 @@ void tee_ta_gprof_sample_pc(vaddr_t pc)
 	sbuf->count++;
 }
 
-/*
- * Update user-mode CPU time for the current session
- * @suspend: true if session is being suspended (leaving user mode), false if
- * it is resumed (entering user mode)
- */
-static void tee_ta_update_session_utime(bool suspend)
+static void gprof_update_utime(struct tee_ta_session *s, uint64_t now,
+			       bool suspend)
 {
-	struct tee_ta_session *s;
-	struct sample_buf *sbuf;
-	uint64_t now;
+	struct sample_buf *sbuf = s->sbuf;
 
-	if (tee_ta_get_current_session(&s) != TEE_SUCCESS)
-		return;
-	sbuf = s->sbuf;
 	if (!sbuf)
 		return;
-	now = read_cntpct();
 	if (suspend) {
 		assert(sbuf->usr_entered);
 		sbuf->usr += now - sbuf->usr_entered;
@@ -854,6 +868,149 @@ static void tee_ta_update_session_utime(bool suspend)
 		sbuf->usr_entered = now;
 	}
 }
+#else
+static void gprof_update_utime(struct tee_ta_session *s __unused,
+			       uint64_t now __unused, bool suspend __unused)
+{
+}
+#endif
+
+#if defined(CFG_WITH_STATS)
+static struct tee_ta_session *acct_session(void)
+{
+	struct tee_ta_session *s = NULL;
+
+	if (thread_get_id_may_fail() < 0 ||
+	    tee_ta_get_current_session(&s) != TEE_SUCCESS)
+		return NULL;
+	return s;
+}
+
+static void acct_update_utime(struct tee_ta_session *s, uint64_t now,
+			      bool suspend)
+{
+	uint64_t ticks = 0;
+
+	/* No system counter, CFG_CORE_HAS_GENERIC_TIMER=n */
+	if (!now)
+		return;
+
+	if (!suspend) {
+		s->usr_entered = now;
+		return;
+	}
+
+	if (!s->usr_entered)
+		return;
+	ticks = now - s->usr_entered;
+	s->acct.user_ticks += ticks;
+	s->ctx->acct.user_ticks += ticks;
+	s->usr_entered = 0;
+}
+
+uint64_t tee_ta_acct_syscall_enter(size_t scn)
+{
+	struct tee_ta_session *s = acct_session();
+
+	if (!s)
+		return 0;
+
+	if (scn < ARRAY_SIZE(s->acct.syscalls)) {
+		s->acct.syscalls[scn]++;
+		s->ctx->acct.syscalls[scn]++;
+	}
+	return sys_counter_read();
+}
+
+void tee_ta_acct_syscall_exit(uint64_t entered)
+{
+	struct tee_ta_session *s = acct_session();
+	uint64_t ticks = 0;
+
+	if (!s || !entered)
+		return;
+
+	ticks = sys_counter_read() - entered;
+	s->acct.kernel_ticks += ticks;
+	s->ctx->acct.kernel_ticks += ticks;
+}
+
+uint64_t tee_ta_acct_rpc_begin(void)
+{
+	if (!acct_session())
+		return 0;
+	return sys_counter_read();
+}
+
+void tee_ta_acct_rpc_end(uint64_t begin)
+{
+	struct tee_ta_session *s = acct_session();
+	uint64_t ticks = 0;
+
+	if (!s || !begin)
+		return;
+
+	ticks = sys_counter_read() - begin;
+	s->acct.rpc_count++;
+	s->acct.rpc_ticks += ticks;
+	s->ctx->acct.rpc_count++;
+	s->ctx->acct.rpc_ticks += ticks;
+}
+
+void tee_ta_acct_page_fault(void)
+{
+	struct tee_ta_session *s = acct_session();
+
+	if (!s)
+		return;
+
+	s->acct.page_faults++;
+	s->ctx->acct.page_faults++;
+}
+
+void tee_ta_acct_storage(struct tee_ta_session *s, size_t read,
+			 size_t written)
+{
+	s->acct.storage_read += read;
+	s->acct.storage_written += written;
+	s->ctx->acct.storage_read += read;
+	s->ctx->acct.storage_written += written;
+}
+
+void tee_ta_acct_crypto(struct tee_ta_session *s, uint32_t algo, size_t len)
+{
+	size_t class = TEE_ALG_GET_CLASS(algo);
+
+	COMPILE_TIME_ASSERT(TEE_TA_ACCT_NB_CRYPTO_CLASSES ==
+			    TEE_ALG_GET_CLASS(UINT32_MAX) + 1);
+
+	s->acct.crypto_bytes[class] += len;
+	s->ctx->acct.crypto_bytes[class] += len;
+}
+#else
+static void acct_update_utime(struct tee_ta_session *s __unused,
+			      uint64_t now __unused, bool suspend __unused)
+{
+}
+#endif
+
+#if defined(CFG_TA_GPROF_SUPPORT) || defined(CFG_WITH_STATS)
+/*
+ * Update user-mode CPU time for the current session
+ * @suspend: true if session is being suspended (leaving user mode), false if
+ * it is resumed (entering user mode)
+ */
+static void tee_ta_update_session_utime(bool suspend)
+{
+	struct tee_ta_session *s;
+	uint64_t now;
+
+	if (tee_ta_get_current_session(&s) != TEE_SUCCESS)
+		return;
+	now = sys_counter_read();
+	gprof_update_utime(s, now, suspend);
+	acct_update_utime(s, now, suspend);
+}
 
 void tee_ta_update_session_utime_suspend(void)
 {
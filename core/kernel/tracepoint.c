@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <arm.h>
+#include <atomic.h>
+#include <kernel/misc.h>
+#include <kernel/sys_counter.h>
+#include <kernel/thread.h>
+#include <kernel/tracepoint.h>
+#include <string.h>
+#include <util.h>
+
+/*
+ * The event buffer lives in non-secure shared memory, so the ring indexes
+ * are kept in secure memory and only copied to the buffer.
+ *
+ * tp_busy[] is set by a CPU while it's recording an event, it's used by
+ * tp_stop() to know when the buffer isn't accessed any longer.
+ */
+static struct tp_buf_hdr *tp_hdr;
+static size_t tp_events_per_cpu;
+static uint64_t tp_head[CFG_TEE_CORE_NB_CORE];
+static unsigned int tp_busy[CFG_TEE_CORE_NB_CORE];
+static unsigned int tp_active;
+
+static size_t cpu_buf_size(size_t events_per_cpu)
+{
+	return sizeof(struct tp_cpu_buf) +
+	       events_per_cpu * sizeof(struct tp_event);
+}
+
+static struct tp_cpu_buf *get_cpu_buf(size_t pos)
+{
+	return (void *)((vaddr_t)(tp_hdr + 1) +
+			pos * cpu_buf_size(tp_events_per_cpu));
+}
+
+size_t tp_buf_size(size_t events_per_cpu)
+{
+	return sizeof(struct tp_buf_hdr) +
+	       CFG_TEE_CORE_NB_CORE * cpu_buf_size(events_per_cpu);
+}
+
+void tp_record(unsigned int id, unsigned int phase, uint32_t arg0,
+	       uint64_t arg1, uint64_t arg2)
+{
+	uint32_t exceptions = 0;
+	struct tp_cpu_buf *cb = NULL;
+	struct tp_event *ev = NULL;
+	int thread_id = 0;
+	size_t pos = 0;
+
+	if (!atomic_load_uint(&tp_active))
+		return;
+
+	exceptions = thread_mask_exceptions(THREAD_EXCP_ALL);
+	pos = get_core_pos();
+
+	atomic_store_uint(tp_busy + pos, 1);
+	/* Pairs with the barrier in tp_stop() */
+	dmb();
+	if (!atomic_load_uint(&tp_active))
+		goto out;
+
+	thread_id = thread_get_id_may_fail();
+	cb = get_cpu_buf(pos);
+	ev = (struct tp_event *)(cb + 1) +
+	     (tp_head[pos] & (tp_events_per_cpu - 1));
+
+	ev->ts = sys_counter_read();
+	ev->id = id;
+	ev->phase = phase;
+	ev->thread = thread_id < 0 ? TP_NO_THREAD : thread_id;
+	ev->arg0 = arg0;
+	ev->arg1 = arg1;
+	ev->arg2 = arg2;
+
+	tp_head[pos]++;
+	cb->head = tp_head[pos];
+out:
+	atomic_store_uint(tp_busy + pos, 0);
+	thread_unmask_exceptions(exceptions);
+}
+
+TEE_Result tp_start(void *buf, size_t events_per_cpu)
+{
+	if (!buf || !IS_POWER_OF_TWO(events_per_cpu))
+		return TEE_ERROR_BAD_PARAMETERS;
+	if (atomic_load_uint(&tp_active) || tp_hdr)
+		return TEE_ERROR_BAD_STATE;
+	if (!sys_counter_freq())
+		return TEE_ERROR_NOT_SUPPORTED;
+
+	memset(buf, 0, tp_buf_size(events_per_cpu));
+	memset(tp_head, 0, sizeof(tp_head));
+	tp_hdr = buf;
+	tp_events_per_cpu = events_per_cpu;
+	tp_hdr->magic = TP_BUF_MAGIC;
+	tp_hdr->version = TP_BUF_VERSION;
+	tp_hdr->num_cpus = CFG_TEE_CORE_NB_CORE;
+	tp_hdr->events_per_cpu = events_per_cpu;
+	tp_hdr->cntfrq = sys_counter_freq();
+
+	/* Make sure the header is initialized before recording starts */
+	dmb();
+	atomic_store_uint(&tp_active, 1);
+
+	return TEE_SUCCESS;
+}
+
+static void wait_not_busy(void)
+{
+	size_t n = 0;
+
+	dmb();
+	for (n = 0; n < CFG_TEE_CORE_NB_CORE; n++)
+		while (atomic_load_uint(tp_busy + n))
+			;
+}
+
+void tp_pause(bool pause)
+{
+	if (!tp_hdr)
+		return;
+
+	atomic_store_uint(&tp_active, !pause);
+	if (pause)
+		wait_not_busy();
+}
+
+void tp_stop(void)
+{
+	atomic_store_uint(&tp_active, 0);
+	wait_not_busy();
+	tp_hdr = NULL;
+	tp_events_per_cpu = 0;
+}
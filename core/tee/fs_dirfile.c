@@ -9,7 +9,63 @@
 #include <stdlib.h>
 #include <string.h>
 #include <tee/fs_dirfile.h>
+#include <trace.h>
 #include <types_ext.h>
+#include <util.h>
+
+/* Number of entries read at once when scanning the dirfile */
+#define DIRFILE_READ_CHUNK	32
+
+/*
+ * Object id of a file in the dirfile, see struct dirfile_oid_cache
+ */
+struct dirfile_oid {
+	int idx;
+	uint32_t oidlen;
+	uint8_t oid[TEE_OBJECT_ID_MAX_LEN];
+};
+
+/*
+ * The object ids of the files of one TA, ordered by index in the
+ * dirfile, so that tee_fs_dirfile_get_next() doesn't have to read the
+ * dirfile for each object when a TA enumerates its objects. Freed when
+ * an object is added, renamed or removed. If memory runs out the dirfile
+ * is read entry by entry instead.
+ */
+struct dirfile_oid_cache {
+	TEE_UUID uuid;
+	size_t count;
+	struct dirfile_oid oids[];
+};
+
+#define DIRFILE_INDEX_UNUSED	-2
+#define DIRFILE_INDEX_END	-1
+
+/*
+ * Hash index of the entries in the dirfile, so that
+ * tee_fs_dirfile_find() only has to read the entries with the same hash
+ * of UUID and object id, normally just the one searched for.
+ *
+ * @buckets:	Index of the first entry of each chain or
+ *		DIRFILE_INDEX_END, @nbuckets is a power of two
+ * @ents:	Hash and index of the next entry in the chain of each entry
+ *		in the dirfile, next is DIRFILE_INDEX_UNUSED for unused
+ *		entries
+ * @count:	Number of used entries
+ *
+ * If memory runs out the index is freed and the dirfile is searched
+ * linearly instead.
+ */
+struct dirfile_index {
+	int *buckets;
+	size_t nbuckets;
+	struct {
+		uint32_t hash;
+		int next;
+	} *ents;
+	size_t nents;
+	size_t count;
+};
 
 struct tee_fs_dirfile_dirh {
 	const struct tee_fs_dirfile_operations *fops;
@@ -17,6 +73,8 @@ struct tee_fs_dirfile_dirh {
 	int nbits;
 	bitstr_t *files;
 	size_t ndents;
+	struct dirfile_oid_cache *oid_cache;
+	struct dirfile_index index;
 };
 
 struct dirfile_entry {
@@ -79,6 +137,150 @@ static bool test_file(struct tee_fs_dirfile_dirh *dirh, int idx)
 	return false;
 }
 
+/* FNV-1a */
+static uint32_t hash_oid(const TEE_UUID *uuid, const void *oid, size_t oidlen)
+{
+	const uint8_t *b = (const uint8_t *)uuid;
+	uint32_t h = 2166136261;
+	size_t n = 0;
+
+	for (n = 0; n < sizeof(*uuid); n++)
+		h = (h ^ b[n]) * 16777619;
+	b = oid;
+	for (n = 0; n < oidlen; n++)
+		h = (h ^ b[n]) * 16777619;
+
+	return h;
+}
+
+static void index_free(struct dirfile_index *ix)
+{
+	free(ix->buckets);
+	free(ix->ents);
+	memset(ix, 0, sizeof(*ix));
+}
+
+static bool index_valid(struct dirfile_index *ix)
+{
+	return ix->buckets;
+}
+
+static TEE_Result index_init(struct dirfile_index *ix)
+{
+	size_t n = 0;
+
+	ix->nbuckets = 64;
+	ix->buckets = malloc(sizeof(*ix->buckets) * ix->nbuckets);
+	if (!ix->buckets)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	for (n = 0; n < ix->nbuckets; n++)
+		ix->buckets[n] = DIRFILE_INDEX_END;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result index_grow_buckets(struct dirfile_index *ix)
+{
+	size_t nbuckets = ix->nbuckets * 2;
+	int *buckets = NULL;
+	size_t n = 0;
+	int b = 0;
+
+	buckets = malloc(sizeof(*buckets) * nbuckets);
+	if (!buckets)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	for (n = 0; n < nbuckets; n++)
+		buckets[n] = DIRFILE_INDEX_END;
+
+	for (n = 0; n < ix->nents; n++) {
+		if (ix->ents[n].next == DIRFILE_INDEX_UNUSED)
+			continue;
+		b = ix->ents[n].hash & (nbuckets - 1);
+		ix->ents[n].next = buckets[b];
+		buckets[b] = n;
+	}
+
+	free(ix->buckets);
+	ix->buckets = buckets;
+	ix->nbuckets = nbuckets;
+
+	return TEE_SUCCESS;
+}
+
+static TEE_Result index_grow_ents(struct dirfile_index *ix, size_t idx)
+{
+	size_t nents = MAX(ix->nents * 2, ROUNDUP(idx + 1, 64));
+	size_t n = 0;
+	void *p = NULL;
+
+	p = realloc(ix->ents, sizeof(*ix->ents) * nents);
+	if (!p)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	ix->ents = p;
+	for (n = ix->nents; n < nents; n++)
+		ix->ents[n].next = DIRFILE_INDEX_UNUSED;
+	ix->nents = nents;
+
+	return TEE_SUCCESS;
+}
+
+static void index_remove(struct dirfile_index *ix, size_t idx)
+{
+	int *p = NULL;
+
+	if (idx >= ix->nents || ix->ents[idx].next == DIRFILE_INDEX_UNUSED)
+		return;
+
+	p = ix->buckets + (ix->ents[idx].hash & (ix->nbuckets - 1));
+	while (*p != (int)idx) {
+		assert(*p != DIRFILE_INDEX_END);
+		p = &ix->ents[*p].next;
+	}
+	*p = ix->ents[idx].next;
+	ix->ents[idx].next = DIRFILE_INDEX_UNUSED;
+	ix->count--;
+}
+
+static TEE_Result index_add(struct dirfile_index *ix, size_t idx,
+			    const struct dirfile_entry *dent)
+{
+	TEE_Result res = TEE_SUCCESS;
+	int b = 0;
+
+	if (idx >= ix->nents) {
+		res = index_grow_ents(ix, idx);
+		if (res)
+			return res;
+	}
+	if (ix->count >= ix->nbuckets * 2) {
+		res = index_grow_buckets(ix);
+		if (res)
+			return res;
+	}
+
+	ix->ents[idx].hash = hash_oid(&dent->uuid, dent->oid, dent->oidlen);
+	b = ix->ents[idx].hash & (ix->nbuckets - 1);
+	ix->ents[idx].next = ix->buckets[b];
+	ix->buckets[b] = idx;
+	ix->count++;
+
+	return TEE_SUCCESS;
+}
+
+/* Updates the index with an entry written to the dirfile */
+static void index_update(struct dirfile_index *ix, size_t idx,
+			 const struct dirfile_entry *dent)
+{
+	if (!index_valid(ix))
+		return;
+
+	index_remove(ix, idx);
+	if (dent->oidlen && index_add(ix, idx, dent)) {
+		EMSG("Out of memory, searching dirfile linearly");
+		index_free(ix);
+	}
+}
+
 static TEE_Result read_dent(struct tee_fs_dirfile_dirh *dirh, int idx,
 			    struct dirfile_entry *dent)
 {
@@ -94,6 +296,93 @@ static TEE_Result read_dent(struct tee_fs_dirfile_dirh *dirh, int idx,
 	return res;
 }
 
+/*
+ * Reads up to @count entries starting at @idx, *@count is updated with
+ * the number of entries read which is 0 at the end of the dirfile.
+ */
+static TEE_Result read_dents(struct tee_fs_dirfile_dirh *dirh, int idx,
+			     struct dirfile_entry *dents, size_t *count)
+{
+	TEE_Result res;
+	size_t l;
+
+	l = sizeof(*dents) * *count;
+	res = dirh->fops->read(dirh->fh, sizeof(struct dirfile_entry) * idx,
+			       dents, &l);
+	if (!res)
+		*count = l / sizeof(*dents);
+
+	return res;
+}
+
+static void free_oid_cache(struct tee_fs_dirfile_dirh *dirh)
+{
+	free(dirh->oid_cache);
+	dirh->oid_cache = NULL;
+}
+
+static TEE_Result build_oid_cache(struct tee_fs_dirfile_dirh *dirh,
+				  const TEE_UUID *uuid)
+{
+	TEE_Result res = TEE_SUCCESS;
+	struct dirfile_oid_cache *c = NULL;
+	struct dirfile_entry *dents = NULL;
+	size_t max_count = 8;
+	size_t count = 0;
+	size_t idx = 0;
+	size_t n = 0;
+	void *p = NULL;
+
+	free_oid_cache(dirh);
+
+	dents = malloc(sizeof(*dents) * DIRFILE_READ_CHUNK);
+	c = malloc(sizeof(*c) + sizeof(c->oids[0]) * max_count);
+	if (!dents || !c) {
+		res = TEE_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+	c->uuid = *uuid;
+	c->count = 0;
+
+	for (idx = 0; idx < dirh->ndents; idx += count) {
+		count = DIRFILE_READ_CHUNK;
+		res = read_dents(dirh, idx, dents, &count);
+		if (res)
+			goto out;
+		if (!count)
+			break;
+
+		for (n = 0; n < count; n++) {
+			if (!dents[n].oidlen ||
+			    memcmp(&dents[n].uuid, uuid, sizeof(*uuid)))
+				continue;
+
+			if (c->count == max_count) {
+				max_count *= 2;
+				p = realloc(c, sizeof(*c) +
+					       sizeof(c->oids[0]) * max_count);
+				if (!p) {
+					res = TEE_ERROR_OUT_OF_MEMORY;
+					goto out;
+				}
+				c = p;
+			}
+			c->oids[c->count].idx = idx + n;
+			c->oids[c->count].oidlen = dents[n].oidlen;
+			memcpy(c->oids[c->count].oid, dents[n].oid,
+			       sizeof(dents[n].oid));
+			c->count++;
+		}
+	}
+
+	dirh->oid_cache = c;
+	c = NULL;
+out:
+	free(c);
+	free(dents);
+	return res;
+}
+
 static TEE_Result write_dent(struct tee_fs_dirfile_dirh *dirh, size_t n,
 			     struct dirfile_entry *dent)
 {
@@ -101,8 +390,11 @@ static TEE_Result write_dent(struct tee_fs_dirfile_dirh *dirh, size_t n,
 
 	res = dirh->fops->write(dirh->fh, sizeof(*dent) * n,
 				dent, sizeof(*dent));
-	if (!res && n >= dirh->ndents)
-		dirh->ndents = n + 1;
+	if (!res) {
+		if (n >= dirh->ndents)
+			dirh->ndents = n + 1;
+		index_update(&dirh->index, n, dent);
+	}
 
 	return res;
 }
@@ -113,7 +405,12 @@ TEE_Result tee_fs_dirfile_open(bool create, uint8_t *hash,
 {
 	TEE_Result res;
 	struct tee_fs_dirfile_dirh *dirh = calloc(1, sizeof(*dirh));
-	size_t n;
+	struct dirfile_entry *dents = NULL;
+	struct dirfile_entry one_dent;
+	size_t chunk = DIRFILE_READ_CHUNK;
+	size_t count = 0;
+	size_t n = 0;
+	size_t m = 0;
 
 	if (!dirh)
 		return TEE_ERROR_OUT_OF_MEMORY;
@@ -123,34 +420,52 @@ TEE_Result tee_fs_dirfile_open(bool create, uint8_t *hash,
 	if (res)
 		goto out;
 
-	for (n = 0;; n++) {
-		struct dirfile_entry dent;
+	/* Short of memory the dirfile is read entry by entry */
+	dents = malloc(sizeof(*dents) * DIRFILE_READ_CHUNK);
+	if (!dents) {
+		dents = &one_dent;
+		chunk = 1;
+	}
 
-		res = read_dent(dirh, n, &dent);
-		if (res) {
-			if (res == TEE_ERROR_ITEM_NOT_FOUND)
-				res = TEE_SUCCESS;
+	if (index_init(&dirh->index))
+		EMSG("Out of memory, searching dirfile linearly");
+
+	for (n = 0;; n += count) {
+		count = chunk;
+		res = read_dents(dirh, n, dents, &count);
+		if (res || !count)
 			goto out;
-		}
 
-		if (!dent.oidlen)
-			continue;
+		for (m = 0; m < count; m++) {
+			struct dirfile_entry *dent = dents + m;
 
-		if (test_file(dirh, dent.file_number)) {
-			DMSG("clearing duplicate file number %" PRIu32,
-			     dent.file_number);
-			memset(&dent, 0, sizeof(dent));
-			res = write_dent(dirh, n, &dent);
-			if (res)
+			if (!dent->oidlen)
+				continue;
+
+			if (test_file(dirh, dent->file_number)) {
+				DMSG("clearing duplicate file number %" PRIu32,
+				     dent->file_number);
+				memset(dent, 0, sizeof(*dent));
+				res = write_dent(dirh, n + m, dent);
+				if (res)
+					goto out;
+				continue;
+			}
+
+			res = set_file(dirh, dent->file_number);
+			if (res != TEE_SUCCESS)
 				goto out;
-			continue;
-		}
 
-		res = set_file(dirh, dent.file_number);
-		if (res != TEE_SUCCESS)
-			goto out;
+			if (index_valid(&dirh->index) &&
+			    index_add(&dirh->index, n + m, dent)) {
+				EMSG("Out of memory, searching dirfile linearly");
+				index_free(&dirh->index);
+			}
+		}
 	}
 out:
+	if (dents != &one_dent)
+		free(dents);
 	if (!res) {
 		dirh->ndents = n;
 		*dirh_ret = dirh;
@@ -165,6 +480,8 @@ void tee_fs_dirfile_close(struct tee_fs_dirfile_dirh *dirh)
 	if (dirh) {
 		dirh->fops->close(dirh->fh);
 		free(dirh->files);
+		free_oid_cache(dirh);
+		index_free(&dirh->index);
 		free(dirh);
 	}
 }
@@ -194,9 +511,9 @@ TEE_Result tee_fs_dirfile_get_tmp(struct tee_fs_dirfile_dirh *dirh,
 	return res;
 }
 
-TEE_Result tee_fs_dirfile_find(struct tee_fs_dirfile_dirh *dirh,
-			       const TEE_UUID *uuid, const void *oid,
-			       size_t oidlen, struct tee_fs_dirfile_fileh *dfh)
+static TEE_Result find_linear(struct tee_fs_dirfile_dirh *dirh,
+			      const TEE_UUID *uuid, const void *oid,
+			      size_t oidlen, struct tee_fs_dirfile_fileh *dfh)
 {
 	TEE_Result res;
 	struct dirfile_entry dent;
@@ -238,6 +555,63 @@ TEE_Result tee_fs_dirfile_find(struct tee_fs_dirfile_dirh *dirh,
 	return TEE_SUCCESS;
 }
 
+static TEE_Result find_indexed(struct tee_fs_dirfile_dirh *dirh,
+			       const TEE_UUID *uuid, const void *oid,
+			       size_t oidlen, struct tee_fs_dirfile_fileh *dfh)
+{
+	struct dirfile_index *ix = &dirh->index;
+	struct dirfile_entry dent;
+	TEE_Result res;
+	uint32_t h = 0;
+	int n = 0;
+
+	if (!oidlen) {
+		/* First unused entry, or a new one at the end */
+		for (n = 0; n < (int)dirh->ndents; n++)
+			if ((size_t)n >= ix->nents ||
+			    ix->ents[n].next == DIRFILE_INDEX_UNUSED)
+				break;
+		memset(&dent, 0, sizeof(dent));
+		goto out;
+	}
+
+	h = hash_oid(uuid, oid, oidlen);
+	for (n = ix->buckets[h & (ix->nbuckets - 1)]; n != DIRFILE_INDEX_END;
+	     n = ix->ents[n].next) {
+		if (ix->ents[n].hash != h)
+			continue;
+
+		res = read_dent(dirh, n, &dent);
+		if (res)
+			return res;
+
+		if (dent.oidlen == oidlen &&
+		    !memcmp(&dent.uuid, uuid, sizeof(dent.uuid)) &&
+		    !memcmp(&dent.oid, oid, oidlen))
+			goto out;
+	}
+
+	return TEE_ERROR_ITEM_NOT_FOUND;
+out:
+	if (dfh) {
+		dfh->idx = n;
+		dfh->file_number = dent.file_number;
+		memcpy(dfh->hash, dent.hash, sizeof(dent.hash));
+	}
+
+	return TEE_SUCCESS;
+}
+
+TEE_Result tee_fs_dirfile_find(struct tee_fs_dirfile_dirh *dirh,
+			       const TEE_UUID *uuid, const void *oid,
+			       size_t oidlen, struct tee_fs_dirfile_fileh *dfh)
+{
+	if (index_valid(&dirh->index))
+		return find_indexed(dirh, uuid, oid, oidlen, dfh);
+
+	return find_linear(dirh, uuid, oid, oidlen, dfh);
+}
+
 TEE_Result tee_fs_dirfile_fileh_to_fname(const struct tee_fs_dirfile_fileh *dfh,
 					 char *fname, size_t *fnlen)
 {
@@ -290,6 +664,7 @@ TEE_Result tee_fs_dirfile_rename(struct tee_fs_dirfile_dirh *dirh,
 		dfh->idx = dfh2.idx;
 	}
 
+	free_oid_cache(dirh);
 	return write_dent(dirh, dfh->idx, &dent);
 }
 
@@ -311,6 +686,7 @@ TEE_Result tee_fs_dirfile_remove(struct tee_fs_dirfile_dirh *dirh,
 	assert(dfh->file_number == file_number);
 	assert(test_file(dirh, file_number));
 
+	free_oid_cache(dirh);
 	memset(&dent, 0, sizeof(dent));
 	res = write_dent(dirh, dfh->idx, &dent);
 	if (!res)
@@ -336,9 +712,9 @@ TEE_Result tee_fs_dirfile_update_hash(struct tee_fs_dirfile_dirh *dirh,
 	return write_dent(dirh, dfh->idx, &dent);
 }
 
-TEE_Result tee_fs_dirfile_get_next(struct tee_fs_dirfile_dirh *dirh,
-				   const TEE_UUID *uuid, int *idx, void *oid,
-				   size_t *oidlen)
+static TEE_Result get_next_linear(struct tee_fs_dirfile_dirh *dirh,
+				  const TEE_UUID *uuid, int *idx, void *oid,
+				  size_t *oidlen)
 {
 	TEE_Result res;
 	int i = *idx + 1;
@@ -365,3 +741,47 @@ TEE_Result tee_fs_dirfile_get_next(struct tee_fs_dirfile_dirh *dirh,
 
 	return TEE_SUCCESS;
 }
+
+TEE_Result tee_fs_dirfile_get_next(struct tee_fs_dirfile_dirh *dirh,
+				   const TEE_UUID *uuid, int *idx, void *oid,
+				   size_t *oidlen)
+{
+	TEE_Result res;
+	struct dirfile_oid_cache *c = dirh->oid_cache;
+	struct dirfile_oid *o = NULL;
+	size_t lo = 0;
+	size_t hi = 0;
+	size_t mid = 0;
+
+	if (!c || memcmp(&c->uuid, uuid, sizeof(*uuid))) {
+		res = build_oid_cache(dirh, uuid);
+		/* Without the cache the dirfile is read entry by entry */
+		if (res == TEE_ERROR_OUT_OF_MEMORY)
+			return get_next_linear(dirh, uuid, idx, oid, oidlen);
+		if (res)
+			return res;
+		c = dirh->oid_cache;
+	}
+
+	/* Find the first object after *idx */
+	hi = c->count;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (c->oids[mid].idx <= *idx)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == c->count)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	o = c->oids + lo;
+
+	if (*oidlen < o->oidlen)
+		return TEE_ERROR_SHORT_BUFFER;
+
+	memcpy(oid, o->oid, o->oidlen);
+	*oidlen = o->oidlen;
+	*idx = o->idx;
+
+	return TEE_SUCCESS;
+}
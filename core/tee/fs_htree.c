@@ -7,6 +7,7 @@
 #include <crypto/crypto.h>
 #include <initcall.h>
 #include <kernel/tee_common_otp.h>
+#include <kernel/tracepoint.h>
 #include <stdlib.h>
 #include <string_ext.h>
 #include <string.h>
@@ -827,6 +828,8 @@ TEE_Result tee_fs_htree_write_block(struct tee_fs_htree **ht_arg,
 	if (!ht)
 		return TEE_ERROR_CORRUPT_OBJECT;
 
+	tp_storage_write_begin(block_num);
+
 	res = get_block_node(ht, true, block_num, &node);
 	if (res != TEE_SUCCESS)
 		goto out;
@@ -858,6 +861,7 @@ TEE_Result tee_fs_htree_write_block(struct tee_fs_htree **ht_arg,
 	node->dirty = true;
 	ht->dirty = true;
 out:
+	tp_storage_write_end(res);
 	if (res != TEE_SUCCESS)
 		tee_fs_htree_close(ht_arg);
 	return res;
@@ -878,6 +882,8 @@ TEE_Result tee_fs_htree_read_block(struct tee_fs_htree **ht_arg,
 	if (!ht)
 		return TEE_ERROR_CORRUPT_OBJECT;
 
+	tp_storage_read_begin(block_num);
+
 	res = get_block_node(ht, false, block_num, &node);
 	if (res != TEE_SUCCESS)
 		goto out;
@@ -905,6 +911,7 @@ TEE_Result tee_fs_htree_read_block(struct tee_fs_htree **ht_arg,
 	res = authenc_decrypt_final(ctx, node->node.tag, enc_block,
 				    ht->stor->block_size, block);
 out:
+	tp_storage_read_end(res);
 	if (res != TEE_SUCCESS)
 		tee_fs_htree_close(ht_arg);
 	return res;
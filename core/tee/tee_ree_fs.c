@@ -6,6 +6,7 @@
 #include <assert.h>
 #include <kernel/mutex.h>
 #include <kernel/panic.h>
+#include <kernel/tee_ta_manager.h>
 #include <kernel/thread.h>
 #include <mm/core_memprot.h>
 #include <mm/tee_pager.h>
@@ -28,11 +29,25 @@
 
 #define BLOCK_SIZE	(1 << BLOCK_SHIFT)
 
+/*
+ * @tx_dfh:		File handle as committed when the file joined the
+ *			transaction, restored if it's aborted
+ * @tx_dirty:		Changes remain to be synced when the transaction
+ *			is committed
+ * @tx_created:		Created in the transaction, removed if it's aborted
+ * @tx_detached:	Closed in the transaction, the close is deferred
+ *			until the transaction ends
+ */
 struct tee_fs_fd {
 	struct tee_fs_htree *ht;
 	int fd;
 	struct tee_fs_dirfile_fileh dfh;
 	const TEE_UUID *uuid;
+	struct tee_fs_dirfile_fileh tx_dfh;
+	bool tx_dirty;
+	bool tx_created;
+	bool tx_detached;
+	SLIST_ENTRY(tee_fs_fd) tx_link;
 };
 
 struct tee_fs_dir {
@@ -49,6 +64,24 @@ static int pos_to_block_num(int position)
 
 static struct mutex ree_fs_mutex = MUTEX_INITIALIZER;
 
+/*
+ * A storage transaction, see tee_file_operations::begin_transaction.
+ * dirf.db is shared by all TAs so there's at most one transaction at a
+ * time and other contexts are refused until it has ended.
+ *
+ * @owner:	Context which began the transaction, NULL if none
+ * @res:	First error of an operation in the transaction
+ * @fds:	Files changed, created or closed in the transaction
+ * @removed:	Files to remove once the transaction is committed
+ */
+static struct {
+	struct tee_ta_ctx *owner;
+	TEE_Result res;
+	SLIST_HEAD(, tee_fs_fd) fds;
+	struct tee_fs_dirfile_fileh *removed;
+	size_t removed_count;
+} ree_fs_tx;
+
 #ifdef CFG_WITH_PAGER
 static void *ree_fs_tmp_block;
 static bool ree_fs_tmp_block_busy;
@@ -329,8 +362,13 @@ static TEE_Result ree_fs_read_primitive(struct tee_file_handle *fh, size_t pos,
 	uint8_t *data_ptr = buf;
 	uint8_t *block = NULL;
 	struct tee_fs_fd *fdp = (struct tee_fs_fd *)fh;
-	struct tee_fs_htree_meta *meta = tee_fs_htree_get_meta(fdp->ht);
+	struct tee_fs_htree_meta *meta = NULL;
+
+	/* Created in an aborted transaction */
+	if (!fdp->ht)
+		return TEE_ERROR_BAD_STATE;
 
+	meta = tee_fs_htree_get_meta(fdp->ht);
 	remain_bytes = *len;
 	if ((pos + remain_bytes) < remain_bytes || pos > meta->length)
 		remain_bytes = 0;
@@ -566,11 +604,144 @@ static void close_dirh(struct tee_fs_dirfile_dirh **dirh)
 }
 #endif /*!CFG_RPMB_FS*/
 
+static struct tee_ta_ctx *get_current_ctx(void)
+{
+	struct tee_ta_session *s = NULL;
+
+	if (tee_ta_get_current_session(&s))
+		return NULL;
+	return s->ctx;
+}
+
+/*
+ * The owner of a transaction may keep it across invocations, so other
+ * contexts fail instead of waiting for it to end. Unlike TEE_ERROR_BUSY
+ * the GP storage functions return TEE_ERROR_STORAGE_NOT_AVAILABLE to the
+ * TA instead of panicking it.
+ */
+static TEE_Result check_tx_owner(void)
+{
+	if (ree_fs_tx.owner && ree_fs_tx.owner != get_current_ctx())
+		return TEE_ERROR_STORAGE_NOT_AVAILABLE;
+	return TEE_SUCCESS;
+}
+
+static struct tee_fs_fd *tx_find_file(uint32_t file_number)
+{
+	struct tee_fs_fd *fdp = NULL;
+
+	SLIST_FOREACH(fdp, &ree_fs_tx.fds, tx_link)
+		if (fdp->dfh.file_number == file_number)
+			return fdp;
+
+	return NULL;
+}
+
+static void tx_add_file(struct tee_fs_fd *fdp)
+{
+	if (fdp->tx_dirty || fdp->tx_created || fdp->tx_detached)
+		return;
+	fdp->tx_dfh = fdp->dfh;
+	SLIST_INSERT_HEAD(&ree_fs_tx.fds, fdp, tx_link);
+}
+
+static void tx_remove_file(struct tee_fs_fd *fdp)
+{
+	SLIST_REMOVE(&ree_fs_tx.fds, fdp, tee_fs_fd, tx_link);
+	fdp->tx_dirty = false;
+	fdp->tx_created = false;
+	if (fdp->tx_detached) {
+		fdp->tx_detached = false;
+		ree_fs_close_primitive((struct tee_file_handle *)fdp);
+	}
+}
+
+/* Syncs the file now, or when the transaction is committed */
+static TEE_Result sync_file(struct tee_fs_dirfile_dirh *dirh,
+			    struct tee_fs_fd *fdp)
+{
+	TEE_Result res;
+
+	if (ree_fs_tx.owner) {
+		tx_add_file(fdp);
+		fdp->tx_dirty = true;
+		return TEE_SUCCESS;
+	}
+
+	res = tee_fs_htree_sync_to_storage(&fdp->ht, fdp->dfh.hash);
+	if (res)
+		return res;
+
+	return tee_fs_dirfile_update_hash(dirh, &fdp->dfh);
+}
+
+/* Commits the dirfile now, or when the transaction is committed */
+static TEE_Result commit_dirh(struct tee_fs_dirfile_dirh *dirh)
+{
+	if (ree_fs_tx.owner)
+		return TEE_SUCCESS;
+	return commit_dirh_writes(dirh);
+}
+
+/*
+ * Removes a file which isn't referenced by the committed dirfile any
+ * longer. In a transaction the dirfile referencing the file is only
+ * committed when the transaction is, except for files created in the
+ * transaction which aren't referenced at all.
+ */
+static void remove_dfh(const struct tee_fs_dirfile_fileh *dfh)
+{
+	struct tee_fs_fd *fdp = NULL;
+	void *p = NULL;
+
+	if (ree_fs_tx.owner) {
+		fdp = tx_find_file(dfh->file_number);
+		if (fdp) {
+			bool created = fdp->tx_created;
+
+			tx_remove_file(fdp);
+			if (created)
+				goto remove;
+		}
+
+		p = realloc(ree_fs_tx.removed, (ree_fs_tx.removed_count + 1) *
+						sizeof(*ree_fs_tx.removed));
+		if (!p) {
+			if (!ree_fs_tx.res)
+				ree_fs_tx.res = TEE_ERROR_OUT_OF_MEMORY;
+			return;
+		}
+		ree_fs_tx.removed = p;
+		ree_fs_tx.removed[ree_fs_tx.removed_count] = *dfh;
+		ree_fs_tx.removed_count++;
+		return;
+	}
+remove:
+	tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS, dfh);
+}
+
+static bool tx_is_removed(uint32_t file_number)
+{
+	size_t n = 0;
+
+	for (n = 0; n < ree_fs_tx.removed_count; n++)
+		if (ree_fs_tx.removed[n].file_number == file_number)
+			return true;
+
+	return false;
+}
+
 static TEE_Result get_dirh(struct tee_fs_dirfile_dirh **dirh)
 {
-	if (!ree_fs_dirh) {
-		TEE_Result res = open_dirh(&ree_fs_dirh);
+	TEE_Result res = check_tx_owner();
+
+	if (res) {
+		*dirh = NULL;
+		return res;
+	}
 
+	if (!ree_fs_dirh) {
+		res = open_dirh(&ree_fs_dirh);
 		if (res) {
 			*dirh = NULL;
 			return res;
@@ -598,10 +769,19 @@ static void put_dirh_primitive(bool close)
 	 * But in the ree_fs_close() case there's no call to get_dirh()
 	 * only to this function, put_dirh_primitive(), and in this case
 	 * ree_fs_dirh may actually be NULL.
+	 *
+	 * ree_fs_dirh stays open when the last reference is dropped so that
+	 * the next operation finds the hash index and the object ids of
+	 * dirf.db as they are instead of reading it again. It's only closed
+	 * to discard uncommitted changes, on error or by tx_abort().
 	 */
 	ree_fs_dirh_refcount--;
-	if (ree_fs_dirh && (!ree_fs_dirh_refcount || close))
+	if (ree_fs_dirh && close) {
+		/* Uncommitted changes of the transaction are lost too */
+		if (close && ree_fs_tx.owner && !ree_fs_tx.res)
+			ree_fs_tx.res = TEE_ERROR_BAD_STATE;
 		close_dirh(&ree_fs_dirh);
+	}
 }
 
 static void put_dirh(struct tee_fs_dirfile_dirh *dirh, bool close)
@@ -612,6 +792,17 @@ static void put_dirh(struct tee_fs_dirfile_dirh *dirh, bool close)
 	}
 }
 
+/*
+ * Uncommitted changes to the dirfile are discarded by closing it on
+ * error. A conflicting object id is detected before anything is changed
+ * so the dirfile is kept open, which matters in a transaction where all
+ * its changes would be discarded.
+ */
+static bool close_on_error(TEE_Result res)
+{
+	return res && res != TEE_ERROR_ACCESS_CONFLICT;
+}
+
 static TEE_Result ree_fs_open(struct tee_pobj *po, size_t *size,
 			      struct tee_file_handle **fh)
 {
@@ -630,6 +821,19 @@ static TEE_Result ree_fs_open(struct tee_pobj *po, size_t *size,
 	if (res != TEE_SUCCESS)
 		goto out;
 
+	if (ree_fs_tx.owner) {
+		struct tee_fs_fd *fdp = tx_find_file(dfh.file_number);
+
+		/* Pick up the uncommitted changes of the transaction */
+		if (fdp && fdp->tx_detached) {
+			fdp->tx_detached = false;
+			*fh = (struct tee_file_handle *)fdp;
+			if (size)
+				*size = tee_fs_htree_get_meta(fdp->ht)->length;
+			goto out;
+		}
+	}
+
 	res = ree_fs_open_primitive(false, dfh.hash, &po->uuid, &dfh, fh);
 	if (res == TEE_ERROR_ITEM_NOT_FOUND) {
 		/*
@@ -678,12 +882,12 @@ static TEE_Result set_name(struct tee_fs_dirfile_dirh *dirh,
 	if (res)
 		return res;
 
-	res = commit_dirh_writes(dirh);
+	res = commit_dirh(dirh);
 	if (res)
 		return res;
 
 	if (have_old_dfh)
-		tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS, &old_dfh);
+		remove_dfh(&old_dfh);
 
 	return TEE_SUCCESS;
 }
@@ -691,9 +895,14 @@ static TEE_Result set_name(struct tee_fs_dirfile_dirh *dirh,
 static void ree_fs_close(struct tee_file_handle **fh)
 {
 	if (*fh) {
+		struct tee_fs_fd *fdp = (struct tee_fs_fd *)*fh;
+
 		mutex_lock(&ree_fs_mutex);
 		put_dirh_primitive(false);
-		ree_fs_close_primitive(*fh);
+		if (fdp->tx_dirty || fdp->tx_created)
+			fdp->tx_detached = true;
+		else
+			ree_fs_close_primitive(*fh);
 		*fh = NULL;
 		mutex_unlock(&ree_fs_mutex);
 
@@ -719,9 +928,16 @@ static TEE_Result ree_fs_create(struct tee_pobj *po, bool overwrite,
 	if (res)
 		goto out;
 
-	res = tee_fs_dirfile_get_tmp(dirh, &dfh);
-	if (res)
-		goto out;
+	/*
+	 * The file number of a file removed in a transaction is free in
+	 * the dirfile but the file is only removed when the transaction
+	 * is committed.
+	 */
+	do {
+		res = tee_fs_dirfile_get_tmp(dirh, &dfh);
+		if (res)
+			goto out;
+	} while (ree_fs_tx.owner && tx_is_removed(dfh.file_number));
 
 	res = ree_fs_open_primitive(true, dfh.hash, &po->uuid, &dfh, fh);
 	if (res)
@@ -753,9 +969,13 @@ static TEE_Result ree_fs_create(struct tee_pobj *po, bool overwrite,
 		goto out;
 
 	res = set_name(dirh, fdp, po, overwrite);
+	if (!res && ree_fs_tx.owner) {
+		tx_add_file(fdp);
+		fdp->tx_created = true;
+	}
 out:
 	if (res) {
-		put_dirh(dirh, true);
+		put_dirh(dirh, close_on_error(res));
 		if (*fh) {
 			ree_fs_close_primitive(*fh);
 			*fh = NULL;
@@ -780,18 +1000,19 @@ static TEE_Result ree_fs_write(struct tee_file_handle *fh, size_t pos,
 	if (res)
 		goto out;
 
-	res = ree_fs_write_primitive(fh, pos, buf, len);
-	if (res)
+	if (!fdp->ht) {
+		res = TEE_ERROR_BAD_STATE;
 		goto out;
+	}
 
-	res = tee_fs_htree_sync_to_storage(&fdp->ht, fdp->dfh.hash);
+	res = ree_fs_write_primitive(fh, pos, buf, len);
 	if (res)
 		goto out;
 
-	res = tee_fs_dirfile_update_hash(dirh, &fdp->dfh);
+	res = sync_file(dirh, fdp);
 	if (res)
 		goto out;
-	res = commit_dirh_writes(dirh);
+	res = commit_dirh(dirh);
 out:
 	put_dirh(dirh, res);
 	mutex_unlock(&ree_fs_mutex);
@@ -805,7 +1026,7 @@ static TEE_Result ree_fs_rename(struct tee_pobj *old, struct tee_pobj *new,
 	TEE_Result res;
 	struct tee_fs_dirfile_dirh *dirh = NULL;
 	struct tee_fs_dirfile_fileh dfh;
-	struct tee_fs_dirfile_fileh remove_dfh = { .idx = -1 };
+	struct tee_fs_dirfile_fileh old_dfh = { .idx = -1 };
 
 	if (!new)
 		return TEE_ERROR_BAD_PARAMETERS;
@@ -816,7 +1037,7 @@ static TEE_Result ree_fs_rename(struct tee_pobj *old, struct tee_pobj *new,
 		goto out;
 
 	res = tee_fs_dirfile_find(dirh, &new->uuid, new->obj_id,
-				  new->obj_id_len, &remove_dfh);
+				  new->obj_id_len, &old_dfh);
 	if (!res && !overwrite) {
 		res = TEE_ERROR_ACCESS_CONFLICT;
 		goto out;
@@ -832,21 +1053,21 @@ static TEE_Result ree_fs_rename(struct tee_pobj *old, struct tee_pobj *new,
 	if (res)
 		goto out;
 
-	if (remove_dfh.idx != -1) {
-		res = tee_fs_dirfile_remove(dirh, &remove_dfh);
+	if (old_dfh.idx != -1) {
+		res = tee_fs_dirfile_remove(dirh, &old_dfh);
 		if (res)
 			goto out;
 	}
 
-	res = commit_dirh_writes(dirh);
+	res = commit_dirh(dirh);
 	if (res)
 		goto out;
 
-	if (remove_dfh.idx != -1)
-		tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS, &remove_dfh);
+	if (old_dfh.idx != -1)
+		remove_dfh(&old_dfh);
 
 out:
-	put_dirh(dirh, res);
+	put_dirh(dirh, close_on_error(res));
 	mutex_unlock(&ree_fs_mutex);
 
 	return res;
@@ -873,11 +1094,11 @@ static TEE_Result ree_fs_remove(struct tee_pobj *po)
 	if (res)
 		goto out;
 
-	res = commit_dirh_writes(dirh);
+	res = commit_dirh(dirh);
 	if (res)
 		goto out;
 
-	tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS, &dfh);
+	remove_dfh(&dfh);
 
 	assert(tee_fs_dirfile_find(dirh, &po->uuid, po->obj_id, po->obj_id_len,
 				   &dfh));
@@ -900,18 +1121,19 @@ static TEE_Result ree_fs_truncate(struct tee_file_handle *fh, size_t len)
 	if (res)
 		goto out;
 
-	res = ree_fs_ftruncate_internal(fdp, len);
-	if (res)
+	if (!fdp->ht) {
+		res = TEE_ERROR_BAD_STATE;
 		goto out;
+	}
 
-	res = tee_fs_htree_sync_to_storage(&fdp->ht, fdp->dfh.hash);
+	res = ree_fs_ftruncate_internal(fdp, len);
 	if (res)
 		goto out;
 
-	res = tee_fs_dirfile_update_hash(dirh, &fdp->dfh);
+	res = sync_file(dirh, fdp);
 	if (res)
 		goto out;
-	res = commit_dirh_writes(dirh);
+	res = commit_dirh(dirh);
 out:
 	put_dirh(dirh, res);
 	mutex_unlock(&ree_fs_mutex);
@@ -976,12 +1198,137 @@ static TEE_Result ree_fs_readdir_rpc(struct tee_fs_dir *d,
 
 	mutex_lock(&ree_fs_mutex);
 
+	res = check_tx_owner();
+	if (res)
+		goto out;
+
 	d->d.oidlen = sizeof(d->d.oid);
 	res = tee_fs_dirfile_get_next(d->dirh, d->uuid, &d->idx, d->d.oid,
 				      &d->d.oidlen);
 	if (res == TEE_SUCCESS)
 		*ent = &d->d;
+out:
+	mutex_unlock(&ree_fs_mutex);
+
+	return res;
+}
+
+static TEE_Result ree_fs_begin_transaction(struct tee_ta_ctx *ctx)
+{
+	TEE_Result res;
+	struct tee_fs_dirfile_dirh *dirh = NULL;
+
+	mutex_lock(&ree_fs_mutex);
+
+	if (ree_fs_tx.owner) {
+		if (ree_fs_tx.owner == ctx)
+			res = TEE_ERROR_BAD_STATE;
+		else
+			res = TEE_ERROR_BUSY;
+		goto out;
+	}
 
+	/* Keeps the dirfile with the changes of the transaction open */
+	res = get_dirh(&dirh);
+	if (res)
+		goto out;
+
+	ree_fs_tx.owner = ctx;
+	ree_fs_tx.res = TEE_SUCCESS;
+	SLIST_INIT(&ree_fs_tx.fds);
+out:
+	mutex_unlock(&ree_fs_mutex);
+
+	return res;
+}
+
+static TEE_Result tx_commit(void)
+{
+	TEE_Result res;
+	struct tee_fs_dirfile_dirh *dirh = NULL;
+	struct tee_fs_fd *fdp = NULL;
+	size_t n = 0;
+
+	res = get_dirh(&dirh);
+	if (res)
+		return res;
+
+	SLIST_FOREACH(fdp, &ree_fs_tx.fds, tx_link) {
+		if (!fdp->tx_dirty)
+			continue;
+		res = tee_fs_htree_sync_to_storage(&fdp->ht, fdp->dfh.hash);
+		if (res)
+			goto out;
+		res = tee_fs_dirfile_update_hash(dirh, &fdp->dfh);
+		if (res)
+			goto out;
+	}
+
+	res = commit_dirh_writes(dirh);
+	if (res)
+		goto out;
+
+	for (n = 0; n < ree_fs_tx.removed_count; n++)
+		tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS, ree_fs_tx.removed + n);
+out:
+	put_dirh(dirh, res);
+	return res;
+}
+
+static void tx_abort(void)
+{
+	struct tee_fs_fd *fdp = NULL;
+
+	SLIST_FOREACH(fdp, &ree_fs_tx.fds, tx_link) {
+		if (fdp->tx_created) {
+			/* Left unusable if still open */
+			tee_fs_htree_close(&fdp->ht);
+			tee_fs_rpc_remove_dfh(OPTEE_RPC_CMD_FS, &fdp->dfh);
+		} else if (fdp->tx_dirty) {
+			fdp->dfh = fdp->tx_dfh;
+			tee_fs_htree_close(&fdp->ht);
+			if (tee_fs_htree_open(false, fdp->dfh.hash, fdp->uuid,
+					      &ree_fs_storage_ops, fdp,
+					      &fdp->ht))
+				EMSG("Can't reopen file %" PRIu32,
+				     fdp->dfh.file_number);
+		}
+	}
+
+	/* Reopened as committed when needed next */
+	if (ree_fs_dirh)
+		close_dirh(&ree_fs_dirh);
+}
+
+static TEE_Result ree_fs_end_transaction(struct tee_ta_ctx *ctx, bool commit)
+{
+	TEE_Result res = TEE_SUCCESS;
+
+	mutex_lock(&ree_fs_mutex);
+
+	if (ree_fs_tx.owner != ctx) {
+		res = TEE_ERROR_BAD_STATE;
+		goto out;
+	}
+
+	if (commit) {
+		res = ree_fs_tx.res;
+		if (!res)
+			res = tx_commit();
+		if (res)
+			tx_abort();
+	} else {
+		tx_abort();
+	}
+
+	while (!SLIST_EMPTY(&ree_fs_tx.fds))
+		tx_remove_file(SLIST_FIRST(&ree_fs_tx.fds));
+	free(ree_fs_tx.removed);
+	ree_fs_tx.removed = NULL;
+	ree_fs_tx.removed_count = 0;
+	ree_fs_tx.owner = NULL;
+	put_dirh_primitive(false);
+out:
 	mutex_unlock(&ree_fs_mutex);
 
 	return res;
@@ -999,4 +1346,6 @@ const struct tee_file_operations ree_fs_ops = {
 	.opendir = ree_fs_opendir_rpc,
 	.closedir = ree_fs_closedir_rpc,
 	.readdir = ree_fs_readdir_rpc,
+	.begin_transaction = ree_fs_begin_transaction,
+	.end_transaction = ree_fs_end_transaction,
 };
@@ -2285,6 +2285,7 @@ TEE_Result syscall_hash_update(unsigned long state, const void *chunk,
 	if (res != TEE_SUCCESS)
 		return res;
 
+
 	switch (TEE_ALG_GET_CLASS(cs->algo)) {
 	case TEE_OPERATION_DIGEST:
 		res = crypto_hash_update(cs->ctx, cs->algo, chunk, chunk_size);
@@ -2300,6 +2301,8 @@ TEE_Result syscall_hash_update(unsigned long state, const void *chunk,
 		return TEE_ERROR_BAD_PARAMETERS;
 	}
 
+	tee_ta_acct_crypto(sess, cs->algo, chunk_size);
+
 	return TEE_SUCCESS;
 }
 
@@ -2343,6 +2346,7 @@ TEE_Result syscall_hash_final(unsigned long state, const void *chunk,
 	if (res != TEE_SUCCESS)
 		return res;
 
+
 	switch (TEE_ALG_GET_CLASS(cs->algo)) {
 	case TEE_OPERATION_DIGEST:
 		res = tee_hash_get_digest_size(cs->algo, &hash_size);
@@ -2389,6 +2393,8 @@ TEE_Result syscall_hash_final(unsigned long state, const void *chunk,
 	default:
 		return TEE_ERROR_BAD_PARAMETERS;
 	}
+
+	tee_ta_acct_crypto(sess, cs->algo, chunk_size);
 out:
 	res2 = put_user_u64(hash_len, hash_size);
 	if (res2 != TEE_SUCCESS)
@@ -2469,6 +2475,7 @@ static TEE_Result tee_svc_cipher_update_helper(unsigned long state,
 	if (res != TEE_SUCCESS)
 		return res;
 
+
 	res = tee_mmu_check_access_rights(to_user_ta_ctx(sess->ctx),
 					  TEE_MEMORY_ACCESS_READ |
 					  TEE_MEMORY_ACCESS_ANY_OWNER,
@@ -2497,6 +2504,8 @@ static TEE_Result tee_svc_cipher_update_helper(unsigned long state,
 		goto out;
 	}
 
+	tee_ta_acct_crypto(sess, cs->algo, src_len);
+
 	if (src_len > 0) {
 		/* Permit src_len == 0 to finalize the operation */
 		res = tee_do_cipher_update(cs->ctx, cs->algo, cs->mode,
@@ -3034,6 +3043,7 @@ TEE_Result syscall_authenc_update_payload(unsigned long state,
 	if (res != TEE_SUCCESS)
 		return res;
 
+
 	res = tee_mmu_check_access_rights(to_user_ta_ctx(sess->ctx),
 					  TEE_MEMORY_ACCESS_READ |
 					  TEE_MEMORY_ACCESS_ANY_OWNER,
@@ -3058,6 +3068,7 @@ TEE_Result syscall_authenc_update_payload(unsigned long state,
 		goto out;
 	}
 
+	tee_ta_acct_crypto(sess, cs->algo, src_len);
 	res = crypto_authenc_update_payload(cs->ctx, cs->algo, cs->mode,
 					    src_data, src_len, dst_data,
 					    &dlen);
@@ -3090,6 +3101,7 @@ TEE_Result syscall_authenc_enc_final(unsigned long state,
 	if (res != TEE_SUCCESS)
 		return res;
 
+
 	if (cs->mode != TEE_MODE_ENCRYPT)
 		return TEE_ERROR_BAD_PARAMETERS;
 
@@ -3133,6 +3145,7 @@ TEE_Result syscall_authenc_enc_final(unsigned long state,
 	if (res != TEE_SUCCESS)
 		return res;
 
+	tee_ta_acct_crypto(sess, cs->algo, src_len);
 	res = crypto_authenc_enc_final(cs->ctx, cs->algo, src_data,
 				       src_len, dst_data, &dlen, tag, &tlen);
 
@@ -3171,6 +3184,7 @@ TEE_Result syscall_authenc_dec_final(unsigned long state,
 	if (res != TEE_SUCCESS)
 		return res;
 
+
 	if (cs->mode != TEE_MODE_DECRYPT)
 		return TEE_ERROR_BAD_PARAMETERS;
 
@@ -3209,6 +3223,7 @@ TEE_Result syscall_authenc_dec_final(unsigned long state,
 	if (res != TEE_SUCCESS)
 		return res;
 
+	tee_ta_acct_crypto(sess, cs->algo, src_len);
 	res = crypto_authenc_dec_final(cs->ctx, cs->algo, src_data, src_len,
 				       dst_data, &dlen, tag, tag_len);
 
@@ -3271,6 +3286,7 @@ TEE_Result syscall_asymm_operate(unsigned long state,
 	if (res != TEE_SUCCESS)
 		return res;
 
+
 	res = tee_mmu_check_access_rights(
 		utc,
 		TEE_MEMORY_ACCESS_READ | TEE_MEMORY_ACCESS_ANY_OWNER,
@@ -3310,6 +3326,8 @@ TEE_Result syscall_asymm_operate(unsigned long state,
 		goto out;
 	}
 
+	tee_ta_acct_crypto(sess, cs->algo, src_len);
+
 	switch (cs->algo) {
 	case TEE_ALG_RSA_NOPAD:
 		if (cs->mode == TEE_MODE_ENCRYPT) {
@@ -3438,6 +3456,7 @@ TEE_Result syscall_asymm_verify(unsigned long state,
 	if (res != TEE_SUCCESS)
 		return res;
 
+
 	if (cs->mode != TEE_MODE_VERIFY)
 		return TEE_ERROR_BAD_PARAMETERS;
 
@@ -3475,6 +3494,8 @@ TEE_Result syscall_asymm_verify(unsigned long state,
 		goto out;
 	}
 
+	tee_ta_acct_crypto(sess, cs->algo, data_len);
+
 	switch (TEE_ALG_GET_MAIN_ALG(cs->algo)) {
 	case TEE_MAIN_ALGO_RSA:
 		if (cs->algo != TEE_ALG_RSASSA_PKCS1_V1_5) {
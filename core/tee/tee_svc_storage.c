@@ -838,6 +838,7 @@ TEE_Result syscall_storage_obj_read(unsigned long obj, void *data, size_t len,
 	}
 
 	o->info.dataPosition += bytes;
+	tee_ta_acct_storage(sess, bytes, 0);
 
 	u_count = bytes;
 	res = tee_svc_copy_to_user(count, &u_count, sizeof(*count));
@@ -887,6 +888,7 @@ TEE_Result syscall_storage_obj_write(unsigned long obj, void *data, size_t len)
 	o->info.dataPosition += len;
 	if (o->info.dataPosition > o->info.dataSize)
 		o->info.dataSize = o->info.dataPosition;
+	tee_ta_acct_storage(sess, 0, len);
 
 exit:
 	return res;
@@ -993,6 +995,62 @@ TEE_Result syscall_storage_obj_seek(unsigned long obj, int32_t offset,
 	return TEE_SUCCESS;
 }
 
+static TEE_Result get_tx_fops(unsigned long storage_id,
+			      const struct tee_file_operations **fops)
+{
+	*fops = tee_svc_storage_file_ops(storage_id);
+	if (!*fops)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	if (!(*fops)->begin_transaction)
+		return TEE_ERROR_NOT_SUPPORTED;
+	return TEE_SUCCESS;
+}
+
+TEE_Result syscall_storage_tx_begin(unsigned long storage_id)
+{
+	const struct tee_file_operations *fops = NULL;
+	struct tee_ta_session *sess = NULL;
+	TEE_Result res;
+
+	res = get_tx_fops(storage_id, &fops);
+	if (res)
+		return res;
+
+	res = tee_ta_get_current_session(&sess);
+	if (res)
+		return res;
+
+	return fops->begin_transaction(sess->ctx);
+}
+
+TEE_Result syscall_storage_tx_end(unsigned long storage_id,
+				  unsigned long commit)
+{
+	const struct tee_file_operations *fops = NULL;
+	struct tee_ta_session *sess = NULL;
+	TEE_Result res;
+
+	res = get_tx_fops(storage_id, &fops);
+	if (res)
+		return res;
+
+	res = tee_ta_get_current_session(&sess);
+	if (res)
+		return res;
+
+	return fops->end_transaction(sess->ctx, commit);
+}
+
+void tee_svc_storage_abort_all_tx(struct user_ta_ctx *utc)
+{
+	const struct tee_file_operations *fops = NULL;
+
+	/* Only the REE FS supports transactions, fails if there's none */
+	fops = tee_svc_storage_file_ops(TEE_STORAGE_PRIVATE_REE);
+	if (fops && fops->end_transaction)
+		fops->end_transaction(&utc->ctx, false);
+}
+
 void tee_svc_storage_close_all_enum(struct user_ta_ctx *utc)
 {
 	struct tee_storage_enum_head *eh = &utc->storage_enums;
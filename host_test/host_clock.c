@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Compiled against the C library of the host, unlike the rest of the
+ * harness which is compiled against the headers of the TEE.
+ */
+#include <stdint.h>
+#include <time.h>
+
+uint64_t read_cntpct(void);
+uint32_t read_cntfrq(void);
+
+uint64_t read_cntpct(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+uint32_t read_cntfrq(void)
+{
+	return 1000000000;
+}
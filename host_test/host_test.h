@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <compiler.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A unit test or a benchmark. Benchmarks time @iterations runs of the
+ * operation and report the result with host_test_bench_report().
+ */
+struct host_test {
+	const char *name;
+	void (*func)(size_t iterations);
+};
+
+#define HOST_TEST_CHECK(expr) \
+	do { \
+		if (!(expr)) \
+			host_test_fail(#expr, __FILE__, __LINE__); \
+	} while (0)
+
+void host_test_fail(const char *expr, const char *file, int line);
+
+/* Nanoseconds from a monotonic clock */
+uint64_t host_test_now(void);
+
+/*
+ * Reports @iterations of a benchmark taking @ns nanoseconds in total,
+ * @bytes is the number of bytes processed by each iteration or 0
+ */
+void host_test_bench_report(const char *name, size_t iterations,
+			    size_t bytes, uint64_t ns);
+
+struct tee_ta_ctx;
+
+/*
+ * Sets the context returned by tee_ta_get_current_session(), NULL if
+ * there's no current session
+ */
+void host_test_set_current_ctx(struct tee_ta_ctx *ctx);
+
+struct host_event;
+struct host_thread;
+
+/*
+ * Threads of the host running a normal world peer of the module under
+ * test, they must only touch memory shared with the module. An event
+ * stays signaled until a wait returns, host_event_wait() returns false
+ * if @timeout_ms expired first.
+ */
+struct host_event *host_event_alloc(void);
+void host_event_free(struct host_event *ev);
+void host_event_signal(struct host_event *ev);
+bool host_event_wait(struct host_event *ev, uint32_t timeout_ms);
+struct host_thread *host_thread_start(void (*func)(void *arg), void *arg);
+void host_thread_join(struct host_thread *t);
+
+void test_malloc(size_t iterations);
+void test_mempool(size_t iterations);
+void test_qsort(size_t iterations);
+void test_snprintk(size_t iterations);
+void test_handle(size_t iterations);
+void test_aes_gcm(size_t iterations);
+void test_ctr_drbg(size_t iterations);
+void test_dirfile(size_t iterations);
+void test_lz4(size_t iterations);
+void test_dt_index(size_t iterations);
+void test_fs_htree(size_t iterations);
+void test_mpa(size_t iterations);
+void test_ree_fs(size_t iterations);
+void test_memfuncs(size_t iterations);
+void test_socket_ring(size_t iterations);
+
+void bench_malloc(size_t iterations);
+void bench_mempool(size_t iterations);
+void bench_qsort(size_t iterations);
+void bench_snprintk(size_t iterations);
+void bench_handle(size_t iterations);
+void bench_aes_gcm(size_t iterations);
+void bench_ctr_drbg(size_t iterations);
+void bench_dirfile(size_t iterations);
+void bench_lz4(size_t iterations);
+void bench_dt_index(size_t iterations);
+void bench_fs_htree(size_t iterations);
+void bench_mpa(size_t iterations);
+void bench_ree_fs(size_t iterations);
+void bench_memfuncs(size_t iterations);
+void bench_socket_ring(size_t iterations);
+
+#endif /*HOST_TEST_H*/
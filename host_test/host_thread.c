@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Threads and events of the host, for tests emulating a normal world
+ * peer running concurrently with the module under test. The peer must
+ * only touch memory shared with the module, the kernel primitives of
+ * stubs.c aren't thread safe. Compiled against the C library of the
+ * host.
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct host_event {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool signaled;
+};
+
+struct host_thread {
+	pthread_t thread;
+	void (*func)(void *arg);
+	void *arg;
+};
+
+struct host_event *host_event_alloc(void);
+void host_event_free(struct host_event *ev);
+void host_event_signal(struct host_event *ev);
+bool host_event_wait(struct host_event *ev, uint32_t timeout_ms);
+struct host_thread *host_thread_start(void (*func)(void *arg), void *arg);
+void host_thread_join(struct host_thread *t);
+
+struct host_event *host_event_alloc(void)
+{
+	struct host_event *ev = calloc(1, sizeof(*ev));
+	pthread_condattr_t attr;
+
+	if (!ev)
+		abort();
+	pthread_mutex_init(&ev->mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&ev->cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	return ev;
+}
+
+void host_event_free(struct host_event *ev)
+{
+	pthread_cond_destroy(&ev->cond);
+	pthread_mutex_destroy(&ev->mutex);
+	free(ev);
+}
+
+void host_event_signal(struct host_event *ev)
+{
+	pthread_mutex_lock(&ev->mutex);
+	ev->signaled = true;
+	pthread_cond_broadcast(&ev->cond);
+	pthread_mutex_unlock(&ev->mutex);
+}
+
+bool host_event_wait(struct host_event *ev, uint32_t timeout_ms)
+{
+	struct timespec ts;
+	bool ret = false;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ts.tv_sec += timeout_ms / 1000;
+	ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (ts.tv_nsec >= 1000000000L) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&ev->mutex);
+	while (!ev->signaled)
+		if (pthread_cond_timedwait(&ev->cond, &ev->mutex,
+					   &ts) == ETIMEDOUT)
+			break;
+	ret = ev->signaled;
+	ev->signaled = false;
+	pthread_mutex_unlock(&ev->mutex);
+
+	return ret;
+}
+
+static void *thread_main(void *arg)
+{
+	struct host_thread *t = arg;
+
+	t->func(t->arg);
+	return NULL;
+}
+
+struct host_thread *host_thread_start(void (*func)(void *arg), void *arg)
+{
+	struct host_thread *t = calloc(1, sizeof(*t));
+
+	if (!t)
+		abort();
+	t->func = func;
+	t->arg = arg;
+	if (pthread_create(&t->thread, NULL, thread_main, t))
+		abort();
+
+	return t;
+}
+
+void host_thread_join(struct host_thread *t)
+{
+	pthread_join(t->thread, NULL);
+	free(t);
+}
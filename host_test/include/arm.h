@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Replaces core/arch/arm/include/arm.h when building for the host. The
+ * system counter is emulated with a monotonic clock counting nanoseconds.
+ */
+#ifndef ARM_H
+#define ARM_H
+
+#include <types_ext.h>
+
+uint64_t read_cntpct(void);
+uint32_t read_cntfrq(void);
+
+static inline void isb(void)
+{
+}
+
+static inline void dmb(void)
+{
+	__sync_synchronize();
+}
+
+static inline void dsb(void)
+{
+	__sync_synchronize();
+}
+
+#endif /*ARM_H*/
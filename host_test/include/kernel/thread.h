@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Replaces core/arch/arm/include/kernel/thread.h when building for the
+ * host. The modules under test run in a single thread, exceptions are
+ * tracked only to keep the assertions of the spinlock helpers meaningful.
+ */
+#ifndef KERNEL_THREAD_H
+#define KERNEL_THREAD_H
+
+#include <stdbool.h>
+#include <types_ext.h>
+
+struct mobj;
+
+#define THREAD_EXCP_FOREIGN_INTR	0x1
+#define THREAD_EXCP_NATIVE_INTR		0x2
+#define THREAD_EXCP_ALL			(THREAD_EXCP_FOREIGN_INTR | \
+					 THREAD_EXCP_NATIVE_INTR)
+
+uint32_t thread_get_exceptions(void);
+void thread_set_exceptions(uint32_t exceptions);
+uint32_t thread_mask_exceptions(uint32_t exceptions);
+void thread_unmask_exceptions(uint32_t state);
+
+static inline bool thread_foreign_intr_disabled(void)
+{
+	return thread_get_exceptions() & THREAD_EXCP_FOREIGN_INTR;
+}
+
+#define THREAD_ID_INVALID		-1
+
+#define THREAD_RPC_MAX_NUM_PARAMS	4
+
+struct thread_param_memref {
+	size_t offs;
+	size_t size;
+	struct mobj *mobj;
+};
+
+struct thread_param_value {
+	uint64_t a;
+	uint64_t b;
+	uint64_t c;
+};
+
+enum thread_param_attr {
+	THREAD_PARAM_ATTR_NONE = 0,
+	THREAD_PARAM_ATTR_VALUE_IN,
+	THREAD_PARAM_ATTR_VALUE_OUT,
+	THREAD_PARAM_ATTR_VALUE_INOUT,
+	THREAD_PARAM_ATTR_MEMREF_IN,
+	THREAD_PARAM_ATTR_MEMREF_OUT,
+	THREAD_PARAM_ATTR_MEMREF_INOUT,
+};
+
+/* Only carries the operations of the RPC backends of the tests */
+struct thread_param {
+	enum thread_param_attr attr;
+	union {
+		struct thread_param_memref memref;
+		struct thread_param_value value;
+	} u;
+};
+
+#define THREAD_PARAM_MEMREF(_direction, _mobj, _offs, _size) \
+	(struct thread_param){ \
+		.attr = THREAD_PARAM_ATTR_MEMREF_ ## _direction, .u.memref = { \
+		.mobj = (_mobj), .offs = (_offs), .size = (_size) } \
+	}
+
+#define THREAD_PARAM_VALUE(_direction, _a, _b, _c) \
+	(struct thread_param){ \
+		.attr = THREAD_PARAM_ATTR_VALUE_ ## _direction, .u.value = { \
+		.a = (_a), .b = (_b), .c = (_c) } \
+	}
+
+/* Provided by the tests of the modules doing RPCs */
+uint32_t thread_rpc_cmd(uint32_t cmd, size_t num_params,
+			struct thread_param *params);
+struct mobj *thread_rpc_alloc_payload(size_t size);
+void thread_rpc_free_payload(struct mobj *mobj);
+
+int thread_get_id(void);
+int thread_get_id_may_fail(void);
+
+#endif /*KERNEL_THREAD_H*/
@@ -0,0 +1,16 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Replaces core/arch/arm/include/mm/core_memprot.h when building for the
+ * host. The modules under test only use memory from the heap, there's no
+ * translation between physical and virtual addresses.
+ */
+#ifndef CORE_MEMPROT_H
+#define CORE_MEMPROT_H
+
+#include <types_ext.h>
+
+#endif /*CORE_MEMPROT_H*/
@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Replaces core/arch/arm/include/mm/mobj.h when building for the host.
+ * A memory object is only a buffer on the heap, defined by the test
+ * providing thread_rpc_alloc_payload().
+ */
+#ifndef __MM_MOBJ_H
+#define __MM_MOBJ_H
+
+#include <types_ext.h>
+
+struct mobj;
+
+void *mobj_get_va(struct mobj *mobj, size_t offs);
+
+#endif /*__MM_MOBJ_H*/
@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Replaces core/arch/arm/include/mm/tee_pager.h when building for the
+ * host. The modules under test are built without CFG_WITH_PAGER.
+ */
+#ifndef MM_TEE_PAGER_H
+#define MM_TEE_PAGER_H
+
+#include <types_ext.h>
+
+#endif /*MM_TEE_PAGER_H*/
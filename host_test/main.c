@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define HEAP_SIZE	(4 * 1024 * 1024)
+
+static const struct host_test tests[] = {
+	{ "malloc", test_malloc },
+	{ "mempool", test_mempool },
+	{ "qsort", test_qsort },
+	{ "snprintk", test_snprintk },
+	{ "handle", test_handle },
+	{ "aes_gcm", test_aes_gcm },
+	{ "ctr_drbg", test_ctr_drbg },
+	{ "dirfile", test_dirfile },
+	{ "lz4", test_lz4 },
+	{ "dt_index", test_dt_index },
+	{ "fs_htree", test_fs_htree },
+	{ "mpa", test_mpa },
+	{ "ree_fs", test_ree_fs },
+	{ "memfuncs", test_memfuncs },
+	{ "socket_ring", test_socket_ring },
+};
+
+static const struct host_test benchmarks[] = {
+	{ "malloc", bench_malloc },
+	{ "mempool", bench_mempool },
+	{ "qsort", bench_qsort },
+	{ "snprintk", bench_snprintk },
+	{ "handle", bench_handle },
+	{ "aes_gcm", bench_aes_gcm },
+	{ "ctr_drbg", bench_ctr_drbg },
+	{ "dirfile", bench_dirfile },
+	{ "lz4", bench_lz4 },
+	{ "dt_index", bench_dt_index },
+	{ "fs_htree", bench_fs_htree },
+	{ "mpa", bench_mpa },
+	{ "ree_fs", bench_ree_fs },
+	{ "memfuncs", bench_memfuncs },
+	{ "socket_ring", bench_socket_ring },
+};
+
+static uint8_t heap[HEAP_SIZE] __aligned(64);
+static const char *current_test;
+
+uint64_t read_cntpct(void);
+
+uint64_t host_test_now(void)
+{
+	return read_cntpct();
+}
+
+void host_test_fail(const char *expr, const char *file, int line)
+{
+	printf("FAIL %s: %s at %s:%d\n", current_test, expr, file, line);
+	abort();
+}
+
+void host_test_bench_report(const char *name, size_t iterations,
+			    size_t bytes, uint64_t ns)
+{
+	unsigned long ns_per_op = 0;
+	unsigned long mb_per_s = 0;
+
+	if (iterations)
+		ns_per_op = ns / iterations;
+	if (bytes && ns)
+		mb_per_s = (uint64_t)bytes * iterations * 1000 / ns;
+
+	if (bytes)
+		printf("%-28s %10lu ns/op %8lu MB/s\n", name, ns_per_op,
+		       mb_per_s);
+	else
+		printf("%-28s %10lu ns/op\n", name, ns_per_op);
+}
+
+static int usage(const char *prog)
+{
+	printf("usage: %s [-b iterations] [name...]\n", prog);
+	return 1;
+}
+
+static bool selected(const char *name, int argc, char *argv[])
+{
+	int n = 0;
+
+	if (!argc)
+		return true;
+	for (n = 0; n < argc; n++)
+		if (!strcmp(name, argv[n]))
+			return true;
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	const struct host_test *t = tests;
+	size_t num_tests = ARRAY_SIZE(tests);
+	size_t iterations = 1;
+	size_t n = 0;
+	int argn = 1;
+
+	if (argn < argc && !strcmp(argv[argn], "-b")) {
+		if (argn + 1 >= argc)
+			return usage(argv[0]);
+		iterations = strtoul(argv[argn + 1], NULL, 0);
+		if (!iterations)
+			return usage(argv[0]);
+		t = benchmarks;
+		num_tests = ARRAY_SIZE(benchmarks);
+		argn += 2;
+	}
+
+	malloc_add_pool(heap, sizeof(heap));
+
+	for (n = 0; n < num_tests; n++) {
+		if (!selected(t[n].name, argc - argn, argv + argn))
+			continue;
+		current_test = t[n].name;
+		t[n].func(iterations);
+		if (t == tests)
+			printf("PASS %s\n", t[n].name);
+	}
+
+	return 0;
+}
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Kernel primitives used by the modules under test. The harness is single
+ * threaded so locks only check that they are used in a balanced way.
+ */
+#include <assert.h>
+#include <kernel/mutex.h>
+#include <kernel/panic.h>
+#include <kernel/spinlock.h>
+#include <kernel/tee_ta_manager.h>
+#include <kernel/thread.h>
+#include <printk.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <trace.h>
+
+#include "host_test.h"
+
+int trace_level = TRACE_LEVEL;
+const char trace_ext_prefix[] = "HT";
+
+static uint32_t exceptions_state;
+
+uint32_t thread_get_exceptions(void)
+{
+	return exceptions_state;
+}
+
+void thread_set_exceptions(uint32_t exceptions)
+{
+	exceptions_state = exceptions;
+}
+
+uint32_t thread_mask_exceptions(uint32_t exceptions)
+{
+	uint32_t state = exceptions_state;
+
+	exceptions_state |= exceptions;
+	return state;
+}
+
+void thread_unmask_exceptions(uint32_t state)
+{
+	exceptions_state = state;
+}
+
+int thread_get_id(void)
+{
+	return 0;
+}
+
+int thread_get_id_may_fail(void)
+{
+	return 0;
+}
+
+void __cpu_spin_lock(unsigned int *lock)
+{
+	if (*lock != SPINLOCK_UNLOCK)
+		panic("spinlock already taken");
+	*lock = SPINLOCK_LOCK;
+}
+
+unsigned int __cpu_spin_trylock(unsigned int *lock)
+{
+	if (*lock != SPINLOCK_UNLOCK)
+		return 1;
+	*lock = SPINLOCK_LOCK;
+	return 0;
+}
+
+void __cpu_spin_unlock(unsigned int *lock)
+{
+	if (*lock != SPINLOCK_LOCK)
+		panic("spinlock not taken");
+	*lock = SPINLOCK_UNLOCK;
+}
+
+void mutex_init(struct mutex *m)
+{
+	*m = (struct mutex)MUTEX_INITIALIZER;
+}
+
+void mutex_destroy(struct mutex *m)
+{
+	if (m->state)
+		panic("mutex in use");
+}
+
+void mutex_lock(struct mutex *m)
+{
+	if (m->state)
+		panic("mutex already taken");
+	m->state = -1;
+	m->owner_id = thread_get_id();
+}
+
+bool mutex_trylock(struct mutex *m)
+{
+	if (m->state)
+		return false;
+	mutex_lock(m);
+	return true;
+}
+
+void mutex_unlock(struct mutex *m)
+{
+	if (m->state != -1)
+		panic("mutex not taken");
+	m->state = 0;
+	m->owner_id = MUTEX_OWNER_ID_NONE;
+}
+
+void mutex_read_lock(struct mutex *m)
+{
+	if (m->state < 0)
+		panic("mutex write locked");
+	m->state++;
+}
+
+bool mutex_read_trylock(struct mutex *m)
+{
+	if (m->state < 0)
+		return false;
+	m->state++;
+	return true;
+}
+
+void mutex_read_unlock(struct mutex *m)
+{
+	if (m->state <= 0)
+		panic("mutex not read locked");
+	m->state--;
+}
+
+void condvar_init(struct condvar *cv)
+{
+	*cv = (struct condvar)CONDVAR_INITIALIZER;
+}
+
+void condvar_destroy(struct condvar *cv __unused)
+{
+}
+
+void condvar_signal(struct condvar *cv __unused)
+{
+}
+
+void condvar_broadcast(struct condvar *cv __unused)
+{
+}
+
+void condvar_wait(struct condvar *cv __unused, struct mutex *m __unused)
+{
+	/* Nothing can change the condition while we're alone */
+	panic("condvar_wait() would block forever");
+}
+
+/* Session of the TA the modules under test are called on behalf of */
+static struct tee_ta_session current_session;
+
+void host_test_set_current_ctx(struct tee_ta_ctx *ctx)
+{
+	current_session.ctx = ctx;
+}
+
+TEE_Result tee_ta_get_current_session(struct tee_ta_session **sess)
+{
+	if (!current_session.ctx)
+		return TEE_ERROR_BAD_STATE;
+	*sess = &current_session;
+	return TEE_SUCCESS;
+}
+
+/* The pseudo TAs under test are called from the current session */
+struct tee_ta_session *tee_ta_get_calling_session(void)
+{
+	if (!current_session.ctx)
+		return NULL;
+	return &current_session;
+}
+
+void trace_ext_puts(const char *str)
+{
+	printf("%s", str);
+}
+
+int trace_ext_get_thread_id(void)
+{
+	return -1;
+}
+
+void trace_printf(const char *function, int line, int level, bool level_ok,
+		  const char *fmt, ...)
+{
+	char buf[256] = { 0 };
+	va_list ap;
+
+	if (level_ok && level > trace_level)
+		return;
+
+	va_start(ap, fmt);
+	vsnprintk(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	if (function)
+		printf("%s:%d %s\n", function, line, buf);
+	else
+		printf("%s", buf);
+}
+
+void _assert_log(const char *expr, const char *file, const int line,
+		 const char *func)
+{
+	printf("assertion '%s' failed at %s:%d in %s()\n", expr, file, line,
+	       func);
+}
+
+void __noreturn _assert_break(void)
+{
+	abort();
+}
+
+void __noreturn __do_panic(const char *file, const int line,
+			   const char *func, const char *msg)
+{
+	printf("panic '%s' at %s:%d in %s()\n", msg ? msg : "", file, line,
+	       func);
+	abort();
+}
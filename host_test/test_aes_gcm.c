@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <crypto/internal_aes-gcm.h>
+#include <malloc.h>
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+/* Test Case 3 of "The Galois/Counter Mode of Operation (GCM)" */
+static const uint8_t key[] = {
+	0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c,
+	0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08,
+};
+
+static const uint8_t nonce[] = {
+	0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad,
+	0xde, 0xca, 0xf8, 0x88,
+};
+
+static const uint8_t plain[] = {
+	0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5,
+	0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+	0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,
+	0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+	0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+	0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+	0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57,
+	0xba, 0x63, 0x7b, 0x39, 0x1a, 0xaf, 0xd2, 0x55,
+};
+
+static const uint8_t cipher[] = {
+	0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24,
+	0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+	0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+	0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+	0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+	0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+	0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97,
+	0x3d, 0x58, 0xe0, 0x91, 0x47, 0x3f, 0x59, 0x85,
+};
+
+static const uint8_t tag[] = {
+	0x4d, 0x5c, 0x2a, 0xf3, 0x27, 0xcd, 0x64, 0xa6,
+	0x2c, 0xf3, 0x5a, 0xbd, 0x2b, 0xa6, 0xfa, 0xb4,
+};
+
+void test_aes_gcm(size_t iterations __unused)
+{
+	struct internal_aes_gcm_key ek = { };
+	uint8_t buf[sizeof(plain)] = { 0 };
+	uint8_t t[sizeof(tag)] = { 0 };
+	size_t tag_len = sizeof(t);
+
+	HOST_TEST_CHECK(!internal_aes_gcm_expand_enc_key(key, sizeof(key),
+							 &ek));
+
+	HOST_TEST_CHECK(!internal_aes_gcm_enc(&ek, nonce, sizeof(nonce),
+					      NULL, 0, plain, sizeof(plain),
+					      buf, t, &tag_len));
+	HOST_TEST_CHECK(tag_len == sizeof(tag));
+	HOST_TEST_CHECK(!memcmp(buf, cipher, sizeof(cipher)));
+	HOST_TEST_CHECK(!memcmp(t, tag, sizeof(tag)));
+
+	HOST_TEST_CHECK(!internal_aes_gcm_dec(&ek, nonce, sizeof(nonce),
+					      NULL, 0, cipher, sizeof(cipher),
+					      buf, tag, sizeof(tag)));
+	HOST_TEST_CHECK(!memcmp(buf, plain, sizeof(plain)));
+
+	t[0] ^= 1;
+	HOST_TEST_CHECK(internal_aes_gcm_dec(&ek, nonce, sizeof(nonce),
+					     NULL, 0, cipher, sizeof(cipher),
+					     buf, t, sizeof(t)) ==
+			TEE_ERROR_MAC_INVALID);
+}
+
+/* Same size as a page of the pager, see encrypt_page() in tee_pager.c */
+#define BENCH_SIZE	4096
+
+void bench_aes_gcm(size_t iterations)
+{
+	struct internal_aes_gcm_key ek = { };
+	uint8_t *src = calloc(1, BENCH_SIZE);
+	uint8_t *dst = calloc(1, BENCH_SIZE);
+	uint8_t t[sizeof(tag)] = { 0 };
+	size_t tag_len = sizeof(t);
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	HOST_TEST_CHECK(src && dst);
+	HOST_TEST_CHECK(!internal_aes_gcm_expand_enc_key(key, sizeof(key),
+							 &ek));
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		internal_aes_gcm_enc(&ek, nonce, sizeof(nonce), NULL, 0, src,
+				     BENCH_SIZE, dst, t, &tag_len);
+	host_test_bench_report("aes_gcm_enc 4k", iterations, BENCH_SIZE,
+			       host_test_now() - begin);
+
+	free(src);
+	free(dst);
+}
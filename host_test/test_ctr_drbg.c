@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <crypto/crypto.h>
+#include <malloc.h>
+#include <rng_support.h>
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+static const char pers[] = "host_test personalization";
+
+/*
+ * Output of a reference implementation of SP 800-90A CTR_DRBG AES-256
+ * without derivation function, instantiated with the entropy input
+ * 0x00, 0x01, ..., 0x2f and the personalization string above.
+ */
+static const uint8_t out1[] = {
+	0x9e, 0x3b, 0x0a, 0xd7, 0x17, 0x46, 0x2e, 0x61,
+	0xd7, 0xa5, 0x78, 0xbf, 0xe1, 0x37, 0x71, 0x62,
+	0xad, 0xce, 0xde, 0x2a, 0x7c, 0xd6, 0xaf, 0x07,
+	0x82, 0xdc, 0xc8, 0x62, 0x74, 0x96, 0x72, 0xea,
+	0x8e, 0xfe, 0x23, 0x23, 0x91, 0xe2, 0x25, 0xa7,
+	0x34, 0xca, 0xae, 0xe1, 0xd2, 0xca, 0x5d, 0x77,
+	0xfc, 0x2e, 0x92, 0xc9, 0x7b, 0x6e, 0x57, 0xe5,
+	0x1f, 0xb0, 0x62, 0x19, 0x2f, 0xba, 0xc2, 0x58,
+};
+
+static const uint8_t out2[] = {
+	0x7a, 0xea, 0xc4, 0x84, 0x3b, 0x39, 0xaa, 0xad,
+	0xec, 0x94, 0xe8, 0x46, 0xbc, 0xf5, 0xd3, 0x4f,
+	0xae, 0x4a, 0x57, 0x85,
+};
+
+static size_t hw_reads;
+
+TEE_Result hw_get_random_bytes(void *buf, size_t len)
+{
+	uint8_t *b = buf;
+	size_t n = 0;
+
+	for (n = 0; n < len; n++)
+		b[n] = n;
+	hw_reads++;
+
+	return TEE_SUCCESS;
+}
+
+void test_ctr_drbg(size_t iterations __unused)
+{
+	uint8_t buf[sizeof(out1)] = { 0 };
+	size_t n = 0;
+
+	HOST_TEST_CHECK(!crypto_rng_init(pers, sizeof(pers) - 1));
+	HOST_TEST_CHECK(!crypto_rng_read(buf, sizeof(out1)));
+	HOST_TEST_CHECK(!memcmp(buf, out1, sizeof(out1)));
+	HOST_TEST_CHECK(!crypto_rng_read(buf, sizeof(out2)));
+	HOST_TEST_CHECK(!memcmp(buf, out2, sizeof(out2)));
+	HOST_TEST_CHECK(hw_reads == 1);
+
+	/* Reseeded once the reseed interval has passed */
+	for (n = 0; n < 70000; n++)
+		HOST_TEST_CHECK(!crypto_rng_read(buf, 1));
+	HOST_TEST_CHECK(hw_reads == 2);
+}
+
+#define BENCH_SIZE	256
+
+void bench_ctr_drbg(size_t iterations)
+{
+	uint8_t buf[BENCH_SIZE] = { 0 };
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		crypto_rng_read(buf, sizeof(buf));
+	host_test_bench_report("ctr_drbg 256", iterations, BENCH_SIZE,
+			       host_test_now() - begin);
+}
@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tee/fs_dirfile.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define NUM_OBJECTS	500
+
+/* dirf.db backed by memory, counting the reads which would be RPCs */
+static uint8_t *file_data;
+static size_t file_size;
+static size_t file_reads;
+
+static TEE_Result mem_open(bool create, uint8_t *hash __unused,
+			   const TEE_UUID *uuid __unused,
+			   struct tee_fs_dirfile_fileh *dfh __unused,
+			   struct tee_file_handle **fh)
+{
+	if (create) {
+		free(file_data);
+		file_data = NULL;
+		file_size = 0;
+	}
+	*fh = (struct tee_file_handle *)&file_data;
+	return TEE_SUCCESS;
+}
+
+static void mem_close(struct tee_file_handle *fh __unused)
+{
+}
+
+static TEE_Result mem_read(struct tee_file_handle *fh __unused, size_t pos,
+			   void *buf, size_t *len)
+{
+	file_reads++;
+	if (pos >= file_size)
+		*len = 0;
+	else
+		*len = MIN(*len, file_size - pos);
+	memcpy(buf, file_data + pos, *len);
+	return TEE_SUCCESS;
+}
+
+static TEE_Result mem_write(struct tee_file_handle *fh __unused, size_t pos,
+			    const void *buf, size_t len)
+{
+	void *p = NULL;
+
+	if (pos + len > file_size) {
+		p = realloc(file_data, pos + len);
+		if (!p)
+			return TEE_ERROR_OUT_OF_MEMORY;
+		file_data = p;
+		memset(file_data + file_size, 0, pos + len - file_size);
+		file_size = pos + len;
+	}
+	memcpy(file_data + pos, buf, len);
+	return TEE_SUCCESS;
+}
+
+static TEE_Result mem_commit_writes(struct tee_file_handle *fh __unused,
+				    uint8_t *hash __unused)
+{
+	return TEE_SUCCESS;
+}
+
+static const struct tee_fs_dirfile_operations mem_ops = {
+	.open = mem_open,
+	.close = mem_close,
+	.read = mem_read,
+	.write = mem_write,
+	.commit_writes = mem_commit_writes,
+};
+
+static const TEE_UUID uuid1 = { 1, 2, 3, { 4, 5, 6, 7, 8, 9, 10, 11 } };
+static const TEE_UUID uuid2 = { 2, 2, 3, { 4, 5, 6, 7, 8, 9, 10, 11 } };
+
+static void add_object(struct tee_fs_dirfile_dirh *dirh, const TEE_UUID *uuid,
+		       size_t n)
+{
+	struct tee_fs_dirfile_fileh dfh = { .idx = -1 };
+	char oid[16] = { 0 };
+
+	snprintf(oid, sizeof(oid), "obj%zu", n);
+	HOST_TEST_CHECK(!tee_fs_dirfile_get_tmp(dirh, &dfh));
+	HOST_TEST_CHECK(!tee_fs_dirfile_rename(dirh, uuid, &dfh, oid,
+					       strlen(oid)));
+}
+
+static struct tee_fs_dirfile_dirh *populate(void)
+{
+	struct tee_fs_dirfile_dirh *dirh = NULL;
+	size_t n = 0;
+
+	HOST_TEST_CHECK(!tee_fs_dirfile_open(true, NULL, &mem_ops, &dirh));
+	for (n = 0; n < NUM_OBJECTS; n++)
+		add_object(dirh, n % 2 ? &uuid2 : &uuid1, n);
+
+	return dirh;
+}
+
+static size_t count_objects(struct tee_fs_dirfile_dirh *dirh,
+			    const TEE_UUID *uuid)
+{
+	uint8_t oid[TEE_OBJECT_ID_MAX_LEN] = { 0 };
+	size_t oidlen = 0;
+	size_t count = 0;
+	int idx = -1;
+
+	while (true) {
+		oidlen = sizeof(oid);
+		if (tee_fs_dirfile_get_next(dirh, uuid, &idx, oid, &oidlen))
+			break;
+		count++;
+	}
+
+	return count;
+}
+
+/* Allocates all of the heap, returns a list of the blocks */
+static void *exhaust_heap(void)
+{
+	void *list = NULL;
+	void **p = NULL;
+	size_t size = 64 * 1024;
+
+	while (size >= sizeof(void *)) {
+		p = malloc(size);
+		if (!p) {
+			size /= 2;
+			continue;
+		}
+		*p = list;
+		list = p;
+	}
+
+	return list;
+}
+
+static void release_heap(void *list)
+{
+	void **p = NULL;
+
+	while (list) {
+		p = list;
+		list = *p;
+		free(p);
+	}
+}
+
+void test_dirfile(size_t iterations __unused)
+{
+	void *heap = NULL;
+
+	struct tee_fs_dirfile_dirh *dirh = populate();
+	struct tee_fs_dirfile_fileh dfh = { .idx = -1 };
+
+	/* Reopening reads the entries in chunks */
+	tee_fs_dirfile_close(dirh);
+	file_reads = 0;
+	HOST_TEST_CHECK(!tee_fs_dirfile_open(false, NULL, &mem_ops, &dirh));
+	HOST_TEST_CHECK(file_reads < NUM_OBJECTS / 8);
+
+	/* Enumeration reads the dirfile once */
+	file_reads = 0;
+	HOST_TEST_CHECK(count_objects(dirh, &uuid1) == NUM_OBJECTS / 2);
+	HOST_TEST_CHECK(count_objects(dirh, &uuid1) == NUM_OBJECTS / 2);
+	HOST_TEST_CHECK(file_reads < NUM_OBJECTS / 8);
+	HOST_TEST_CHECK(count_objects(dirh, &uuid2) == NUM_OBJECTS / 2);
+
+	/* Out of memory for the cache the dirfile is read entry by entry */
+	heap = exhaust_heap();
+	file_reads = 0;
+	HOST_TEST_CHECK(count_objects(dirh, &uuid1) == NUM_OBJECTS / 2);
+	HOST_TEST_CHECK(file_reads >= NUM_OBJECTS);
+	release_heap(heap);
+	HOST_TEST_CHECK(count_objects(dirh, &uuid1) == NUM_OBJECTS / 2);
+
+	/* Lookups read only the entry found */
+	file_reads = 0;
+	HOST_TEST_CHECK(!tee_fs_dirfile_find(dirh, &uuid2, "obj123", 6, &dfh));
+	HOST_TEST_CHECK(file_reads == 1);
+	HOST_TEST_CHECK(tee_fs_dirfile_find(dirh, &uuid1, "obj123", 6, &dfh) ==
+			TEE_ERROR_ITEM_NOT_FOUND);
+	HOST_TEST_CHECK(tee_fs_dirfile_find(dirh, &uuid1, "nothing", 7,
+					    &dfh) == TEE_ERROR_ITEM_NOT_FOUND);
+
+	/* Changes are seen by the next enumeration and lookup */
+	HOST_TEST_CHECK(!tee_fs_dirfile_find(dirh, &uuid2, "obj1", 4, &dfh));
+	HOST_TEST_CHECK(!tee_fs_dirfile_remove(dirh, &dfh));
+	HOST_TEST_CHECK(tee_fs_dirfile_find(dirh, &uuid2, "obj1", 4, &dfh) ==
+			TEE_ERROR_ITEM_NOT_FOUND);
+	HOST_TEST_CHECK(count_objects(dirh, &uuid2) == NUM_OBJECTS / 2 - 1);
+	add_object(dirh, &uuid2, NUM_OBJECTS);
+	add_object(dirh, &uuid2, NUM_OBJECTS + 1);
+	HOST_TEST_CHECK(count_objects(dirh, &uuid2) == NUM_OBJECTS / 2 + 1);
+	/* The entry removed above is reused */
+	HOST_TEST_CHECK(!tee_fs_dirfile_find(dirh, &uuid2, "obj500", 6, &dfh));
+	HOST_TEST_CHECK(dfh.idx == 1);
+
+	HOST_TEST_CHECK(!tee_fs_dirfile_find(dirh, &uuid1, "obj0", 4, &dfh));
+	HOST_TEST_CHECK(!tee_fs_dirfile_rename(dirh, &uuid1, &dfh, "renamed",
+					       7));
+	HOST_TEST_CHECK(tee_fs_dirfile_find(dirh, &uuid1, "obj0", 4, &dfh) ==
+			TEE_ERROR_ITEM_NOT_FOUND);
+	HOST_TEST_CHECK(!tee_fs_dirfile_find(dirh, &uuid1, "renamed", 7, &dfh));
+	HOST_TEST_CHECK(dfh.idx == 0);
+
+	tee_fs_dirfile_close(dirh);
+}
+
+void bench_dirfile(size_t iterations)
+{
+	struct tee_fs_dirfile_dirh *dirh = populate();
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	begin = host_test_now();
+	for (n = 0; n < iterations / NUM_OBJECTS + 1; n++) {
+		/* Enumerations of different TAs don't share the cache */
+		count_objects(dirh, n % 2 ? &uuid2 : &uuid1);
+	}
+	host_test_bench_report("dirfile enum", (iterations / NUM_OBJECTS + 1) *
+			       NUM_OBJECTS / 2, 0, host_test_now() - begin);
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++) {
+		struct tee_fs_dirfile_fileh dfh = { .idx = -1 };
+		char oid[16] = { 0 };
+
+		snprintf(oid, sizeof(oid), "obj%zu", n % NUM_OBJECTS);
+		tee_fs_dirfile_find(dirh, n % 2 ? &uuid2 : &uuid1, oid,
+				    strlen(oid), &dfh);
+	}
+	host_test_bench_report("dirfile find", iterations, 0,
+			       host_test_now() - begin);
+
+	tee_fs_dirfile_close(dirh);
+}
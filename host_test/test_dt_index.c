@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <kernel/dt.h>
+#include <libfdt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define NUM_BUSES	16
+#define NUM_DEVS	32
+#define DTB_SIZE	(256 * 1024)
+
+/*
+ * A tree with NUM_BUSES buses of NUM_DEVS devices each, each device with
+ * a phandle and two compatible strings, the second shared by all devices
+ * of the same kind.
+ */
+static void *make_dtb(void)
+{
+	void *fdt = malloc(DTB_SIZE);
+	char name[32] = { 0 };
+	char compat[64] = { 0 };
+	uint32_t phandle = 1;
+	int len = 0;
+	int b = 0;
+	int d = 0;
+
+	HOST_TEST_CHECK(fdt);
+	HOST_TEST_CHECK(!fdt_create(fdt, DTB_SIZE));
+	HOST_TEST_CHECK(!fdt_finish_reservemap(fdt));
+	HOST_TEST_CHECK(!fdt_begin_node(fdt, ""));
+	HOST_TEST_CHECK(!fdt_begin_node(fdt, "chosen"));
+	HOST_TEST_CHECK(!fdt_end_node(fdt));
+	for (b = 0; b < NUM_BUSES; b++) {
+		snprintf(name, sizeof(name), "bus@%x", b * 0x1000000);
+		HOST_TEST_CHECK(!fdt_begin_node(fdt, name));
+		HOST_TEST_CHECK(!fdt_property_string(fdt, "compatible",
+						     "simple-bus"));
+		for (d = 0; d < NUM_DEVS; d++) {
+			snprintf(name, sizeof(name), "dev@%x", d * 0x1000);
+			HOST_TEST_CHECK(!fdt_begin_node(fdt, name));
+			len = snprintf(compat, sizeof(compat), "vnd,dev%d-%d",
+				       b, d) + 1;
+			len += snprintf(compat + len, sizeof(compat) - len,
+					"vnd,kind%d", d % 4) + 1;
+			HOST_TEST_CHECK(!fdt_property(fdt, "compatible",
+						      compat, len));
+			HOST_TEST_CHECK(!fdt_property_u32(fdt, "phandle",
+							  phandle++));
+			HOST_TEST_CHECK(!fdt_end_node(fdt));
+		}
+		HOST_TEST_CHECK(!fdt_end_node(fdt));
+	}
+	HOST_TEST_CHECK(!fdt_end_node(fdt));
+	HOST_TEST_CHECK(!fdt_finish(fdt));
+
+	return fdt;
+}
+
+static void check_compatible(const void *fdt, const char *compat)
+{
+	int a = -1;
+	int b = -1;
+
+	do {
+		a = fdt_node_offset_by_compatible(fdt, a, compat);
+		b = dt_node_offset_by_compatible(fdt, b, compat);
+		HOST_TEST_CHECK(a == b || (a < 0 && b < 0));
+	} while (a >= 0);
+}
+
+void test_dt_index(size_t iterations __unused)
+{
+	void *fdt = make_dtb();
+	char path[64] = { 0 };
+	uint32_t phandle = 0;
+	int offs = 0;
+	int depth = 0;
+
+	HOST_TEST_CHECK(!dt_index_init(fdt));
+
+	/* Every node is found by path, phandle and parent as with libfdt */
+	for (offs = 0; offs >= 0 && depth >= 0;
+	     offs = fdt_next_node(fdt, offs, &depth)) {
+		HOST_TEST_CHECK(!fdt_get_path(fdt, offs, path, sizeof(path)));
+		HOST_TEST_CHECK(dt_path_offset(fdt, path) == offs);
+		HOST_TEST_CHECK(dt_parent_offset(fdt, offs) ==
+				fdt_parent_offset(fdt, offs) ||
+				(!offs && dt_parent_offset(fdt, offs) < 0));
+		phandle = fdt_get_phandle(fdt, offs);
+		if (phandle)
+			HOST_TEST_CHECK(dt_node_offset_by_phandle(fdt,
+								  phandle) ==
+					offs);
+	}
+
+	check_compatible(fdt, "simple-bus");
+	check_compatible(fdt, "vnd,kind3");
+	check_compatible(fdt, "vnd,dev7-31");
+	check_compatible(fdt, "vnd,dev");
+	check_compatible(fdt, "none");
+
+	HOST_TEST_CHECK(dt_path_offset(fdt, "/") == 0);
+	HOST_TEST_CHECK(dt_path_offset(fdt, "/bus@0/dev") ==
+			fdt_path_offset(fdt, "/bus@0/dev"));
+	HOST_TEST_CHECK(dt_path_offset(fdt, "/secure-chosen") < 0);
+	HOST_TEST_CHECK(dt_path_offset(fdt, "/bus@0/dev@1000/x") < 0);
+	HOST_TEST_CHECK(dt_node_offset_by_phandle(fdt, 0xffff) < 0);
+
+	free(fdt);
+}
+
+void bench_dt_index(size_t iterations)
+{
+	void *fdt = make_dtb();
+	uint64_t begin = 0;
+	size_t count = MAX(iterations / 100, 1U);
+	size_t n = 0;
+
+	begin = host_test_now();
+	for (n = 0; n < count; n++)
+		HOST_TEST_CHECK(fdt_node_offset_by_compatible(fdt, -1,
+							      "vnd,dev15-31") >
+				0);
+	host_test_bench_report("fdt_node_offset_by_compatible", count, 0,
+			       host_test_now() - begin);
+
+	HOST_TEST_CHECK(!dt_index_init(fdt));
+	begin = host_test_now();
+	for (n = 0; n < count; n++)
+		HOST_TEST_CHECK(dt_node_offset_by_compatible(fdt, -1,
+							     "vnd,dev15-31") >
+				0);
+	host_test_bench_report("dt_node_offset_by_compatible", count, 0,
+			       host_test_now() - begin);
+
+	free(fdt);
+}
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Runs the hash tree tests of core_fs_htree_tests.c, which store the tree
+ * in memory instead of doing RPCs to tee-supplicant
+ */
+#include <kernel/tee_ta_manager.h>
+#include <string.h>
+#include <tee/tee_fs_key_manager.h>
+#include <trace.h>
+
+#include "../core/arch/arm/pta/core_self_tests.h"
+#include "host_test.h"
+
+static struct tee_ta_ctx test_ctx = {
+	.uuid = { 1, 2, 3, { 4, 5, 6, 7, 8, 9, 10, 11 } },
+};
+
+/* The FEK is kept as is, the key manager isn't under test */
+TEE_Result tee_fs_fek_crypt(const TEE_UUID *uuid __unused,
+			    TEE_OperationMode mode __unused,
+			    const uint8_t *in_key, size_t size,
+			    uint8_t *out_key)
+{
+	if (size != TEE_FS_KM_FEK_SIZE)
+		return TEE_ERROR_BAD_PARAMETERS;
+	memmove(out_key, in_key, size);
+	return TEE_SUCCESS;
+}
+
+void test_fs_htree(size_t iterations __unused)
+{
+	int level = trace_level;
+
+	host_test_set_current_ctx(&test_ctx);
+	/* The corruption tests log each corrupted node they detect */
+	trace_level = 0;
+	HOST_TEST_CHECK(!core_fs_htree_tests(0, NULL));
+	trace_level = level;
+	HOST_TEST_CHECK(core_fs_htree_tests(1, NULL) ==
+			TEE_ERROR_BAD_PARAMETERS);
+	host_test_set_current_ctx(NULL);
+}
+
+void bench_fs_htree(size_t iterations)
+{
+	int level = trace_level;
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	host_test_set_current_ctx(&test_ctx);
+	trace_level = 0;
+	begin = host_test_now();
+	/* Each run writes, reads back and corrupts a few small trees */
+	for (n = 0; n < iterations / 1000 + 1; n++)
+		HOST_TEST_CHECK(!core_fs_htree_tests(0, NULL));
+	trace_level = level;
+	host_test_set_current_ctx(NULL);
+	host_test_bench_report("fs_htree tests", iterations / 1000 + 1, 0,
+			       host_test_now() - begin);
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <stddef.h>
+#include <kernel/handle.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define NUM_HANDLES	100
+
+void test_handle(size_t iterations __unused)
+{
+	struct handle_db db = HANDLE_DB_INITIALIZER;
+	int handles[NUM_HANDLES] = { 0 };
+	int objs[NUM_HANDLES] = { 0 };
+	size_t n = 0;
+
+	HOST_TEST_CHECK(handle_get(&db, NULL) < 0);
+
+	for (n = 0; n < NUM_HANDLES; n++) {
+		handles[n] = handle_get(&db, objs + n);
+		HOST_TEST_CHECK(handles[n] >= 0);
+	}
+	for (n = 0; n < NUM_HANDLES; n++)
+		HOST_TEST_CHECK(handle_lookup(&db, handles[n]) == objs + n);
+
+	HOST_TEST_CHECK(handle_put(&db, handles[10]) == objs + 10);
+	HOST_TEST_CHECK(!handle_lookup(&db, handles[10]));
+	HOST_TEST_CHECK(!handle_put(&db, handles[10]));
+	HOST_TEST_CHECK(!handle_lookup(&db, -1));
+	HOST_TEST_CHECK(!handle_lookup(&db, 1000000));
+
+	/* The free slot is reused */
+	HOST_TEST_CHECK(handle_get(&db, objs + 10) == handles[10]);
+
+	handle_db_destroy(&db);
+	HOST_TEST_CHECK(!handle_lookup(&db, handles[0]));
+}
+
+void bench_handle(size_t iterations)
+{
+	struct handle_db db = HANDLE_DB_INITIALIZER;
+	int objs[NUM_HANDLES] = { 0 };
+	uint64_t begin = 0;
+	size_t n = 0;
+	int h = 0;
+
+	for (n = 0; n < NUM_HANDLES; n++)
+		HOST_TEST_CHECK(handle_get(&db, objs + n) >= 0);
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++) {
+		h = handle_get(&db, objs);
+		handle_put(&db, h);
+	}
+	host_test_bench_report("handle_get+put", iterations, 0,
+			       host_test_now() - begin);
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		handle_lookup(&db, n % NUM_HANDLES);
+	host_test_bench_report("handle_lookup", iterations, 0,
+			       host_test_now() - begin);
+
+	handle_db_destroy(&db);
+}
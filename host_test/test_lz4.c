@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <kernel/lz4.h>
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define BLOCK_SIZE	(16 * 1024)
+
+/*
+ * Compressed block with its expected output, built one sequence at a time
+ * by add_seq() like scripts/ta_bin_to_c.py does
+ */
+struct lz4_block {
+	uint8_t in[2 * BLOCK_SIZE];
+	size_t in_len;
+	uint8_t out[BLOCK_SIZE];
+	size_t out_len;
+};
+
+static void add_len(struct lz4_block *b, size_t len)
+{
+	for (; len >= 255; len -= 255)
+		b->in[b->in_len++] = 255;
+	b->in[b->in_len++] = len;
+}
+
+/* A match of @mlen bytes at @offs bytes back, none if @offs is 0 */
+static void add_seq(struct lz4_block *b, const uint8_t *lit, size_t nlit,
+		    size_t offs, size_t mlen)
+{
+	size_t n = 0;
+
+	b->in[b->in_len++] = (MIN(nlit, 15U) << 4) |
+			     (offs ? MIN(mlen - 4, 15U) : 0);
+	if (nlit >= 15)
+		add_len(b, nlit - 15);
+	memcpy(b->in + b->in_len, lit, nlit);
+	b->in_len += nlit;
+	memcpy(b->out + b->out_len, lit, nlit);
+	b->out_len += nlit;
+	if (!offs)
+		return;
+
+	b->in[b->in_len++] = offs;
+	b->in[b->in_len++] = offs >> 8;
+	if (mlen - 4 >= 15)
+		add_len(b, mlen - 4 - 15);
+	for (n = 0; n < mlen; n++, b->out_len++)
+		b->out[b->out_len] = b->out[b->out_len - offs];
+}
+
+/* Repeated runs, short and long literals and overlapping matches */
+static void make_block(struct lz4_block *b)
+{
+	static const uint8_t lit[300] = "Early TA";
+	size_t n = 0;
+
+	memset(b, 0, sizeof(*b));
+	add_seq(b, lit, 8, 1, 20);
+	add_seq(b, lit, sizeof(lit), 8, 300);
+	for (n = 0; b->out_len < BLOCK_SIZE - 600; n++)
+		add_seq(b, lit + n % 16, 1 + n % 20, 1 + (n * 37) % 200,
+			4 + n % 40);
+	add_seq(b, lit, 5, 0, 0);
+}
+
+static uint8_t out[BLOCK_SIZE];
+
+void test_lz4(size_t iterations __unused)
+{
+	static struct lz4_block b;
+	static const uint8_t empty[] = { 0x00 };
+	static const uint8_t lits[] = { 0x30, 'a', 'b', 'c' };
+	static const uint8_t bad_offs[] = { 0x14, 'a', 0x02, 0x00, 0x00 };
+	static const uint8_t zero_offs[] = { 0x14, 'a', 0x00, 0x00, 0x00 };
+	static const uint8_t long_lit[] = { 0xf0, 0xff };
+
+	HOST_TEST_CHECK(!lz4_decompress_block(empty, sizeof(empty), out, 0));
+	HOST_TEST_CHECK(!lz4_decompress_block(lits, sizeof(lits), out, 3));
+	HOST_TEST_CHECK(!memcmp(out, "abc", 3));
+
+	/* Output of the wrong size */
+	HOST_TEST_CHECK(lz4_decompress_block(lits, sizeof(lits), out, 2));
+	HOST_TEST_CHECK(lz4_decompress_block(lits, sizeof(lits), out, 4));
+	/* Match before the start of the output */
+	HOST_TEST_CHECK(lz4_decompress_block(bad_offs, sizeof(bad_offs), out,
+					     sizeof(out)));
+	HOST_TEST_CHECK(lz4_decompress_block(zero_offs, sizeof(zero_offs), out,
+					     sizeof(out)));
+	/* Truncated length */
+	HOST_TEST_CHECK(lz4_decompress_block(long_lit, sizeof(long_lit), out,
+					     sizeof(out)));
+
+	make_block(&b);
+	memset(out, 0, sizeof(out));
+	HOST_TEST_CHECK(!lz4_decompress_block(b.in, b.in_len, out, b.out_len));
+	HOST_TEST_CHECK(!memcmp(out, b.out, b.out_len));
+	HOST_TEST_CHECK(lz4_decompress_block(b.in, b.in_len - 1, out,
+					     b.out_len));
+	HOST_TEST_CHECK(lz4_decompress_block(b.in, b.in_len, out,
+					     b.out_len - 1));
+}
+
+void bench_lz4(size_t iterations)
+{
+	static struct lz4_block b;
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	make_block(&b);
+	iterations = MAX(iterations / 100, 1U);
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		HOST_TEST_CHECK(!lz4_decompress_block(b.in, b.in_len, out,
+						      b.out_len));
+	host_test_bench_report("lz4_decompress_block", iterations, b.out_len,
+			       host_test_now() - begin);
+}
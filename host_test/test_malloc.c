@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <malloc.h>
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define NUM_BUFS	64
+
+static uint32_t get_allocated(void)
+{
+	struct malloc_stats stats = { };
+
+	malloc_get_stats(&stats);
+	return stats.allocated;
+}
+
+void test_malloc(size_t iterations __unused)
+{
+	uint32_t allocated = get_allocated();
+	struct malloc_heap_stats hs = { };
+	uint8_t *bufs[NUM_BUFS] = { NULL };
+	uint8_t *p = NULL;
+	size_t n = 0;
+	size_t m = 0;
+
+	for (n = 0; n < NUM_BUFS; n++) {
+		bufs[n] = malloc(n * 8 + 1);
+		HOST_TEST_CHECK(bufs[n]);
+		HOST_TEST_CHECK(malloc_buffer_is_within_alloced(bufs[n],
+								n * 8 + 1));
+		memset(bufs[n], n, n * 8 + 1);
+	}
+	for (n = 0; n < NUM_BUFS; n++)
+		for (m = 0; m < n * 8 + 1; m++)
+			HOST_TEST_CHECK(bufs[n][m] == n);
+
+	malloc_get_heap_stats(&hs);
+	HOST_TEST_CHECK(hs.num_alloced >= NUM_BUFS);
+
+	/* Free every second buffer to fragment the heap */
+	for (n = 0; n < NUM_BUFS; n += 2) {
+		free(bufs[n]);
+		bufs[n] = NULL;
+	}
+
+	p = calloc(16, 16);
+	HOST_TEST_CHECK(p);
+	for (n = 0; n < 16 * 16; n++)
+		HOST_TEST_CHECK(!p[n]);
+
+	memset(p, 0xa5, 16 * 16);
+	p = realloc(p, 4096);
+	HOST_TEST_CHECK(p);
+	for (n = 0; n < 16 * 16; n++)
+		HOST_TEST_CHECK(p[n] == 0xa5);
+	free(p);
+
+	for (n = 0; n < NUM_BUFS; n++)
+		free(bufs[n]);
+
+	/* A request larger than the heap fails and is accounted */
+	HOST_TEST_CHECK(!malloc(SIZE_MAX / 2));
+	HOST_TEST_CHECK(get_allocated() == allocated);
+}
+
+void bench_malloc(size_t iterations)
+{
+	static const size_t sizes[] = { 16, 48, 100, 256, 1000, 4096 };
+	void *bufs[ARRAY_SIZE(sizes)] = { NULL };
+	uint64_t begin = 0;
+	size_t n = 0;
+	size_t m = 0;
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++) {
+		for (m = 0; m < ARRAY_SIZE(sizes); m++)
+			bufs[m] = malloc(sizes[m]);
+		for (m = 0; m < ARRAY_SIZE(sizes); m++)
+			free(bufs[m]);
+	}
+	host_test_bench_report("malloc+free x6", iterations, 0,
+			       host_test_now() - begin);
+}
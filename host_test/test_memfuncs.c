@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * memcpy(), memmove(), memset() and memcmp() of libutils against byte by
+ * byte references, for all relative alignments of source and destination
+ * and lengths around the block sizes of the implementations. The bytes
+ * around the range are compared too so that stray writes are caught.
+ */
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define MAX_OFFS	16
+#define MAX_SMALL_LEN	160
+#define BUF_SIZE	(4 * MAX_OFFS + 4097)
+
+static uint8_t buf[BUF_SIZE] __aligned(64);
+static uint8_t ref[BUF_SIZE] __aligned(64);
+static uint8_t src[BUF_SIZE] __aligned(64);
+
+/* Lengths past the small ones, around pages and the largest unrolling */
+static const size_t large_lens[] = {
+	255, 256, 257, 511, 1023, 1024, 1025, 4095, 4096, 4097,
+};
+
+/* Bytes of the buffers used, with some to spare past the end */
+static size_t span(size_t len)
+{
+	return 4 * MAX_OFFS + len;
+}
+
+static void fill(uint8_t *b, size_t len, unsigned int seed)
+{
+	size_t n = 0;
+
+	for (n = 0; n < len; n++)
+		b[n] = (n * 7 + seed) ^ (n >> 8);
+}
+
+static void ref_move(uint8_t *dst, const uint8_t *s, size_t len)
+{
+	size_t n = 0;
+
+	if (dst > s) {
+		for (n = len; n > 0; n--)
+			dst[n - 1] = s[n - 1];
+	} else {
+		for (n = 0; n < len; n++)
+			dst[n] = s[n];
+	}
+}
+
+static void ref_set(uint8_t *dst, int c, size_t len)
+{
+	size_t n = 0;
+
+	for (n = 0; n < len; n++)
+		dst[n] = c;
+}
+
+static void check_memcpy(size_t doffs, size_t soffs, size_t len)
+{
+	fill(buf, span(len), 1);
+	fill(ref, span(len), 1);
+	fill(src, span(len), 2);
+
+	ref_move(ref + doffs, src + soffs, len);
+	HOST_TEST_CHECK(memcpy(buf + doffs, src + soffs, len) == buf + doffs);
+	HOST_TEST_CHECK(!memcmp(buf, ref, span(len)));
+}
+
+/* Source and destination in the same buffer, overlapping if close */
+static void check_memmove(size_t doffs, size_t soffs, size_t len)
+{
+	fill(buf, span(len), 3);
+	fill(ref, span(len), 3);
+
+	ref_move(ref + doffs, ref + soffs, len);
+	HOST_TEST_CHECK(memmove(buf + doffs, buf + soffs, len) == buf + doffs);
+	HOST_TEST_CHECK(!memcmp(buf, ref, span(len)));
+}
+
+static void check_memset(size_t offs, int c, size_t len)
+{
+	fill(buf, span(len), 4);
+	fill(ref, span(len), 4);
+
+	ref_set(ref + offs, c, len);
+	HOST_TEST_CHECK(memset(buf + offs, c, len) == buf + offs);
+	HOST_TEST_CHECK(!memcmp(buf, ref, span(len)));
+}
+
+static int sign(int v)
+{
+	return (v > 0) - (v < 0);
+}
+
+/* Differences at the first, a middle and the last byte */
+static void check_memcmp(size_t aoffs, size_t boffs, size_t len)
+{
+	uint8_t *a = buf + aoffs;
+	uint8_t *b = src + boffs;
+	size_t pos[3] = { 0, len / 2, len - 1 };
+	size_t n = 0;
+
+	fill(a, len, 5);
+	fill(b, len, 5);
+	HOST_TEST_CHECK(!memcmp(a, b, len));
+
+	for (n = 0; n < ARRAY_SIZE(pos) && len; n++) {
+		/* Bytes compare as unsigned char */
+		a[pos[n]] = 0x80;
+		b[pos[n]] = 0x7f;
+		HOST_TEST_CHECK(memcmp(a, b, len) > 0);
+		HOST_TEST_CHECK(memcmp(b, a, len) < 0);
+		/* Not past the length */
+		HOST_TEST_CHECK(!memcmp(a, b, pos[n]));
+		b[pos[n]] = 0x80;
+		HOST_TEST_CHECK(!memcmp(a, b, len));
+	}
+
+	/* The first difference decides, not the sum or a later word */
+	if (len >= 2) {
+		a[0] = 1;
+		b[0] = 2;
+		a[len - 1] = 0xff;
+		b[len - 1] = 0;
+		HOST_TEST_CHECK(sign(memcmp(a, b, len)) == -1);
+	}
+}
+
+static void check_all(size_t doffs, size_t soffs, size_t len)
+{
+	check_memcpy(doffs, soffs, len);
+	check_memcpy(doffs, MAX_OFFS * 2 + soffs, len);
+	check_memmove(doffs, soffs, len);
+	check_memmove(soffs, doffs, len);
+	/* Overlapping by more than the offsets alone */
+	check_memmove(MAX_OFFS + doffs, soffs, len);
+	check_memmove(soffs, MAX_OFFS + doffs, len);
+	check_memcmp(doffs, soffs, len);
+}
+
+void test_memfuncs(size_t iterations __unused)
+{
+	size_t doffs = 0;
+	size_t soffs = 0;
+	size_t len = 0;
+	size_t n = 0;
+
+	for (doffs = 0; doffs < MAX_OFFS; doffs++) {
+		for (soffs = 0; soffs < MAX_OFFS; soffs++) {
+			for (len = 0; len <= MAX_SMALL_LEN; len++)
+				check_all(doffs, soffs, len);
+			for (n = 0; n < ARRAY_SIZE(large_lens); n++)
+				check_all(doffs, soffs, large_lens[n]);
+		}
+
+		for (len = 0; len <= MAX_SMALL_LEN; len++) {
+			check_memset(doffs, 0, len);
+			check_memset(doffs, 0xa5, len);
+			/* Only the low byte of the value is used */
+			check_memset(doffs, 0x1ff, len);
+			check_memset(doffs, -1, len);
+		}
+		for (n = 0; n < ARRAY_SIZE(large_lens); n++) {
+			check_memset(doffs, 0, large_lens[n]);
+			check_memset(doffs, 0x5a, large_lens[n]);
+		}
+	}
+
+	/* Moving onto itself is a no-op */
+	fill(buf, sizeof(buf), 6);
+	fill(ref, sizeof(ref), 6);
+	HOST_TEST_CHECK(memmove(buf + 3, buf + 3, 100) == buf + 3);
+	HOST_TEST_CHECK(!memcmp(buf, ref, sizeof(buf)));
+}
+
+static void bench_one(const char *name, size_t doffs, size_t soffs,
+		      size_t len, size_t iterations)
+{
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		memcpy(buf + doffs, src + soffs, len);
+	host_test_bench_report(name, iterations, len, host_test_now() - begin);
+}
+
+void bench_memfuncs(size_t iterations)
+{
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	bench_one("memcpy 4096 aligned", 0, 0, 4096, iterations);
+	bench_one("memcpy 4096 unaligned", 1, 3, 4096, iterations);
+	bench_one("memcpy 64 unaligned", 1, 3, 64, iterations);
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		memmove(buf + 1, buf, 4096);
+	host_test_bench_report("memmove 4096 overlapping", iterations, 4096,
+			       host_test_now() - begin);
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		memset(buf, n, 4096);
+	host_test_bench_report("memset 4096", iterations, 4096,
+			       host_test_now() - begin);
+
+	fill(buf, 4096, 0);
+	fill(src, 4096, 0);
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		HOST_TEST_CHECK(!memcmp(buf, src, 4096));
+	host_test_bench_report("memcmp 4096 equal", iterations, 4096,
+			       host_test_now() - begin);
+}
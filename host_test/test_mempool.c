@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <malloc.h>
+#include <mempool.h>
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define POOL_SIZE	(64 * 1024)
+
+static struct mempool *alloc_pool(void)
+{
+	void *data = malloc(POOL_SIZE);
+	struct mempool *pool = NULL;
+
+	HOST_TEST_CHECK(data);
+	pool = mempool_alloc_pool(data, POOL_SIZE, NULL);
+	HOST_TEST_CHECK(pool);
+
+	return pool;
+}
+
+void test_mempool(size_t iterations __unused)
+{
+	struct mempool *pool = alloc_pool();
+	uint8_t *a = NULL;
+	uint8_t *b = NULL;
+	uint8_t *c = NULL;
+	size_t n = 0;
+
+	a = mempool_alloc(pool, 100);
+	b = mempool_calloc(pool, 10, 10);
+	HOST_TEST_CHECK(a && b);
+	HOST_TEST_CHECK(!((vaddr_t)a & (MEMPOOL_ALIGN - 1)));
+	HOST_TEST_CHECK(!((vaddr_t)b & (MEMPOOL_ALIGN - 1)));
+	HOST_TEST_CHECK(b >= a + 100 || a >= b + 100);
+	for (n = 0; n < 100; n++)
+		HOST_TEST_CHECK(!b[n]);
+
+	/* Items are freed in reverse order, it's a stack */
+	mempool_free(pool, b);
+	c = mempool_alloc(pool, 100);
+	HOST_TEST_CHECK(c == b);
+	mempool_free(pool, c);
+	mempool_free(pool, a);
+
+	/* Everything freed, the pool starts over */
+	HOST_TEST_CHECK(mempool_alloc(pool, 10) == a);
+	HOST_TEST_CHECK(!mempool_alloc(pool, POOL_SIZE));
+	mempool_free(pool, a);
+}
+
+void bench_mempool(size_t iterations)
+{
+	struct mempool *pool = alloc_pool();
+	uint64_t begin = 0;
+	void *a = NULL;
+	void *b = NULL;
+	size_t n = 0;
+
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++) {
+		a = mempool_alloc(pool, 256);
+		b = mempool_alloc(pool, 1024);
+		mempool_free(pool, b);
+		mempool_free(pool, a);
+	}
+	host_test_bench_report("mempool_alloc+free x2", iterations, 0,
+			       host_test_now() - begin);
+}
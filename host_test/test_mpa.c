@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <mempool.h>
+#include <mpalib.h>
+#include <string.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define MPA_BITS	2048
+#define NUM_VARS	10
+#define NUM_TEMP_VARS	20
+
+/* 2^127 - 1 and 2^89 - 1 are Mersenne primes */
+#define PRIME_127	"7FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF"
+#define PRIME_89	"1FFFFFFFFFFFFFFFFFFFFFF"
+
+static uint32_t num_data[NUM_VARS][mpa_StaticVarSizeInU32(MPA_BITS)];
+static uint32_t pool_data[mpa_scratch_mem_size_in_U32(NUM_TEMP_VARS,
+						      MPA_BITS * 2)]
+	__aligned(MEMPOOL_ALIGN);
+static mpa_scratch_mem_base pool;
+static char str[MPA_STR_MAX_SIZE];
+
+static mpanum num(size_t idx)
+{
+	mpanum n = (mpanum)num_data[idx];
+
+	mpa_init_static(n, mpa_StaticVarSizeInU32(MPA_BITS));
+	return n;
+}
+
+static void init_pool(void)
+{
+	if (pool.pool)
+		return;
+	pool.bn_bits = MPA_BITS * 2;
+	pool.pool = mempool_alloc_pool(pool_data, sizeof(pool_data), NULL);
+	HOST_TEST_CHECK(pool.pool);
+}
+
+static void set(mpanum n, const char *s)
+{
+	HOST_TEST_CHECK(mpa_set_str(n, s) >= 0);
+}
+
+static bool equals(mpanum n, const char *s)
+{
+	HOST_TEST_CHECK(mpa_get_str(str, MPA_STRING_MODE_HEX_UC, n));
+	return !strcmp(str, s);
+}
+
+static void test_conv(void)
+{
+	uint8_t in[32] = { 0 };
+	uint8_t out[32] = { 0 };
+	size_t len = sizeof(out);
+	mpanum a = num(0);
+	size_t n = 0;
+
+	set(a, "123456789ABCDEF0123456789ABCDEF");
+	HOST_TEST_CHECK(equals(a, "123456789ABCDEF0123456789ABCDEF"));
+	set(a, "-1F");
+	HOST_TEST_CHECK(equals(a, "-1F"));
+	HOST_TEST_CHECK(mpa_cmp_short(a, -31) == 0);
+	set(a, "0");
+	HOST_TEST_CHECK(equals(a, "0"));
+
+	for (n = 0; n < sizeof(in); n++)
+		in[n] = n + 1;
+	HOST_TEST_CHECK(!mpa_set_oct_str(a, in, sizeof(in), false));
+	HOST_TEST_CHECK(!mpa_get_oct_str(out, &len, a));
+	HOST_TEST_CHECK(len == sizeof(in));
+	HOST_TEST_CHECK(!memcmp(in, out, len));
+	HOST_TEST_CHECK(mpa_highest_bit_index(a) == 248);
+}
+
+static void test_addsub(void)
+{
+	mpanum a = num(0);
+	mpanum b = num(1);
+	mpanum c = num(2);
+
+	set(a, PRIME_127);
+	set(b, PRIME_89);
+
+	/* Carries across all words */
+	mpa_add_word(c, a, 1, &pool);
+	HOST_TEST_CHECK(equals(c, "80000000000000000000000000000000"));
+	mpa_sub_word(c, c, 1, &pool);
+	HOST_TEST_CHECK(!mpa_cmp(c, a));
+
+	mpa_add(c, a, b, &pool);
+	mpa_sub(c, c, b, &pool);
+	HOST_TEST_CHECK(!mpa_cmp(c, a));
+
+	/* Negative results */
+	mpa_sub(c, b, a, &pool);
+	HOST_TEST_CHECK(mpa_cmp_short(c, 0) < 0);
+	HOST_TEST_CHECK(mpa_cmp(c, b) < 0);
+	mpa_add(c, c, a, &pool);
+	HOST_TEST_CHECK(!mpa_cmp(c, b));
+	mpa_sub(c, a, a, &pool);
+	HOST_TEST_CHECK(!mpa_cmp_short(c, 0));
+}
+
+static void test_muldiv(void)
+{
+	mpanum a = num(0);
+	mpanum b = num(1);
+	mpanum c = num(2);
+	mpanum q = num(3);
+	mpanum r = num(4);
+
+	set(a, PRIME_127);
+	set(b, PRIME_89);
+
+	/* (a * b + 12345) / b = a, remainder 12345 */
+	mpa_mul(c, a, b, &pool);
+	mpa_add_word(c, c, 12345, &pool);
+	mpa_div(q, r, c, b, &pool);
+	HOST_TEST_CHECK(!mpa_cmp(q, a));
+	HOST_TEST_CHECK(!mpa_cmp_short(r, 12345));
+
+	mpa_mul_word(c, a, 2, &pool);
+	mpa_shift_right(q, c, 1);
+	HOST_TEST_CHECK(!mpa_cmp(q, a));
+
+	mpa_shift_left(c, a, 100);
+	HOST_TEST_CHECK(mpa_highest_bit_index(c) == 226);
+	mpa_shift_right(c, c, 100);
+	HOST_TEST_CHECK(!mpa_cmp(c, a));
+
+	mpa_mod(r, c, b, &pool);
+	mpa_div(q, NULL, c, b, &pool);
+	mpa_mul(q, q, b, &pool);
+	mpa_add(q, q, r, &pool);
+	HOST_TEST_CHECK(!mpa_cmp(q, c));
+}
+
+static void test_modular(void)
+{
+	mpanum a = num(0);
+	mpanum n = num(1);
+	mpanum c = num(2);
+	mpanum g = num(3);
+	mpanum r_modn = num(4);
+	mpanum r2_modn = num(5);
+	mpa_word_t n_inv = 0;
+
+	set(n, PRIME_127);
+	set(a, "123456789ABCDEF0123456789ABCDEF");
+
+	HOST_TEST_CHECK(mpa_inv_mod(c, a, n, &pool) == 0);
+	mpa_mul_mod(c, c, a, n, &pool);
+	HOST_TEST_CHECK(!mpa_cmp_short(c, 1));
+
+	/* gcd(a, p) = 1 and gcd(a * q, q * p) = q for primes p, q */
+	mpa_gcd(g, a, n, &pool);
+	HOST_TEST_CHECK(!mpa_cmp_short(g, 1));
+	set(c, PRIME_89);
+	mpa_mul(g, a, c, &pool);
+	mpa_mul(c, c, n, &pool);
+	mpa_gcd(g, g, c, &pool);
+	set(c, PRIME_89);
+	HOST_TEST_CHECK(!mpa_cmp(g, c));
+
+	/* 4^13 mod 497 = 445 */
+	mpa_set_S32(n, 497);
+	mpa_set_S32(a, 4);
+	mpa_set_S32(c, 13);
+	HOST_TEST_CHECK(!mpa_compute_fmm_context(n, r_modn, r2_modn, &n_inv,
+						 &pool));
+	mpa_exp_mod(g, a, c, n, r_modn, r2_modn, n_inv, &pool);
+	HOST_TEST_CHECK(!mpa_cmp_short(g, 445));
+
+	/* Fermat: a^(p - 1) mod p = 1 */
+	set(n, PRIME_127);
+	set(a, "123456789ABCDEF0123456789ABCDEF");
+	mpa_sub_word(c, n, 1, &pool);
+	HOST_TEST_CHECK(!mpa_compute_fmm_context(n, r_modn, r2_modn, &n_inv,
+						 &pool));
+	mpa_exp_mod(g, a, c, n, r_modn, r2_modn, n_inv, &pool);
+	HOST_TEST_CHECK(!mpa_cmp_short(g, 1));
+}
+
+static void test_primes(void)
+{
+	mpanum n = num(0);
+	mpanum p = num(1);
+
+	set(n, PRIME_127);
+	HOST_TEST_CHECK(mpa_is_prob_prime(n, 100, &pool));
+	set(n, PRIME_89);
+	HOST_TEST_CHECK(mpa_is_prob_prime(n, 100, &pool));
+	/* 2^127 + 1 is divisible by 3 */
+	set(n, "80000000000000000000000000000001");
+	HOST_TEST_CHECK(!mpa_is_prob_prime(n, 100, &pool));
+	/* (2^89 - 1) * (2^127 - 1) has no small factor */
+	set(n, PRIME_89);
+	set(p, PRIME_127);
+	mpa_mul(n, n, p, &pool);
+	HOST_TEST_CHECK(!mpa_is_prob_prime(n, 100, &pool));
+	mpa_set_S32(n, 997);
+	HOST_TEST_CHECK(mpa_is_prob_prime(n, 100, &pool) == 1);
+}
+
+void test_mpa(size_t iterations __unused)
+{
+	init_pool();
+	test_conv();
+	test_addsub();
+	test_muldiv();
+	test_modular();
+	test_primes();
+}
+
+void bench_mpa(size_t iterations)
+{
+	mpanum a = num(0);
+	mpanum e = num(1);
+	mpanum n = num(2);
+	mpanum r = num(3);
+	mpanum r_modn = num(4);
+	mpanum r2_modn = num(5);
+	mpa_word_t n_inv = 0;
+	uint64_t begin = 0;
+	size_t count = iterations / 1000 + 1;
+	size_t k = 0;
+
+	init_pool();
+
+	/* A 2048-bit odd modulus and exponent, modular exponentiation */
+	HOST_TEST_CHECK(mpa_get_random_digits(n, MPA_BITS / 32) ==
+			MPA_BITS / 32);
+	mpa_shift_right(n, n, 1);
+	mpa_shift_left(a, mpa_constant_one(), MPA_BITS - 1);
+	mpa_add(n, n, a, &pool);
+	if (mpa_is_even(n))
+		mpa_add_word(n, n, 1, &pool);
+	HOST_TEST_CHECK(mpa_get_random_digits(e, MPA_BITS / 32) ==
+			MPA_BITS / 32);
+	mpa_mod(e, e, n, &pool);
+	mpa_set(a, e);
+	HOST_TEST_CHECK(!mpa_compute_fmm_context(n, r_modn, r2_modn, &n_inv,
+						 &pool));
+
+	begin = host_test_now();
+	for (k = 0; k < count; k++)
+		mpa_exp_mod(r, a, e, n, r_modn, r2_modn, n_inv, &pool);
+	host_test_bench_report("mpa exp_mod 2048", count, 0,
+			       host_test_now() - begin);
+
+	begin = host_test_now();
+	for (k = 0; k < iterations; k++)
+		mpa_mul_mod(r, a, e, n, &pool);
+	host_test_bench_report("mpa mul_mod 2048", iterations, 0,
+			       host_test_now() - begin);
+}
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#define NUM_ELEMS	1000
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t va = *(const uint32_t *)a;
+	uint32_t vb = *(const uint32_t *)b;
+
+	if (va < vb)
+		return -1;
+	return va > vb;
+}
+
+/* Deterministic pseudo random numbers, the sequence doesn't matter */
+static void fill(uint32_t *a, size_t n, uint32_t seed)
+{
+	size_t i = 0;
+
+	for (i = 0; i < n; i++) {
+		seed = seed * 1664525 + 1013904223;
+		a[i] = seed >> 8;
+	}
+}
+
+static void check_sorted(const uint32_t *a, size_t n)
+{
+	size_t i = 0;
+
+	for (i = 1; i < n; i++)
+		HOST_TEST_CHECK(a[i - 1] <= a[i]);
+}
+
+void test_qsort(size_t iterations __unused)
+{
+	uint32_t *a = calloc(NUM_ELEMS, sizeof(*a));
+	size_t n = 0;
+
+	HOST_TEST_CHECK(a);
+
+	/* Random, sorted, reversed and equal input */
+	fill(a, NUM_ELEMS, 1);
+	qsort(a, NUM_ELEMS, sizeof(*a), cmp_u32);
+	check_sorted(a, NUM_ELEMS);
+	qsort(a, NUM_ELEMS, sizeof(*a), cmp_u32);
+	check_sorted(a, NUM_ELEMS);
+	for (n = 0; n < NUM_ELEMS; n++)
+		a[n] = NUM_ELEMS - n;
+	qsort(a, NUM_ELEMS, sizeof(*a), cmp_u32);
+	check_sorted(a, NUM_ELEMS);
+	memset(a, 0, NUM_ELEMS * sizeof(*a));
+	qsort(a, NUM_ELEMS, sizeof(*a), cmp_u32);
+	check_sorted(a, NUM_ELEMS);
+
+	/* Degenerate sizes */
+	qsort(a, 0, sizeof(*a), cmp_u32);
+	qsort(a, 1, sizeof(*a), cmp_u32);
+
+	free(a);
+}
+
+void bench_qsort(size_t iterations)
+{
+	uint32_t *a = calloc(NUM_ELEMS, sizeof(*a));
+	uint64_t ns = 0;
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	HOST_TEST_CHECK(a);
+
+	/* Only the sorting is timed, not the refill */
+	for (n = 0; n < iterations; n++) {
+		fill(a, NUM_ELEMS, n);
+		begin = host_test_now();
+		qsort(a, NUM_ELEMS, sizeof(*a), cmp_u32);
+		ns += host_test_now() - begin;
+	}
+	host_test_bench_report("qsort 1000 u32", iterations, 0, ns);
+
+	free(a);
+}
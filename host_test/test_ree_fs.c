@@ -0,0 +1,509 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * Transactions of tee_ree_fs.c with the files of tee-supplicant kept in
+ * memory
+ */
+#include <kernel/tee_ta_manager.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tee/fs_dirfile.h>
+#include <tee/tee_fs.h>
+#include <tee/tee_fs_rpc.h>
+#include <tee/tee_pobj.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define MAX_FILES	16
+/* The file descriptor of dirf.db, the others are their file number */
+#define DIRF_FD		MAX_FILES
+
+struct mem_file {
+	bool used;
+	uint8_t *data;
+	size_t size;
+};
+
+static struct mem_file files[MAX_FILES + 1];
+/* Number of reads of dirf.db */
+static size_t dirf_reads;
+/* Largest transfer is a block of the hash tree */
+static uint8_t rpc_buf[4096];
+
+static struct mem_file *get_file(int fd)
+{
+	if (fd < 0 || fd > DIRF_FD)
+		return NULL;
+	return files + fd;
+}
+
+static int dfh_to_fd(const struct tee_fs_dirfile_fileh *dfh)
+{
+	if (!dfh)
+		return DIRF_FD;
+	if (dfh->file_number >= MAX_FILES)
+		return -1;
+	return dfh->file_number;
+}
+
+static TEE_Result resize_file(struct mem_file *f, size_t size)
+{
+	void *p = NULL;
+
+	if (size > f->size) {
+		p = realloc(f->data, size);
+		if (!p)
+			return TEE_ERROR_OUT_OF_MEMORY;
+		f->data = p;
+		memset(f->data + f->size, 0, size - f->size);
+	}
+	f->size = size;
+	return TEE_SUCCESS;
+}
+
+static void remove_file(struct mem_file *f)
+{
+	free(f->data);
+	memset(f, 0, sizeof(*f));
+}
+
+TEE_Result tee_fs_rpc_open_dfh(uint32_t id __unused,
+			       const struct tee_fs_dirfile_fileh *dfh, int *fd)
+{
+	struct mem_file *f = get_file(dfh_to_fd(dfh));
+
+	if (!f || !f->used)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	*fd = dfh_to_fd(dfh);
+	return TEE_SUCCESS;
+}
+
+TEE_Result tee_fs_rpc_create_dfh(uint32_t id __unused,
+				 const struct tee_fs_dirfile_fileh *dfh,
+				 int *fd)
+{
+	struct mem_file *f = get_file(dfh_to_fd(dfh));
+
+	if (!f)
+		return TEE_ERROR_STORAGE_NO_SPACE;
+	remove_file(f);
+	f->used = true;
+	*fd = dfh_to_fd(dfh);
+	return TEE_SUCCESS;
+}
+
+TEE_Result tee_fs_rpc_close(uint32_t id __unused, int fd __unused)
+{
+	return TEE_SUCCESS;
+}
+
+TEE_Result tee_fs_rpc_remove_dfh(uint32_t id __unused,
+				 const struct tee_fs_dirfile_fileh *dfh)
+{
+	struct mem_file *f = get_file(dfh_to_fd(dfh));
+
+	if (!f || !f->used)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	remove_file(f);
+	return TEE_SUCCESS;
+}
+
+TEE_Result tee_fs_rpc_truncate(uint32_t id __unused, int fd, size_t len)
+{
+	struct mem_file *f = get_file(fd);
+
+	if (!f || !f->used)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	return resize_file(f, len);
+}
+
+static TEE_Result op_init(struct tee_fs_rpc_operation *op, int fd,
+			  tee_fs_off_t offset, size_t len, void **data)
+{
+	if (len > sizeof(rpc_buf) || offset < 0)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	memset(op, 0, sizeof(*op));
+	op->params[0].u.value.a = fd;
+	op->params[0].u.value.b = offset;
+	op->params[0].u.value.c = len;
+	*data = rpc_buf;
+	return TEE_SUCCESS;
+}
+
+TEE_Result tee_fs_rpc_read_init(struct tee_fs_rpc_operation *op,
+				uint32_t id __unused, int fd,
+				tee_fs_off_t offset, size_t data_len,
+				void **out_data)
+{
+	return op_init(op, fd, offset, data_len, out_data);
+}
+
+TEE_Result tee_fs_rpc_read_final(struct tee_fs_rpc_operation *op,
+				 size_t *data_len)
+{
+	struct mem_file *f = get_file(op->params[0].u.value.a);
+	size_t offs = op->params[0].u.value.b;
+	size_t len = op->params[0].u.value.c;
+
+	if (!f || !f->used)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+	if (f == files + DIRF_FD)
+		dirf_reads++;
+
+	if (offs >= f->size)
+		len = 0;
+	else
+		len = MIN(len, f->size - offs);
+	memcpy(rpc_buf, f->data + offs, len);
+	*data_len = len;
+	return TEE_SUCCESS;
+}
+
+TEE_Result tee_fs_rpc_write_init(struct tee_fs_rpc_operation *op,
+				 uint32_t id __unused, int fd,
+				 tee_fs_off_t offset, size_t data_len,
+				 void **data)
+{
+	return op_init(op, fd, offset, data_len, data);
+}
+
+TEE_Result tee_fs_rpc_write_final(struct tee_fs_rpc_operation *op)
+{
+	struct mem_file *f = get_file(op->params[0].u.value.a);
+	size_t offs = op->params[0].u.value.b;
+	size_t len = op->params[0].u.value.c;
+	TEE_Result res = TEE_SUCCESS;
+
+	if (!f || !f->used)
+		return TEE_ERROR_ITEM_NOT_FOUND;
+
+	if (offs + len > f->size) {
+		res = resize_file(f, offs + len);
+		if (res)
+			return res;
+	}
+	memcpy(f->data + offs, rpc_buf, len);
+	return TEE_SUCCESS;
+}
+
+static struct tee_ta_ctx ctx_a = {
+	.uuid = { 0xa, 0, 0, { 0 } },
+};
+/* A new instance of the TA of ctx_a */
+static struct tee_ta_ctx ctx_a2 = {
+	.uuid = { 0xa, 0, 0, { 0 } },
+};
+static struct tee_ta_ctx ctx_b = {
+	.uuid = { 0xb, 0, 0, { 0 } },
+};
+
+static void init_pobj(struct tee_pobj *po, struct tee_ta_ctx *ctx,
+		      const char *id)
+{
+	memset(po, 0, sizeof(*po));
+	po->uuid = ctx->uuid;
+	po->obj_id = (void *)id;
+	po->obj_id_len = strlen(id);
+	po->fops = &ree_fs_ops;
+}
+
+static void reset_storage(void)
+{
+	size_t n = 0;
+
+	/* Aborting a transaction closes the dirfile kept open across calls */
+	HOST_TEST_CHECK(!ree_fs_ops.begin_transaction(&ctx_b));
+	HOST_TEST_CHECK(!ree_fs_ops.end_transaction(&ctx_b, false));
+
+	for (n = 0; n < ARRAY_SIZE(files); n++)
+		remove_file(files + n);
+}
+
+static size_t count_files(void)
+{
+	size_t count = 0;
+	size_t n = 0;
+
+	for (n = 0; n < MAX_FILES; n++)
+		if (files[n].used)
+			count++;
+
+	return count;
+}
+
+static TEE_Result create_obj(struct tee_pobj *po, const char *data,
+			     struct tee_file_handle **fh)
+{
+	struct tee_file_handle *h = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	res = ree_fs_ops.create(po, false, NULL, 0, NULL, 0, data,
+				strlen(data), &h);
+	if (res)
+		return res;
+
+	if (fh)
+		*fh = h;
+	else
+		ree_fs_ops.close(&h);
+	return TEE_SUCCESS;
+}
+
+static TEE_Result write_obj(struct tee_pobj *po, const char *data)
+{
+	struct tee_file_handle *fh = NULL;
+	TEE_Result res = TEE_SUCCESS;
+
+	res = ree_fs_ops.open(po, NULL, &fh);
+	if (res)
+		return res;
+	res = ree_fs_ops.write(fh, 0, data, strlen(data));
+	ree_fs_ops.close(&fh);
+	return res;
+}
+
+static bool obj_equals(struct tee_pobj *po, const char *data)
+{
+	struct tee_file_handle *fh = NULL;
+	char buf[32] = { 0 };
+	size_t len = sizeof(buf);
+	size_t size = 0;
+	bool ret = false;
+
+	if (ree_fs_ops.open(po, &size, &fh))
+		return false;
+	if (!ree_fs_ops.read(fh, 0, buf, &len))
+		ret = size == strlen(data) && len == size &&
+		      !memcmp(buf, data, len);
+	ree_fs_ops.close(&fh);
+
+	return ret;
+}
+
+static void test_commit(void)
+{
+	struct tee_file_handle *fh = NULL;
+	struct tee_pobj a1 = { };
+	struct tee_pobj a2 = { };
+	struct tee_pobj a3 = { };
+	struct tee_pobj b1 = { };
+
+	init_pobj(&a1, &ctx_a, "a1");
+	init_pobj(&a2, &ctx_a, "a2");
+	init_pobj(&a3, &ctx_a, "a3");
+	init_pobj(&b1, &ctx_b, "b1");
+
+	host_test_set_current_ctx(&ctx_a);
+	HOST_TEST_CHECK(!create_obj(&a1, "one", NULL));
+	HOST_TEST_CHECK(!create_obj(&a2, "two", NULL));
+
+	HOST_TEST_CHECK(!ree_fs_ops.begin_transaction(&ctx_a));
+	HOST_TEST_CHECK(ree_fs_ops.begin_transaction(&ctx_a) ==
+			TEE_ERROR_BAD_STATE);
+	HOST_TEST_CHECK(!write_obj(&a1, "ONE"));
+	HOST_TEST_CHECK(!ree_fs_ops.remove(&a2));
+	HOST_TEST_CHECK(!create_obj(&a3, "three", &fh));
+	/* The owner sees its uncommitted changes */
+	HOST_TEST_CHECK(obj_equals(&a1, "ONE"));
+	HOST_TEST_CHECK(!obj_equals(&a2, "two"));
+
+	/* Other contexts are refused instead of waiting */
+	host_test_set_current_ctx(&ctx_b);
+	HOST_TEST_CHECK(create_obj(&b1, "b", NULL) ==
+			TEE_ERROR_STORAGE_NOT_AVAILABLE);
+	HOST_TEST_CHECK(ree_fs_ops.begin_transaction(&ctx_b) ==
+			TEE_ERROR_BUSY);
+	HOST_TEST_CHECK(ree_fs_ops.end_transaction(&ctx_b, true) ==
+			TEE_ERROR_BAD_STATE);
+
+	host_test_set_current_ctx(&ctx_a);
+	HOST_TEST_CHECK(!ree_fs_ops.end_transaction(&ctx_a, true));
+	ree_fs_ops.close(&fh);
+
+	HOST_TEST_CHECK(obj_equals(&a1, "ONE"));
+	HOST_TEST_CHECK(ree_fs_ops.open(&a2, NULL, &fh) ==
+			TEE_ERROR_ITEM_NOT_FOUND);
+	HOST_TEST_CHECK(obj_equals(&a3, "three"));
+	/* The file of a2 was removed once the removal was committed */
+	HOST_TEST_CHECK(count_files() == 2);
+
+	host_test_set_current_ctx(&ctx_b);
+	HOST_TEST_CHECK(!create_obj(&b1, "b", NULL));
+	HOST_TEST_CHECK(obj_equals(&b1, "b"));
+	host_test_set_current_ctx(NULL);
+}
+
+static void test_abort(void)
+{
+	struct tee_file_handle *fh = NULL;
+	struct tee_pobj a1 = { };
+	struct tee_pobj a2 = { };
+	struct tee_pobj a3 = { };
+	char buf[8] = { 0 };
+	size_t len = sizeof(buf);
+
+	init_pobj(&a1, &ctx_a, "a1");
+	init_pobj(&a2, &ctx_a, "a2");
+	init_pobj(&a3, &ctx_a, "a3");
+
+	host_test_set_current_ctx(&ctx_a);
+	HOST_TEST_CHECK(!create_obj(&a1, "one", NULL));
+	HOST_TEST_CHECK(!create_obj(&a2, "two", NULL));
+
+	HOST_TEST_CHECK(!ree_fs_ops.begin_transaction(&ctx_a));
+	HOST_TEST_CHECK(!write_obj(&a1, "ONE"));
+	HOST_TEST_CHECK(!ree_fs_ops.remove(&a2));
+	HOST_TEST_CHECK(!create_obj(&a3, "three", &fh));
+	HOST_TEST_CHECK(!ree_fs_ops.end_transaction(&ctx_a, false));
+
+	/* An object created in the transaction can only be closed */
+	HOST_TEST_CHECK(ree_fs_ops.read(fh, 0, buf, &len) ==
+			TEE_ERROR_BAD_STATE);
+	ree_fs_ops.close(&fh);
+
+	HOST_TEST_CHECK(obj_equals(&a1, "one"));
+	HOST_TEST_CHECK(obj_equals(&a2, "two"));
+	HOST_TEST_CHECK(ree_fs_ops.open(&a3, NULL, &fh) ==
+			TEE_ERROR_ITEM_NOT_FOUND);
+	HOST_TEST_CHECK(count_files() == 2);
+	HOST_TEST_CHECK(ree_fs_ops.end_transaction(&ctx_a, false) ==
+			TEE_ERROR_BAD_STATE);
+	host_test_set_current_ctx(NULL);
+}
+
+/* The owner is destroyed with the transaction pending, see free_utc() */
+static void test_owner_dies(void)
+{
+	struct tee_file_handle *fh1 = NULL;
+	struct tee_file_handle *fh2 = NULL;
+	struct tee_pobj a1 = { };
+	struct tee_pobj a2 = { };
+	struct tee_pobj b1 = { };
+
+	init_pobj(&a1, &ctx_a, "a1");
+	init_pobj(&a2, &ctx_a, "a2");
+	init_pobj(&b1, &ctx_b, "b1");
+
+	host_test_set_current_ctx(&ctx_a);
+	HOST_TEST_CHECK(!create_obj(&a1, "one", NULL));
+	HOST_TEST_CHECK(!ree_fs_ops.begin_transaction(&ctx_a));
+	HOST_TEST_CHECK(!ree_fs_ops.open(&a1, NULL, &fh1));
+	HOST_TEST_CHECK(!ree_fs_ops.write(fh1, 0, "ONE", 3));
+	HOST_TEST_CHECK(!create_obj(&a2, "two", &fh2));
+
+	/* Torn down on behalf of the client, not of the TA */
+	host_test_set_current_ctx(NULL);
+	HOST_TEST_CHECK(!ree_fs_ops.end_transaction(&ctx_a, false));
+	ree_fs_ops.close(&fh1);
+	ree_fs_ops.close(&fh2);
+
+	host_test_set_current_ctx(&ctx_b);
+	HOST_TEST_CHECK(!create_obj(&b1, "b", NULL));
+	HOST_TEST_CHECK(!ree_fs_ops.begin_transaction(&ctx_b));
+	HOST_TEST_CHECK(!ree_fs_ops.end_transaction(&ctx_b, true));
+
+	host_test_set_current_ctx(&ctx_a2);
+	HOST_TEST_CHECK(obj_equals(&a1, "one"));
+	HOST_TEST_CHECK(ree_fs_ops.open(&a2, NULL, &fh2) ==
+			TEE_ERROR_ITEM_NOT_FOUND);
+	HOST_TEST_CHECK(count_files() == 2);
+	host_test_set_current_ctx(NULL);
+}
+
+/*
+ * dirf.db is scanned when the dirfile is opened, a lookup in the dirfile
+ * kept open reads the entry it finds only
+ */
+static void test_dirh_cached(void)
+{
+	static const char *const ids[] = {
+		"o0", "o1", "o2", "o3", "o4", "o5", "o6", "o7",
+	};
+	struct tee_pobj po[ARRAY_SIZE(ids)] = { };
+	size_t reads = 0;
+	size_t round = 0;
+	size_t n = 0;
+
+	host_test_set_current_ctx(&ctx_a);
+	for (n = 0; n < ARRAY_SIZE(ids); n++) {
+		init_pobj(po + n, &ctx_a, ids[n]);
+		HOST_TEST_CHECK(!create_obj(po + n, ids[n], NULL));
+	}
+
+	/* Nothing is open between the lookups */
+	reads = dirf_reads;
+	for (round = 0; round < 2; round++)
+		for (n = 0; n < ARRAY_SIZE(ids); n++)
+			HOST_TEST_CHECK(obj_equals(po + n, ids[n]));
+	HOST_TEST_CHECK(dirf_reads - reads <= 2 * ARRAY_SIZE(ids));
+
+	/* Changes go through the dirfile kept open */
+	HOST_TEST_CHECK(!write_obj(po, "x0"));
+	HOST_TEST_CHECK(!ree_fs_ops.remove(po + 1));
+	HOST_TEST_CHECK(obj_equals(po, "x0"));
+	HOST_TEST_CHECK(!obj_equals(po + 1, ids[1]));
+
+	/* Scanned again once closed */
+	HOST_TEST_CHECK(!ree_fs_ops.begin_transaction(&ctx_a));
+	HOST_TEST_CHECK(!ree_fs_ops.end_transaction(&ctx_a, false));
+	reads = dirf_reads;
+	HOST_TEST_CHECK(obj_equals(po, "x0"));
+	HOST_TEST_CHECK(!obj_equals(po + 1, ids[1]));
+	HOST_TEST_CHECK(obj_equals(po + 2, ids[2]));
+	/* More than the entry of each of the three lookups */
+	HOST_TEST_CHECK(dirf_reads - reads > 3);
+	host_test_set_current_ctx(NULL);
+}
+
+void test_ree_fs(size_t iterations __unused)
+{
+	reset_storage();
+	test_commit();
+	reset_storage();
+	test_abort();
+	reset_storage();
+	test_owner_dies();
+	reset_storage();
+	test_dirh_cached();
+	reset_storage();
+}
+
+void bench_ree_fs(size_t iterations)
+{
+	struct tee_file_handle *fh = NULL;
+	struct tee_pobj po = { };
+	uint8_t buf[64] = { 0 };
+	size_t count = iterations / 100 + 1;
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	reset_storage();
+	init_pobj(&po, &ctx_a, "bench");
+	host_test_set_current_ctx(&ctx_a);
+	HOST_TEST_CHECK(!create_obj(&po, "x", &fh));
+
+	/* Each write syncs the hash tree and commits dirf.db */
+	begin = host_test_now();
+	for (n = 0; n < count; n++)
+		HOST_TEST_CHECK(!ree_fs_ops.write(fh, 0, buf, sizeof(buf)));
+	host_test_bench_report("ree_fs write", count, sizeof(buf),
+			       host_test_now() - begin);
+
+	/* The syncs and the commit are deferred to the end */
+	begin = host_test_now();
+	HOST_TEST_CHECK(!ree_fs_ops.begin_transaction(&ctx_a));
+	for (n = 0; n < count; n++)
+		HOST_TEST_CHECK(!ree_fs_ops.write(fh, 0, buf, sizeof(buf)));
+	HOST_TEST_CHECK(!ree_fs_ops.end_transaction(&ctx_a, true));
+	host_test_bench_report("ree_fs write in transaction", count,
+			       sizeof(buf), host_test_now() - begin);
+
+	ree_fs_ops.close(&fh);
+	host_test_set_current_ctx(NULL);
+	reset_storage();
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#include <printk.h>
+#include <stdio.h>
+#include <string.h>
+#include <types_ext.h>
+
+#include "host_test.h"
+
+static void check_fmt(const char *expect, const char *fmt, ...)
+{
+	char buf[64] = { 0 };
+	va_list ap;
+	int res = 0;
+
+	va_start(ap, fmt);
+	res = vsnprintk(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	HOST_TEST_CHECK(res == (int)strlen(expect));
+	HOST_TEST_CHECK(!strcmp(buf, expect));
+}
+
+void test_snprintk(size_t iterations __unused)
+{
+	char buf[8] = { 0 };
+
+	check_fmt("42", "%d", 42);
+	check_fmt("-42", "%d", -42);
+	check_fmt("0x2a", "%#x", 42);
+	check_fmt("  42", "%4u", 42);
+	check_fmt("0042", "%04u", 42);
+	check_fmt("18446744073709551615", "%llu", 18446744073709551615ULL);
+	check_fmt("ab   |", "%-5s|", "ab");
+	check_fmt("abc", "%.3s", "abcdef");
+	check_fmt("%", "%%");
+	check_fmt("x 1 y", "%c %zu %s", 'x', (size_t)1, "y");
+
+	/* Truncation returns the length of the untruncated string */
+	HOST_TEST_CHECK(snprintk(buf, sizeof(buf), "%s", "0123456789") == 10);
+	HOST_TEST_CHECK(!strcmp(buf, "0123456"));
+
+	HOST_TEST_CHECK(snprintf(buf, sizeof(buf), "%d", 7) == 1);
+	HOST_TEST_CHECK(!strcmp(buf, "7"));
+}
+
+void bench_snprintk(size_t iterations)
+{
+	char buf[128] = { 0 };
+	uint64_t begin = 0;
+	size_t n = 0;
+
+	/* A typical trace line, see trace_printf() */
+	begin = host_test_now();
+	for (n = 0; n < iterations; n++)
+		snprintk(buf, sizeof(buf), "D/TC:%d %s:%d %s 0x%" PRIxVA " %zu",
+			 0, "tee_ta_open_session", 123, "res", (vaddr_t)n, n);
+	host_test_bench_report("snprintk trace line", iterations, 0,
+			       host_test_now() - begin);
+}
@@ -0,0 +1,372 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * The rings of the socket pseudo TA against a tee-supplicant emulated by
+ * two host threads, one consuming the transmit ring and one producing
+ * into the receive ring. They sleep as struct optee_socket_ring requires,
+ * a kick missed by OP-TEE shows as a sleep timing out with the ring ready.
+ */
+#include <kernel/pseudo_ta.h>
+#include <kernel/tee_ta_manager.h>
+#include <kernel/thread.h>
+#include <mm/mobj.h>
+#include <optee_rpc_cmd.h>
+#include <pta_socket.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tee/tee_fs_rpc.h>
+#include <util.h>
+
+#include "host_test.h"
+
+#define RING_SIZE		PTA_SOCKET_RING_MIN_SIZE
+#define SOCKET_HANDLE		1
+#define INSTANCE_ID		2
+#define TX_SEED			3
+#define RX_SEED			4
+/* Never expires unless a wakeup is lost */
+#define WAKEUP_TIMEOUT_MS	2000
+#define TEST_BYTES		(1024 * 1024)
+
+struct mobj {
+	void *va;
+};
+
+/*
+ * The emulated tee-supplicant, each thread only writes its own fields
+ * and the indexes it owns in the rings
+ */
+static struct {
+	struct optee_socket_ring *tx;
+	struct optee_socket_ring *rx;
+	struct host_event *tx_kick;
+	struct host_event *rx_kick;
+	struct host_event *tx_space;
+	struct host_event *rx_data;
+	struct host_thread *tx_thread;
+	struct host_thread *rx_thread;
+	uint32_t total;
+	uint32_t tx_cons;
+	uint32_t rx_prod;
+	size_t tx_errors;
+	size_t tx_lost;
+	size_t rx_lost;
+} nw;
+
+static uint8_t pattern(uint32_t pos, unsigned int seed)
+{
+	return (pos * 13 + seed) ^ (pos >> 9);
+}
+
+static uint32_t load_acquire(uint32_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint32_t *p, uint32_t val)
+{
+	__atomic_store_n(p, val, __ATOMIC_RELEASE);
+}
+
+static bool tx_ready(void)
+{
+	return load_acquire(&nw.tx->prod) != nw.tx_cons;
+}
+
+static bool rx_ready(void)
+{
+	return nw.rx_prod - load_acquire(&nw.rx->cons) < RING_SIZE;
+}
+
+/*
+ * Sleeps until kicked as tee-supplicant must, returns false if the ring
+ * became ready without a kick
+ */
+static bool nw_sleep(uint32_t *waiting, struct host_event *kick,
+		     bool (*ready)(void))
+{
+	bool lost = false;
+
+	__atomic_store_n(waiting, 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (!ready())
+		lost = !host_event_wait(kick, WAKEUP_TIMEOUT_MS) && ready();
+	__atomic_store_n(waiting, 0, __ATOMIC_RELAXED);
+
+	return !lost;
+}
+
+static void nw_tx_thread(void *arg __unused)
+{
+	const uint8_t *data = (const uint8_t *)(nw.tx + 1);
+	uint32_t prod = 0;
+
+	while (nw.tx_cons != nw.total) {
+		prod = load_acquire(&nw.tx->prod);
+		if (prod - nw.tx_cons > RING_SIZE) {
+			nw.tx_errors++;
+			return;
+		}
+		if (prod == nw.tx_cons) {
+			if (!nw_sleep(&nw.tx->cons_waiting, nw.tx_kick,
+				      tx_ready))
+				nw.tx_lost++;
+			continue;
+		}
+
+		for (; nw.tx_cons != prod; nw.tx_cons++)
+			if (data[nw.tx_cons & (RING_SIZE - 1)] !=
+			    pattern(nw.tx_cons, TX_SEED))
+				nw.tx_errors++;
+		store_release(&nw.tx->cons, nw.tx_cons);
+		host_event_signal(nw.tx_space);
+	}
+}
+
+static void nw_rx_thread(void *arg __unused)
+{
+	uint8_t *data = (uint8_t *)(nw.rx + 1);
+	uint32_t pos = 0;
+	uint32_t n = 0;
+
+	while (nw.rx_prod != nw.total) {
+		n = RING_SIZE - (nw.rx_prod - load_acquire(&nw.rx->cons));
+		if (!n) {
+			if (!nw_sleep(&nw.rx->prod_waiting, nw.rx_kick,
+				      rx_ready))
+				nw.rx_lost++;
+			continue;
+		}
+
+		/* Chunks of varying size to leave the ring at any offset */
+		n = MIN(n, MIN(nw.total - nw.rx_prod, 1 + nw.rx_prod % 1531));
+		for (pos = nw.rx_prod; pos != nw.rx_prod + n; pos++)
+			data[pos & (RING_SIZE - 1)] = pattern(pos, RX_SEED);
+		nw.rx_prod = pos;
+		store_release(&nw.rx->prod, nw.rx_prod);
+		host_event_signal(nw.rx_data);
+	}
+}
+
+void *mobj_get_va(struct mobj *mobj, size_t offs)
+{
+	return (uint8_t *)mobj->va + offs;
+}
+
+struct mobj *thread_rpc_alloc_payload(size_t size)
+{
+	struct mobj *mobj = calloc(1, sizeof(*mobj));
+
+	if (!mobj)
+		return NULL;
+	mobj->va = malloc(size);
+	if (!mobj->va) {
+		free(mobj);
+		return NULL;
+	}
+
+	return mobj;
+}
+
+void thread_rpc_free_payload(struct mobj *mobj)
+{
+	free(mobj->va);
+	free(mobj);
+}
+
+/* Only the rings are exercised */
+void *tee_fs_rpc_cache_alloc(size_t size __unused, struct mobj **mobj)
+{
+	*mobj = NULL;
+	return NULL;
+}
+
+static uint32_t ring_setup(struct thread_param *params)
+{
+	uint8_t *va = mobj_get_va(params[1].u.memref.mobj, 0);
+
+	if (params[1].u.memref.size != 2 * (sizeof(*nw.tx) + RING_SIZE))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	nw.tx = (struct optee_socket_ring *)va;
+	nw.rx = (struct optee_socket_ring *)(va + sizeof(*nw.tx) + RING_SIZE);
+	nw.tx_cons = 0;
+	nw.rx_prod = 0;
+	nw.tx_thread = host_thread_start(nw_tx_thread, NULL);
+	nw.rx_thread = host_thread_start(nw_rx_thread, NULL);
+
+	return TEE_SUCCESS;
+}
+
+/* Returns when the transmit ring has space or the receive ring data */
+static uint32_t ring_wait(uint32_t dir)
+{
+	uint32_t timeout = 2 * WAKEUP_TIMEOUT_MS;
+
+	if (dir == OPTEE_SOCKET_RING_TX) {
+		while (nw.tx->prod - load_acquire(&nw.tx->cons) == RING_SIZE)
+			if (!host_event_wait(nw.tx_space, timeout))
+				return TEE_ERROR_BUSY;
+	} else {
+		while (load_acquire(&nw.rx->prod) == nw.rx->cons)
+			if (!host_event_wait(nw.rx_data, timeout))
+				return TEE_ERROR_BUSY;
+	}
+
+	return TEE_SUCCESS;
+}
+
+uint32_t thread_rpc_cmd(uint32_t cmd, size_t num_params,
+			struct thread_param *params)
+{
+	if (cmd != OPTEE_RPC_CMD_SOCKET || !num_params ||
+	    params[0].u.value.b != INSTANCE_ID)
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	switch (params[0].u.value.a) {
+	case OPTEE_RPC_SOCKET_RING_SETUP:
+		return ring_setup(params);
+	case OPTEE_RPC_SOCKET_RING_WAIT:
+		return ring_wait(params[1].u.value.a);
+	case OPTEE_RPC_SOCKET_RING_KICK:
+		if (params[1].u.value.a == OPTEE_SOCKET_RING_TX)
+			host_event_signal(nw.tx_kick);
+		else
+			host_event_signal(nw.rx_kick);
+		return TEE_SUCCESS;
+	case OPTEE_RPC_SOCKET_CLOSE_ALL:
+		return TEE_SUCCESS;
+	default:
+		return TEE_ERROR_NOT_IMPLEMENTED;
+	}
+}
+
+static uint32_t get_instance_id(struct tee_ta_ctx *ctx __unused)
+{
+	return INSTANCE_ID;
+}
+
+static const struct tee_ta_ops ta_ops = {
+	.get_instance_id = get_instance_id,
+};
+
+static void sock_send(void *sess, uint8_t *buf, uint32_t pos, size_t len)
+{
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	size_t n = 0;
+
+	for (n = 0; n < len; n++)
+		buf[n] = pattern(pos + n, TX_SEED);
+
+	params[0].value.a = SOCKET_HANDLE;
+	params[0].value.b = PTA_SOCKET_TIMEOUT_BLOCKING;
+	params[1].memref.buffer = buf;
+	params[1].memref.size = len;
+	HOST_TEST_CHECK(!host_test_pseudo_ta.invoke_command_entry_point(sess,
+				PTA_SOCKET_SEND,
+				TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+						TEE_PARAM_TYPE_MEMREF_INPUT,
+						TEE_PARAM_TYPE_VALUE_OUTPUT,
+						TEE_PARAM_TYPE_NONE), params));
+	HOST_TEST_CHECK(params[2].value.a == len);
+}
+
+static size_t sock_recv(void *sess, uint8_t *buf, uint32_t pos, size_t len)
+{
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	size_t n = 0;
+
+	params[0].value.a = SOCKET_HANDLE;
+	params[0].value.b = PTA_SOCKET_TIMEOUT_BLOCKING;
+	params[1].memref.buffer = buf;
+	params[1].memref.size = len;
+	HOST_TEST_CHECK(!host_test_pseudo_ta.invoke_command_entry_point(sess,
+				PTA_SOCKET_RECV,
+				TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+						TEE_PARAM_TYPE_MEMREF_OUTPUT,
+						TEE_PARAM_TYPE_NONE,
+						TEE_PARAM_TYPE_NONE), params));
+	HOST_TEST_CHECK(params[1].memref.size && params[1].memref.size <= len);
+
+	for (n = 0; n < params[1].memref.size; n++)
+		HOST_TEST_CHECK(buf[n] == pattern(pos + n, RX_SEED));
+
+	return params[1].memref.size;
+}
+
+/* Sends and receives @total bytes in chunks of about @chunk bytes */
+static void transfer(uint32_t total, size_t chunk)
+{
+	struct tee_ta_ctx ctx = { .ops = &ta_ops };
+	TEE_Param params[TEE_NUM_PARAMS] = { };
+	uint8_t buf[3 * RING_SIZE / 2];
+	void *sess = NULL;
+	uint32_t sent = 0;
+	uint32_t rcvd = 0;
+
+	memset(&nw, 0, sizeof(nw));
+	nw.total = total;
+	nw.tx_kick = host_event_alloc();
+	nw.rx_kick = host_event_alloc();
+	nw.tx_space = host_event_alloc();
+	nw.rx_data = host_event_alloc();
+
+	host_test_set_current_ctx(&ctx);
+	HOST_TEST_CHECK(!host_test_pseudo_ta.open_session_entry_point(0, params,
+								      &sess));
+
+	params[0].value.a = SOCKET_HANDLE;
+	params[0].value.b = RING_SIZE;
+	HOST_TEST_CHECK(!host_test_pseudo_ta.invoke_command_entry_point(sess,
+				PTA_SOCKET_RING_ENABLE,
+				TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+						TEE_PARAM_TYPE_NONE,
+						TEE_PARAM_TYPE_NONE,
+						TEE_PARAM_TYPE_NONE), params));
+
+	while (sent != total || rcvd != total) {
+		if (sent != total) {
+			/* Varying sizes, some larger than the ring */
+			size_t n = MIN(total - sent,
+				       MIN(sizeof(buf), 1 + sent % chunk));
+
+			sock_send(sess, buf, sent, n);
+			sent += n;
+		}
+		if (rcvd != total)
+			rcvd += sock_recv(sess, buf, rcvd,
+					  MIN(total - rcvd, sizeof(buf)));
+	}
+
+	host_thread_join(nw.tx_thread);
+	host_thread_join(nw.rx_thread);
+	HOST_TEST_CHECK(nw.tx_cons == total && !nw.tx_errors);
+	HOST_TEST_CHECK(!nw.tx_lost && !nw.rx_lost);
+
+	host_test_pseudo_ta.close_session_entry_point(sess);
+	host_test_set_current_ctx(NULL);
+
+	host_event_free(nw.tx_kick);
+	host_event_free(nw.rx_kick);
+	host_event_free(nw.tx_space);
+	host_event_free(nw.rx_data);
+}
+
+void test_socket_ring(size_t iterations __unused)
+{
+	transfer(TEST_BYTES, 2 * RING_SIZE + 7);
+	/* Mostly small chunks, each side often sleeps on the other */
+	transfer(TEST_BYTES, 61);
+}
+
+void bench_socket_ring(size_t iterations)
+{
+	uint64_t begin = host_test_now();
+
+	transfer(iterations * 1024, 1024 + 1);
+	host_test_bench_report("send and recv 1024", iterations, 1024,
+			       host_test_now() - begin);
+}
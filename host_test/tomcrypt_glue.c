@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+/*
+ * The AES block functions of tee_ltc_provider.c used by the software
+ * implementation of AES-GCM and the SHA-256 context of hash.c used by
+ * the hash tree of the secure storage, without the rest of the provider.
+ */
+#include <crypto/crypto.h>
+#include <crypto/crypto_impl.h>
+#include <kernel/panic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tomcrypt.h>
+#include <utee_defines.h>
+#include <util.h>
+
+TEE_Result crypto_aes_expand_enc_key(const void *key, size_t key_len,
+				     void *enc_key, unsigned int *rounds)
+{
+	symmetric_key skey;
+
+	if (aes_setup(key, key_len, 0, &skey))
+		return TEE_ERROR_BAD_PARAMETERS;
+
+	memcpy(enc_key, skey.rijndael.eK, sizeof(skey.rijndael.eK));
+	*rounds = skey.rijndael.Nr;
+	return TEE_SUCCESS;
+}
+
+void crypto_aes_enc_block(const void *enc_key, unsigned int rounds,
+			  const void *src, void *dst)
+{
+	symmetric_key skey;
+
+	memcpy(skey.rijndael.eK, enc_key, sizeof(skey.rijndael.eK));
+	skey.rijndael.Nr = rounds;
+	if (aes_ecb_encrypt(src, dst, &skey))
+		panic();
+}
+
+struct sha256_ctx {
+	struct crypto_hash_ctx ctx;
+	hash_state state;
+};
+
+static const struct crypto_hash_ops sha256_ops;
+
+static struct sha256_ctx *to_sha256_ctx(struct crypto_hash_ctx *ctx)
+{
+	return container_of(ctx, struct sha256_ctx, ctx);
+}
+
+static TEE_Result sha256_ctx_init(struct crypto_hash_ctx *ctx)
+{
+	if (sha256_init(&to_sha256_ctx(ctx)->state))
+		return TEE_ERROR_BAD_STATE;
+	return TEE_SUCCESS;
+}
+
+static TEE_Result sha256_ctx_update(struct crypto_hash_ctx *ctx,
+				    const uint8_t *data, size_t len)
+{
+	if (sha256_process(&to_sha256_ctx(ctx)->state, data, len))
+		return TEE_ERROR_BAD_STATE;
+	return TEE_SUCCESS;
+}
+
+static TEE_Result sha256_ctx_final(struct crypto_hash_ctx *ctx,
+				   uint8_t *digest, size_t len)
+{
+	uint8_t d[TEE_SHA256_HASH_SIZE] = { 0 };
+
+	if (sha256_done(&to_sha256_ctx(ctx)->state, d))
+		return TEE_ERROR_BAD_STATE;
+	memcpy(digest, d, MIN(len, sizeof(d)));
+	return TEE_SUCCESS;
+}
+
+static void sha256_ctx_free(struct crypto_hash_ctx *ctx)
+{
+	free(to_sha256_ctx(ctx));
+}
+
+static void sha256_ctx_copy_state(struct crypto_hash_ctx *dst_ctx,
+				  struct crypto_hash_ctx *src_ctx)
+{
+	to_sha256_ctx(dst_ctx)->state = to_sha256_ctx(src_ctx)->state;
+}
+
+static const struct crypto_hash_ops sha256_ops = {
+	.init = sha256_ctx_init,
+	.update = sha256_ctx_update,
+	.final = sha256_ctx_final,
+	.free_ctx = sha256_ctx_free,
+	.copy_state = sha256_ctx_copy_state,
+};
+
+TEE_Result crypto_sha256_alloc_ctx(struct crypto_hash_ctx **ctx)
+{
+	struct sha256_ctx *c = calloc(1, sizeof(*c));
+
+	if (!c)
+		return TEE_ERROR_OUT_OF_MEMORY;
+	c->ctx.ops = &sha256_ops;
+	*ctx = &c->ctx;
+	return TEE_SUCCESS;
+}
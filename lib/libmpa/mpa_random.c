@@ -63,7 +63,7 @@ void mpa_get_random(mpanum dest, mpanum limit)
 			/* 1 <= hbi <= WORD_SIZE */
 			hbi = (hbi % WORD_SIZE) + 1;
 			if (hbi < WORD_SIZE) {
-				hbi = (1 << hbi) - 1;
+				hbi = ((mpa_word_t)1 << hbi) - 1;
 				dest->d[dest->size - 1] &= hbi;
 			}
 			done = (mpa_cmp(dest, limit) < 0) ? 1 : 0;
@@ -9,5 +9,13 @@
 /* Instance and implementation specific ioctl functions */
 #define TEE_TCP_SET_RECVBUF	0x65f00000
 #define TEE_TCP_SET_SENDBUF	0x65f00001
+/*
+ * Moves the data of the socket through rings in memory shared with normal
+ * world instead of one RPC per send and receive. The buffer holds the
+ * size of each ring as a uint32_t. Returns TEE_ERROR_NOT_SUPPORTED if
+ * normal world doesn't support it, the socket then keeps working as
+ * before.
+ */
+#define TEE_TCP_SET_RING	0x65f00002
 
 #endif /*____TEE_TCPSOCKET_DEFINES_EXTENSIONS_H*/
@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#ifndef __PTA_MICROBENCH_H
+#define __PTA_MICROBENCH_H
+
+/*
+ * Interface to the microbenchmark pseudo-TA, which measures the cost of
+ * performance sensitive operations of the TEE core.
+ */
+
+#define PTA_MICROBENCH_UUID \
+		{ 0x8c1f1f47, 0x1e06, 0x4c2b, \
+			{ 0x93, 0x3b, 0x2d, 0x8a, 0x0f, 0x5d, 0x61, 0xe4 } }
+
+/*
+ * Does nothing, used by the client to measure the round trip of invoking
+ * a command of a pseudo-TA. Parameters are not used/checked.
+ */
+#define PTA_MICROBENCH_CMD_NOP		0
+
+/*
+ * Runs a benchmark
+ *
+ * [in]  value[0].a	Benchmark PTA_MICROBENCH_*
+ * [in]  value[0].b	Benchmark specific parameter, see below
+ * [in]  value[1].a	Number of iterations
+ * [in]  value[1].b	Number of bytes processed in each iteration, used
+ *			by benchmarks of symmetric crypto and memory
+ *			functions only
+ * [out] value[2].a	Upper 32 bits of the elapsed system counter ticks
+ * [out] value[2].b	Lower 32 bits of the elapsed system counter ticks
+ * [out] value[3].a	Frequency of the system counter
+ *
+ * Setup and teardown, for instance key generation, are not included in
+ * the elapsed time. Returns TEE_ERROR_NOT_SUPPORTED if the TEE core has no
+ * system counter, CFG_CORE_HAS_GENERIC_TIMER=n.
+ */
+#define PTA_MICROBENCH_CMD_RUN		1
+
+/* handle_get() and handle_put(), parameter: number of handles in use */
+#define PTA_MICROBENCH_HANDLE_GET	0
+/* handle_lookup(), parameter: number of handles in use */
+#define PTA_MICROBENCH_HANDLE_LOOKUP	1
+/* malloc() and free(), parameter: size of the allocation */
+#define PTA_MICROBENCH_MALLOC		2
+/* mempool_alloc() and mempool_free(), parameter: size of the allocation */
+#define PTA_MICROBENCH_MEMPOOL		3
+/* tee_mm_alloc() and tee_mm_free(), parameter: size of the allocation */
+#define PTA_MICROBENCH_TEE_MM		4
+/* Hash of value[1].b bytes, parameter: TEE_ALG_* */
+#define PTA_MICROBENCH_HASH		5
+/* MAC of value[1].b bytes, parameter: TEE_ALG_* */
+#define PTA_MICROBENCH_MAC		6
+/* Encryption of value[1].b bytes, parameter: TEE_ALG_* */
+#define PTA_MICROBENCH_CIPHER		7
+/* Authenticated encryption of value[1].b bytes, parameter: TEE_ALG_* */
+#define PTA_MICROBENCH_AUTHENC		8
+/* RSASSA PKCS#1 v1.5 SHA-256, parameter: key size in bits */
+#define PTA_MICROBENCH_RSA_SIGN		9
+#define PTA_MICROBENCH_RSA_VERIFY	10
+/* ECDSA, parameter: TEE_ECC_CURVE_* */
+#define PTA_MICROBENCH_ECC_SIGN		11
+#define PTA_MICROBENCH_ECC_VERIFY	12
+/*
+ * Block write/read of the hash tree of secure storage with an in-memory
+ * backend, parameter: number of blocks in the file
+ */
+#define PTA_MICROBENCH_FS_HTREE_WRITE	13
+#define PTA_MICROBENCH_FS_HTREE_READ	14
+/* Page fault of paged memory, parameter: number of pages touched */
+#define PTA_MICROBENCH_PAGER_FAULT	15
+/* Uncontended mutex_lock() and mutex_unlock(), parameter: unused */
+#define PTA_MICROBENCH_MUTEX		16
+/* Uncontended cpu_spin_lock_xsave() and unlock, parameter: unused */
+#define PTA_MICROBENCH_SPINLOCK		17
+/*
+ * memcpy(), memmove(), memset() and memcmp() of value[1].b bytes, up to
+ * PTA_MICROBENCH_MEM_MAX_SIZE. Parameter: offset of the destination (s1
+ * for memcmp()) from an aligned address in bits [7:0] and offset of the
+ * source (s2) in bits [15:8], both less than PTA_MICROBENCH_MEM_MAX_OFFS.
+ * The source and destination of memmove() overlap, memcmp() compares
+ * equal buffers.
+ */
+#define PTA_MICROBENCH_MEMCPY		18
+#define PTA_MICROBENCH_MEMMOVE		19
+#define PTA_MICROBENCH_MEMSET		20
+#define PTA_MICROBENCH_MEMCMP		21
+
+#define PTA_MICROBENCH_MEM_MAX_SIZE	(1024 * 1024)
+#define PTA_MICROBENCH_MEM_MAX_OFFS	64
+
+#endif /*__PTA_MICROBENCH_H*/
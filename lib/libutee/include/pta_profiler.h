@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#ifndef __PTA_PROFILER_H
+#define __PTA_PROFILER_H
+
+#include <stdint.h>
+
+/*
+ * Interface to the core profiler pseudo-TA, which samples the program
+ * counter and call stack of the TEE core each time a secure thread is
+ * preempted by a foreign (non-secure) interrupt.
+ */
+
+#define PTA_PROFILER_UUID { 0xd5ede669, 0x2289, 0x4d6b, { \
+			    0xae, 0x46, 0x64, 0x25, 0x1d, 0xd3, 0xb2, 0xb0 } }
+
+/*
+ * Allocate the sample buffer in shared memory and start sampling
+ *
+ * [in]  value[0].a: Number of samples per CPU, must be a power of two
+ * [out] value[1].a: Size of the buffer in bytes
+ */
+#define PTA_PROFILER_CMD_START		0
+
+/*
+ * Stop sampling, the samples are kept until the next
+ * PTA_PROFILER_CMD_START
+ */
+#define PTA_PROFILER_CMD_STOP		1
+
+/*
+ * Copy the sample buffer, only allowed once sampling has been stopped
+ *
+ * [out] memref[0]: Destination buffer, updated with the required size
+ *		    if too small
+ */
+#define PTA_PROFILER_CMD_READ		2
+
+/*
+ * Format of the sample buffer, all fields are little endian:
+ *
+ * struct prof_buf_hdr
+ * struct prof_cpu_buf for CPU 0
+ * struct prof_sample[samples_per_cpu] for CPU 0
+ * struct prof_cpu_buf for CPU 1
+ * ...
+ *
+ * Each per-CPU buffer is a ring, prof_cpu_buf.head is the total number of
+ * samples taken on that CPU. When head > samples_per_cpu the oldest
+ * samples have been overwritten.
+ */
+#define PROF_BUF_MAGIC		0x464f5250	/* "PROF" */
+#define PROF_BUF_VERSION	1
+
+/* Maximum number of return addresses recorded for each sample */
+#define PROF_MAX_DEPTH		16
+
+struct prof_buf_hdr {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_cpus;
+	uint32_t samples_per_cpu;
+	uint32_t max_depth;
+	uint32_t pad;
+};
+
+struct prof_cpu_buf {
+	uint64_t head;
+};
+
+/*
+ * @thread:	ID of the preempted thread
+ * @depth:	Number of valid entries in @pc, at least 1
+ * @pc:		@pc[0] is the address where the thread was preempted,
+ *		followed by the return addresses of the callers (minus one
+ *		instruction) as found by unwinding the stack, innermost first
+ */
+struct prof_sample {
+	uint32_t thread;
+	uint32_t depth;
+	uint64_t pc[PROF_MAX_DEPTH];
+};
+
+#endif /* __PTA_PROFILER_H */
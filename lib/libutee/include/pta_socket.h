@@ -48,4 +48,20 @@
  */
 #define PTA_SOCKET_IOCTL	5
 
+/*
+ * Moves the data of a TCP socket through rings in memory shared with
+ * tee-supplicant instead of one RPC per PTA_SOCKET_SEND or
+ * PTA_SOCKET_RECV. Returns TEE_ERROR_NOT_SUPPORTED if tee-supplicant
+ * doesn't support it, the socket is then used as before.
+ *
+ * [in]		value[0].a	socket handle
+ * [in]		value[0].b	size of each ring, a power of two between
+ *				PTA_SOCKET_RING_MIN_SIZE and
+ *				PTA_SOCKET_RING_MAX_SIZE
+ */
+#define PTA_SOCKET_RING_ENABLE	6
+
+#define PTA_SOCKET_RING_MIN_SIZE	(4 * 1024)
+#define PTA_SOCKET_RING_MAX_SIZE	(256 * 1024)
+
 #endif /*__PTA_SOCKET*/
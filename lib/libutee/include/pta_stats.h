@@ -0,0 +1,218 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#ifndef __PTA_STATS_H
+#define __PTA_STATS_H
+
+#include <stdint.h>
+#include <tee_api_types.h>
+
+/*
+ * Interface to the statistics pseudo-TA
+ *
+ * The structures below are what the commands return in memory references,
+ * they are independent of the layout of the structures used internally by
+ * the TEE core. Their layout is fixed for a given STATS_VERSION, any change
+ * to them increments it.
+ */
+
+#define STATS_UUID \
+		{ 0xd96a5b40, 0xe2c7, 0xb1af, \
+			{ 0x87, 0x94, 0x10, 0x02, 0xa5, 0xd5, 0xc6, 0x1b } }
+
+#define STATS_VERSION			1
+
+#define STATS_CMD_PAGER_STATS		0
+#define STATS_CMD_ALLOC_STATS		1
+#define STATS_CMD_MEMLEAK_STATS		2
+#define STATS_CMD_TA_STATS		3
+#define STATS_CMD_LOCK_STATS		4
+#define STATS_CMD_HEAP_STATS		5
+#define STATS_CMD_RPC_STATS		6
+#define STATS_CMD_PAGER_AREA_STATS	7
+#define STATS_CMD_MUTEX_STATS		8
+#define STATS_CMD_GUEST_STATS		9
+#define STATS_CMD_ITR_STATS		10
+
+/*
+ * Returns the version of the structures below
+ *
+ * [out] value[0].a	STATS_VERSION
+ * [out] value[0].b	Reserved, 0
+ */
+#define STATS_CMD_GET_VERSION		11
+
+#define STATS_TA_NUM_CRYPTO_CLASSES	16
+#define STATS_TA_NUM_SYSCALLS		128
+
+/*
+ * Resource accounting of a loaded TA, returned by STATS_CMD_TA_STATS.
+ * Times are in system counter ticks.
+ *
+ * @sess_count:		Number of open sessions
+ * @panicked:		True if the TA has panicked
+ * @user_ticks:		Time spent in user mode
+ * @kernel_ticks:	Time spent in system calls, including RPCs
+ * @rpc_count:		Number of RPCs to normal world
+ * @rpc_ticks:		Time spent waiting for normal world in RPCs
+ * @storage_read:	Bytes read from persistent objects
+ * @storage_written:	Bytes written to persistent objects
+ * @page_faults:	Number of faults handled by the pager
+ * @crypto_bytes:	Bytes supplied to crypto operations, indexed by
+ *			TEE_OPERATION_*
+ * @syscalls:		Number of system calls, indexed by TEE_SCN_*
+ */
+struct stats_ta_acct {
+	TEE_UUID uuid;
+	uint32_t sess_count;
+	uint32_t panicked;
+	uint64_t user_ticks;
+	uint64_t kernel_ticks;
+	uint64_t rpc_count;
+	uint64_t rpc_ticks;
+	uint64_t storage_read;
+	uint64_t storage_written;
+	uint64_t page_faults;
+	uint64_t crypto_bytes[STATS_TA_NUM_CRYPTO_CLASSES];
+	uint32_t syscalls[STATS_TA_NUM_SYSCALLS];
+};
+
+#define STATS_LOCK_TYPE_SPINLOCK	0
+#define STATS_LOCK_TYPE_MUTEX		1
+
+/*
+ * Contention of a lock class, returned by STATS_CMD_LOCK_STATS. Times are
+ * in system counter ticks.
+ *
+ * @key:	Identifies the lock class
+ * @type:	STATS_LOCK_TYPE_*
+ * @acquired:	Number of times the lock has been acquired
+ * @contended:	Number of times the lock had to be waited for
+ * @wait_ticks:	Total time spent waiting for the lock
+ * @max_wait_ticks: Longest time spent waiting for the lock
+ * @hold_ticks:	Total time the lock has been held
+ * @max_hold_ticks: Longest time the lock has been held
+ */
+struct stats_lock {
+	uint64_t key;
+	uint32_t type;
+	uint32_t pad;
+	uint64_t acquired;
+	uint64_t contended;
+	uint64_t wait_ticks;
+	uint64_t max_wait_ticks;
+	uint64_t hold_ticks;
+	uint64_t max_hold_ticks;
+};
+
+#define STATS_RPC_NUM_BUCKETS		32
+/* Commands with an id >= STATS_RPC_CMD_OTHER are accounted together */
+#define STATS_RPC_CMD_OTHER		32
+
+/*
+ * Latency of an RPC command, returned by STATS_CMD_RPC_STATS. Times are in
+ * system counter ticks.
+ *
+ * @cmd:	OPTEE_RPC_CMD_* or STATS_RPC_CMD_OTHER
+ * @in_flight:	Number of requests currently serviced by normal world
+ * @count:	Number of completed requests
+ * @total_ticks: Accumulated latency of the completed requests
+ * @max_ticks:	Longest latency
+ * @buckets:	@buckets[n] counts the requests which took 2^n to
+ *		2^(n+1) - 1 ticks, the last bucket also counts all longer
+ *		requests
+ */
+struct stats_rpc_cmd {
+	uint32_t cmd;
+	uint32_t in_flight;
+	uint64_t count;
+	uint64_t total_ticks;
+	uint64_t max_ticks;
+	uint32_t buckets[STATS_RPC_NUM_BUCKETS];
+};
+
+#define STATS_PAGER_AREA_TYPE_RO	0
+#define STATS_PAGER_AREA_TYPE_RW	1
+#define STATS_PAGER_AREA_TYPE_LOCK	2
+
+/*
+ * Paging activity of a pager area, returned by STATS_CMD_PAGER_AREA_STATS.
+ * Times are in system counter ticks.
+ *
+ * @uuid:	UUID of the TA owning the area, all zero for core areas
+ * @base:	Start virtual address of the area
+ * @size:	Size of the area in bytes
+ * @type:	STATS_PAGER_AREA_TYPE_*
+ * @resident:	Number of pages of the area currently held in physical pages
+ * @faults:	Number of faults handled in the area
+ * @loads:	Number of pages loaded
+ * @saves:	Number of dirty pages saved
+ * @decrypted:	Number of bytes decrypted when loading pages
+ * @encrypted:	Number of bytes encrypted when saving pages
+ * @fault_ticks: Total time spent handling faults in the area
+ */
+struct stats_pager_area {
+	TEE_UUID uuid;
+	uint64_t base;
+	uint32_t size;
+	uint32_t type;
+	uint32_t resident;
+	uint32_t faults;
+	uint32_t loads;
+	uint32_t saves;
+	uint64_t decrypted;
+	uint64_t encrypted;
+	uint64_t fault_ticks;
+};
+
+/*
+ * Secure interrupt, returned by STATS_CMD_ITR_STATS. Times are in system
+ * counter ticks.
+ *
+ * @it:		Interrupt number
+ * @count:	Number of times the interrupt has been handled
+ * @total_ticks: Accumulated time spent in the handlers
+ * @max_ticks:	Longest time spent in the handlers
+ */
+struct stats_itr {
+	uint32_t it;
+	uint32_t count;
+	uint64_t total_ticks;
+	uint64_t max_ticks;
+};
+
+#define STATS_HEAP_NUM_SIZE_CLASSES	16
+
+/*
+ * Layout of a heap, returned by STATS_CMD_HEAP_STATS
+ *
+ * @size_class[n] counts the allocations of 2^n to 2^(n+1) - 1 bytes, the
+ * last class also counts all larger allocations.
+ */
+struct stats_heap {
+	uint32_t num_alloced;
+	uint32_t num_free;
+	uint32_t total_free;
+	uint32_t largest_free;
+	uint32_t size_class[STATS_HEAP_NUM_SIZE_CLASSES];
+};
+
+#define STATS_HEAP_SITE_FNAME_LENGTH	48
+
+/*
+ * Allocations of a heap from a call site, returned by STATS_CMD_HEAP_STATS.
+ * @fname holds the tail of the source file name if it's too long.
+ */
+struct stats_heap_site {
+	char fname[STATS_HEAP_SITE_FNAME_LENGTH];
+	uint32_t line;
+	uint32_t num_allocs;
+	uint32_t num_alloced;
+	uint32_t allocated;
+	uint32_t max_allocated;
+	uint32_t pad;
+};
+
+#endif /* __PTA_STATS_H */
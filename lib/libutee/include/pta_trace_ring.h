@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#ifndef __PTA_TRACE_RING_H
+#define __PTA_TRACE_RING_H
+
+/*
+ * Interface to the trace ring pseudo-TA, which hands the core traces
+ * stored in the per-CPU trace rings over to normal world. It's only
+ * available with CFG_CORE_TRACE_RING=y, the traces are then only output
+ * on the secure console in case of panic.
+ */
+
+#define PTA_TRACE_RING_UUID { 0x6b1bd77d, 0x5a2c, 0x4f3b, { \
+			      0x9b, 0x47, 0x0e, 0x2d, 0x1a, 0x8c, 0x53, 0xf1 } }
+
+/*
+ * Move the pending traces into a buffer, the traces are removed from the
+ * rings. Nothing is returned while another CPU is reading, the command is
+ * supposed to be repeated periodically from a context where the latency
+ * doesn't matter, until it returns no data.
+ *
+ * [out] memref[0]: Destination buffer, updated with the number of bytes
+ *		    of traces copied
+ */
+#define PTA_TRACE_RING_CMD_READ		0
+
+#endif /* __PTA_TRACE_RING_H */
@@ -0,0 +1,142 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/*
+ * Copyright (c) 2019, Linaro Limited
+ */
+
+#ifndef __PTA_TRACEPOINT_H
+#define __PTA_TRACEPOINT_H
+
+#include <stdint.h>
+
+/*
+ * Interface to the tracepoint pseudo-TA, which is used to record
+ * timestamped events from the TEE core into per-CPU ring buffers
+ * allocated in shared memory.
+ */
+
+#define PTA_TRACEPOINT_UUID { 0x281c0d0c, 0x8c5c, 0x4ef8, { \
+			      0x90, 0x2a, 0x34, 0xdf, 0x38, 0xd6, 0x02, 0xb6 } }
+
+/*
+ * Allocate the event buffer in shared memory and start recording
+ *
+ * [in]  value[0].a: Number of events per CPU, must be a power of two
+ * [out] value[1].a: Upper 32 bits of the physical address of the buffer
+ * [out] value[1].b: Lower 32 bits of the physical address of the buffer
+ * [out] value[2].a: Size of the buffer in bytes
+ *
+ * Returns TEE_ERROR_NOT_SUPPORTED if the TEE core has no system counter to
+ * timestamp the events with.
+ */
+#define PTA_TRACEPOINT_CMD_START	0
+
+/*
+ * Stop recording and free the event buffer
+ */
+#define PTA_TRACEPOINT_CMD_STOP		1
+
+/*
+ * Copy the event buffer, the copy is only guaranteed to be consistent
+ * once recording has been paused with PTA_TRACEPOINT_CMD_PAUSE.
+ *
+ * [out] memref[0]: Destination buffer, updated with the required size
+ *		    if too small
+ */
+#define PTA_TRACEPOINT_CMD_READ		2
+
+/*
+ * Pause or resume recording without releasing the event buffer
+ *
+ * [in]  value[0].a: 0 to pause, 1 to resume
+ */
+#define PTA_TRACEPOINT_CMD_PAUSE	3
+
+/*
+ * Format of the event buffer, all fields are little endian:
+ *
+ * struct tp_buf_hdr
+ * struct tp_cpu_buf for CPU 0
+ * struct tp_event[events_per_cpu] for CPU 0
+ * struct tp_cpu_buf for CPU 1
+ * ...
+ *
+ * Each per-CPU buffer is a ring, tp_cpu_buf.head is the total number of
+ * events recorded on that CPU. The most recent event is at index
+ * (head - 1) % events_per_cpu, and when head > events_per_cpu the
+ * oldest events have been overwritten.
+ */
+#define TP_BUF_MAGIC		0x4f505450	/* "PTPO" */
+#define TP_BUF_VERSION		1
+
+struct tp_buf_hdr {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_cpus;
+	uint32_t events_per_cpu;
+	uint64_t cntfrq;	/* Frequency of tp_event.ts */
+};
+
+struct tp_cpu_buf {
+	uint64_t head;
+};
+
+#define TP_PHASE_INSTANT	0
+#define TP_PHASE_BEGIN		1
+#define TP_PHASE_END		2
+
+#define TP_NO_THREAD		0xff
+
+/*
+ * @ts:		Value of the system counter at record time
+ * @id:		One of TP_EVENT_* below
+ * @phase:	One of TP_PHASE_* above
+ * @thread:	Thread ID or TP_NO_THREAD
+ * @arg0..2:	Payload, see the description of each event below
+ */
+struct tp_event {
+	uint64_t ts;
+	uint16_t id;
+	uint8_t phase;
+	uint8_t thread;
+	uint32_t arg0;
+	uint64_t arg1;
+	uint64_t arg2;
+};
+
+/*
+ * Events and payload
+ *
+ * STD_SMC		begin: arg0 = a0, arg1 = a1, end: arg0 = returned a0,
+ *			only once per call, not when resuming from RPC
+ * FAST_SMC		begin: arg0 = a0, end: arg0 = returned a0
+ * THREAD_ALLOC		instant: arg0 = allocated thread ID
+ * THREAD_SUSPEND	instant: arg0 = suspend flags, arg1 = resume PC
+ * THREAD_RESUME	instant: arg0 = thread ID
+ * RPC			begin: arg0 = OPTEE_RPC_CMD_*,
+ *			end: arg0 = OPTEE_RPC_CMD_*, arg1 = result
+ * PAGER_FAULT		begin: arg1 = faulting address, end: arg0 = handled
+ * PAGER_LOAD		instant: arg0 = area type, arg1 = page address
+ * PAGER_EVICT		instant: arg1 = evicted page address
+ * STORAGE_READ		begin: arg1 = block number, end: arg0 = result
+ * STORAGE_WRITE	begin: arg1 = block number, end: arg0 = result
+ * CRYPTO		begin: arg0 = TEE_ALG_*, arg1 = length
+ *			end: arg0 = TEE_ALG_*, arg1 = result
+ * TA_LOAD		begin: arg0 = uuid.timeLow, arg1 and arg2 = the
+ *			remaining 12 bytes of the TEE_UUID in memory order,
+ *			end: arg0 = result
+ */
+#define TP_EVENT_STD_SMC	0
+#define TP_EVENT_FAST_SMC	1
+#define TP_EVENT_THREAD_ALLOC	2
+#define TP_EVENT_THREAD_SUSPEND	3
+#define TP_EVENT_THREAD_RESUME	4
+#define TP_EVENT_RPC		5
+#define TP_EVENT_PAGER_FAULT	6
+#define TP_EVENT_PAGER_LOAD	7
+#define TP_EVENT_PAGER_EVICT	8
+#define TP_EVENT_STORAGE_READ	9
+#define TP_EVENT_STORAGE_WRITE	10
+#define TP_EVENT_CRYPTO		11
+#define TP_EVENT_TA_LOAD	12
+
+#endif /* __PTA_TRACEPOINT_H */
@@ -34,4 +34,31 @@ TEE_Result TEE_CacheClean(char *buf, size_t len);
 TEE_Result TEE_CacheFlush(char *buf, size_t len);
 TEE_Result TEE_CacheInvalidate(char *buf, size_t len);
 
+/*
+ * Persistent object storage transactions
+ *
+ * TEE_BeginPersistentObjectTransaction() Starts a transaction on the
+ *     storage, changes made to persistent objects by the TA until the
+ *     transaction ends are committed together: creation, writes,
+ *     truncation, renaming and deletion. Until the transaction has
+ *     ended, other TAs get TEE_ERROR_STORAGE_NOT_AVAILABLE when using the
+ *     same storage and TEE_ERROR_BUSY when beginning a transaction. Returns
+ *     TEE_ERROR_NOT_SUPPORTED if the storage doesn't support transactions,
+ *     only TEE_STORAGE_PRIVATE_REE does.
+ *
+ * TEE_CommitPersistentObjectTransaction() Commits the changes with a
+ *     single update of the storage directory. If a change made in the
+ *     transaction failed or the commit fails, all changes are discarded
+ *     and the error is returned.
+ *
+ * TEE_AbortPersistentObjectTransaction() Discards the changes. Objects
+ *     created in the transaction which are still open can only be closed.
+ *
+ * A transaction not ended when the TA panics or its instance is destroyed
+ * is aborted.
+ */
+TEE_Result TEE_BeginPersistentObjectTransaction(uint32_t storageID);
+TEE_Result TEE_CommitPersistentObjectTransaction(uint32_t storageID);
+void TEE_AbortPersistentObjectTransaction(uint32_t storageID);
+
 #endif
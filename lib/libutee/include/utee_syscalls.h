@@ -209,6 +209,11 @@ TEE_Result utee_storage_obj_trunc(unsigned long obj, size_t len);
 TEE_Result utee_storage_obj_seek(unsigned long obj, int32_t offset,
 				 unsigned long whence);
 
+TEE_Result utee_storage_tx_begin(unsigned long storage_id);
+
+/* commit is 1 to commit the transaction or 0 to abort it */
+TEE_Result utee_storage_tx_end(unsigned long storage_id, unsigned long commit);
+
 /* seServiceHandle is of type TEE_SEServiceHandle */
 TEE_Result utee_se_service_open(uint32_t *seServiceHandle);
 
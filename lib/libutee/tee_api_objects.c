@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include <tee_api.h>
+#include <tee_internal_api_extensions.h>
 #include <utee_syscalls.h>
 #include "tee_api_private.h"
 
@@ -776,3 +777,46 @@ out:
 
 	return res;
 }
+
+TEE_Result TEE_BeginPersistentObjectTransaction(uint32_t storageID)
+{
+	TEE_Result res;
+
+	res = utee_storage_tx_begin(storageID);
+	if (res != TEE_SUCCESS &&
+	    res != TEE_ERROR_ITEM_NOT_FOUND &&
+	    res != TEE_ERROR_NOT_SUPPORTED &&
+	    res != TEE_ERROR_BAD_STATE &&
+	    res != TEE_ERROR_BUSY &&
+	    res != TEE_ERROR_OUT_OF_MEMORY &&
+	    res != TEE_ERROR_CORRUPT_OBJECT &&
+	    res != TEE_ERROR_STORAGE_NOT_AVAILABLE)
+		TEE_Panic(res);
+
+	return res;
+}
+
+TEE_Result TEE_CommitPersistentObjectTransaction(uint32_t storageID)
+{
+	TEE_Result res;
+
+	res = utee_storage_tx_end(storageID, 1);
+	if (res != TEE_SUCCESS &&
+	    res != TEE_ERROR_BAD_STATE &&
+	    res != TEE_ERROR_OUT_OF_MEMORY &&
+	    res != TEE_ERROR_STORAGE_NO_SPACE &&
+	    res != TEE_ERROR_CORRUPT_OBJECT &&
+	    res != TEE_ERROR_STORAGE_NOT_AVAILABLE)
+		TEE_Panic(res);
+
+	return res;
+}
+
+void TEE_AbortPersistentObjectTransaction(uint32_t storageID)
+{
+	TEE_Result res;
+
+	res = utee_storage_tx_end(storageID, 0);
+	if (res != TEE_SUCCESS)
+		TEE_Panic(res);
+}
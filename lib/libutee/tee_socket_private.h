@@ -29,4 +29,6 @@ TEE_Result __tee_socket_pta_recv(uint32_t handle, void *buf, uint32_t *len,
 TEE_Result __tee_socket_pta_ioctl(uint32_t handle, uint32_t command, void *buf,
 				  uint32_t *len);
 
+TEE_Result __tee_socket_pta_ring_enable(uint32_t handle, uint32_t size);
+
 #endif /*__TEE_SOCKET_PRIVATE_H*/
@@ -158,3 +158,18 @@ TEE_Result __tee_socket_pta_ioctl(uint32_t handle, uint32_t command, void *buf,
 	*len =  params[1].memref.size;
 	return res;
 }
+
+TEE_Result __tee_socket_pta_ring_enable(uint32_t handle, uint32_t size)
+{
+	uint32_t param_types;
+	TEE_Param params[TEE_NUM_PARAMS];
+
+	param_types = TEE_PARAM_TYPES(TEE_PARAM_TYPE_VALUE_INPUT,
+				      TEE_PARAM_TYPE_NONE, TEE_PARAM_TYPE_NONE,
+				      TEE_PARAM_TYPE_NONE);
+	memset(params, 0, sizeof(params));
+
+	params[0].value.a = handle;
+	params[0].value.b = size;
+	return invoke_socket_pta(PTA_SOCKET_RING_ENABLE, param_types, params);
+}
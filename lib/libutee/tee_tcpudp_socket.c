@@ -4,6 +4,7 @@
  */
 
 #include <pta_socket.h>
+#include <string.h>
 #include <tee_internal_api.h>
 #include <tee_isocket.h>
 #include <tee_tcpsocket.h>
@@ -154,6 +155,7 @@ static TEE_Result tcp_ioctl(TEE_iSocketHandle ctx, uint32_t commandCode,
 {
 	TEE_Result res = TEE_ERROR_GENERIC;
 	struct socket_ctx *sock_ctx = (struct socket_ctx *)ctx;
+	uint32_t size = 0;
 
 	if (ctx == TEE_HANDLE_NULL || !length || (!buf && *length))
 		TEE_Panic(0);
@@ -167,6 +169,12 @@ static TEE_Result tcp_ioctl(TEE_iSocketHandle ctx, uint32_t commandCode,
 		res = __tee_socket_pta_ioctl(sock_ctx->handle, commandCode,
 					     buf, length);
 		break;
+	case TEE_TCP_SET_RING:
+		if (*length != sizeof(size))
+			TEE_Panic(0);
+		memcpy(&size, buf, sizeof(size));
+		res = __tee_socket_pta_ring_enable(sock_ctx->handle, size);
+		break;
 	default:
 		TEE_Panic(0);
 	}
@@ -23,6 +23,11 @@ static inline bool atomic_cas_u32(uint32_t *p, uint32_t *oval, uint32_t nval)
 	return __compiler_compare_and_swap(p, oval, nval);
 }
 
+static inline bool atomic_cas_u64(uint64_t *p, uint64_t *oval, uint64_t nval)
+{
+	return __compiler_compare_and_swap(p, oval, nval);
+}
+
 static inline int atomic_load_int(int *p)
 {
 	return __compiler_atomic_load(p);
@@ -38,6 +43,11 @@ static inline unsigned int atomic_load_u32(unsigned int *p)
 	return __compiler_atomic_load(p);
 }
 
+static inline uint64_t atomic_load_u64(uint64_t *p)
+{
+	return __compiler_atomic_load(p);
+}
+
 static inline void atomic_store_int(int *p, int val)
 {
 	__compiler_atomic_store(p, val);
@@ -53,4 +63,9 @@ static inline void atomic_store_u32(uint32_t *p, uint32_t val)
 	__compiler_atomic_store(p, val);
 }
 
+static inline uint64_t atomic_add_u64(uint64_t *p, uint64_t val)
+{
+	return __compiler_atomic_add(p, val);
+}
+
 #endif /*__ATOMIC_H*/
@@ -239,5 +239,7 @@
 #define __compiler_atomic_load(p) __atomic_load_n((p), __ATOMIC_RELAXED)
 #define __compiler_atomic_store(p, val) \
 	__atomic_store_n((p), (val), __ATOMIC_RELAXED)
+#define __compiler_atomic_add(p, val) \
+	__atomic_add_fetch((p), (val), __ATOMIC_RELAXED)
 
 #endif /*COMPILER_H*/
@@ -83,6 +83,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string_ext.h>
 #include <trace.h>
 #include <util.h>
 
@@ -132,6 +133,24 @@ struct malloc_pool {
 	size_t len;
 };
 
+#if defined(BufStats) && defined(ENABLE_MDBG)
+/* Must be a power of two */
+#define MDBG_NUM_SITES		128
+
+/*
+ * Allocations aggregated by call site, the call sites are identified by
+ * the __FILE__ and __LINE__ supplied to mdbg_malloc() and friends.
+ */
+struct mdbg_site {
+	const char *fname;
+	uint32_t line;
+	uint32_t num_allocs;
+	uint32_t num_alloced;
+	uint32_t allocated;
+	uint32_t max_allocated;
+};
+#endif
+
 struct malloc_ctx {
 	struct bpoolset poolset;
 	struct malloc_pool *pool;
@@ -139,6 +158,10 @@ struct malloc_ctx {
 #ifdef BufStats
 	struct malloc_stats mstats;
 #endif
+#if defined(BufStats) && defined(ENABLE_MDBG)
+	struct mdbg_site sites[MDBG_NUM_SITES];
+	size_t num_sites;
+#endif
 #ifdef __KERNEL__
 	unsigned int spinlock;
 #endif
@@ -451,6 +474,118 @@ struct mdbg_hdr {
 #define MDBG_HEADER_MAGIC	0xadadadad
 #define MDBG_FOOTER_MAGIC	0xecececec
 
+#ifdef BufStats
+/*
+ * Returns the entry of a call site, adding it if @add is true. Entries are
+ * never removed, when the table is full further call sites aren't
+ * recorded.
+ */
+static struct mdbg_site *mdbg_get_site(struct malloc_ctx *ctx,
+				       const char *fname, uint32_t line,
+				       bool add)
+{
+	const size_t mask = MDBG_NUM_SITES - 1;
+	struct mdbg_site *site = NULL;
+	size_t idx = 0;
+	size_t n = 0;
+
+	COMPILE_TIME_ASSERT(IS_POWER_OF_TWO(MDBG_NUM_SITES));
+
+	idx = ((uintptr_t)fname >> 2) * 31 + line;
+	for (n = 0; n < MDBG_NUM_SITES; n++) {
+		site = ctx->sites + ((idx + n) & mask);
+		if (!site->line) {
+			if (!add)
+				return NULL;
+			site->fname = fname;
+			site->line = line;
+			ctx->num_sites++;
+			return site;
+		}
+		if (site->fname == fname && site->line == line)
+			return site;
+	}
+
+	return NULL;
+}
+
+static void mdbg_site_alloced(struct malloc_ctx *ctx, struct mdbg_hdr *hdr)
+{
+	/* Line 0 marks a free entry, no allocation can be on line 0 */
+	struct mdbg_site *site = mdbg_get_site(ctx, hdr->fname,
+					       MAX(hdr->line, 1), true);
+
+	if (site) {
+		site->num_allocs++;
+		site->num_alloced++;
+		site->allocated += hdr->pl_size;
+		if (site->allocated > site->max_allocated)
+			site->max_allocated = site->allocated;
+	}
+}
+
+static void mdbg_site_freed(struct malloc_ctx *ctx, struct mdbg_hdr *hdr)
+{
+	struct mdbg_site *site = mdbg_get_site(ctx, hdr->fname,
+					       MAX(hdr->line, 1), false);
+
+	if (site) {
+		site->num_alloced--;
+		site->allocated -= hdr->pl_size;
+	}
+}
+
+static size_t gen_malloc_get_site_stats(struct malloc_ctx *ctx,
+					struct malloc_site_stats *stats,
+					size_t count)
+{
+	uint32_t exceptions = malloc_lock(ctx);
+	struct mdbg_site *site = NULL;
+	const char *fname = NULL;
+	size_t num_sites = 0;
+	size_t len = 0;
+	size_t n = 0;
+
+	for (n = 0; n < MDBG_NUM_SITES && num_sites < count; n++) {
+		site = ctx->sites + n;
+		if (!site->line)
+			continue;
+
+		fname = site->fname;
+		if (!fname)
+			fname = "unknown";
+		len = strlen(fname);
+		if (len >= sizeof(stats->fname))
+			fname += len - sizeof(stats->fname) + 1;
+
+		memset(stats, 0, sizeof(*stats));
+		strlcpy(stats->fname, fname, sizeof(stats->fname));
+		stats->line = site->line;
+		stats->num_allocs = site->num_allocs;
+		stats->num_alloced = site->num_alloced;
+		stats->allocated = site->allocated;
+		stats->max_allocated = site->max_allocated;
+		stats++;
+		num_sites++;
+	}
+	num_sites = ctx->num_sites;
+
+	malloc_unlock(ctx, exceptions);
+
+	return num_sites;
+}
+#else
+static void mdbg_site_alloced(struct malloc_ctx *ctx __unused,
+			      struct mdbg_hdr *hdr __unused)
+{
+}
+
+static void mdbg_site_freed(struct malloc_ctx *ctx __unused,
+			    struct mdbg_hdr *hdr __unused)
+{
+}
+#endif
+
 static size_t mdbg_get_ftr_size(size_t pl_size)
 {
 	size_t ftr_pad = ROUNDUP(pl_size, sizeof(uint32_t)) - pl_size;
@@ -501,6 +636,7 @@ static void *gen_mdbg_malloc(struct malloc_ctx *ctx, const char *fname,
 			 mdbg_get_ftr_size(size), size, ctx);
 	if (hdr) {
 		mdbg_update_hdr(hdr, fname, lineno, size);
+		mdbg_site_alloced(ctx, hdr);
 		hdr++;
 	}
 
@@ -521,6 +657,7 @@ static void gen_mdbg_free(struct malloc_ctx *ctx, void *ptr)
 	if (hdr) {
 		hdr--;
 		assert_header(hdr);
+		mdbg_site_freed(ctx, hdr);
 		hdr->magic = 0;
 		*mdbg_get_footer(hdr) = 0;
 		raw_free(hdr, ctx);
@@ -546,6 +683,7 @@ static void *gen_mdbg_calloc(struct malloc_ctx *ctx, const char *fname, int line
 			  ctx);
 	if (hdr) {
 		mdbg_update_hdr(hdr, fname, lineno, nmemb * size);
+		mdbg_site_alloced(ctx, hdr);
 		hdr++;
 	}
 	malloc_unlock(ctx, exceptions);
@@ -556,15 +694,21 @@ static void *gen_mdbg_realloc_unlocked(struct malloc_ctx *ctx, const char *fname
 				       int lineno, void *ptr, size_t size)
 {
 	struct mdbg_hdr *hdr = ptr;
+	struct mdbg_hdr old_hdr = { 0 };
 
 	if (hdr) {
 		hdr--;
 		assert_header(hdr);
+		old_hdr = *hdr;
 	}
 	hdr = raw_realloc(hdr, sizeof(struct mdbg_hdr),
 			   mdbg_get_ftr_size(size), size, ctx);
 	if (hdr) {
+		/* The old buffer is only released if the realloc succeeds */
+		if (ptr)
+			mdbg_site_freed(ctx, &old_hdr);
 		mdbg_update_hdr(hdr, fname, lineno, size);
+		mdbg_site_alloced(ctx, hdr);
 		hdr++;
 	}
 	return hdr;
@@ -691,6 +835,63 @@ static void *get_payload_start_size(void *ptr, size_t *size)
 	return ptr;
 }
 
+#ifdef BufStats
+static size_t gen_malloc_get_site_stats(struct malloc_ctx *ctx __unused,
+					struct malloc_site_stats *stats __unused,
+					size_t count __unused)
+{
+	return 0;
+}
+#endif
+
+#endif
+
+#ifdef BufStats
+static void gen_malloc_get_heap_stats(struct malloc_ctx *ctx,
+				      struct malloc_heap_stats *stats)
+{
+	uint32_t exceptions = malloc_lock(ctx);
+	struct bpool_iterator itr = { 0 };
+	size_t class = 0;
+	bool isfree = false;
+	void *b = NULL;
+	size_t len = 0;
+	size_t n = 0;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for (n = 0; n < ctx->pool_len; n++) {
+		itr.next_buf = BFH(ctx->pool[n].buf);
+		while (bpool_foreach_pool(&itr, &b, &len, &isfree)) {
+			if (isfree) {
+				stats->num_free++;
+				stats->total_free += len;
+				if (len > stats->largest_free)
+					stats->largest_free = len;
+				continue;
+			}
+
+			get_payload_start_size(b, &len);
+			stats->num_alloced++;
+			for (class = 0; len > 1 &&
+			     class < MALLOC_NUM_SIZE_CLASSES - 1; class++)
+				len >>= 1;
+			stats->size_class[class]++;
+		}
+	}
+
+	malloc_unlock(ctx, exceptions);
+}
+
+void malloc_get_heap_stats(struct malloc_heap_stats *stats)
+{
+	gen_malloc_get_heap_stats(&malloc_ctx, stats);
+}
+
+size_t malloc_get_site_stats(struct malloc_site_stats *stats, size_t count)
+{
+	return gen_malloc_get_site_stats(&malloc_ctx, stats, count);
+}
 #endif
 
 static void gen_malloc_add_pool(struct malloc_ctx *ctx, void *buf, size_t len)
@@ -914,6 +1115,17 @@ void nex_malloc_get_stats(struct malloc_stats *stats)
 	gen_malloc_get_stats(&nex_malloc_ctx, stats);
 }
 
+void nex_malloc_get_heap_stats(struct malloc_heap_stats *stats)
+{
+	gen_malloc_get_heap_stats(&nex_malloc_ctx, stats);
+}
+
+size_t nex_malloc_get_site_stats(struct malloc_site_stats *stats,
+				 size_t count)
+{
+	return gen_malloc_get_site_stats(&nex_malloc_ctx, stats, count);
+}
+
 #endif
 
 #endif
@@ -74,6 +74,47 @@ struct malloc_stats {
 
 void malloc_get_stats(struct malloc_stats *stats);
 void malloc_reset_stats(void);
+
+/* Number of power of two size classes in struct malloc_heap_stats */
+#define MALLOC_NUM_SIZE_CLASSES	16
+
+/*
+ * Layout of the heap, gathered by walking all the buffers
+ * @size_class[n] counts the allocations of 2^n to 2^(n+1) - 1 bytes, the
+ * last class also counts all larger allocations. The ratio between
+ * @largest_free and @total_free tells how fragmented the free space is.
+ */
+struct malloc_heap_stats {
+	uint32_t num_alloced;             /* Number of allocated buffers */
+	uint32_t num_free;                /* Number of free buffers */
+	uint32_t total_free;              /* Bytes in free buffers */
+	uint32_t largest_free;            /* Bytes in largest free buffer */
+	uint32_t size_class[MALLOC_NUM_SIZE_CLASSES];
+};
+
+void malloc_get_heap_stats(struct malloc_heap_stats *stats);
+
+/*
+ * Allocations aggregated by call site, only recorded with
+ * CFG_TEE_CORE_MALLOC_DEBUG=y. @fname holds the tail of the source file
+ * name if it's too long.
+ */
+#define MALLOC_SITE_FNAME_LENGTH 48
+struct malloc_site_stats {
+	char fname[MALLOC_SITE_FNAME_LENGTH];
+	uint32_t line;
+	uint32_t num_allocs;              /* Number of allocations */
+	uint32_t num_alloced;             /* Number of live allocations */
+	uint32_t allocated;               /* Bytes currently allocated */
+	uint32_t max_allocated;           /* Tracks max value of allocated */
+	uint32_t pad;
+};
+
+/*
+ * Copies the statistics of at most @count call sites into @stats and
+ * returns the number of call sites recorded so far
+ */
+size_t malloc_get_site_stats(struct malloc_site_stats *stats, size_t count);
 #endif /* CFG_WITH_STATS */
 
 
@@ -116,6 +157,9 @@ void nex_malloc_add_pool(void *buf, size_t len);
 
 void nex_malloc_get_stats(struct malloc_stats *stats);
 void nex_malloc_reset_stats(void);
+void nex_malloc_get_heap_stats(struct malloc_heap_stats *stats);
+size_t nex_malloc_get_site_stats(struct malloc_site_stats *stats,
+				 size_t count);
 
 #endif	/* CFG_WITH_STATS */
 #else  /* CFG_VIRTUALIZATION */
@@ -72,9 +72,24 @@ CFG_TEE_CORE_TA_TRACE ?= y
 #   $ make CFG_TEE_TA_MALLOC_DEBUG=y CFG_TEE_TA_LOG_LEVEL=3
 # - To debug TEE core allocations: build OP-TEE with:
 #   $ make CFG_TEE_CORE_MALLOC_DEBUG=y CFG_TEE_CORE_LOG_LEVEL=3
+# Combined with CFG_WITH_STATS=y the live and peak allocations of the TEE
+# core heap are also aggregated per call site and can be retrieved with
+# the stats pseudo TA.
 CFG_TEE_CORE_MALLOC_DEBUG ?= n
 CFG_TEE_TA_MALLOC_DEBUG ?= n
 
+# Asynchronous core traces
+# If y, core traces are stored in per-CPU lock-free ring buffers instead of
+# being written synchronously to the console with all exceptions masked.
+# Normal world reads the rings with the trace ring pseudo TA, see
+# pta_trace_ring.h, and outputs the traces itself, the secure console is
+# only written to during early boot and once a panic has occurred.
+# Messages that don't fit in the ring are dropped and accounted for.
+# CFG_CORE_TRACE_RING_SIZE is the size in bytes of each per-CPU ring, it
+# must be a power of two.
+CFG_CORE_TRACE_RING ?= n
+CFG_CORE_TRACE_RING_SIZE ?= 4096
+
 # Mask to select which messages are prefixed with long debugging information
 # (severity, core ID, thread ID, component name, function name, line number)
 # based on the message level. If BIT(level) is set, the long prefix is shown.
@@ -85,9 +100,20 @@ CFG_MSG_LONG_PREFIX_MASK ?= 0x1a
 # PRNG configuration
 # If CFG_WITH_SOFTWARE_PRNG is enabled, crypto provider provided
 # software PRNG implementation is used.
-# Otherwise, you need to implement hw_get_random_byte() for your platform
+# Otherwise, you need to implement hw_get_random_bytes() or
+# hw_get_random_byte() for your platform
 CFG_WITH_SOFTWARE_PRNG ?= y
 
+# When the software PRNG is disabled, CFG_WITH_CTR_DRBG serves random
+# numbers from an AES-256 CTR_DRBG (NIST SP 800-90A) which is seeded and
+# periodically reseeded from hw_get_random_bytes(), instead of reading the
+# hardware RNG for each request.
+CFG_WITH_CTR_DRBG ?= n
+
+# CFG_SOFT_RNG provides an insecure hw_get_random_bytes() derived from the
+# system counter, for testing on platforms without a hardware RNG only.
+CFG_SOFT_RNG ?= n
+
 # Number of threads
 CFG_NUM_THREADS ?= 2
 
@@ -239,12 +265,18 @@ $(eval $(call cfg-depends-all,CFG_REE_FS_TA_BUFFERED,CFG_REE_FS_TA))
 # in-tree TAs. CFG_IN_TREE_EARLY_TAS is formatted as:
 # <name-of-ta>/<uuid>
 # for instance avb/023f8f1a-292a-432b-8fc4-de8471358067
+#
+# CFG_EARLY_TA_COMPRESS selects how the early TAs are compressed: deflate
+# (zlib), lz4 which decompresses several times faster for a somewhat larger
+# binary and only decompresses the parts of the TA which are loaded, or
+# none.
 ifneq ($(EARLY_TA_PATHS)$(CFG_IN_TREE_EARLY_TAS),)
 $(call force,CFG_EARLY_TA,y)
 else
 CFG_EARLY_TA ?= n
 endif
-ifeq ($(CFG_EARLY_TA),y)
+CFG_EARLY_TA_COMPRESS ?= deflate
+ifeq ($(CFG_EARLY_TA)-$(CFG_EARLY_TA_COMPRESS),y-deflate)
 $(call force,CFG_ZLIB,y)
 endif
 
@@ -262,6 +294,21 @@ CFG_WITH_PAGER ?= n
 # Expect a significant performance impact when enabling this.
 CFG_LOCKDEP ?= n
 
+# Lock contention profiling: counts acquisitions and contended acquisitions
+# and accumulates wait and hold times of mutexes and spinlocks in the TEE
+# core. Locks are grouped in classes by address, or by the call site of
+# mutex_init() for dynamically initialized mutexes. The statistics are
+# retrieved with the stats pseudo TA, which requires CFG_WITH_STATS=y.
+# Every lock operation is slowed down when enabled.
+CFG_LOCK_PROFILING ?= n
+
+# Adaptive mutexes: a thread finding a mutex write locked by a thread
+# running on another core spins up to this many microseconds for it to be
+# released before sleeping in normal world, saving the two wait queue RPCs
+# of a sleep and a wakeup. 0 disables spinning. The spin is timed with the
+# Generic Timer, so it requires CFG_CORE_HAS_GENERIC_TIMER=y.
+CFG_MUTEX_SPIN_US ?= 0
+
 # BestFit algorithm in bget reduces the fragmentation of the heap when running
 # with the pager enabled or lockdep
 CFG_CORE_BGET_BESTFIT ?= $(call cfg-one-enabled, CFG_WITH_PAGER CFG_LOCKDEP)
@@ -269,6 +316,18 @@ CFG_CORE_BGET_BESTFIT ?= $(call cfg-one-enabled, CFG_WITH_PAGER CFG_LOCKDEP)
 # Use the pager for user TAs
 CFG_PAGED_USER_TA ?= $(CFG_WITH_PAGER)
 
+# With the pager, only the init part of the pageable area, which is used
+# in place, is checked against its hashes at boot. The rest is checked by
+# the pager each time a page of it is loaded, so checking it at boot too
+# only delays the boot. Set to n to check everything at boot anyway, to
+# detect a corrupted binary before the normal world is started.
+CFG_PAGER_DEFER_HASH_CHECK ?= y
+
+# If y, the name, level and duration of each initcall and the total time
+# spent in initcalls are printed at boot, to find the ones worth optimizing.
+# Durations read as 0 without CFG_CORE_HAS_GENERIC_TIMER.
+CFG_CORE_INITCALL_TIMING ?= n
+
 # Enable support for detected undefined behavior in C
 # Uses a lot of memory, can't be enabled by default
 CFG_CORE_SANITIZE_UNDEFINED ?= n
@@ -300,6 +359,12 @@ endif
 CFG_EMBED_DTB ?= n
 CFG_DT ?= n
 
+# When CFG_DT_INDEX is enabled the embedded DTB is indexed the first time
+# it's used, so that looking up nodes by compatible string, phandle, path
+# or parent with the dt_*() helpers of <kernel/dt.h> doesn't rescan the
+# tree. The external DTB isn't indexed since it's modified by the core.
+CFG_DT_INDEX ?= y
+
 # Maximum size of the Device Tree Blob, has to be large enough to allow
 # editing of the supplied DTB.
 CFG_DTB_MAX_SIZE ?= 0x10000
@@ -317,6 +382,12 @@ CFG_EXTERNAL_DTB_OVERLAY ?= n
 # Enable core self tests and related pseudo TAs
 CFG_TEE_CORE_EMBED_INTERNAL_TESTS ?= y
 
+# Enable the microbenchmark pseudo TA, see <pta_microbench.h>. It measures
+# the cost of core operations such as memory allocation, crypto, locking
+# and page faults and runs on QEMU as well as on hardware. The secure
+# storage hash tree benchmark requires CFG_TEE_CORE_EMBED_INTERNAL_TESTS=y.
+CFG_CORE_MICROBENCH ?= n
+
 # This option enables OP-TEE to respond to SMP boot request: the Rich OS
 # issues this to request OP-TEE to release secondaries cores out of reset,
 # with specific core number and non-secure entry address.
@@ -336,6 +407,26 @@ CFG_CORE_NEX_HEAP_SIZE ?= 16384
 # tee-supplicant)
 CFG_TA_GPROF_SUPPORT ?= n
 
+# Core tracepoints.
+# When this option is enabled, the TEE core records timestamped binary events
+# (SMC entry and exit, thread scheduling, RPCs, pager faults, secure storage
+# block accesses, crypto operations and TA loading) into per-CPU ring buffers
+# in shared memory. Recording is controlled with the tracepoint pseudo TA,
+# see lib/libutee/include/pta_tracepoint.h for the buffer format and
+# scripts/tp_timeline.py to convert a buffer into a timeline.
+# When disabled, the tracepoints are compiled out.
+CFG_CORE_TRACEPOINTS ?= n
+
+# Core profiler.
+# When this option is enabled, the program counter of a secure thread
+# preempted by a foreign (non-secure) interrupt while executing in the TEE
+# core is sampled, together with a short call stack if CFG_UNWIND=y. The
+# samples are recorded into per-CPU ring buffers in shared memory,
+# controlled with the profiler pseudo TA (lib/libutee/include/pta_profiler.h).
+# scripts/symbolize.py --folded turns a sample buffer into folded stacks
+# suitable for flame graphs.
+CFG_CORE_PROFILER ?= n
+
 # Enable to compile user TA libraries with profiling (-pg).
 # Depends on CFG_TA_GPROF_SUPPORT.
 CFG_ULIBS_GPROF ?= n
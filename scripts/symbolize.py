@@ -9,6 +9,7 @@ import argparse
 import glob
 import os
 import re
+import struct
 import subprocess
 import sys
 
@@ -57,8 +58,23 @@ Sample usage:
   $ scripts/symbolize.py -d out/arm-plat-hikey/core -d ../optee_test/out/ta/*
   <paste whole dump here>
   ^D
+
+With --folded, the script instead reads a sample buffer recorded by the core
+profiler pseudo TA (CFG_CORE_PROFILER=y, see PTA_PROFILER_CMD_READ) and
+outputs one line per distinct call stack with the number of times it was
+sampled, in the folded format expected by flamegraph.pl:
+
+  $ scripts/symbolize.py -d out/arm-plat-hikey/core --folded prof.bin | \
+        flamegraph.pl > prof.svg
 '''
 
+# Keep in sync with lib/libutee/include/pta_profiler.h
+PROF_BUF_MAGIC = 0x464f5250
+PROF_BUF_VERSION = 1
+PROF_HDR_FMT = '<IIIIII'
+PROF_CPU_BUF_FMT = '<Q'
+PROF_SAMPLE_HDR_FMT = '<II'
+
 
 def get_args():
     parser = argparse.ArgumentParser(
@@ -75,6 +91,9 @@ def get_args():
                         help='Strip STRIP_PATH from file paths (default: '
                         'current directory, use -s with no argument to show '
                         'full paths)', default=os.getcwd())
+    parser.add_argument('-f', '--folded', metavar='BUF',
+                        help='Read core profiler samples from BUF and '
+                        'output folded call stacks')
 
     return parser.parse_args()
 
@@ -85,6 +104,7 @@ class Symbolizer(object):
         self._dirs = dirs
         self._strip_path = strip_path
         self._addr2line = None
+        self._func_names = {}
         self.reset()
 
     def my_Popen(self, cmd):
@@ -198,6 +218,12 @@ class Symbolizer(object):
             ret = '!!!'
         return ret
 
+    def function_name(self, addr):
+        if addr not in self._func_names:
+            res = self.resolve(addr)
+            self._func_names[addr] = res.split(' at ')[0]
+        return self._func_names[addr]
+
     def symbol_plus_offset(self, addr):
         ret = ''
         prevsize = 0
@@ -428,6 +454,47 @@ class Symbolizer(object):
         self._out.flush()
 
 
+def read_samples(data):
+    hdr_size = struct.calcsize(PROF_HDR_FMT)
+    cpu_buf_size = struct.calcsize(PROF_CPU_BUF_FMT)
+    sample_hdr_size = struct.calcsize(PROF_SAMPLE_HDR_FMT)
+
+    magic, version, num_cpus, samples_per_cpu, max_depth, _ = \
+        struct.unpack_from(PROF_HDR_FMT, data, 0)
+    if magic != PROF_BUF_MAGIC:
+        sys.exit('Bad magic 0x{:x}'.format(magic))
+    if version != PROF_BUF_VERSION:
+        sys.exit('Unsupported version {}'.format(version))
+
+    pc_fmt = '<{}Q'.format(max_depth)
+    sample_size = sample_hdr_size + struct.calcsize(pc_fmt)
+    offs = hdr_size
+    for cpu in range(num_cpus):
+        head, = struct.unpack_from(PROF_CPU_BUF_FMT, data, offs)
+        for n in range(min(head, samples_per_cpu)):
+            s_offs = offs + cpu_buf_size + n * sample_size
+            _, depth = struct.unpack_from(PROF_SAMPLE_HDR_FMT, data, s_offs)
+            pcs = struct.unpack_from(pc_fmt, data, s_offs + sample_hdr_size)
+            yield pcs[:min(depth, max_depth)]
+        offs += cpu_buf_size + samples_per_cpu * sample_size
+
+
+def print_folded(symbolizer, buf):
+    with open(buf, 'rb') as f:
+        data = f.read()
+
+    stacks = {}
+    for pcs in read_samples(data):
+        # Outermost caller first
+        funcs = [symbolizer.function_name('0x{:x}'.format(pc))
+                 for pc in reversed(pcs)]
+        key = ';'.join(funcs)
+        stacks[key] = stacks.get(key, 0) + 1
+
+    for key in sorted(stacks):
+        sys.stdout.write('{} {}\n'.format(key, stacks[key]))
+
+
 def main():
     args = get_args()
     if args.dir:
@@ -438,6 +505,10 @@ def main():
         args.dirs = []
     symbolizer = Symbolizer(sys.stdout, args.dirs, args.strip_path)
 
+    if args.folded:
+        print_folded(symbolizer, args.folded)
+        return
+
     for line in sys.stdin:
         symbolizer.write(line)
     symbolizer.flush()
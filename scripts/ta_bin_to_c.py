@@ -8,9 +8,23 @@ import argparse
 import array
 import os
 import re
+import struct
 import uuid
 import zlib
 
+# Must match EARLY_TA_FORMAT_* in core/arch/arm/include/kernel/early_ta.h
+EARLY_TA_FORMAT_DEFLATE = 0
+EARLY_TA_FORMAT_LZ4 = 1
+
+# Uncompressed size of the independently compressed LZ4 blocks
+LZ4_BLOCK_SIZE = 16 * 1024
+LZ4_MIN_MATCH = 4
+# The last match must start at least 12 bytes before the end of the block
+# and the last 5 bytes are literals
+LZ4_MFLIMIT = 12
+LZ4_LAST_LITERALS = 5
+LZ4_MAX_OFFSET = 65535
+
 
 def get_args():
 
@@ -30,14 +44,81 @@ def get_args():
 
     parser.add_argument(
         '--compress',
-        dest="compress",
-        action="store_true",
-        help='Compress the TA using the DEFLATE '
-        'algorithm')
+        nargs='?',
+        const='deflate',
+        default='none',
+        choices=['none', 'deflate', 'lz4'],
+        help='Compress the TA using the DEFLATE algorithm (default when '
+        'no value is given) or in LZ4 blocks which are faster to '
+        'decompress')
 
     return parser.parse_args()
 
 
+def lz4_write_len(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def lz4_write_seq(out, lit, offs, mlen):
+    token = min(len(lit), 15) << 4
+    if offs:
+        token |= min(mlen - LZ4_MIN_MATCH, 15)
+    out.append(token)
+    if len(lit) >= 15:
+        lz4_write_len(out, len(lit) - 15)
+    out += lit
+    if offs:
+        out += struct.pack('<H', offs)
+        if mlen - LZ4_MIN_MATCH >= 15:
+            lz4_write_len(out, mlen - LZ4_MIN_MATCH - 15)
+
+
+def lz4_compress_block(src):
+    # Greedy matching with the last occurrence of each 4 bytes sequence
+    out = bytearray()
+    last = {}
+    anchor = 0
+    i = 0
+    while i < len(src) - LZ4_MFLIMIT:
+        seq = bytes(src[i:i + LZ4_MIN_MATCH])
+        ref = last.get(seq)
+        last[seq] = i
+        if ref is None or i - ref > LZ4_MAX_OFFSET:
+            i += 1
+            continue
+        mlen = LZ4_MIN_MATCH
+        while (i + mlen < len(src) - LZ4_LAST_LITERALS and
+               src[ref + mlen] == src[i + mlen]):
+            mlen += 1
+        lz4_write_seq(out, src[anchor:i], i - ref, mlen)
+        for j in range(i + 1, min(i + mlen, len(src) - LZ4_MFLIMIT)):
+            last[bytes(src[j:j + LZ4_MIN_MATCH])] = j
+        i += mlen
+        anchor = i
+    lz4_write_seq(out, src[anchor:], 0, 0)
+    return out
+
+
+def lz4_compress(data):
+    # See EARLY_TA_FORMAT_LZ4 in core/arch/arm/include/kernel/early_ta.h
+    blocks = bytearray()
+    offs = []
+    for i in range(0, len(data), LZ4_BLOCK_SIZE):
+        block = data[i:i + LZ4_BLOCK_SIZE]
+        c = lz4_compress_block(block)
+        if len(c) >= len(block):
+            c = block
+        offs.append(len(blocks))
+        blocks += c
+    offs.append(len(blocks))
+    hdr = struct.pack('<II', LZ4_BLOCK_SIZE, len(offs) - 1)
+    hdr += struct.pack('<{:d}I'.format(len(offs)), *offs)
+    return bytearray(hdr) + blocks
+
+
 def main():
 
     args = get_args()
@@ -45,10 +126,14 @@ def main():
     ta_uuid = uuid.UUID(re.sub(r'\..*', '', os.path.basename(args.ta)))
 
     with open(args.ta, 'rb') as ta:
-        bytes = ta.read()
+        bytes = bytearray(ta.read())
         uncompressed_size = len(bytes)
-        if args.compress:
-            bytes = zlib.compress(bytes)
+        if args.compress == 'deflate':
+            bytes = bytearray(zlib.compress(bytes))
+            fmt = EARLY_TA_FORMAT_DEFLATE
+        elif args.compress == 'lz4':
+            bytes = lz4_compress(bytes)
+            fmt = EARLY_TA_FORMAT_LZ4
         size = len(bytes)
 
     f = open(args.out, 'w')
@@ -71,15 +156,16 @@ def main():
     f.write(', '.join('0x' + csn[i:i + 2] for i in range(0, len(csn), 2)))
     f.write('\n\t\t},\n\t},\n')
     f.write('\t.size = {:d},\n'.format(size))
-    if args.compress:
+    if args.compress != 'none':
         f.write('\t.uncompressed_size = '
                 '{:d},\n'.format(uncompressed_size))
+        f.write('\t.format = {:d},\n'.format(fmt))
     f.write('\t.ta = {\n')
     i = 0
     while i < size:
         if i % 8 == 0:
             f.write('\t\t')
-        f.write('0x' + '{:02x}'.format(ord(bytes[i])) + ',')
+        f.write('0x' + '{:02x}'.format(bytes[i]) + ',')
         i = i + 1
         if i % 8 == 0 or i == size:
             f.write('\n')
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2019, Linaro Limited
+#
+
+import argparse
+import json
+import struct
+import sys
+
+# Keep in sync with lib/libutee/include/pta_tracepoint.h
+TP_BUF_MAGIC = 0x4f505450
+TP_BUF_VERSION = 1
+HDR_FMT = '<IIIIQ'
+CPU_BUF_FMT = '<Q'
+EVENT_FMT = '<QHBBIQQ'
+
+TP_NO_THREAD = 0xff
+PHASES = {0: 'i', 1: 'B', 2: 'E'}
+
+EVENTS = {
+    0: 'std_smc',
+    1: 'fast_smc',
+    2: 'thread_alloc',
+    3: 'thread_suspend',
+    4: 'thread_resume',
+    5: 'rpc',
+    6: 'pager_fault',
+    7: 'pager_load',
+    8: 'pager_evict',
+    9: 'storage_read',
+    10: 'storage_write',
+    11: 'crypto',
+    12: 'ta_load',
+}
+
+epilog = '''
+This script reads an event buffer recorded by the OP-TEE tracepoint pseudo TA
+(CFG_CORE_TRACEPOINTS=y, see PTA_TRACEPOINT_CMD_READ) and converts it to the
+Trace Event JSON format, which can be loaded in chrome://tracing or in the
+Perfetto UI. Each CPU is shown as a process and each thread as a track.
+'''
+
+
+def get_args():
+    parser = argparse.ArgumentParser(description='Converts an OP-TEE '
+                                     'tracepoint buffer into a timeline',
+                                     epilog=epilog)
+    parser.add_argument('buf', help='the binary event buffer')
+    parser.add_argument('-o', '--out', default='-',
+                        help='output JSON file (default: stdout)')
+    return parser.parse_args()
+
+
+def parse_events(data):
+    hdr_size = struct.calcsize(HDR_FMT)
+    cpu_buf_size = struct.calcsize(CPU_BUF_FMT)
+    ev_size = struct.calcsize(EVENT_FMT)
+
+    magic, version, num_cpus, events_per_cpu, cntfrq = \
+        struct.unpack_from(HDR_FMT, data, 0)
+    if magic != TP_BUF_MAGIC:
+        sys.exit('Bad magic 0x{:x}'.format(magic))
+    if version != TP_BUF_VERSION:
+        sys.exit('Unsupported version {}'.format(version))
+    if not cntfrq:
+        sys.exit('Invalid counter frequency')
+
+    events = []
+    offs = hdr_size
+    for cpu in range(num_cpus):
+        head, = struct.unpack_from(CPU_BUF_FMT, data, offs)
+        first = max(0, head - events_per_cpu)
+        for n in range(first, head):
+            ev_offs = offs + cpu_buf_size + (n % events_per_cpu) * ev_size
+            ts, eid, phase, thread, arg0, arg1, arg2 = \
+                struct.unpack_from(EVENT_FMT, data, ev_offs)
+            events.append((ts, cpu, eid, phase, thread, arg0, arg1, arg2))
+        offs += cpu_buf_size + events_per_cpu * ev_size
+
+    events.sort()
+    return cntfrq, events
+
+
+def to_trace_events(cntfrq, events):
+    out = []
+    if not events:
+        return out
+    t0 = events[0][0]
+    for ts, cpu, eid, phase, thread, arg0, arg1, arg2 in events:
+        e = {
+            'name': EVENTS.get(eid, 'event_{}'.format(eid)),
+            'ph': PHASES.get(phase, 'i'),
+            'ts': (ts - t0) * 1000000.0 / cntfrq,
+            'pid': cpu,
+            'tid': -1 if thread == TP_NO_THREAD else thread,
+            'args': {
+                'arg0': '0x{:x}'.format(arg0),
+                'arg1': '0x{:x}'.format(arg1),
+                'arg2': '0x{:x}'.format(arg2),
+            },
+        }
+        if e['ph'] == 'i':
+            e['s'] = 't'
+        out.append(e)
+    return out
+
+
+def main():
+    args = get_args()
+
+    with open(args.buf, 'rb') as f:
+        data = f.read()
+
+    cntfrq, events = parse_events(data)
+    trace = {'traceEvents': to_trace_events(cntfrq, events),
+             'displayTimeUnit': 'ns'}
+
+    if args.out == '-':
+        json.dump(trace, sys.stdout, indent=1)
+    else:
+        with open(args.out, 'w') as f:
+            json.dump(trace, f, indent=1)
+
+
+if __name__ == "__main__":
+    main()